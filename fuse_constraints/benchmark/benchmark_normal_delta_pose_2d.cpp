@@ -0,0 +1,95 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/normal_delta_pose_2d.h>
+#include <fuse_constraints/normal_delta_pose_2d_cost_functor.h>
+#include <fuse_core/eigen.h>
+
+#include <benchmark/benchmark.h>
+#include <ceres/autodiff_cost_function.h>
+#include <ceres/cost_function.h>
+
+#include <memory>
+
+
+/**
+ * @brief Evaluate the residuals and Jacobians of a relative 2D pose cost function
+ *
+ * This is the operation Ceres performs for every relative pose constraint on every solver iteration.
+ */
+static void evaluateCostFunction(benchmark::State& state, const ceres::CostFunction& cost_function)
+{
+  double position1[] = {1.5, -2.0};
+  double orientation1[] = {0.3};
+  double position2[] = {2.5, -1.0};
+  double orientation2[] = {0.5};
+  const double* parameters[] = {position1, orientation1, position2, orientation2};
+  double residuals[3];
+  double jacobian_position1[6];
+  double jacobian_orientation1[3];
+  double jacobian_position2[6];
+  double jacobian_orientation2[3];
+  double* jacobians[] = {jacobian_position1, jacobian_orientation1, jacobian_position2, jacobian_orientation2};
+  for (auto _ : state)
+  {
+    cost_function.Evaluate(parameters, residuals, jacobians);
+    benchmark::DoNotOptimize(residuals);
+    benchmark::DoNotOptimize(jacobians);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static fuse_core::Matrix3d sqrtInformation()
+{
+  fuse_core::Matrix3d A;
+  A << 1.0, 0.1, 0.2,  0.0, 2.0, 0.3,  0.0, 0.0, 3.0;
+  return A;
+}
+
+static void BM_autoDiff(benchmark::State& state)
+{
+  ceres::AutoDiffCostFunction<fuse_constraints::NormalDeltaPose2DCostFunctor, ceres::DYNAMIC, 2, 1, 2, 1> cost_function(
+    new fuse_constraints::NormalDeltaPose2DCostFunctor(sqrtInformation(), fuse_core::Vector3d(1.0, 1.0, 0.2)), 3);
+  evaluateCostFunction(state, cost_function);
+}
+BENCHMARK(BM_autoDiff);
+
+static void BM_analytic(benchmark::State& state)
+{
+  fuse_constraints::NormalDeltaPose2D cost_function(sqrtInformation(), fuse_core::Vector3d(1.0, 1.0, 0.2));
+  evaluateCostFunction(state, cost_function);
+}
+BENCHMARK(BM_analytic);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/normal_prior_orientation_3d_euler.h>
+#include <fuse_constraints/normal_prior_orientation_3d_euler_cost_functor.h>
+#include <fuse_core/eigen.h>
+#include <fuse_variables/orientation_3d_stamped.h>
+
+#include <benchmark/benchmark.h>
+#include <ceres/autodiff_cost_function.h>
+#include <ceres/cost_function.h>
+
+#include <vector>
+
+
+using Euler = fuse_variables::Orientation3DStamped::Euler;
+
+/**
+ * @brief Evaluate the residuals and Jacobians of an Euler orientation prior cost function
+ */
+static void evaluateCostFunction(benchmark::State& state, const ceres::CostFunction& cost_function)
+{
+  double orientation[] = {0.952, 0.038, -0.189, 0.239};
+  const double* parameters[] = {orientation};
+  double residuals[3];
+  double jacobian_orientation[12];
+  double* jacobians[] = {jacobian_orientation};
+  for (auto _ : state)
+  {
+    cost_function.Evaluate(parameters, residuals, jacobians);
+    benchmark::DoNotOptimize(residuals);
+    benchmark::DoNotOptimize(jacobians);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static fuse_core::Matrix3d sqrtInformation()
+{
+  fuse_core::Matrix3d A;
+  A << 1.0, 0.1, 0.2,  0.0, 2.0, 0.3,  0.0, 0.0, 3.0;
+  return A;
+}
+
+static const std::vector<Euler> axes = {Euler::ROLL, Euler::PITCH, Euler::YAW};  // NOLINT
+
+static void BM_autoDiff(benchmark::State& state)
+{
+  ceres::AutoDiffCostFunction<fuse_constraints::NormalPriorOrientation3DEulerCostFunctor, 3, 4> cost_function(
+    new fuse_constraints::NormalPriorOrientation3DEulerCostFunctor(
+      sqrtInformation(), fuse_core::Vector3d(0.1, -0.4, 0.5), axes));
+  evaluateCostFunction(state, cost_function);
+}
+BENCHMARK(BM_autoDiff);
+
+static void BM_analytic(benchmark::State& state)
+{
+  fuse_constraints::NormalPriorOrientation3DEuler cost_function(
+    sqrtInformation(), fuse_core::Vector3d(0.1, -0.4, 0.5), axes);
+  evaluateCostFunction(state, cost_function);
+}
+BENCHMARK(BM_analytic);
+
+BENCHMARK_MAIN();
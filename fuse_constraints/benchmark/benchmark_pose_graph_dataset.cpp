@@ -0,0 +1,102 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/pose_graph_io.h>
+#include <fuse_graphs/hash_graph.h>
+
+#include <ceres/solver.h>
+#include <ceres/types.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+
+/**
+ * @brief Load a g2o or TORO pose graph dataset, optimize it, and report the solve time and final chi-squared error
+ *
+ * This allows the fuse solve performance to be compared against the published results of other back ends on the
+ * standard pose graph datasets (e.g. Intel, Manhattan, sphere, garage, and torus). The chi-squared error is the sum of
+ * the squared, information-weighted residuals, which is twice the Ceres cost.
+ *
+ * Usage: benchmark_pose_graph_dataset <dataset> [max_iterations] [output_dataset]
+ */
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <dataset> [max_iterations] [output_dataset]\n";
+    return EXIT_FAILURE;
+  }
+  using Clock = std::chrono::steady_clock;
+  try
+  {
+    fuse_graphs::HashGraph graph;
+    const auto load_start = Clock::now();
+    fuse_constraints::loadPoseGraph(std::string(argv[1]), graph);
+    const std::chrono::duration<double> load_time = Clock::now() - load_start;
+
+    ceres::Solver::Options options;
+    options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
+    options.max_num_iterations = (argc > 2) ? std::stoi(argv[2]) : 100;
+    const auto solve_start = Clock::now();
+    const auto summary = graph.optimize(options);
+    const std::chrono::duration<double> solve_time = Clock::now() - solve_start;
+
+    std::cout << "dataset:            " << argv[1] << "\n"
+              << "variables:          " << std::distance(graph.getVariables().begin(), graph.getVariables().end())
+              << "\n"
+              << "constraints:        "
+              << std::distance(graph.getConstraints().begin(), graph.getConstraints().end()) << "\n"
+              << "load time (s):      " << load_time.count() << "\n"
+              << "solve time (s):     " << solve_time.count() << "\n"
+              << "iterations:         " << summary.num_successful_steps + summary.num_unsuccessful_steps << "\n"
+              << "initial chi2:       " << 2.0 * summary.initial_cost << "\n"
+              << "final chi2:         " << 2.0 * summary.final_cost << "\n"
+              << "termination:        " << ceres::TerminationTypeToString(summary.termination_type) << "\n";
+
+    if (argc > 3)
+    {
+      fuse_constraints::savePoseGraph(graph, std::string(argv[3]));
+    }
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -81,6 +81,17 @@ public:
     const fuse_core::VectorXd& mean,
     const fuse_core::MatrixXd& covariance);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  AbsoluteConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const Variable& variable,
+    const fuse_core::VectorXd& mean,
+    const fuse_core::MatrixXd& covariance);
+
   /**
    * @brief Create a constraint using a measurement/prior of only a partial set of dimensions of the target variable
    *
@@ -95,6 +106,18 @@ public:
     const fuse_core::MatrixXd& partial_covariance,
     const std::vector<size_t>& indices);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  AbsoluteConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const Variable& variable,
+    const fuse_core::VectorXd& partial_mean,
+    const fuse_core::MatrixXd& partial_covariance,
+    const std::vector<size_t>& indices);
+
   /**
    * @brief Destructor
    */
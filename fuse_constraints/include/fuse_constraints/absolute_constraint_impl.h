@@ -35,10 +35,14 @@
 #define FUSE_CONSTRAINTS_ABSOLUTE_CONSTRAINT_IMPL_H
 
 #include <fuse_constraints/normal_prior_orientation_2d.h>
+#include <fuse_core/measurement_key.h>
 
+#include <boost/core/demangle.hpp>
 #include <ceres/normal_prior.h>
 #include <Eigen/Dense>
 
+#include <string>
+#include <typeinfo>
 #include <vector>
 
 
@@ -59,6 +63,18 @@ AbsoluteConstraint<Variable>::AbsoluteConstraint(
   assert(covariance.cols() == static_cast<int>(variable.size()));
 }
 
+template<class Variable>
+AbsoluteConstraint<Variable>::AbsoluteConstraint(
+  fuse_core::ContentAddressed,
+  const Variable& variable,
+  const fuse_core::VectorXd& mean,
+  const fuse_core::MatrixXd& covariance) :
+    AbsoluteConstraint(variable, mean, covariance)
+{
+  static const std::string type = boost::core::demangle(typeid(AbsoluteConstraint).name());
+  setContentAddressedUuid(type, fuse_core::measurementKey(mean, covariance));
+}
+
 template<class Variable>
 AbsoluteConstraint<Variable>::AbsoluteConstraint(
   const Variable& variable,
@@ -88,6 +104,19 @@ AbsoluteConstraint<Variable>::AbsoluteConstraint(
   }
 }
 
+template<class Variable>
+AbsoluteConstraint<Variable>::AbsoluteConstraint(
+  fuse_core::ContentAddressed,
+  const Variable& variable,
+  const fuse_core::VectorXd& partial_mean,
+  const fuse_core::MatrixXd& partial_covariance,
+  const std::vector<size_t>& indices) :
+    AbsoluteConstraint(variable, partial_mean, partial_covariance, indices)
+{
+  static const std::string type = boost::core::demangle(typeid(AbsoluteConstraint).name());
+  setContentAddressedUuid(type, fuse_core::measurementKey(partial_mean, partial_covariance, indices));
+}
+
 template<class Variable>
 fuse_core::MatrixXd AbsoluteConstraint<Variable>::covariance() const
 {
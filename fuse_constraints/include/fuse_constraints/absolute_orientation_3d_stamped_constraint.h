@@ -74,6 +74,17 @@ public:
     const fuse_core::Vector4d& mean,
     const fuse_core::Matrix3d& covariance);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  AbsoluteOrientation3DStampedConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const fuse_variables::Orientation3DStamped& orientation,
+    const fuse_core::Vector4d& mean,
+    const fuse_core::Matrix3d& covariance);
+
   /**
    * @brief Create a constraint using a measurement/prior of a 3D orientation
    *
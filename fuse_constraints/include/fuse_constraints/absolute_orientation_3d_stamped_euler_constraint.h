@@ -80,6 +80,18 @@ public:
     const fuse_core::MatrixXd& covariance,
     const std::vector<Euler> &axes);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  AbsoluteOrientation3DStampedEulerConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const fuse_variables::Orientation3DStamped& orientation,
+    const fuse_core::VectorXd& mean,
+    const fuse_core::MatrixXd& covariance,
+    const std::vector<Euler> &axes);
+
   /**
    * @brief Destructor
    */
@@ -79,6 +79,18 @@ public:
     const fuse_core::Vector7d& mean,
     const fuse_core::Matrix6d& covariance);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  AbsolutePose3DStampedConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const fuse_variables::Position3DStamped& position,
+    const fuse_variables::Orientation3DStamped& orientation,
+    const fuse_core::Vector7d& mean,
+    const fuse_core::Matrix6d& covariance);
+
   /**
    * @brief Destructor
    */
@@ -0,0 +1,105 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CONSTRAINTS_FIXED_SIZE_COST_FUNCTION_H
+#define FUSE_CONSTRAINTS_FIXED_SIZE_COST_FUNCTION_H
+
+#include <ceres/autodiff_cost_function.h>
+#include <ceres/cost_function.h>
+
+#include <stdexcept>
+#include <string>
+
+
+namespace fuse_constraints
+{
+
+namespace detail
+{
+
+/**
+ * @brief Recursively search for the compile-time residual count that matches the runtime residual count
+ */
+template <typename Functor, int NUM_RESIDUALS, int... PARAMETER_SIZES>
+struct FixedSizeAutoDiffCostFunctionFactory
+{
+  static ceres::CostFunction* create(Functor* functor, int num_residuals)
+  {
+    if (num_residuals == NUM_RESIDUALS)
+    {
+      return new ceres::AutoDiffCostFunction<Functor, NUM_RESIDUALS, PARAMETER_SIZES...>(functor);
+    }
+    return FixedSizeAutoDiffCostFunctionFactory<Functor, NUM_RESIDUALS - 1, PARAMETER_SIZES...>::create(
+      functor, num_residuals);
+  }
+};
+
+template <typename Functor, int... PARAMETER_SIZES>
+struct FixedSizeAutoDiffCostFunctionFactory<Functor, 0, PARAMETER_SIZES...>
+{
+  static ceres::CostFunction* create(Functor* functor, int num_residuals)
+  {
+    delete functor;
+    throw std::invalid_argument("Unsupported number of residuals (" + std::to_string(num_residuals) + ").");
+  }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Create an automatically differentiated cost function with a compile-time residual count
+ *
+ * Constraints that support partial measurements only know the number of residuals at runtime. Using a
+ * ceres::AutoDiffCostFunction with a ceres::DYNAMIC residual count prevents Ceres from sizing the Jet arrays at
+ * compile time. Instead, this instantiates a fixed-size AutoDiffCostFunction for every residual count between 1 and
+ * \p MAX_RESIDUALS, and selects the matching one at runtime.
+ *
+ * Exceptions: If \p num_residuals is not in the range [1, MAX_RESIDUALS], a std::invalid_argument exception is thrown
+ *
+ * @tparam Functor         The cost functor type. It must support any number of residuals up to MAX_RESIDUALS.
+ * @tparam MAX_RESIDUALS   The largest number of residuals the functor can produce
+ * @tparam PARAMETER_SIZES The size of each parameter block
+ * @param[in] functor       The cost functor. The returned cost function takes ownership of the functor.
+ * @param[in] num_residuals The number of residuals produced by the functor
+ * @return                  A new cost function. The caller takes ownership of the cost function.
+ */
+template <typename Functor, int MAX_RESIDUALS, int... PARAMETER_SIZES>
+ceres::CostFunction* makeFixedSizeAutoDiffCostFunction(Functor* functor, int num_residuals)
+{
+  return detail::FixedSizeAutoDiffCostFunctionFactory<Functor, MAX_RESIDUALS, PARAMETER_SIZES...>::create(
+    functor, num_residuals);
+}
+
+}  // namespace fuse_constraints
+
+#endif  // FUSE_CONSTRAINTS_FIXED_SIZE_COST_FUNCTION_H
@@ -0,0 +1,94 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CONSTRAINTS_NORMAL_DELTA_POSE_2D_H
+#define FUSE_CONSTRAINTS_NORMAL_DELTA_POSE_2D_H
+
+#include <fuse_core/eigen.h>
+
+#include <ceres/cost_function.h>
+
+
+namespace fuse_constraints
+{
+
+/**
+ * @brief Implements a cost function that models a difference between pose variables, with analytic Jacobians
+ *
+ * This computes the same cost as the NormalDeltaPose2DCostFunctor:
+ *
+ *             ||    [ delta.x   - b(0)] ||^2
+ *   cost(x) = ||A * [ delta.y   - b(1)] ||
+ *             ||    [ delta.yaw - b(2)] ||
+ *
+ * where delta = [R1 | t1]^-1 * [R2 | t2]. However, the Jacobians are computed in closed form using fixed-size
+ * matrices, rather than using automatic differentiation. Relative pose constraints are typically the most numerous
+ * constraints in a graph, and avoiding the Jet arithmetic of the autodiff version significantly reduces the cost of
+ * each residual block evaluation.
+ *
+ * The matrix A may have fewer than three rows, allowing a subset of the pose dimensions to be constrained.
+ */
+class NormalDeltaPose2D : public ceres::CostFunction
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] A The residual weighting matrix, most likely the square root information matrix in order (x, y, yaw).
+   *              The matrix must have three columns, and between one and three rows.
+   * @param[in] b The exposed pose difference in order (x, y, yaw)
+   */
+  NormalDeltaPose2D(const fuse_core::MatrixXd& A, const fuse_core::Vector3d& b);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~NormalDeltaPose2D() = default;
+
+  /**
+   * @brief Compute the cost values/residuals, and optionally the Jacobians, using the provided variable/parameter
+   *        values
+   */
+  virtual bool Evaluate(
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians) const;
+
+private:
+  fuse_core::MatrixXd A_;  //!< The residual weighting matrix, most likely the square root information matrix
+  fuse_core::Vector3d b_;  //!< The measured difference between the two poses
+};
+
+}  // namespace fuse_constraints
+
+#endif  // FUSE_CONSTRAINTS_NORMAL_DELTA_POSE_2D_H
@@ -0,0 +1,104 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CONSTRAINTS_NORMAL_PRIOR_ORIENTATION_3D_EULER_H
+#define FUSE_CONSTRAINTS_NORMAL_PRIOR_ORIENTATION_3D_EULER_H
+
+#include <fuse_core/eigen.h>
+#include <fuse_variables/orientation_3d_stamped.h>
+
+#include <ceres/cost_function.h>
+
+#include <vector>
+
+
+namespace fuse_constraints
+{
+
+/**
+ * @brief Implements a prior cost function on a 3D orientation variable using Euler angles, with analytic Jacobians
+ *
+ * This computes the same cost as the NormalPriorOrientation3DEulerCostFunctor:
+ *
+ *   cost(x) = || A * [ angle_0(x) - b(0) ] ||^2
+ *             ||     [ angle_1(x) - b(1) ] ||
+ *             ||     [     ...           ] ||
+ *
+ * where angle_i is the roll, pitch, or yaw of the orientation quaternion, as selected by the \p axes. However, the
+ * Jacobians of the Euler angle extraction with respect to the quaternion are computed in closed form, rather than by
+ * evaluating atan2 and asin on Jets.
+ *
+ * The Jacobians match the automatic differentiation of fuse_variables::getRoll(), getPitch(), and getYaw(), including
+ * at the pitch singularity. Once |sin(pitch)| reaches 1, the pitch is clamped to +/-pi/2 and its derivative is zero.
+ */
+class NormalPriorOrientation3DEuler : public ceres::CostFunction
+{
+public:
+  using Euler = fuse_variables::Orientation3DStamped::Euler;
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] A The residual weighting matrix, most likely the square root information matrix. Its order must match
+   *              the values in \p axes.
+   * @param[in] b The orientation measurement or prior. Its order must match the values in \p axes.
+   * @param[in] axes The Euler angle axes for which we want to compute errors. Between one and three axes may be used.
+   */
+  NormalPriorOrientation3DEuler(
+    const fuse_core::MatrixXd& A,
+    const fuse_core::VectorXd& b,
+    const std::vector<Euler>& axes);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~NormalPriorOrientation3DEuler() = default;
+
+  /**
+   * @brief Compute the cost values/residuals, and optionally the Jacobians, using the provided variable/parameter
+   *        values
+   */
+  virtual bool Evaluate(
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians) const;
+
+private:
+  fuse_core::MatrixXd A_;  //!< The residual weighting matrix, most likely the square root information matrix
+  fuse_core::VectorXd b_;  //!< The measured Euler angles
+  std::vector<Euler> axes_;  //!< The Euler angle axes that we're measuring
+};
+
+}  // namespace fuse_constraints
+
+#endif  // FUSE_CONSTRAINTS_NORMAL_PRIOR_ORIENTATION_3D_EULER_H
@@ -69,10 +69,12 @@ public:
   /**
    * @brief Construct a cost function instance
    *
-   * @param[in] A The residual weighting matrix, most likely the square root information matrix in order (x, y, yaw)
+   * @param[in] A The residual weighting matrix, most likely the square root information matrix in order (x, y, yaw).
+   *              The matrix must have three columns, and between one and three rows. One residual is produced for
+   *              each row.
    * @param[in] b The pose measurement or prior in order (x, y, yaw)
    */
-  NormalPriorPose2DCostFunctor(const fuse_core::Matrix3d& A, const fuse_core::Vector3d& b);
+  NormalPriorPose2DCostFunctor(const fuse_core::MatrixXd& A, const fuse_core::Vector3d& b);
 
   /**
    * @brief Evaluate the cost function. Used by the Ceres optimization engine.
@@ -81,11 +83,13 @@ public:
   bool operator()(const T* const position, const T* const orientation, T* residual) const;
 
 private:
-  fuse_core::Matrix3d A_;  //!< The residual weighting matrix, most likely the square root information matrix
+  using WeightMatrix = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor, 3, 3>;
+
+  WeightMatrix A_;  //!< The residual weighting matrix, most likely the square root information matrix
   fuse_core::Vector3d b_;  //!< The measured 2D pose value
 };
 
-NormalPriorPose2DCostFunctor::NormalPriorPose2DCostFunctor(const fuse_core::Matrix3d& A, const fuse_core::Vector3d& b) :
+NormalPriorPose2DCostFunctor::NormalPriorPose2DCostFunctor(const fuse_core::MatrixXd& A, const fuse_core::Vector3d& b) :
   A_(A),
   b_(b)
 {
@@ -94,14 +98,15 @@ NormalPriorPose2DCostFunctor::NormalPriorPose2DCostFunctor(const fuse_core::Matr
 template <typename T>
 bool NormalPriorPose2DCostFunctor::operator()(const T* const position, const T* const orientation, T* residual) const
 {
-  Eigen::Map<Eigen::Matrix<T, 3, 1>> residuals_map(residual);
-  residuals_map(0) = position[0] - T(b_(0));
-  residuals_map(1) = position[1] - T(b_(1));
-  residuals_map(2) = orientation[0] - T(b_(2));
-  wrapAngle2D(residuals_map(2));
+  Eigen::Matrix<T, 3, 1> error;
+  error(0) = position[0] - T(b_(0));
+  error(1) = position[1] - T(b_(1));
+  error(2) = orientation[0] - T(b_(2));
+  wrapAngle2D(error(2));
   // Scale the residuals by the square root information matrix to account for
-  // the measurement uncertainty.
-  residuals_map.applyOnTheLeft(A_.template cast<T>());
+  // the measurement uncertainty. The number of residuals is the number of rows in A.
+  Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1>> residuals_map(residual, A_.rows());
+  residuals_map.noalias() = A_.template cast<T>() * error;
   return true;
 }
 
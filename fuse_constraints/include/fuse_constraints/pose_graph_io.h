@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CONSTRAINTS_POSE_GRAPH_IO_H
+#define FUSE_CONSTRAINTS_POSE_GRAPH_IO_H
+
+#include <fuse_core/graph.h>
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+
+namespace fuse_constraints
+{
+
+/**
+ * @brief The supported pose graph dataset file formats
+ */
+enum class PoseGraphFormat
+{
+  G2O,  //!< The g2o format: VERTEX_SE2, EDGE_SE2, VERTEX_SE3:QUAT, EDGE_SE3:QUAT, and FIX records
+  TORO  //!< The TORO format: VERTEX2, EDGE2, VERTEX3, and EDGE3 records
+};
+
+/**
+ * @brief Load a g2o or TORO pose graph dataset into a graph
+ *
+ * This allows fuse to be compared against other back ends on the standard pose graph benchmarks (e.g. Intel,
+ * Manhattan, sphere, garage, and torus). Both formats may be read by the same function, as the format is determined
+ * by the record tags. Blank lines and lines starting with '#' are ignored.
+ *
+ * Each vertex is converted into a position and an orientation variable, using the vertex id as the timestamp (in
+ * seconds) of the variables: fuse_variables::Position2DStamped and fuse_variables::Orientation2DStamped for 2D
+ * vertices, and fuse_variables::Position3DStamped and fuse_variables::Orientation3DStamped for 3D vertices. Each edge
+ * is converted into a fuse_constraints::RelativePose2DStampedConstraint or
+ * fuse_constraints::RelativePose3DStampedConstraint, with the covariance computed from the edge information matrix.
+ *
+ * The vertices listed in g2o FIX records are held constant. If the dataset contains no FIX records, the vertex with
+ * the smallest id is held constant to remove the gauge freedom, which is the convention of the standard benchmarks.
+ *
+ * The TORO EDGE3 information matrix is expressed in terms of roll, pitch, and yaw. It is used directly as the
+ * information of the fuse rotation error, which is valid for the small rotation errors seen near the solution.
+ *
+ * Exceptions: If the dataset is malformed, references an unknown vertex, defines a vertex more than once, or contains
+ *             an unsupported record, a std::runtime_error exception will be thrown. The graph is not modified in that
+ *             case.
+ *
+ * @param[in]  stream The stream to read the dataset from
+ * @param[out] graph  The graph to add the variables and constraints to
+ */
+void loadPoseGraph(std::istream& stream, fuse_core::Graph& graph);
+
+/**
+ * @brief Load a g2o or TORO pose graph dataset file into a graph
+ *
+ * See loadPoseGraph(std::istream&, fuse_core::Graph&) for details.
+ *
+ * Exceptions: If the file cannot be opened, a std::runtime_error exception will be thrown.
+ *
+ * @param[in]  filename The dataset file to read
+ * @param[out] graph    The graph to add the variables and constraints to
+ */
+void loadPoseGraph(const std::string& filename, fuse_core::Graph& graph);
+
+/**
+ * @brief Write the poses and relative pose constraints of a graph as a g2o or TORO pose graph dataset
+ *
+ * Every stamp that has both a position and an orientation variable of matching dimension is written as a vertex.
+ * Vertex ids are assigned sequentially in stamp order, so a dataset loaded with loadPoseGraph() is written back with
+ * its original ids (provided the original ids were sequential). Every RelativePose2DStampedConstraint and
+ * RelativePose3DStampedConstraint between exported vertices is written as an edge. Other variables and constraints
+ * are not part of the file formats and are skipped. Held variables are not recorded.
+ *
+ * @param[in]  graph  The graph to export
+ * @param[out] stream The stream to write the dataset to
+ * @param[in]  format The file format to write
+ */
+void savePoseGraph(const fuse_core::Graph& graph, std::ostream& stream, PoseGraphFormat format = PoseGraphFormat::G2O);
+
+/**
+ * @brief Write the poses and relative pose constraints of a graph to a g2o or TORO pose graph dataset file
+ *
+ * See savePoseGraph(const fuse_core::Graph&, std::ostream&, PoseGraphFormat) for details.
+ *
+ * Exceptions: If the file cannot be written, a std::runtime_error exception will be thrown.
+ *
+ * @param[in] graph    The graph to export
+ * @param[in] filename The dataset file to write
+ * @param[in] format   The file format to write
+ */
+void savePoseGraph(
+  const fuse_core::Graph& graph,
+  const std::string& filename,
+  PoseGraphFormat format = PoseGraphFormat::G2O);
+
+}  // namespace fuse_constraints
+
+#endif  // FUSE_CONSTRAINTS_POSE_GRAPH_IO_H
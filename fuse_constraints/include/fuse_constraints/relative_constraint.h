@@ -86,6 +86,18 @@ public:
     const fuse_core::VectorXd& delta,
     const fuse_core::MatrixXd& covariance);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  RelativeConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const Variable& variable1,
+    const Variable& variable2,
+    const fuse_core::VectorXd& delta,
+    const fuse_core::MatrixXd& covariance);
+
   /**
    * @brief Constructor
    *
@@ -104,6 +116,19 @@ public:
     const fuse_core::MatrixXd& covariance,
     const std::vector<size_t>& indices);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  RelativeConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const Variable& variable1,
+    const Variable& variable2,
+    const fuse_core::VectorXd& delta,
+    const fuse_core::MatrixXd& covariance,
+    const std::vector<size_t>& indices);
+
   /**
    * @brief Destructor
    */
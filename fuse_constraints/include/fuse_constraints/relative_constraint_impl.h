@@ -36,9 +36,13 @@
 
 #include <fuse_constraints/normal_delta.h>
 #include <fuse_constraints/normal_delta_orientation_2d.h>
+#include <fuse_core/measurement_key.h>
 
+#include <boost/core/demangle.hpp>
 #include <Eigen/Dense>
 
+#include <string>
+#include <typeinfo>
 #include <vector>
 
 
@@ -61,6 +65,19 @@ RelativeConstraint<Variable>::RelativeConstraint(
   assert(covariance.cols() == static_cast<int>(variable1.size()));
 }
 
+template<class Variable>
+RelativeConstraint<Variable>::RelativeConstraint(
+  fuse_core::ContentAddressed,
+  const Variable& variable1,
+  const Variable& variable2,
+  const fuse_core::VectorXd& delta,
+  const fuse_core::MatrixXd& covariance) :
+    RelativeConstraint(variable1, variable2, delta, covariance)
+{
+  static const std::string type = boost::core::demangle(typeid(RelativeConstraint).name());
+  setContentAddressedUuid(type, fuse_core::measurementKey(delta, covariance));
+}
+
 template<class Variable>
 RelativeConstraint<Variable>::RelativeConstraint(
   const Variable& variable1,
@@ -92,6 +109,20 @@ RelativeConstraint<Variable>::RelativeConstraint(
   }
 }
 
+template<class Variable>
+RelativeConstraint<Variable>::RelativeConstraint(
+  fuse_core::ContentAddressed,
+  const Variable& variable1,
+  const Variable& variable2,
+  const fuse_core::VectorXd& partial_delta,
+  const fuse_core::MatrixXd& partial_covariance,
+  const std::vector<size_t>& indices) :
+    RelativeConstraint(variable1, variable2, partial_delta, partial_covariance, indices)
+{
+  static const std::string type = boost::core::demangle(typeid(RelativeConstraint).name());
+  setContentAddressedUuid(type, fuse_core::measurementKey(partial_delta, partial_covariance, indices));
+}
+
 template<class Variable>
 fuse_core::MatrixXd RelativeConstraint<Variable>::covariance() const
 {
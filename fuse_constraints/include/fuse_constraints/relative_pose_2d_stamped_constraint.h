@@ -97,6 +97,23 @@ public:
       {fuse_variables::Position2DStamped::X, fuse_variables::Position2DStamped::Y},             // NOLINT
     const std::vector<size_t>& angular_indices = {fuse_variables::Orientation2DStamped::YAW});  // NOLINT
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  RelativePose2DStampedConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const fuse_variables::Position2DStamped& position1,
+    const fuse_variables::Orientation2DStamped& orientation1,
+    const fuse_variables::Position2DStamped& position2,
+    const fuse_variables::Orientation2DStamped& orientation2,
+    const fuse_core::VectorXd& partial_delta,
+    const fuse_core::MatrixXd& partial_covariance,
+    const std::vector<size_t>& linear_indices =
+      {fuse_variables::Position2DStamped::X, fuse_variables::Position2DStamped::Y},             // NOLINT
+    const std::vector<size_t>& angular_indices = {fuse_variables::Orientation2DStamped::YAW});  // NOLINT
+
   /**
    * @brief Destructor
    */
@@ -80,6 +80,20 @@ public:
     const fuse_core::Vector7d& delta,
     const fuse_core::Matrix6d& covariance);
 
+  /**
+   * @brief Create the same constraint as above, with a content-addressed UUID
+   *
+   * See fuse_core::ContentAddressed. The remaining parameters are described in the constructor above.
+   */
+  RelativePose3DStampedConstraint(
+    fuse_core::ContentAddressed content_addressed,
+    const fuse_variables::Position3DStamped& position1,
+    const fuse_variables::Orientation3DStamped& orientation1,
+    const fuse_variables::Position3DStamped& position2,
+    const fuse_variables::Orientation3DStamped& orientation2,
+    const fuse_core::Vector7d& delta,
+    const fuse_core::Matrix6d& covariance);
+
   /**
    * @brief Destructor
    */
@@ -33,6 +33,7 @@
  */
 #include <fuse_constraints/absolute_orientation_3d_stamped_constraint.h>
 #include <fuse_constraints/normal_prior_orientation_3d_cost_functor.h>
+#include <fuse_core/measurement_key.h>
 
 #include <ceres/autodiff_cost_function.h>
 #include <Eigen/Geometry>
@@ -51,6 +52,18 @@ AbsoluteOrientation3DStampedConstraint::AbsoluteOrientation3DStampedConstraint(
 {
 }
 
+AbsoluteOrientation3DStampedConstraint::AbsoluteOrientation3DStampedConstraint(
+  fuse_core::ContentAddressed,
+  const fuse_variables::Orientation3DStamped& orientation,
+  const fuse_core::Vector4d& mean,
+  const fuse_core::Matrix3d& covariance) :
+    AbsoluteOrientation3DStampedConstraint(orientation, mean, covariance)
+{
+  setContentAddressedUuid(
+    "fuse_constraints::AbsoluteOrientation3DStampedConstraint",
+    fuse_core::measurementKey(mean, covariance));
+}
+
 AbsoluteOrientation3DStampedConstraint::AbsoluteOrientation3DStampedConstraint(
   const fuse_variables::Orientation3DStamped& orientation,
   const Eigen::Quaterniond& mean,
@@ -32,9 +32,9 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_constraints/absolute_orientation_3d_stamped_euler_constraint.h>
-#include <fuse_constraints/normal_prior_orientation_3d_euler_cost_functor.h>
+#include <fuse_constraints/normal_prior_orientation_3d_euler.h>
+#include <fuse_core/measurement_key.h>
 
-#include <ceres/autodiff_cost_function.h>
 #include <Eigen/Dense>
 
 #include <vector>
@@ -58,6 +58,19 @@ AbsoluteOrientation3DStampedEulerConstraint::AbsoluteOrientation3DStampedEulerCo
   assert(mean.rows() == static_cast<int>(axes.size()));
 }
 
+AbsoluteOrientation3DStampedEulerConstraint::AbsoluteOrientation3DStampedEulerConstraint(
+  fuse_core::ContentAddressed,
+  const fuse_variables::Orientation3DStamped& orientation,
+  const fuse_core::VectorXd& mean,
+  const fuse_core::MatrixXd& covariance,
+  const std::vector<Euler> &axes) :
+    AbsoluteOrientation3DStampedEulerConstraint(orientation, mean, covariance, axes)
+{
+  setContentAddressedUuid(
+    "fuse_constraints::AbsoluteOrientation3DStampedEulerConstraint",
+    fuse_core::measurementKey(mean, covariance, axes));
+}
+
 fuse_core::MatrixXd AbsoluteOrientation3DStampedEulerConstraint::covariance() const
 {
   return (sqrt_information_.transpose() * sqrt_information_).inverse();
@@ -79,8 +92,7 @@ fuse_core::Constraint::UniquePtr AbsoluteOrientation3DStampedEulerConstraint::cl
 
 ceres::CostFunction* AbsoluteOrientation3DStampedEulerConstraint::costFunction() const
 {
-  return new ceres::AutoDiffCostFunction<NormalPriorOrientation3DEulerCostFunctor, ceres::DYNAMIC, 4>(
-    new NormalPriorOrientation3DEulerCostFunctor(sqrt_information_, mean_, axes_), axes_.size());
+  return new NormalPriorOrientation3DEuler(sqrt_information_, mean_, axes_);
 }
 
 }  // namespace fuse_constraints
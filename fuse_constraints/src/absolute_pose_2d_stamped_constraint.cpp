@@ -32,9 +32,10 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/fixed_size_cost_function.h>
 #include <fuse_constraints/normal_prior_pose_2d_cost_functor.h>
+#include <fuse_core/measurement_key.h>
 
-#include <ceres/autodiff_cost_function.h>
 #include <Eigen/Dense>
 
 #include <vector>
@@ -85,6 +86,22 @@ AbsolutePose2DStampedConstraint::AbsolutePose2DStampedConstraint(
   }
 }
 
+AbsolutePose2DStampedConstraint::AbsolutePose2DStampedConstraint(
+  fuse_core::ContentAddressed,
+  const fuse_variables::Position2DStamped& position,
+  const fuse_variables::Orientation2DStamped& orientation,
+  const fuse_core::VectorXd& partial_mean,
+  const fuse_core::MatrixXd& partial_covariance,
+  const std::vector<size_t>& linear_indices,
+  const std::vector<size_t>& angular_indices) :
+    AbsolutePose2DStampedConstraint(
+      position, orientation, partial_mean, partial_covariance, linear_indices, angular_indices)
+{
+  setContentAddressedUuid(
+    "fuse_constraints::AbsolutePose2DStampedConstraint",
+    fuse_core::measurementKey(partial_mean, partial_covariance, linear_indices, angular_indices));
+}
+
 fuse_core::Matrix3d AbsolutePose2DStampedConstraint::covariance() const
 {
   // We want to compute:
@@ -116,7 +133,7 @@ fuse_core::Constraint::UniquePtr AbsolutePose2DStampedConstraint::clone() const
 
 ceres::CostFunction* AbsolutePose2DStampedConstraint::costFunction() const
 {
-  return new ceres::AutoDiffCostFunction<NormalPriorPose2DCostFunctor, ceres::DYNAMIC, 2, 1>(
+  return makeFixedSizeAutoDiffCostFunction<NormalPriorPose2DCostFunctor, 3, 2, 1>(
     new NormalPriorPose2DCostFunctor(sqrt_information_, mean_), sqrt_information_.rows());
 }
 
@@ -33,6 +33,7 @@
  */
 #include <fuse_constraints/absolute_pose_3d_stamped_constraint.h>
 #include <fuse_constraints/normal_prior_pose_3d_cost_functor.h>
+#include <fuse_core/measurement_key.h>
 
 #include <ceres/autodiff_cost_function.h>
 #include <Eigen/Dense>
@@ -52,6 +53,19 @@ AbsolutePose3DStampedConstraint::AbsolutePose3DStampedConstraint(
 {
 }
 
+AbsolutePose3DStampedConstraint::AbsolutePose3DStampedConstraint(
+  fuse_core::ContentAddressed,
+  const fuse_variables::Position3DStamped& position,
+  const fuse_variables::Orientation3DStamped& orientation,
+  const fuse_core::Vector7d& mean,
+  const fuse_core::Matrix6d& covariance) :
+    AbsolutePose3DStampedConstraint(position, orientation, mean, covariance)
+{
+  setContentAddressedUuid(
+    "fuse_constraints::AbsolutePose3DStampedConstraint",
+    fuse_core::measurementKey(mean, covariance));
+}
+
 void AbsolutePose3DStampedConstraint::print(std::ostream& stream) const
 {
   stream << type() << "\n"
@@ -0,0 +1,117 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/normal_delta_pose_2d.h>
+#include <fuse_constraints/util.h>
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <cmath>
+
+
+namespace fuse_constraints
+{
+
+NormalDeltaPose2D::NormalDeltaPose2D(const fuse_core::MatrixXd& A, const fuse_core::Vector3d& b) :
+  A_(A),
+  b_(b)
+{
+  CHECK_GT(A_.rows(), 0);
+  CHECK_LE(A_.rows(), 3);
+  CHECK_EQ(A_.cols(), 3);
+  set_num_residuals(A_.rows());
+  mutable_parameter_block_sizes()->push_back(2);  // position1
+  mutable_parameter_block_sizes()->push_back(1);  // orientation1
+  mutable_parameter_block_sizes()->push_back(2);  // position2
+  mutable_parameter_block_sizes()->push_back(1);  // orientation2
+}
+
+bool NormalDeltaPose2D::Evaluate(
+  double const* const* parameters,
+  double* residuals,
+  double** jacobians) const
+{
+  const double cos_yaw1 = std::cos(parameters[1][0]);
+  const double sin_yaw1 = std::sin(parameters[1][0]);
+  const double dx = parameters[2][0] - parameters[0][0];
+  const double dy = parameters[2][1] - parameters[0][1];
+
+  // The pose difference, expressed in the frame of the first pose
+  fuse_core::Vector3d delta;
+  delta(0) = cos_yaw1 * dx + sin_yaw1 * dy;
+  delta(1) = -sin_yaw1 * dx + cos_yaw1 * dy;
+  delta(2) = parameters[3][0] - parameters[1][0];
+
+  fuse_core::Vector3d error = delta - b_;
+  wrapAngle2D(error(2));
+  Eigen::Map<fuse_core::VectorXd> r(residuals, num_residuals());
+  r.noalias() = A_ * error;
+
+  if (jacobians != NULL)
+  {
+    // Jacobians of the unweighted error with respect to each parameter block:
+    //   d(error)/d(position1)    = [-R1^T;  0]
+    //   d(error)/d(orientation1) = [delta.y; -delta.x; -1]
+    //   d(error)/d(position2)    = [ R1^T;  0]
+    //   d(error)/d(orientation2) = [0; 0; 1]
+    // The weighted Jacobians are then simple combinations of the columns of A.
+    using Jacobian2 = Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>;
+    using Jacobian1 = Eigen::Matrix<double, Eigen::Dynamic, 1>;
+    if (jacobians[0] != NULL)
+    {
+      Eigen::Map<Jacobian2> j(jacobians[0], num_residuals(), 2);
+      j.col(0) = -cos_yaw1 * A_.col(0) + sin_yaw1 * A_.col(1);
+      j.col(1) = -sin_yaw1 * A_.col(0) - cos_yaw1 * A_.col(1);
+    }
+    if (jacobians[1] != NULL)
+    {
+      Eigen::Map<Jacobian1> j(jacobians[1], num_residuals(), 1);
+      j = delta(1) * A_.col(0) - delta(0) * A_.col(1) - A_.col(2);
+    }
+    if (jacobians[2] != NULL)
+    {
+      Eigen::Map<Jacobian2> j(jacobians[2], num_residuals(), 2);
+      j.col(0) = cos_yaw1 * A_.col(0) - sin_yaw1 * A_.col(1);
+      j.col(1) = sin_yaw1 * A_.col(0) + cos_yaw1 * A_.col(1);
+    }
+    if (jacobians[3] != NULL)
+    {
+      Eigen::Map<Jacobian1> j(jacobians[3], num_residuals(), 1);
+      j = A_.col(2);
+    }
+  }
+  return true;
+}
+
+}  // namespace fuse_constraints
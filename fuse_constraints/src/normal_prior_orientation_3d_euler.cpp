@@ -0,0 +1,177 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/normal_prior_orientation_3d_euler.h>
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+
+namespace fuse_constraints
+{
+
+namespace
+{
+
+/**
+ * @brief Compute an atan2-based Euler angle and its gradient with respect to the quaternion (w, x, y, z)
+ *
+ * @param[in]  y        The sine term of the atan2
+ * @param[in]  x        The cosine term of the atan2
+ * @param[in]  dy       The gradient of the sine term with respect to the quaternion
+ * @param[in]  dx       The gradient of the cosine term with respect to the quaternion
+ * @param[out] gradient The gradient of the angle with respect to the quaternion, or zero if the angle is undefined
+ * @return              The angle
+ */
+double atan2WithGradient(
+  const double y,
+  const double x,
+  const Eigen::Vector4d& dy,
+  const Eigen::Vector4d& dx,
+  Eigen::Vector4d& gradient)
+{
+  const double norm_squared = x * x + y * y;
+  if (norm_squared < std::numeric_limits<double>::epsilon())
+  {
+    // The angle is undefined at the pitch singularity (gimbal lock). Use a zero gradient instead of inf or NaN.
+    gradient.setZero();
+  }
+  else
+  {
+    gradient = (x * dy - y * dx) / norm_squared;
+  }
+  return std::atan2(y, x);
+}
+
+}  // namespace
+
+NormalPriorOrientation3DEuler::NormalPriorOrientation3DEuler(
+  const fuse_core::MatrixXd& A,
+  const fuse_core::VectorXd& b,
+  const std::vector<Euler>& axes) :
+    A_(A),
+    b_(b),
+    axes_(axes)
+{
+  CHECK_GT(axes_.size(), 0u);
+  CHECK_LE(axes_.size(), 3u);
+  CHECK_EQ(A_.rows(), static_cast<int>(axes_.size()));
+  CHECK_EQ(A_.cols(), static_cast<int>(axes_.size()));
+  CHECK_EQ(b_.rows(), static_cast<int>(axes_.size()));
+  set_num_residuals(axes_.size());
+  mutable_parameter_block_sizes()->push_back(4);  // orientation
+}
+
+bool NormalPriorOrientation3DEuler::Evaluate(
+  double const* const* parameters,
+  double* residuals,
+  double** jacobians) const
+{
+  const double w = parameters[0][0];
+  const double x = parameters[0][1];
+  const double y = parameters[0][2];
+  const double z = parameters[0][3];
+
+  // Compute each requested Euler angle and its gradient with respect to the quaternion. These follow the extraction
+  // in fuse_variables/util.h.
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> error(axes_.size());
+  Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor, 3, 4> error_jacobian(axes_.size(), 4);
+  for (size_t i = 0; i < axes_.size(); ++i)
+  {
+    Eigen::Vector4d gradient;
+    double angle;
+    switch (axes_[i])
+    {
+      case Euler::ROLL:
+      {
+        angle = atan2WithGradient(
+          2.0 * (w * x + y * z),
+          1.0 - 2.0 * (x * x + y * y),
+          Eigen::Vector4d(2.0 * x, 2.0 * w, 2.0 * z, 2.0 * y),
+          Eigen::Vector4d(0.0, -4.0 * x, -4.0 * y, 0.0),
+          gradient);
+        break;
+      }
+      case Euler::PITCH:
+      {
+        const double sin_pitch = 2.0 * (w * y - z * x);
+        if (std::abs(sin_pitch) >= 1.0)
+        {
+          // The pitch is clamped at the singularity, so it does not change with the quaternion
+          angle = std::copysign(M_PI / 2.0, sin_pitch);
+          gradient.setZero();
+        }
+        else
+        {
+          angle = std::asin(sin_pitch);
+          gradient = Eigen::Vector4d(2.0 * y, -2.0 * z, 2.0 * w, -2.0 * x) / std::sqrt(1.0 - sin_pitch * sin_pitch);
+        }
+        break;
+      }
+      case Euler::YAW:
+      {
+        angle = atan2WithGradient(
+          2.0 * (w * z + x * y),
+          1.0 - 2.0 * (y * y + z * z),
+          Eigen::Vector4d(2.0 * z, 2.0 * y, 2.0 * x, 2.0 * w),
+          Eigen::Vector4d(0.0, 0.0, -4.0 * y, -4.0 * z),
+          gradient);
+        break;
+      }
+      default:
+      {
+        throw std::runtime_error("The provided axis specified is unknown. "
+                                 "I should probably be more informative here");
+      }
+    }
+    error(i) = angle - b_(i);
+    error_jacobian.row(i) = gradient.transpose();
+  }
+
+  Eigen::Map<fuse_core::VectorXd> r(residuals, num_residuals());
+  r.noalias() = A_ * error;
+
+  if (jacobians != NULL && jacobians[0] != NULL)
+  {
+    Eigen::Map<fuse_core::MatrixXd> j(jacobians[0], num_residuals(), 4);
+    j.noalias() = A_ * error_jacobian;
+  }
+  return true;
+}
+
+}  // namespace fuse_constraints
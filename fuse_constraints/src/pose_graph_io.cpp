@@ -0,0 +1,559 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/pose_graph_io.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_3d_stamped_constraint.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/orientation_3d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/position_3d_stamped.h>
+#include <fuse_variables/util.h>
+#include <ros/time.h>
+
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief The variables created for a single dataset vertex
+ */
+struct Vertex
+{
+  fuse_variables::Position2DStamped::SharedPtr position_2d;
+  fuse_variables::Orientation2DStamped::SharedPtr orientation_2d;
+  fuse_variables::Position3DStamped::SharedPtr position_3d;
+  fuse_variables::Orientation3DStamped::SharedPtr orientation_3d;
+};
+
+/**
+ * @brief An edge read from the dataset, stored until all vertices are known
+ */
+struct Edge
+{
+  size_t line_number;  //!< The dataset line number, used for error messages
+  std::string line;  //!< The dataset line, used for error messages
+  uint32_t id1;  //!< The id of the first vertex
+  uint32_t id2;  //!< The id of the second vertex
+  bool is_3d;  //!< Flag indicating the edge connects 3D vertices
+  fuse_core::Vector7d delta;  //!< The pose change. Only the first three elements are used for 2D edges.
+  fuse_core::Matrix6d information;  //!< The information matrix. Only the upper-left 3x3 block is used for 2D edges.
+};
+
+/**
+ * @brief Create an exception describing a dataset line that could not be loaded
+ */
+std::runtime_error parseError(size_t line_number, const std::string& line, const std::string& reason)
+{
+  return std::runtime_error("Could not load line " + std::to_string(line_number) + " of the pose graph dataset ('" +
+                            line + "'): " + reason);
+}
+
+/**
+ * @brief Read a vertex id, verifying it can be used as a timestamp
+ */
+uint32_t readId(std::istream& stream)
+{
+  int64_t id;
+  if (!(stream >> id) || id < 0 || id > std::numeric_limits<uint32_t>::max())
+  {
+    throw std::invalid_argument("invalid vertex id");
+  }
+  return static_cast<uint32_t>(id);
+}
+
+/**
+ * @brief Read the requested number of floating point values
+ */
+void readValues(std::istream& stream, double* values, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (!(stream >> values[i]))
+    {
+      throw std::invalid_argument("expected " + std::to_string(count) + " values");
+    }
+  }
+}
+
+/**
+ * @brief Read a symmetric matrix stored as its upper triangle in row-major order
+ */
+template <typename Matrix>
+void readUpperTriangle(std::istream& stream, Matrix& matrix, int size)
+{
+  for (int row = 0; row < size; ++row)
+  {
+    for (int col = row; col < size; ++col)
+    {
+      readValues(stream, &matrix(row, col), 1);
+      matrix(col, row) = matrix(row, col);
+    }
+  }
+}
+
+/**
+ * @brief Write a symmetric matrix as its upper triangle in row-major order
+ */
+template <typename Matrix>
+void writeUpperTriangle(std::ostream& stream, const Matrix& matrix, int size)
+{
+  for (int row = 0; row < size; ++row)
+  {
+    for (int col = row; col < size; ++col)
+    {
+      stream << ' ' << matrix(row, col);
+    }
+  }
+}
+
+/**
+ * @brief Convert roll, pitch, and yaw angles into a quaternion (w, x, y, z)
+ */
+Eigen::Quaterniond toQuaternion(double roll, double pitch, double yaw)
+{
+  return Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()) *
+         Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY()) *
+         Eigen::AngleAxisd(roll, Eigen::Vector3d::UnitX());
+}
+
+/**
+ * @brief Write a quaternion (w, x, y, z) as roll, pitch, and yaw angles
+ */
+void writeRollPitchYaw(std::ostream& stream, double w, double x, double y, double z)
+{
+  stream << ' ' << fuse_variables::getRoll(w, x, y, z)
+         << ' ' << fuse_variables::getPitch(w, x, y, z)
+         << ' ' << fuse_variables::getYaw(w, x, y, z);
+}
+
+}  // namespace
+
+namespace fuse_constraints
+{
+
+void loadPoseGraph(std::istream& stream, fuse_core::Graph& graph)
+{
+  std::map<uint32_t, Vertex> vertices;
+  std::vector<Edge> edges;
+  std::set<uint32_t> fixed_vertices;
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(stream, line))
+  {
+    ++line_number;
+    std::istringstream line_stream(line);
+    std::string tag;
+    if (!(line_stream >> tag) || tag[0] == '#')
+    {
+      continue;
+    }
+    try
+    {
+      if (tag == "VERTEX_SE2" || tag == "VERTEX2")
+      {
+        const auto id = readId(line_stream);
+        double values[3];
+        readValues(line_stream, values, 3);
+        auto& vertex = vertices[id];
+        if (vertex.position_2d || vertex.position_3d)
+        {
+          throw std::invalid_argument("the vertex is defined more than once");
+        }
+        vertex.position_2d = fuse_variables::Position2DStamped::make_shared(ros::Time(id, 0));
+        vertex.position_2d->x() = values[0];
+        vertex.position_2d->y() = values[1];
+        vertex.orientation_2d = fuse_variables::Orientation2DStamped::make_shared(ros::Time(id, 0));
+        vertex.orientation_2d->yaw() = values[2];
+      }
+      else if (tag == "VERTEX_SE3:QUAT" || tag == "VERTEX3")
+      {
+        const auto id = readId(line_stream);
+        double values[7];
+        Eigen::Quaterniond orientation;
+        if (tag == "VERTEX3")
+        {
+          readValues(line_stream, values, 6);
+          orientation = toQuaternion(values[3], values[4], values[5]);
+        }
+        else
+        {
+          readValues(line_stream, values, 7);
+          orientation = Eigen::Quaterniond(values[6], values[3], values[4], values[5]).normalized();
+        }
+        auto& vertex = vertices[id];
+        if (vertex.position_2d || vertex.position_3d)
+        {
+          throw std::invalid_argument("the vertex is defined more than once");
+        }
+        vertex.position_3d = fuse_variables::Position3DStamped::make_shared(ros::Time(id, 0));
+        vertex.position_3d->x() = values[0];
+        vertex.position_3d->y() = values[1];
+        vertex.position_3d->z() = values[2];
+        vertex.orientation_3d = fuse_variables::Orientation3DStamped::make_shared(ros::Time(id, 0));
+        vertex.orientation_3d->w() = orientation.w();
+        vertex.orientation_3d->x() = orientation.x();
+        vertex.orientation_3d->y() = orientation.y();
+        vertex.orientation_3d->z() = orientation.z();
+      }
+      else if (tag == "EDGE_SE2" || tag == "EDGE2")
+      {
+        Edge edge;
+        edge.line_number = line_number;
+        edge.line = line;
+        edge.id1 = readId(line_stream);
+        edge.id2 = readId(line_stream);
+        edge.is_3d = false;
+        edge.delta.setZero();
+        edge.information.setZero();
+        readValues(line_stream, edge.delta.data(), 3);
+        if (tag == "EDGE2")
+        {
+          // TORO stores the information matrix as: xx, xy, yy, yaw-yaw, x-yaw, y-yaw
+          double values[6];
+          readValues(line_stream, values, 6);
+          edge.information(0, 0) = values[0];
+          edge.information(0, 1) = edge.information(1, 0) = values[1];
+          edge.information(1, 1) = values[2];
+          edge.information(2, 2) = values[3];
+          edge.information(0, 2) = edge.information(2, 0) = values[4];
+          edge.information(1, 2) = edge.information(2, 1) = values[5];
+        }
+        else
+        {
+          readUpperTriangle(line_stream, edge.information, 3);
+        }
+        edges.push_back(edge);
+      }
+      else if (tag == "EDGE_SE3:QUAT" || tag == "EDGE3")
+      {
+        Edge edge;
+        edge.line_number = line_number;
+        edge.line = line;
+        edge.id1 = readId(line_stream);
+        edge.id2 = readId(line_stream);
+        edge.is_3d = true;
+        Eigen::Quaterniond rotation;
+        double values[7];
+        if (tag == "EDGE3")
+        {
+          readValues(line_stream, values, 6);
+          rotation = toQuaternion(values[3], values[4], values[5]);
+        }
+        else
+        {
+          readValues(line_stream, values, 7);
+          rotation = Eigen::Quaterniond(values[6], values[3], values[4], values[5]).normalized();
+        }
+        edge.delta << values[0], values[1], values[2], rotation.w(), rotation.x(), rotation.y(), rotation.z();
+        readUpperTriangle(line_stream, edge.information, 6);
+        edges.push_back(edge);
+      }
+      else if (tag == "FIX")
+      {
+        fixed_vertices.insert(readId(line_stream));
+      }
+      else
+      {
+        throw std::invalid_argument("unsupported record type");
+      }
+    }
+    catch (const std::invalid_argument& ex)
+    {
+      throw parseError(line_number, line, ex.what());
+    }
+  }
+
+  // Create the constraints now that all of the vertices are known
+  fuse_core::Transaction transaction;
+  for (const auto& id__vertex : vertices)
+  {
+    const auto& vertex = id__vertex.second;
+    if (vertex.position_2d)
+    {
+      transaction.addVariable(vertex.position_2d);
+      transaction.addVariable(vertex.orientation_2d);
+    }
+    else
+    {
+      transaction.addVariable(vertex.position_3d);
+      transaction.addVariable(vertex.orientation_3d);
+    }
+  }
+  for (const auto& edge : edges)
+  {
+    auto vertex1_iter = vertices.find(edge.id1);
+    auto vertex2_iter = vertices.find(edge.id2);
+    if (vertex1_iter == vertices.end() || vertex2_iter == vertices.end())
+    {
+      throw parseError(edge.line_number, edge.line, "the edge references an unknown vertex");
+    }
+    const auto& vertex1 = vertex1_iter->second;
+    const auto& vertex2 = vertex2_iter->second;
+    if (edge.is_3d)
+    {
+      if (!vertex1.position_3d || !vertex2.position_3d)
+      {
+        throw parseError(edge.line_number, edge.line, "a 3D edge references a 2D vertex");
+      }
+      transaction.addConstraint(RelativePose3DStampedConstraint::make_shared(
+        *vertex1.position_3d,
+        *vertex1.orientation_3d,
+        *vertex2.position_3d,
+        *vertex2.orientation_3d,
+        edge.delta,
+        edge.information.inverse()));
+    }
+    else
+    {
+      if (!vertex1.position_2d || !vertex2.position_2d)
+      {
+        throw parseError(edge.line_number, edge.line, "a 2D edge references a 3D vertex");
+      }
+      transaction.addConstraint(RelativePose2DStampedConstraint::make_shared(
+        *vertex1.position_2d,
+        *vertex1.orientation_2d,
+        *vertex2.position_2d,
+        *vertex2.orientation_2d,
+        fuse_core::VectorXd(edge.delta.head<3>()),
+        fuse_core::MatrixXd(edge.information.topLeftCorner<3, 3>().inverse())));
+    }
+  }
+  for (const auto& id : fixed_vertices)
+  {
+    if (vertices.find(id) == vertices.end())
+    {
+      throw std::runtime_error("The pose graph dataset fixes an unknown vertex (" + std::to_string(id) + ").");
+    }
+  }
+  graph.update(transaction);
+
+  // Remove the gauge freedom
+  if (fixed_vertices.empty() && !vertices.empty())
+  {
+    fixed_vertices.insert(vertices.begin()->first);
+  }
+  for (const auto& id : fixed_vertices)
+  {
+    const auto& vertex = vertices.at(id);
+    if (vertex.position_2d)
+    {
+      graph.holdVariable(vertex.position_2d->uuid());
+      graph.holdVariable(vertex.orientation_2d->uuid());
+    }
+    else
+    {
+      graph.holdVariable(vertex.position_3d->uuid());
+      graph.holdVariable(vertex.orientation_3d->uuid());
+    }
+  }
+}
+
+void loadPoseGraph(const std::string& filename, fuse_core::Graph& graph)
+{
+  std::ifstream stream(filename);
+  if (!stream)
+  {
+    throw std::runtime_error("Could not open the pose graph dataset '" + filename + "'.");
+  }
+  loadPoseGraph(stream, graph);
+}
+
+void savePoseGraph(const fuse_core::Graph& graph, std::ostream& stream, PoseGraphFormat format)
+{
+  // Group the position and orientation variables by stamp
+  struct Pose
+  {
+    const fuse_variables::Position2DStamped* position_2d = nullptr;
+    const fuse_variables::Orientation2DStamped* orientation_2d = nullptr;
+    const fuse_variables::Position3DStamped* position_3d = nullptr;
+    const fuse_variables::Orientation3DStamped* orientation_3d = nullptr;
+  };
+  std::map<ros::Time, Pose> poses;
+  for (const auto& variable : graph.getVariables())
+  {
+    if (auto position_2d = dynamic_cast<const fuse_variables::Position2DStamped*>(&variable))
+    {
+      poses[position_2d->stamp()].position_2d = position_2d;
+    }
+    else if (auto orientation_2d = dynamic_cast<const fuse_variables::Orientation2DStamped*>(&variable))
+    {
+      poses[orientation_2d->stamp()].orientation_2d = orientation_2d;
+    }
+    else if (auto position_3d = dynamic_cast<const fuse_variables::Position3DStamped*>(&variable))
+    {
+      poses[position_3d->stamp()].position_3d = position_3d;
+    }
+    else if (auto orientation_3d = dynamic_cast<const fuse_variables::Orientation3DStamped*>(&variable))
+    {
+      poses[orientation_3d->stamp()].orientation_3d = orientation_3d;
+    }
+  }
+
+  // Write the vertices in stamp order, recording the id assigned to each variable
+  stream.precision(std::numeric_limits<double>::max_digits10);
+  std::unordered_map<fuse_core::UUID, size_t, fuse_core::uuid::hash> ids;
+  size_t id = 0;
+  for (const auto& stamp__pose : poses)
+  {
+    const auto& pose = stamp__pose.second;
+    if (pose.position_2d && pose.orientation_2d)
+    {
+      stream << (format == PoseGraphFormat::G2O ? "VERTEX_SE2 " : "VERTEX2 ") << id
+             << ' ' << pose.position_2d->x() << ' ' << pose.position_2d->y() << ' ' << pose.orientation_2d->yaw()
+             << '\n';
+      ids.emplace(pose.position_2d->uuid(), id);
+      ids.emplace(pose.orientation_2d->uuid(), id);
+      ++id;
+    }
+    if (pose.position_3d && pose.orientation_3d)
+    {
+      const auto& position = *pose.position_3d;
+      const auto& orientation = *pose.orientation_3d;
+      stream << (format == PoseGraphFormat::G2O ? "VERTEX_SE3:QUAT " : "VERTEX3 ") << id
+             << ' ' << position.x() << ' ' << position.y() << ' ' << position.z();
+      if (format == PoseGraphFormat::G2O)
+      {
+        stream << ' ' << orientation.x() << ' ' << orientation.y() << ' ' << orientation.z() << ' ' << orientation.w();
+      }
+      else
+      {
+        writeRollPitchYaw(stream, orientation.w(), orientation.x(), orientation.y(), orientation.z());
+      }
+      stream << '\n';
+      ids.emplace(position.uuid(), id);
+      ids.emplace(orientation.uuid(), id);
+      ++id;
+    }
+  }
+
+  // Write the edges. The graph does not define an iteration order, so the edges are sorted by vertex id.
+  std::vector<std::tuple<size_t, size_t, std::string>> edges;
+  for (const auto& constraint : graph.getConstraints())
+  {
+    const auto& variables = constraint.variables();
+    if (variables.size() != 4)
+    {
+      continue;
+    }
+    auto id1_iter = ids.find(variables[0]);
+    auto id2_iter = ids.find(variables[2]);
+    if (id1_iter == ids.end() || id2_iter == ids.end())
+    {
+      continue;
+    }
+    std::ostringstream edge_stream;
+    edge_stream.precision(std::numeric_limits<double>::max_digits10);
+    if (auto constraint_2d = dynamic_cast<const RelativePose2DStampedConstraint*>(&constraint))
+    {
+      const auto& delta = constraint_2d->delta();
+      const fuse_core::Matrix3d information = constraint_2d->sqrtInformation().transpose() *
+                                              constraint_2d->sqrtInformation();
+      edge_stream << (format == PoseGraphFormat::G2O ? "EDGE_SE2 " : "EDGE2 ") << id1_iter->second << ' '
+                  << id2_iter->second << ' ' << delta(0) << ' ' << delta(1) << ' ' << delta(2);
+      if (format == PoseGraphFormat::G2O)
+      {
+        writeUpperTriangle(edge_stream, information, 3);
+      }
+      else
+      {
+        edge_stream << ' ' << information(0, 0) << ' ' << information(0, 1) << ' ' << information(1, 1)
+                    << ' ' << information(2, 2) << ' ' << information(0, 2) << ' ' << information(1, 2);
+      }
+    }
+    else if (auto constraint_3d = dynamic_cast<const RelativePose3DStampedConstraint*>(&constraint))
+    {
+      const auto& delta = constraint_3d->delta();
+      const fuse_core::Matrix6d information = constraint_3d->sqrtInformation().transpose() *
+                                              constraint_3d->sqrtInformation();
+      edge_stream << (format == PoseGraphFormat::G2O ? "EDGE_SE3:QUAT " : "EDGE3 ") << id1_iter->second << ' '
+                  << id2_iter->second << ' ' << delta(0) << ' ' << delta(1) << ' ' << delta(2);
+      if (format == PoseGraphFormat::G2O)
+      {
+        edge_stream << ' ' << delta(4) << ' ' << delta(5) << ' ' << delta(6) << ' ' << delta(3);
+      }
+      else
+      {
+        writeRollPitchYaw(edge_stream, delta(3), delta(4), delta(5), delta(6));
+      }
+      writeUpperTriangle(edge_stream, information, 6);
+    }
+    else
+    {
+      continue;
+    }
+    edges.emplace_back(id1_iter->second, id2_iter->second, edge_stream.str());
+  }
+  std::sort(edges.begin(), edges.end());
+  for (const auto& edge : edges)
+  {
+    stream << std::get<2>(edge) << '\n';
+  }
+}
+
+void savePoseGraph(const fuse_core::Graph& graph, const std::string& filename, PoseGraphFormat format)
+{
+  std::ofstream stream(filename);
+  if (!stream)
+  {
+    throw std::runtime_error("Could not open the pose graph dataset '" + filename + "' for writing.");
+  }
+  savePoseGraph(graph, stream, format);
+  if (!stream)
+  {
+    throw std::runtime_error("Could not write the pose graph dataset '" + filename + "'.");
+  }
+}
+
+}  // namespace fuse_constraints
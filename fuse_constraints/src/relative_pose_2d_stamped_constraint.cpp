@@ -31,10 +31,9 @@
  *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  *  POSSIBILITY OF SUCH DAMAGE.
  */
-#include <fuse_constraints/normal_delta_pose_2d_cost_functor.h>
+#include <fuse_constraints/normal_delta_pose_2d.h>
 #include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
-
-#include <ceres/autodiff_cost_function.h>
+#include <fuse_core/measurement_key.h>
 
 #include <vector>
 
@@ -87,6 +86,25 @@ RelativePose2DStampedConstraint::RelativePose2DStampedConstraint(
   }
 }
 
+RelativePose2DStampedConstraint::RelativePose2DStampedConstraint(
+  fuse_core::ContentAddressed,
+  const fuse_variables::Position2DStamped& position1,
+  const fuse_variables::Orientation2DStamped& orientation1,
+  const fuse_variables::Position2DStamped& position2,
+  const fuse_variables::Orientation2DStamped& orientation2,
+  const fuse_core::VectorXd& partial_delta,
+  const fuse_core::MatrixXd& partial_covariance,
+  const std::vector<size_t>& linear_indices,
+  const std::vector<size_t>& angular_indices) :
+    RelativePose2DStampedConstraint(
+      position1, orientation1, position2, orientation2, partial_delta, partial_covariance, linear_indices,
+      angular_indices)
+{
+  setContentAddressedUuid(
+    "fuse_constraints::RelativePose2DStampedConstraint",
+    fuse_core::measurementKey(partial_delta, partial_covariance, linear_indices, angular_indices));
+}
+
 fuse_core::Matrix3d RelativePose2DStampedConstraint::covariance() const
 {
   // We want to compute:
@@ -120,8 +138,7 @@ fuse_core::Constraint::UniquePtr RelativePose2DStampedConstraint::clone() const
 
 ceres::CostFunction* RelativePose2DStampedConstraint::costFunction() const
 {
-  return new ceres::AutoDiffCostFunction<NormalDeltaPose2DCostFunctor, ceres::DYNAMIC, 2, 1, 2, 1>(
-    new NormalDeltaPose2DCostFunctor(sqrt_information_, delta_), sqrt_information_.rows());
+  return new NormalDeltaPose2D(sqrt_information_, delta_);
 }
 
 }  // namespace fuse_constraints
@@ -33,6 +33,7 @@
  */
 #include <fuse_constraints/normal_delta_pose_3d_cost_functor.h>
 #include <fuse_constraints/relative_pose_3d_stamped_constraint.h>
+#include <fuse_core/measurement_key.h>
 
 #include <ceres/autodiff_cost_function.h>
 
@@ -53,6 +54,21 @@ RelativePose3DStampedConstraint::RelativePose3DStampedConstraint(
 {
 }
 
+RelativePose3DStampedConstraint::RelativePose3DStampedConstraint(
+  fuse_core::ContentAddressed,
+  const fuse_variables::Position3DStamped& position1,
+  const fuse_variables::Orientation3DStamped& orientation1,
+  const fuse_variables::Position3DStamped& position2,
+  const fuse_variables::Orientation3DStamped& orientation2,
+  const fuse_core::Vector7d& delta,
+  const fuse_core::Matrix6d& covariance) :
+    RelativePose3DStampedConstraint(position1, orientation1, position2, orientation2, delta, covariance)
+{
+  setContentAddressedUuid(
+    "fuse_constraints::RelativePose3DStampedConstraint",
+    fuse_core::measurementKey(delta, covariance));
+}
+
 void RelativePose3DStampedConstraint::print(std::ostream& stream) const
 {
   stream << type() << "\n"
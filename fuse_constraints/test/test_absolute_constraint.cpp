@@ -124,6 +124,30 @@ TEST(AbsoluteConstraint, PartialMeasurement)
   EXPECT_NO_THROW(fuse_constraints::AbsolutePosition3DStampedConstraint constraint(variable, mean, cov, indices));
 }
 
+TEST(AbsoluteConstraint, ContentAddressedUuid)
+{
+  fuse_variables::Position3DStamped variable(ros::Time(1234, 5678), fuse_core::uuid::generate("vici"));
+  fuse_core::Vector2d mean;
+  mean << 3.0, 1.0;
+  fuse_core::Matrix2d cov;
+  cov << 3.0, 0.2, 0.2, 1.0;
+  auto indices = std::vector<size_t>{2, 0};
+  fuse_constraints::AbsolutePosition3DStampedConstraint random1(variable, mean, cov, indices);
+  fuse_constraints::AbsolutePosition3DStampedConstraint random2(variable, mean, cov, indices);
+  EXPECT_NE(random1.uuid(), random2.uuid());
+
+  fuse_constraints::AbsolutePosition3DStampedConstraint constraint1(
+    fuse_core::content_addressed, variable, mean, cov, indices);
+  fuse_constraints::AbsolutePosition3DStampedConstraint constraint2(
+    fuse_core::content_addressed, variable, mean, cov, indices);
+  EXPECT_EQ(constraint1.uuid(), constraint2.uuid());
+
+  // Measuring the same values in a different set of dimensions is a different constraint
+  fuse_constraints::AbsolutePosition3DStampedConstraint constraint3(
+    fuse_core::content_addressed, variable, mean, cov, std::vector<size_t>{0, 2});  // NOLINT
+  EXPECT_NE(constraint1.uuid(), constraint3.uuid());
+}
+
 TEST(AbsoluteConstraint, Covariance)
 {
   // Test the covariance of a full measurement
@@ -32,17 +32,20 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_constraints/absolute_orientation_3d_stamped_euler_constraint.h>
+#include <fuse_constraints/normal_prior_orientation_3d_euler_cost_functor.h>
 #include <fuse_core/eigen.h>
 #include <fuse_core/uuid.h>
 #include <fuse_variables/orientation_3d_stamped.h>
 #include <geometry_msgs/Quaternion.h>
 
+#include <ceres/autodiff_cost_function.h>
 #include <ceres/covariance.h>
 #include <ceres/problem.h>
 #include <ceres/solver.h>
 #include <Eigen/Geometry>
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -87,6 +90,80 @@ TEST(AbsoluteOrientation3DStampedEulerConstraint, Covariance)
   EXPECT_TRUE(expected_sqrt_info.isApprox(constraint.sqrtInformation(), 1.0e-9));
 }
 
+TEST(AbsoluteOrientation3DStampedEulerConstraint, CostFunctionMatchesAutoDiff)
+{
+  // Verify the analytic cost function matches the automatic differentiation of the cost functor, for full and partial
+  // measurements, and on both sides of the pitch singularity
+  Orientation3DStamped orientation_variable(ros::Time(1234, 5678), fuse_core::uuid::generate("c3po"));
+  fuse_core::Vector3d mean;
+  mean << 0.1, -0.4, 0.5;
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_core::Vector2d partial_mean;
+  partial_mean << 0.5, -0.4;
+  fuse_core::Matrix2d partial_cov;
+  partial_cov << 3.0, 0.3, 0.3, 2.0;
+  std::vector<AbsoluteOrientation3DStampedEulerConstraint> constraints =
+  {
+    AbsoluteOrientation3DStampedEulerConstraint(orientation_variable, mean, cov,
+      {Orientation3DStamped::Euler::ROLL, Orientation3DStamped::Euler::PITCH, Orientation3DStamped::Euler::YAW}),
+    AbsoluteOrientation3DStampedEulerConstraint(orientation_variable, partial_mean, partial_cov,
+      {Orientation3DStamped::Euler::YAW, Orientation3DStamped::Euler::PITCH}),  // NOLINT(whitespace/braces)
+  };
+
+  // The second orientation is not normalized, and its pitch lies beyond the singularity where it is clamped
+  std::vector<std::vector<double>> orientations = {{0.952, 0.038, -0.189, 0.239}, {0.72, 0.0, 0.72, 0.1}};  // NOLINT
+  for (const auto& constraint : constraints)
+  {
+    const auto num_residuals = constraint.axes().size();
+    ceres::AutoDiffCostFunction<fuse_constraints::NormalPriorOrientation3DEulerCostFunctor, ceres::DYNAMIC, 4>
+      expected_cost_function(
+        new fuse_constraints::NormalPriorOrientation3DEulerCostFunctor(
+          constraint.sqrtInformation(), constraint.mean(), constraint.axes()),
+        num_residuals);
+    std::unique_ptr<ceres::CostFunction> cost_function(constraint.costFunction());
+    ASSERT_EQ(static_cast<int>(num_residuals), cost_function->num_residuals());
+
+    for (const auto& orientation : orientations)
+    {
+      const double* parameters[] = {orientation.data()};
+      fuse_core::VectorXd expected_residuals(num_residuals);
+      fuse_core::MatrixXd expected_jacobian(num_residuals, 4);
+      double* expected_jacobians[] = {expected_jacobian.data()};
+      ASSERT_TRUE(expected_cost_function.Evaluate(parameters, expected_residuals.data(), expected_jacobians));
+
+      fuse_core::VectorXd residuals(num_residuals);
+      fuse_core::MatrixXd jacobian(num_residuals, 4);
+      double* jacobians[] = {jacobian.data()};
+      ASSERT_TRUE(cost_function->Evaluate(parameters, residuals.data(), jacobians));
+
+      EXPECT_TRUE(expected_residuals.isApprox(residuals, 1.0e-9));
+      EXPECT_TRUE(expected_jacobian.isApprox(jacobian, 1.0e-9)) << "Expected:\n" << expected_jacobian
+                                                                << "\nActual:\n" << jacobian;
+    }
+
+    // At exactly +/-90 degrees of pitch the roll and yaw are undefined, and the automatic derivative of atan2(0, 0)
+    // is NaN. The angles must still match, while the analytic jacobian is zero instead of NaN.
+    std::vector<std::vector<double>> gimbal_lock_orientations =
+      {{0.5, 0.5, 0.5, -0.5}, {0.5, -0.5, -0.5, -0.5}};  // NOLINT(whitespace/braces)
+    for (const auto& orientation : gimbal_lock_orientations)
+    {
+      const double* parameters[] = {orientation.data()};
+      fuse_core::VectorXd expected_residuals(num_residuals);
+      ASSERT_TRUE(expected_cost_function.Evaluate(parameters, expected_residuals.data(), nullptr));
+
+      fuse_core::VectorXd residuals(num_residuals);
+      fuse_core::MatrixXd jacobian(num_residuals, 4);
+      double* jacobians[] = {jacobian.data()};
+      ASSERT_TRUE(cost_function->Evaluate(parameters, residuals.data(), jacobians));
+
+      EXPECT_TRUE(expected_residuals.isApprox(residuals, 1.0e-9));
+      EXPECT_TRUE(jacobian.allFinite());
+      EXPECT_TRUE(jacobian.isZero()) << "Actual:\n" << jacobian;
+    }
+  }
+}
+
 TEST(AbsoluteOrientation3DStampedEulerConstraint, OptimizationFull)
 {
   // Optimize a single pose and single constraint, verify the expected value and covariance are generated.
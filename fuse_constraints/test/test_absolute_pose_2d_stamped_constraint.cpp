@@ -42,6 +42,7 @@
 #include <ceres/solver.h>
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -83,6 +84,44 @@ TEST(AbsolutePose2DStampedConstraint, Covariance)
   EXPECT_TRUE(expected_sqrt_info.isApprox(constraint.sqrtInformation(), 1.0e-9));
 }
 
+TEST(AbsolutePose2DStampedConstraint, PartialCostFunction)
+{
+  // Verify the cost function generates one residual per measured dimension
+  Orientation2DStamped orientation_variable(ros::Time(1234, 5678), fuse_core::uuid::generate("eve"));
+  orientation_variable.yaw() = 0.5;
+  Position2DStamped position_variable(ros::Time(1234, 5678), fuse_core::uuid::generate("eve"));
+  position_variable.x() = 1.5;
+  position_variable.y() = -3.0;
+  const double* parameters[] = {position_variable.data(), orientation_variable.data()};
+
+  // A yaw-only prior
+  fuse_core::Vector1d mean1;
+  mean1 << 0.2;
+  fuse_core::Matrix1d cov1;
+  cov1 << 4.0;
+  AbsolutePose2DStampedConstraint constraint1(
+    position_variable, orientation_variable, mean1, cov1, {}, {Orientation2DStamped::YAW});  // NOLINT
+  std::unique_ptr<ceres::CostFunction> cost_function1(constraint1.costFunction());
+  ASSERT_EQ(1, cost_function1->num_residuals());
+  double residuals1[1];
+  ASSERT_TRUE(cost_function1->Evaluate(parameters, residuals1, nullptr));
+  EXPECT_NEAR(0.5 * (0.5 - 0.2), residuals1[0], 1.0e-9);
+
+  // An (x, y) prior
+  fuse_core::Vector2d mean2;
+  mean2 << 1.0, -2.0;
+  fuse_core::Matrix2d cov2;
+  cov2 << 1.0, 0.0, 0.0, 4.0;
+  AbsolutePose2DStampedConstraint constraint2(
+    position_variable, orientation_variable, mean2, cov2, {Position2DStamped::X, Position2DStamped::Y}, {});  // NOLINT
+  std::unique_ptr<ceres::CostFunction> cost_function2(constraint2.costFunction());
+  ASSERT_EQ(2, cost_function2->num_residuals());
+  double residuals2[2];
+  ASSERT_TRUE(cost_function2->Evaluate(parameters, residuals2, nullptr));
+  EXPECT_NEAR(1.5 - 1.0, residuals2[0], 1.0e-9);
+  EXPECT_NEAR(0.5 * (-3.0 + 2.0), residuals2[1], 1.0e-9);
+}
+
 TEST(AbsolutePose2DStampedConstraint, OptimizationFull)
 {
   // Optimize a single pose and single constraint, verify the expected value and covariance are generated.
@@ -0,0 +1,292 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/pose_graph_io.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_3d_stamped_constraint.h>
+#include <fuse_core/eigen.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/orientation_3d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/position_3d_stamped.h>
+#include <ros/time.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using fuse_constraints::RelativePose2DStampedConstraint;
+using fuse_constraints::RelativePose3DStampedConstraint;
+using fuse_variables::Orientation2DStamped;
+using fuse_variables::Orientation3DStamped;
+using fuse_variables::Position2DStamped;
+using fuse_variables::Position3DStamped;
+
+
+/**
+ * @brief A small 2D pose graph in the g2o format: a unit square with a loop closure
+ */
+const std::string SQUARE_2D_G2O =
+  "# A unit square\n"
+  "VERTEX_SE2 0 0 0 0\n"
+  "VERTEX_SE2 1 1.1 0.1 1.5\n"
+  "VERTEX_SE2 2 0.9 1.2 3.0\n"
+  "VERTEX_SE2 3 -0.1 0.8 -1.6\n"
+  "\n"
+  "EDGE_SE2 0 1 1 0 1.5707963267948966 100 0 0 100 0 400\n"
+  "EDGE_SE2 1 2 1 0 1.5707963267948966 100 0 0 100 0 400\n"
+  "EDGE_SE2 2 3 1 0 1.5707963267948966 100 0 0 100 0 400\n"
+  "EDGE_SE2 3 0 1 0 1.5707963267948966 100 0 0 100 0 400\n"
+  "FIX 0\n";
+
+/**
+ * @brief Find the single relative pose constraint in the graph connecting the two stamps
+ */
+template <typename Constraint, typename Position>
+const Constraint& getEdge(const fuse_core::Graph& graph, uint32_t id1, uint32_t id2)
+{
+  const auto position1_uuid = Position(ros::Time(id1, 0)).uuid();
+  const auto position2_uuid = Position(ros::Time(id2, 0)).uuid();
+  for (const auto& constraint : graph.getConstraints())
+  {
+    if (constraint.variables().at(0) == position1_uuid && constraint.variables().at(2) == position2_uuid)
+    {
+      return dynamic_cast<const Constraint&>(constraint);
+    }
+  }
+  throw std::out_of_range("No edge between " + std::to_string(id1) + " and " + std::to_string(id2));
+}
+
+/**
+ * @brief Compare two datasets token by token, allowing a small numerical error in the values
+ */
+void expectDatasetsNear(const std::string& expected, const std::string& actual)
+{
+  std::istringstream expected_stream(expected);
+  std::istringstream actual_stream(actual);
+  std::string expected_token;
+  std::string actual_token;
+  while (expected_stream >> expected_token)
+  {
+    ASSERT_TRUE(static_cast<bool>(actual_stream >> actual_token));
+    if (expected_token.find_first_not_of("0123456789.-+e") == std::string::npos)
+    {
+      const double expected_value = std::stod(expected_token);
+      EXPECT_NEAR(expected_value, std::stod(actual_token), 1.0e-9 * (1.0 + std::abs(expected_value)));
+    }
+    else
+    {
+      EXPECT_EQ(expected_token, actual_token);
+    }
+  }
+  EXPECT_FALSE(static_cast<bool>(actual_stream >> actual_token));
+}
+
+TEST(PoseGraphIO, LoadG2O2D)
+{
+  fuse_graphs::HashGraph graph;
+  std::istringstream stream(SQUARE_2D_G2O);
+  fuse_constraints::loadPoseGraph(stream, graph);
+
+  EXPECT_EQ(8, std::distance(graph.getVariables().begin(), graph.getVariables().end()));
+  EXPECT_EQ(4, std::distance(graph.getConstraints().begin(), graph.getConstraints().end()));
+
+  const auto& position = dynamic_cast<const Position2DStamped&>(
+    graph.getVariable(Position2DStamped(ros::Time(1, 0)).uuid()));
+  EXPECT_EQ(1.1, position.x());
+  EXPECT_EQ(0.1, position.y());
+  const auto& orientation = dynamic_cast<const Orientation2DStamped&>(
+    graph.getVariable(Orientation2DStamped(ros::Time(1, 0)).uuid()));
+  EXPECT_EQ(1.5, orientation.yaw());
+
+  const auto& edge = getEdge<RelativePose2DStampedConstraint, Position2DStamped>(graph, 3, 0);
+  EXPECT_NEAR(1.0, edge.delta()(0), 1.0e-9);
+  EXPECT_NEAR(0.0, edge.delta()(1), 1.0e-9);
+  EXPECT_NEAR(1.5707963267948966, edge.delta()(2), 1.0e-9);
+  fuse_core::Matrix3d expected_covariance;
+  expected_covariance << 0.01, 0.0, 0.0,
+                         0.0, 0.01, 0.0,
+                         0.0, 0.0, 0.0025;
+  EXPECT_TRUE(expected_covariance.isApprox(edge.covariance(), 1.0e-9));
+}
+
+TEST(PoseGraphIO, LoadG2O3D)
+{
+  fuse_graphs::HashGraph graph;
+  std::istringstream stream(
+    "VERTEX_SE3:QUAT 4 1 2 3 0 0 0 1\n"
+    "VERTEX_SE3:QUAT 7 2 2 3 0 0 0.7071067811865476 0.7071067811865476\n"
+    "EDGE_SE3:QUAT 4 7 1 0 0 0 0 0.7071067811865476 0.7071067811865476 "
+    "100 0 0 0 0 0 100 0 0 0 0 100 0 0 0 400 0 0 400 0 400\n");
+  fuse_constraints::loadPoseGraph(stream, graph);
+
+  const auto& position = dynamic_cast<const Position3DStamped&>(
+    graph.getVariable(Position3DStamped(ros::Time(7, 0)).uuid()));
+  EXPECT_EQ(2.0, position.x());
+  EXPECT_EQ(3.0, position.z());
+  const auto& orientation = dynamic_cast<const Orientation3DStamped&>(
+    graph.getVariable(Orientation3DStamped(ros::Time(7, 0)).uuid()));
+  EXPECT_NEAR(0.7071067811865476, orientation.w(), 1.0e-9);
+  EXPECT_NEAR(0.0, orientation.x(), 1.0e-9);
+  EXPECT_NEAR(0.7071067811865476, orientation.z(), 1.0e-9);
+
+  const auto& edge = getEdge<RelativePose3DStampedConstraint, Position3DStamped>(graph, 4, 7);
+  fuse_core::Vector7d expected_delta;
+  expected_delta << 1.0, 0.0, 0.0, 0.7071067811865476, 0.0, 0.0, 0.7071067811865476;
+  EXPECT_TRUE(expected_delta.isApprox(edge.delta(), 1.0e-9));
+  EXPECT_NEAR(0.01, edge.covariance()(0, 0), 1.0e-9);
+  EXPECT_NEAR(0.0025, edge.covariance()(5, 5), 1.0e-9);
+}
+
+TEST(PoseGraphIO, LoadTORO)
+{
+  fuse_graphs::HashGraph graph;
+  std::istringstream stream(
+    "VERTEX2 0 0 0 0\n"
+    "VERTEX2 1 1 0 0\n"
+    "EDGE2 0 1 1 0 0 4 1 5 9 2 3\n"
+    "VERTEX3 2 0 0 0 0 0 1.5707963267948966\n"
+    "VERTEX3 3 1 0 0 0 0 0\n"
+    "EDGE3 2 3 1 0 0 0 0 -1.5707963267948966 1 0 0 0 0 0 1 0 0 0 0 1 0 0 0 1 0 0 1 0 1\n");
+  fuse_constraints::loadPoseGraph(stream, graph);
+
+  // TORO orders the 2D information matrix as xx, xy, yy, yaw-yaw, x-yaw, y-yaw
+  const auto& edge_2d = getEdge<RelativePose2DStampedConstraint, Position2DStamped>(graph, 0, 1);
+  fuse_core::Matrix3d expected_information;
+  expected_information << 4, 1, 2,
+                          1, 5, 3,
+                          2, 3, 9;
+  EXPECT_TRUE(expected_information.inverse().isApprox(edge_2d.covariance(), 1.0e-9));
+
+  // TORO stores 3D rotations as roll, pitch, and yaw
+  const auto& orientation = dynamic_cast<const Orientation3DStamped&>(
+    graph.getVariable(Orientation3DStamped(ros::Time(2, 0)).uuid()));
+  EXPECT_NEAR(0.7071067811865476, orientation.w(), 1.0e-9);
+  EXPECT_NEAR(0.7071067811865476, orientation.z(), 1.0e-9);
+  const auto& edge_3d = getEdge<RelativePose3DStampedConstraint, Position3DStamped>(graph, 2, 3);
+  EXPECT_NEAR(0.7071067811865476, edge_3d.delta()(3), 1.0e-9);
+  EXPECT_NEAR(-0.7071067811865476, edge_3d.delta()(6), 1.0e-9);
+}
+
+TEST(PoseGraphIO, RoundTrip)
+{
+  // Load, save, and load the dataset again. The second save must match the first, up to rounding errors.
+  fuse_graphs::HashGraph graph1;
+  std::istringstream input(SQUARE_2D_G2O +
+    "VERTEX_SE3:QUAT 4 1 2 3 0 0 0 1\n"
+    "VERTEX_SE3:QUAT 5 2 2 3 0 0 0.6 0.8\n"
+    "EDGE_SE3:QUAT 4 5 1 0 0 0 0 0.6 0.8 100 1 0 0 0 0 100 0 0 0 0 100 0 0 0 400 0 0 400 0 400\n");
+  fuse_constraints::loadPoseGraph(input, graph1);
+  std::ostringstream output1;
+  fuse_constraints::savePoseGraph(graph1, output1);
+
+  fuse_graphs::HashGraph graph2;
+  std::istringstream input2(output1.str());
+  fuse_constraints::loadPoseGraph(input2, graph2);
+  std::ostringstream output2;
+  fuse_constraints::savePoseGraph(graph2, output2);
+  expectDatasetsNear(output1.str(), output2.str());
+  EXPECT_NE(std::string::npos, output1.str().find("VERTEX_SE2 3 "));
+  EXPECT_NE(std::string::npos, output1.str().find("EDGE_SE3:QUAT 4 5 "));
+
+  // Convert to TORO and back
+  std::ostringstream toro;
+  fuse_constraints::savePoseGraph(graph1, toro, fuse_constraints::PoseGraphFormat::TORO);
+  EXPECT_NE(std::string::npos, toro.str().find("EDGE2 3 0 "));
+  fuse_graphs::HashGraph graph3;
+  std::istringstream input3(toro.str());
+  fuse_constraints::loadPoseGraph(input3, graph3);
+  const auto& edge = getEdge<RelativePose3DStampedConstraint, Position3DStamped>(graph3, 4, 5);
+  fuse_core::Vector7d expected_delta;
+  expected_delta << 1.0, 0.0, 0.0, 0.8, 0.0, 0.0, 0.6;
+  EXPECT_TRUE(expected_delta.isApprox(edge.delta(), 1.0e-9));
+  const auto& edge_2d = getEdge<RelativePose2DStampedConstraint, Position2DStamped>(graph3, 2, 3);
+  EXPECT_NEAR(0.0025, edge_2d.covariance()(2, 2), 1.0e-9);
+}
+
+TEST(PoseGraphIO, Optimize)
+{
+  // The fixed vertex stays in place, and the remaining vertices converge to the corners of the square
+  fuse_graphs::HashGraph graph;
+  std::istringstream stream(SQUARE_2D_G2O);
+  fuse_constraints::loadPoseGraph(stream, graph);
+  graph.optimize();
+
+  const double expected[4][3] = {{0, 0, 0}, {1, 0, 1.5707963267948966}, {1, 1, 3.141592653589793},  // NOLINT
+                                 {0, 1, -1.5707963267948966}};  // NOLINT
+  for (uint32_t id = 0; id < 4; ++id)
+  {
+    const auto& position = dynamic_cast<const Position2DStamped&>(
+      graph.getVariable(Position2DStamped(ros::Time(id, 0)).uuid()));
+    const auto& orientation = dynamic_cast<const Orientation2DStamped&>(
+      graph.getVariable(Orientation2DStamped(ros::Time(id, 0)).uuid()));
+    EXPECT_NEAR(expected[id][0], position.x(), 1.0e-5);
+    EXPECT_NEAR(expected[id][1], position.y(), 1.0e-5);
+    EXPECT_NEAR(std::cos(expected[id][2]), std::cos(orientation.yaw()), 1.0e-5);
+    EXPECT_NEAR(std::sin(expected[id][2]), std::sin(orientation.yaw()), 1.0e-5);
+  }
+}
+
+TEST(PoseGraphIO, Errors)
+{
+  const std::string errors[] =
+  {
+    "VERTEX_SE2 0 0 0\n",  // Missing value
+    "VERTEX_SE2 -1 0 0 0\n",  // Negative id
+    "VERTEX_SE2 0 0 0 0\nVERTEX_SE2 0 0 0 0\n",  // Duplicate vertex
+    "VERTEX_SE2 0 0 0 0\nEDGE_SE2 0 1 1 0 0 1 0 0 1 0 1\n",  // Unknown vertex
+    "VERTEX_SE2 0 0 0 0\nVERTEX_SE3:QUAT 1 0 0 0 0 0 0 1\nEDGE_SE2 0 1 1 0 0 1 0 0 1 0 1\n",  // Mixed dimensions
+    "VERTEX_SE2 0 0 0 0\nFIX 1\n",  // Unknown fixed vertex
+    "VERTEX_XY 0 0 0\n",  // Unsupported record
+  };
+  for (const auto& error : errors)
+  {
+    fuse_graphs::HashGraph graph;
+    std::istringstream stream(error);
+    EXPECT_THROW(fuse_constraints::loadPoseGraph(stream, graph), std::runtime_error) << error;
+    EXPECT_EQ(0, std::distance(graph.getVariables().begin(), graph.getVariables().end())) << error;
+  }
+  fuse_graphs::HashGraph graph;
+  EXPECT_THROW(fuse_constraints::loadPoseGraph("/nonexistent/dataset.g2o", graph), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -32,17 +32,20 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/normal_delta_pose_2d_cost_functor.h>
 #include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
 #include <fuse_core/eigen.h>
 #include <fuse_core/uuid.h>
 #include <fuse_variables/orientation_2d_stamped.h>
 #include <fuse_variables/position_2d_stamped.h>
 
+#include <ceres/autodiff_cost_function.h>
 #include <ceres/covariance.h>
 #include <ceres/problem.h>
 #include <ceres/solver.h>
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -71,6 +74,45 @@ TEST(RelativePose2DStampedConstraint, Constructor)
                                                              cov));
 }
 
+TEST(RelativePose2DStampedConstraint, ContentAddressedUuid)
+{
+  Orientation2DStamped orientation1(ros::Time(1234, 5678), fuse_core::uuid::generate("r5d4"));
+  Position2DStamped position1(ros::Time(1234, 5678), fuse_core::uuid::generate("r5d4"));
+  Orientation2DStamped orientation2(ros::Time(1235, 5678), fuse_core::uuid::generate("r5d4"));
+  Position2DStamped position2(ros::Time(1235, 5678), fuse_core::uuid::generate("r5d4"));
+  fuse_core::Vector3d delta;
+  delta << 1.0, 2.0, 3.0;
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+
+  // The default constructor generates a random UUID
+  RelativePose2DStampedConstraint random1(position1, orientation1, position2, orientation2, delta, cov);
+  RelativePose2DStampedConstraint random2(position1, orientation1, position2, orientation2, delta, cov);
+  EXPECT_NE(random1.uuid(), random2.uuid());
+
+  // The content-addressed constructor derives the UUID from the measurement
+  RelativePose2DStampedConstraint constraint1(
+    fuse_core::content_addressed, position1, orientation1, position2, orientation2, delta, cov);
+  RelativePose2DStampedConstraint constraint2(
+    fuse_core::content_addressed, position1, orientation1, position2, orientation2, delta, cov);
+  EXPECT_EQ(constraint1.uuid(), constraint2.uuid());
+  EXPECT_NE(random1.uuid(), constraint1.uuid());
+  EXPECT_EQ(random1.variables(), constraint1.variables());
+  EXPECT_TRUE(random1.sqrtInformation().isApprox(constraint1.sqrtInformation()));
+
+  // A different measurement between the same variables is a different constraint
+  fuse_core::Vector3d other_delta;
+  other_delta << 1.0, 2.0, 3.5;
+  RelativePose2DStampedConstraint constraint3(
+    fuse_core::content_addressed, position1, orientation1, position2, orientation2, other_delta, cov);
+  EXPECT_NE(constraint1.uuid(), constraint3.uuid());
+
+  // The same measurement between different variables is a different constraint
+  RelativePose2DStampedConstraint constraint4(
+    fuse_core::content_addressed, position2, orientation2, position1, orientation1, delta, cov);
+  EXPECT_NE(constraint1.uuid(), constraint4.uuid());
+}
+
 TEST(RelativePose2DStampedConstraint, Covariance)
 {
   // Verify the covariance <--> sqrt information conversions are correct
@@ -420,6 +462,87 @@ TEST(RelativePose2DStampedConstraint, OptimizationPartial)
   }
 }
 
+TEST(RelativePose2DStampedConstraint, CostFunctionMatchesAutoDiff)
+{
+  // Verify the analytic cost function matches the automatic differentiation of the cost functor, for both full and
+  // partial measurements
+  Orientation2DStamped orientation1(ros::Time(1234, 5678), fuse_core::uuid::generate("r5d4"));
+  Position2DStamped position1(ros::Time(1234, 5678), fuse_core::uuid::generate("r5d4"));
+  Orientation2DStamped orientation2(ros::Time(1235, 5678), fuse_core::uuid::generate("r5d4"));
+  Position2DStamped position2(ros::Time(1235, 5678), fuse_core::uuid::generate("r5d4"));
+  fuse_core::Vector3d delta;
+  delta << 1.0, 2.0, 3.0;
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_core::Vector2d partial_delta;
+  partial_delta << 2.0, 3.0;
+  fuse_core::Matrix2d partial_cov;
+  partial_cov << 2.0, 0.3, 0.3, 3.0;
+  std::vector<RelativePose2DStampedConstraint> constraints =
+  {
+    RelativePose2DStampedConstraint(position1, orientation1, position2, orientation2, delta, cov),
+    RelativePose2DStampedConstraint(position1, orientation1, position2, orientation2, partial_delta, partial_cov,
+                                    {1}, {0}),  // NOLINT(whitespace/braces)
+  };
+
+  // Evaluate at a point where the orientation difference wraps around
+  double x1[] = {1.5, -2.0};
+  double yaw1[] = {3.0};
+  double x2[] = {-0.5, 4.0};
+  double yaw2[] = {-2.9};
+  const double* parameters[] = {x1, yaw1, x2, yaw2};
+  const std::vector<int> block_sizes = {2, 1, 2, 1};
+  for (const auto& constraint : constraints)
+  {
+    // The autodiff functor only supports a full 3x3 weighting matrix. Compute the unweighted residuals and Jacobians
+    // with it, then apply the constraint's weighting matrix.
+    const fuse_core::MatrixXd A = constraint.sqrtInformation();
+    ceres::AutoDiffCostFunction<fuse_constraints::NormalDeltaPose2DCostFunctor, 3, 2, 1, 2, 1> unweighted_cost_function(
+      new fuse_constraints::NormalDeltaPose2DCostFunctor(fuse_core::Matrix3d::Identity(), constraint.delta()));
+    fuse_core::Vector3d unweighted_residuals;
+    std::vector<fuse_core::MatrixXd> unweighted_jacobians;
+    std::vector<double*> unweighted_jacobian_ptrs;
+    for (auto block_size : block_sizes)
+    {
+      unweighted_jacobians.push_back(fuse_core::MatrixXd(3, block_size));
+    }
+    for (auto& jacobian : unweighted_jacobians)
+    {
+      unweighted_jacobian_ptrs.push_back(jacobian.data());
+    }
+    ASSERT_TRUE(unweighted_cost_function.Evaluate(
+      parameters, unweighted_residuals.data(), unweighted_jacobian_ptrs.data()));
+
+    std::unique_ptr<ceres::CostFunction> cost_function(constraint.costFunction());
+    ASSERT_EQ(A.rows(), cost_function->num_residuals());
+    fuse_core::VectorXd residuals(A.rows());
+    std::vector<fuse_core::MatrixXd> jacobians;
+    std::vector<double*> jacobian_ptrs;
+    for (auto block_size : block_sizes)
+    {
+      jacobians.push_back(fuse_core::MatrixXd(A.rows(), block_size));
+    }
+    for (auto& jacobian : jacobians)
+    {
+      jacobian_ptrs.push_back(jacobian.data());
+    }
+    ASSERT_TRUE(cost_function->Evaluate(parameters, residuals.data(), jacobian_ptrs.data()));
+
+    EXPECT_TRUE((A * unweighted_residuals).isApprox(residuals, 1.0e-9));
+    for (size_t i = 0; i < block_sizes.size(); ++i)
+    {
+      fuse_core::MatrixXd expected_jacobian = A * unweighted_jacobians[i];
+      EXPECT_TRUE(expected_jacobian.isApprox(jacobians[i], 1.0e-9)) << "Jacobian block " << i << "\n"
+        << "Expected:\n" << expected_jacobian << "\nActual:\n" << jacobians[i];
+    }
+
+    // Evaluating the residuals alone must produce the same values
+    fuse_core::VectorXd residuals_only(A.rows());
+    ASSERT_TRUE(cost_function->Evaluate(parameters, residuals_only.data(), nullptr));
+    EXPECT_TRUE(residuals.isApprox(residuals_only, 1.0e-12));
+  }
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,103 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/message_buffer.h>
+#include <ros/duration.h>
+#include <ros/time.h>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+
+/**
+ * @brief The timestamp of the i-th message in the buffer
+ */
+static ros::Time stampAt(const int64_t i)
+{
+  return ros::Time(10, 0) + ros::Duration(0.01 * i);
+}
+
+/**
+ * @brief Insert messages into a buffer that is already holding a long history
+ *
+ * The buffer length is sized to hold \p state.range(0) messages, so every insert also purges the oldest message.
+ */
+static void BM_messageBufferInsert(benchmark::State& state)
+{
+  fuse_core::MessageBuffer<double> buffer(ros::Duration(0.01 * state.range(0)));
+  int64_t i = 0;
+  for (; i < state.range(0); ++i)
+  {
+    buffer.insert(stampAt(i), 1.0);
+  }
+  for (auto _ : state)
+  {
+    buffer.insert(stampAt(i++), 1.0);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_messageBufferInsert)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+/**
+ * @brief Query random, short time ranges from a long buffer
+ *
+ * This is the typical motion model access pattern: find the few messages bracketing a pair of timestamps.
+ */
+static void BM_messageBufferQuery(benchmark::State& state)
+{
+  fuse_core::MessageBuffer<double> buffer;
+  for (int64_t i = 0; i < state.range(0); ++i)
+  {
+    buffer.insert(stampAt(i), 1.0);
+  }
+  std::mt19937 random_engine(0);
+  std::uniform_int_distribution<int64_t> distribution(0, state.range(0) - 2);
+  std::vector<int64_t> indices(1024);
+  for (auto& index : indices)
+  {
+    index = distribution(random_engine);
+  }
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    const auto index = indices[i++ % indices.size()];
+    auto messages = buffer.query(stampAt(index), stampAt(index + 1));
+    benchmark::DoNotOptimize(messages);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_messageBufferQuery)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
@@ -0,0 +1,127 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/timestamp_manager.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/variable.h>
+#include <ros/duration.h>
+#include <ros/time.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+
+/**
+ * @brief Motion model generator that creates a single constraint between two new variables
+ */
+static void generator(
+  const ros::Time& /* beginning_stamp */,
+  const ros::Time& /* ending_stamp */,
+  std::vector<fuse_core::Constraint::SharedPtr>& constraints,
+  std::vector<fuse_core::Variable::SharedPtr>& variables)
+{
+  auto variable1 = ExampleVariable::make_shared();
+  auto variable2 = ExampleVariable::make_shared();
+  constraints.push_back(ExampleConstraint::make_shared(
+    std::initializer_list<fuse_core::UUID>{variable1->uuid(), variable2->uuid()}));  // NOLINT
+  variables.push_back(variable1);
+  variables.push_back(variable2);
+}
+
+/**
+ * @brief Create a timestamp manager with a motion model history spanning \p history_length timestamps
+ */
+static void populate(fuse_core::TimestampManager& manager, const size_t history_length)
+{
+  // Add the stamps one at a time, as a sensor would. This also keeps the individual transactions small.
+  for (size_t i = 0; i < history_length; ++i)
+  {
+    fuse_core::Transaction transaction;
+    manager.query({ros::Time(10, 0) + ros::Duration(0.1 * i)}, transaction);  // NOLINT
+  }
+}
+
+/**
+ * @brief Query a timestamp that is newer than anything in a long motion model history
+ *
+ * This is the common case for a sensor that produces data in order.
+ */
+static void BM_timestampManagerQueryInOrder(benchmark::State& state)
+{
+  fuse_core::TimestampManager manager(&generator, ros::DURATION_MAX);
+  populate(manager, state.range(0));
+  auto stamp = ros::Time(10, 0) + ros::Duration(0.1 * state.range(0));
+  for (auto _ : state)
+  {
+    fuse_core::Transaction transaction;
+    manager.query({stamp}, transaction);  // NOLINT
+    benchmark::DoNotOptimize(transaction);
+    stamp += ros::Duration(0.1);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_timestampManagerQueryInOrder)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+/**
+ * @brief Query random timestamps that fall inside a long motion model history
+ *
+ * Each query splits an existing motion model segment. This is the pattern produced by delayed or out-of-order
+ * sensor data.
+ */
+static void BM_timestampManagerQueryOutOfOrder(benchmark::State& state)
+{
+  fuse_core::TimestampManager manager(&generator, ros::DURATION_MAX);
+  populate(manager, state.range(0));
+  std::mt19937 random_engine(0);
+  std::uniform_int_distribution<int64_t> distribution(ros::Time(10, 0).toNSec(),
+    (ros::Time(10, 0) + ros::Duration(0.1 * (state.range(0) - 1))).toNSec());
+  for (auto _ : state)
+  {
+    // Generating a new random stamp is cheap compared to the query, so it is not excluded from the timing
+    ros::Time stamp;
+    stamp.fromNSec(distribution(random_engine));
+    fuse_core::Transaction transaction;
+    manager.query({stamp}, transaction);  // NOLINT
+    benchmark::DoNotOptimize(transaction);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_timestampManagerQueryOutOfOrder)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
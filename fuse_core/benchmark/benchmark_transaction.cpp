@@ -0,0 +1,170 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/variable.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <initializer_list>
+#include <vector>
+
+
+/**
+ * @brief Create a chain of variables, with a constraint between each consecutive pair
+ */
+static void createChain(
+  const size_t variable_count,
+  std::vector<fuse_core::Variable::SharedPtr>& variables,
+  std::vector<fuse_core::Constraint::SharedPtr>& constraints)
+{
+  variables.clear();
+  constraints.clear();
+  variables.reserve(variable_count);
+  constraints.reserve(variable_count);
+  for (size_t i = 0; i < variable_count; ++i)
+  {
+    variables.push_back(ExampleVariable::make_shared());
+    if (i > 0)
+    {
+      constraints.push_back(ExampleConstraint::make_shared(
+        std::initializer_list<fuse_core::UUID>{variables[i - 1]->uuid(), variables[i]->uuid()}));  // NOLINT
+    }
+  }
+}
+
+/**
+ * @brief Create a transaction containing a chain of variables and constraints
+ */
+static fuse_core::Transaction createTransaction(const size_t variable_count)
+{
+  std::vector<fuse_core::Variable::SharedPtr> variables;
+  std::vector<fuse_core::Constraint::SharedPtr> constraints;
+  createChain(variable_count, variables, constraints);
+  fuse_core::Transaction transaction;
+  for (const auto& variable : variables)
+  {
+    transaction.addVariable(variable);
+  }
+  for (const auto& constraint : constraints)
+  {
+    transaction.addConstraint(constraint);
+  }
+  return transaction;
+}
+
+/**
+ * @brief Add a large number of constraints to an empty transaction
+ */
+static void BM_transactionAddConstraint(benchmark::State& state)
+{
+  std::vector<fuse_core::Variable::SharedPtr> variables;
+  std::vector<fuse_core::Constraint::SharedPtr> constraints;
+  createChain(state.range(0) + 1, variables, constraints);
+  for (auto _ : state)
+  {
+    fuse_core::Transaction transaction;
+    for (const auto& constraint : constraints)
+    {
+      transaction.addConstraint(constraint);
+    }
+    benchmark::DoNotOptimize(transaction);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_transactionAddConstraint)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+/**
+ * @brief Add a large number of variables to an empty transaction
+ */
+static void BM_transactionAddVariable(benchmark::State& state)
+{
+  std::vector<fuse_core::Variable::SharedPtr> variables;
+  std::vector<fuse_core::Constraint::SharedPtr> constraints;
+  createChain(state.range(0), variables, constraints);
+  for (auto _ : state)
+  {
+    fuse_core::Transaction transaction;
+    for (const auto& variable : variables)
+    {
+      transaction.addVariable(variable);
+    }
+    benchmark::DoNotOptimize(transaction);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_transactionAddVariable)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+/**
+ * @brief Merge a transaction into another transaction of the same size
+ *
+ * This is the pattern used by the optimizers to combine the sensor and motion model transactions before they are
+ * applied to the graph.
+ */
+static void BM_transactionMerge(benchmark::State& state)
+{
+  const auto other = createTransaction(state.range(0));
+  const auto original = createTransaction(state.range(0));
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto transaction = original;
+    state.ResumeTiming();
+    transaction.merge(other);
+    benchmark::DoNotOptimize(transaction);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_transactionMerge)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+/**
+ * @brief Deep copy a transaction
+ */
+static void BM_transactionClone(benchmark::State& state)
+{
+  const auto transaction = createTransaction(state.range(0));
+  for (auto _ : state)
+  {
+    auto clone = transaction.clone();
+    benchmark::DoNotOptimize(clone);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_transactionClone)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
@@ -0,0 +1,145 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/uuid.h>
+#include <ros/time.h>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+
+static void BM_uuidGenerateRandom(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateRandom);
+
+static void BM_uuidGenerateBytes(benchmark::State& state)
+{
+  const unsigned char data[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(data, sizeof(data)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateBytes);
+
+static void BM_uuidGenerateCString(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate("fuse_variables::Position2DStamped"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateCString);
+
+static void BM_uuidGenerateString(benchmark::State& state)
+{
+  const std::string data = "fuse_variables::Position2DStamped";
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(data));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateString);
+
+static void BM_uuidGenerateNamespaceBytes(benchmark::State& state)
+{
+  const std::string namespace_string = "fuse_variables::Position2DStamped";
+  const unsigned char data[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(namespace_string, data, sizeof(data)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateNamespaceBytes);
+
+static void BM_uuidGenerateNamespaceCString(benchmark::State& state)
+{
+  const std::string namespace_string = "fuse_variables::Position2DStamped";
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(namespace_string, "base_link"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateNamespaceCString);
+
+static void BM_uuidGenerateNamespaceString(benchmark::State& state)
+{
+  const std::string namespace_string = "fuse_variables::Position2DStamped";
+  const std::string data = "base_link";
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(namespace_string, data));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateNamespaceString);
+
+/**
+ * @brief Generate a UUID from a timestamp, the method used by all of the stamped variable types
+ */
+static void BM_uuidGenerateNamespaceStamp(benchmark::State& state)
+{
+  const std::string namespace_string = "fuse_variables::Position2DStamped";
+  const ros::Time stamp(1234, 5678);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(namespace_string, stamp));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateNamespaceStamp);
+
+static void BM_uuidGenerateNamespaceStampId(benchmark::State& state)
+{
+  const std::string namespace_string = "fuse_variables::Position2DStamped";
+  const ros::Time stamp(1234, 5678);
+  const auto id = fuse_core::uuid::generate("base_link");
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(fuse_core::uuid::generate(namespace_string, stamp, id));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_uuidGenerateNamespaceStampId);
@@ -34,6 +34,7 @@
 #ifndef FUSE_CORE_ASYNC_MOTION_MODEL_H
 #define FUSE_CORE_ASYNC_MOTION_MODEL_H
 
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
 #include <fuse_core/motion_model.h>
@@ -99,6 +100,15 @@ public:
    */
   const std::string& name() const final { return name_; }
 
+  /**
+   * @brief Get the statistics of the callbacks scheduled by this motion model
+   *
+   * The "apply" and "graphCallback" callbacks are tracked.
+   */
+  CallbackStatistics::ConstSharedPtr callbackStatistics() const final { return callback_statistics_; }
+
+  using MotionModel::initialize;
+
   /**
    * @brief Perform any required post-construction initialization, such as subscribing to topics or reading from the
    * parameter server.
@@ -107,9 +117,16 @@ public:
    * private node handle will be in a namespace based on the plugin's name. This should prevent conflicts and allow
    * the same plugin to be used multiple times with different settings and topics.
    *
-   * @param[in] name A unique name to give this plugin instance
+   * @param[in] name                       A unique name to give this plugin instance
+   * @param[in] parent_node_handle         The optimizer's public node handle. The plugin's public node handle is a
+   *                                       copy of it, so the optimizer's namespace and remappings apply.
+   * @param[in] parent_private_node_handle A node handle in the optimizer's private namespace. The plugin's private
+   *                                       node handle is created beneath it.
    */
-  void initialize(const std::string& name) final;
+  void initialize(
+    const std::string& name,
+    const ros::NodeHandle& parent_node_handle,
+    const ros::NodeHandle& parent_private_node_handle) final;
 
   /**
    * @brief Function to be executed whenever the optimizer has completed a Graph update
@@ -132,18 +149,21 @@ public:
    * to the Graph. This implementation packages a call to the pure virtual method applyCallback() and inserts it into
    * this motion model's local callback queue. This allows the applyCallback() function to be executed from the same
    * thread as any other configured callbacks. Despite the fact that the queryCallback() function call runs in a
-   * different thread than this function, this function blocks until the query callback returns.
+   * different thread than this function, this function blocks until the query callback returns. The cost functions
+   * of the generated constraints are prepared in the local callback queue thread as well (see Transaction::prepare()).
    *
    * @param[in]  stamps      The set of timestamps that should be connected by motion model constraints
    * @param[out] transaction The transaction object that should be augmented with motion model constraints
    * @return                 True if the motion models were generated successfully, false otherwise
+   * @throws std::logic_error if a generated constraint has an invalid cost function
    */
   bool apply(const std::set<ros::Time>& stamps, Transaction& transaction) final;
 
 protected:
   ros::CallbackQueue callback_queue_;  //!< The local callback queue used for all subscriptions
+  CallbackStatistics::SharedPtr callback_statistics_;  //!< Queue depth and latency of the scheduled callbacks
   std::string name_;  //!< The unique name for this motion model instance
-  ros::NodeHandle node_handle_;  //!< A node handle in the global namespace using the local callback queue
+  ros::NodeHandle node_handle_;  //!< A node handle in the optimizer's namespace using the local callback queue
   ros::NodeHandle private_node_handle_;  //!< A node handle in the private namespace using the local callback queue
   ros::AsyncSpinner spinner_;  //!< A single/multi-threaded spinner assigned to the local callback queue
 
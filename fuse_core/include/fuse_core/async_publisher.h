@@ -34,6 +34,7 @@
 #ifndef FUSE_CORE_ASYNC_PUBLISHER_H
 #define FUSE_CORE_ASYNC_PUBLISHER_H
 
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
 #include <fuse_core/publisher.h>
@@ -70,6 +71,19 @@ public:
    */
   virtual ~AsyncPublisher() = default;
 
+  /**
+   * @brief Service this publisher's callbacks from a callback queue provided by the optimizer
+   *
+   * Must be called before initialize(). The node handles and the internal callbacks then use the provided queue, and
+   * the local spinner is never started, so the \p thread_count given to the constructor has no effect.
+   *
+   * @param[in] callback_queue The queue for all of this publisher's callbacks. It outlives the plugin.
+   * @return                   True if the provided queue is used, false if \p callback_queue is nullptr
+   */
+  bool useCallbackQueue(ros::CallbackQueue* callback_queue) final;
+
+  using Publisher::initialize;
+
   /**
    * @brief Initialize the AsyncPublisher object
    *
@@ -77,15 +91,29 @@ public:
    * internal callback queue serviced by a local thread. The AsyncPublisher::onInit() method will be called from
    * here, once the node handles are properly configured.
    *
-   * @param[in] name A unique name to give this plugin instance
+   * @param[in] name                       A unique name to give this plugin instance
+   * @param[in] parent_node_handle         The optimizer's public node handle. The plugin's public node handle is a
+   *                                       copy of it, so the optimizer's namespace and remappings apply.
+   * @param[in] parent_private_node_handle A node handle in the optimizer's private namespace. The plugin's private
+   *                                       node handle is created beneath it.
    */
-  void initialize(const std::string& name) final;
+  void initialize(
+    const std::string& name,
+    const ros::NodeHandle& parent_node_handle,
+    const ros::NodeHandle& parent_private_node_handle) final;
 
   /**
    * @brief Get the unique name of this publisher
    */
   const std::string& name() const final { return name_; }
 
+  /**
+   * @brief Get the statistics of the callbacks scheduled by this publisher
+   *
+   * The "notify" callbacks are tracked.
+   */
+  CallbackStatistics::ConstSharedPtr callbackStatistics() const final { return callback_statistics_; }
+
   /**
    * @brief Notify the publisher that an optimization cycle is complete, and about changes to the Graph.
    *
@@ -102,8 +130,11 @@ public:
 
 protected:
   ros::CallbackQueue callback_queue_;  //!< The local callback queue used for all subscriptions
+  CallbackStatistics::SharedPtr callback_statistics_;  //!< Queue depth and latency of the scheduled callbacks
+  ros::CallbackQueue* external_callback_queue_;  //!< A queue serviced by the optimizer, used instead of the local
+                                                 //!< callback queue and spinner when set. See useCallbackQueue().
   std::string name_;  //!< The unique name for this publisher instance
-  ros::NodeHandle node_handle_;  //!< A node handle in the global namespace using the local callback queue
+  ros::NodeHandle node_handle_;  //!< A node handle in the optimizer's namespace using the local callback queue
   ros::NodeHandle private_node_handle_;  //!< A node handle in the private namespace using the local callback queue
   ros::AsyncSpinner spinner_;  //!< A single/multi-threaded spinner assigned to the local callback queue
 
@@ -116,6 +147,11 @@ protected:
    */
   explicit AsyncPublisher(size_t thread_count = 1);
 
+  /**
+   * @brief The queue servicing this publisher's callbacks, either the queue provided by the optimizer or the local one
+   */
+  ros::CallbackQueue& callbackQueue() { return external_callback_queue_ ? *external_callback_queue_ : callback_queue_; }
+
   /**
    * @brief Perform any required initialization for the publisher
    *
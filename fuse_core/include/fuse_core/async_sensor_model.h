@@ -34,6 +34,7 @@
 #ifndef FUSE_CORE_ASYNC_SENSOR_MODEL_H
 #define FUSE_CORE_ASYNC_SENSOR_MODEL_H
 
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
 #include <fuse_core/sensor_model.h>
@@ -42,7 +43,11 @@
 #include <ros/node_handle.h>
 #include <ros/spinner.h>
 
+#include <atomic>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -81,10 +86,31 @@ namespace fuse_core
  *   void onGraphUpdate(Graph::ConstSharedPtr graph) override { this->graph_ = std::move(graph); }
  *   @endcode
  * - will _probably_ subscribe to a sensor message topic and write a custom message callback function. Within that
- *   function, the derived class will generate new constraints based on the received sensor data.
+ *   function, the derived class will generate new constraints based on the received sensor data. The callback should
+ *   accept the message as a const shared pointer (e.g. const sensor_msgs::PointCloud2::ConstPtr&). When the optimizer
+ *   is loaded as a nodelet alongside the sensor driver, the message is then delivered by pointer, without
+ *   serialization or copies. Callbacks that accept the message by value or by reference force a copy.
  * - _must_ call injectCallback() everytime a new constraints are generated. This is how constraints are sent to the
  *   optimizer. Otherwise, the optimizer will not know about the derived sensor's constraints, and the sensor will
  *   have no effect.
+ *
+ * When the optimizer reports that it is falling behind (see backpressureCallback()), the sensor model can shed
+ * transactions instead of letting latency build. The shedding behavior is configured through the plugin's private
+ * namespace:
+ *  - shedding_policy (string, default: "none") One of:
+ *    - "none" Every transaction is sent to the optimizer.
+ *    - "decimate" Only every N-th transaction is sent to the optimizer, where N grows with the load.
+ *    - "merge" Transactions are merged together, and the merged transaction is sent every N-th transaction, or as
+ *      soon as the optimizer catches up again.
+ *    - "drop_oldest" At most \p max_in_flight transactions wait in the optimizer's callback queue. Older waiting
+ *      transactions are cancelled in favor of newer ones.
+ *  - priority (double, default: 0.0) Higher priority sensors shed later. Shedding begins when the optimizer load
+ *    exceeds (1 + priority).
+ *  - max_in_flight (int, default: 1) The number of waiting transactions allowed by the "drop_oldest" policy while the
+ *    optimizer is overloaded
+ *
+ * Only transactions that add no variables are shed. Transactions that add variables are always sent, in order, and
+ * any previously merged transaction is sent before them.
  */
 class AsyncSensorModel : public SensorModel
 {
@@ -109,6 +135,19 @@ public:
    */
   void graphCallback(Graph::ConstSharedPtr graph) final;
 
+  /**
+   * @brief Service this sensor model's callbacks from a callback queue provided by the optimizer
+   *
+   * Must be called before initialize(). The node handles and the internal callbacks then use the provided queue, and
+   * the local spinner is never started, so the \p thread_count given to the constructor has no effect.
+   *
+   * @param[in] callback_queue The queue for all of this sensor model's callbacks. It outlives the plugin.
+   * @return                   True if the provided queue is used, false if \p callback_queue is nullptr
+   */
+  bool useCallbackQueue(ros::CallbackQueue* callback_queue) final;
+
+  using SensorModel::initialize;
+
   /**
    * @brief Perform any required post-construction initialization, such as subscribing to topics or reading from the
    * parameter server.
@@ -122,11 +161,17 @@ public:
    * @param[in] transaction_callback_queue The callback queue the callback function should be inserted into. This
    *                                       will likely belong to the parent of the plugin, as no attempt to spin this
    *                                       queue is performed.
+   * @param[in] parent_node_handle         The optimizer's public node handle. The plugin's public node handle is a
+   *                                       copy of it, so the optimizer's namespace and remappings apply.
+   * @param[in] parent_private_node_handle A node handle in the optimizer's private namespace. The plugin's private
+   *                                       node handle is created beneath it.
    */
   void initialize(
     const std::string& name,
     TransactionCallback transaction_callback,
-    ros::CallbackQueue* transaction_callback_queue) final;
+    ros::CallbackQueue* transaction_callback_queue,
+    const ros::NodeHandle& parent_node_handle,
+    const ros::NodeHandle& parent_private_node_handle) final;
 
   /**
    * @brief Inject the Transaction into the callback queue registered during initialize()
@@ -138,10 +183,13 @@ public:
    * the Optimizer's callback thread(s).
    * 
    * This should be called by derived classes whenever a new Transaction is generated, probably from within the sensor
-   * message callback function.
+   * message callback function. The cost functions of the added constraints are prepared here, in the sensor model's
+   * thread, before the transaction is merged by a shedding policy or sent (see Transaction::prepare()). A transaction
+   * that fails to prepare is neither merged nor sent.
    *
    * @param[in] stamps      Any timestamps associated with the added variables. These are sent to the motion models.
    * @param[in] transaction A Transaction object describing the set of variables that have been added and removed.
+   * @throws std::logic_error if an added constraint has an invalid cost function
    */
   void injectCallback(
     const std::set<ros::Time>& stamps,
@@ -152,11 +200,63 @@ public:
    */
   const std::string& name() const final { return name_; }
 
+  /**
+   * @brief Get the statistics of the callbacks scheduled by this sensor model
+   *
+   * The "graphCallback" and "injectCallback" callbacks are tracked.
+   */
+  CallbackStatistics::ConstSharedPtr callbackStatistics() const final { return callback_statistics_; }
+
+  /**
+   * @brief Function to be executed whenever the optimizer reports its current load
+   *
+   * The reported load is stored and used to shed transactions according to the configured shedding policy. If the
+   * optimizer has caught up, any transactions merged by the "merge" policy are sent immediately.
+   *
+   * @param[in] load The current optimizer load
+   */
+  void backpressureCallback(double load) final;
+
 protected:
+  /**
+   * @brief The available strategies for shedding transactions while the optimizer is overloaded
+   */
+  enum class SheddingPolicy
+  {
+    NONE,
+    DECIMATE,
+    MERGE,
+    DROP_OLDEST
+  };
+
+  /**
+   * @brief The transactions injected into the optimizer's callback queue but not yet executed
+   *
+   * This is shared with the injected callbacks so they remain valid even if the sensor model is destroyed first.
+   */
+  struct InFlight
+  {
+    std::mutex mutex;  //!< Guards the cancellation flags
+    std::deque<std::shared_ptr<std::atomic<bool>>> cancelled;  //!< One flag per waiting transaction, oldest first
+  };
+
+
   ros::CallbackQueue callback_queue_;  //!< The local callback queue used for all subscriptions
+  CallbackStatistics::SharedPtr callback_statistics_;  //!< Queue depth and latency of the scheduled callbacks
+  ros::CallbackQueue* external_callback_queue_;  //!< A queue serviced by the optimizer, used instead of the local
+                                                 //!< callback queue and spinner when set. See useCallbackQueue().
+  std::shared_ptr<InFlight> in_flight_;  //!< The waiting transactions, used by the "drop_oldest" policy
+  std::atomic<double> load_;  //!< The most recent optimizer load
+  size_t max_in_flight_;  //!< The number of waiting transactions allowed by the "drop_oldest" policy
+  std::set<ros::Time> merged_stamps_;  //!< The timestamps of the transactions merged by the "merge" policy
+  Transaction::SharedPtr merged_transaction_;  //!< The transactions merged by the "merge" policy, if any
   std::string name_;  //!< The unique name for this sensor model instance
-  ros::NodeHandle node_handle_;  //!< A node handle in the global namespace using the local callback queue
+  ros::NodeHandle node_handle_;  //!< A node handle in the optimizer's namespace using the local callback queue
+  double priority_;  //!< Shedding begins when the optimizer load exceeds (1 + priority)
   ros::NodeHandle private_node_handle_;  //!< A node handle in the private namespace using the local callback queue
+  size_t shed_count_;  //!< The number of transactions shed since the last one was sent
+  SheddingPolicy shedding_policy_;  //!< The configured shedding policy
+  std::mutex shedding_mutex_;  //!< Guards the shedding state
   ros::AsyncSpinner spinner_;  //!< A single/multi-threaded spinner assigned to the local callback queue
   TransactionCallback transaction_callback_;  //!< The function to be executed every time a Transaction is "published"
   ros::CallbackQueue* transaction_callback_queue_;  //!< The callback queue used for transaction callbacks. This will
@@ -172,6 +272,16 @@ protected:
    */
   explicit AsyncSensorModel(size_t thread_count = 1);
 
+  /**
+   * @brief The queue servicing this sensor model's callbacks, either the one provided by the optimizer or the local one
+   */
+  ros::CallbackQueue& callbackQueue() { return external_callback_queue_ ? *external_callback_queue_ : callback_queue_; }
+
+  /**
+   * @brief The most recent optimizer load reported by backpressureCallback()
+   */
+  double load() const { return load_; }
+
   /**
    * @brief Callback fired in the local callback queue thread(s) whenever a new Graph is received from the optimizer
    * 
@@ -199,6 +309,18 @@ protected:
    * sensor model would actually do anything.
    */
   virtual void onInit() = 0;
+
+private:
+  /**
+   * @brief Insert the transaction callback into the optimizer's callback queue
+   *
+   * The shedding state must be locked by the caller. The transaction must already be prepared.
+   *
+   * @param[in] stamps      Any timestamps associated with the added variables
+   * @param[in] transaction The transaction to send
+   * @param[in] overloaded  Flag indicating the optimizer is currently overloaded
+   */
+  void sendTransaction(const std::set<ros::Time>& stamps, const Transaction::SharedPtr& transaction, bool overloaded);
 };
 
 }  // namespace fuse_core
@@ -0,0 +1,116 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_CALLBACK_STATISTICS_H
+#define FUSE_CORE_CALLBACK_STATISTICS_H
+
+#include <fuse_core/macros.h>
+#include <ros/callback_queue_interface.h>
+#include <ros/time.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief Tracks the queue depth, latency, and execution time of the callbacks scheduled by a plugin
+ *
+ * Each of the asynchronous plugin base classes services its own callback queue, and a plugin that falls behind is
+ * otherwise invisible until the whole system slows down. Callbacks scheduled through CallbackStatistics::addCallback()
+ * are wrapped in a thin instrumented callback before being inserted into the queue. The wrapper records the time the
+ * callback spent waiting in the queue and the time spent executing it. Statistics are kept separately for each
+ * callback name (e.g. "graphCallback" or "notify"), as callbacks scheduled by the same plugin may be serviced by
+ * different queues.
+ *
+ * Only callbacks that return ros::CallbackInterface::Success are counted as executions. A callback that returns
+ * ros::CallbackInterface::Invalid was cancelled, and a callback that is destroyed without being called was dropped by
+ * its queue. Both leave the queue depth without being counted.
+ *
+ * All functions are thread-safe.
+ */
+class CallbackStatistics
+{
+public:
+  SMART_PTR_DEFINITIONS(CallbackStatistics);
+
+  /**
+   * @brief The accumulated statistics of a single named callback
+   */
+  struct Summary
+  {
+    std::string callback;  //!< The name of the callback
+    uint64_t executed = 0;  //!< The number of completed executions
+    uint64_t queue_depth = 0;  //!< The number of scheduled callbacks that have not been executed yet
+    uint64_t max_queue_depth = 0;  //!< The largest queue depth observed
+    ros::WallDuration mean_latency;  //!< The mean time between scheduling and the start of execution
+    ros::WallDuration max_latency;  //!< The largest time between scheduling and the start of execution
+    ros::WallDuration mean_execution_time;  //!< The mean time spent executing the callback
+    ros::WallDuration max_execution_time;  //!< The largest time spent executing the callback
+  };
+
+  /**
+   * @brief Instrument the \p callback and insert it into the \p callback_queue
+   *
+   * @param[in] callback_name  The name used to group the statistics of this callback
+   * @param[in] callback       The callback to execute
+   * @param[in] callback_queue The callback queue the callback is inserted into
+   */
+  void addCallback(
+    const std::string& callback_name,
+    const ros::CallbackInterfacePtr& callback,
+    ros::CallbackQueueInterface& callback_queue);
+
+  /**
+   * @brief Get the current statistics of every tracked callback, sorted by callback name
+   */
+  std::vector<Summary> summarize() const;
+
+private:
+  class Counters;
+  class InstrumentedCallback;
+
+  std::map<std::string, std::shared_ptr<Counters>> counters_;  //!< The counters of each named callback. Shared with
+                                                               //!< the callbacks that are still waiting in a queue.
+  mutable std::mutex mutex_;  //!< Guards the counters_ container
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_CALLBACK_STATISTICS_H
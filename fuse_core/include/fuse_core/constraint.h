@@ -42,6 +42,7 @@
 #include <ceres/loss_function.h>
 
 #include <initializer_list>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -50,6 +51,22 @@
 namespace fuse_core
 {
 
+/**
+ * @brief Tag type used to select the content-addressed constructors of the constraint types that provide them
+ *
+ * Constraints receive a random UUID by default. Constraint types that support content-addressed UUIDs provide
+ * additional constructors taking fuse_core::content_addressed as the first argument. Sensor models that may re-send
+ * the same measurement, e.g. after a restart or from redundant drivers, opt in by using those constructors.
+ */
+struct ContentAddressed
+{
+};
+
+/**
+ * @brief The tag value passed to the content-addressed constraint constructors
+ */
+constexpr ContentAddressed content_addressed = ContentAddressed();
+
 /**
  * @brief The Constraint interface definition.
  *
@@ -91,6 +108,26 @@ public:
   template<typename VariableUuidIterator>
   Constraint(VariableUuidIterator first, VariableUuidIterator last);
 
+  /**
+   * @brief Constructor for constraint types that opt into content-addressed UUIDs
+   *
+   * Instead of a random UUID, the constraint UUID is derived from the constraint type, the ordered list of variable
+   * UUIDs, and a key describing the measurement. Constructing the same measurement twice, such as when a measurement is
+   * re-sent after a sensor model restart or is published by redundant drivers, produces the same UUID. Transactions and
+   * graphs ignore constraints with a UUID they already contain, so the duplicate is dropped instead of being added as
+   * a second residual block.
+   *
+   * @param[in] type               The constraint type. The type() function cannot be called from a base class
+   *                               constructor, so derived classes should provide the same string type() returns.
+   * @param[in] variable_uuid_list The list of involved variable UUIDs
+   * @param[in] measurement_key    Everything that distinguishes this measurement from other measurements of the same
+   *                               type involving the same variables. See fuse_core::measurementKey().
+   */
+  Constraint(
+    const std::string& type,
+    std::initializer_list<UUID> variable_uuid_list,
+    const std::string& measurement_key);
+
   /**
    * @brief Destructor
    */
@@ -107,7 +144,8 @@ public:
   /**
    * @brief Returns the UUID for this constraint.
    *
-   * Each constraint will generate a unique, random UUID during construction.
+   * Each constraint will generate a unique, random UUID during construction, unless it is created by one of the
+   * content-addressed constructors. In that case, identical measurements share the same UUID.
    */
   const UUID& uuid() const { return uuid_; }
 
@@ -130,6 +168,44 @@ public:
    */
   virtual ceres::CostFunction* costFunction() const = 0;
 
+  /**
+   * @brief Build and validate the cost function ahead of time
+   *
+   * Sensor and motion models call this from their own threads before handing a transaction to the optimizer, usually
+   * via Transaction::prepare(). The cost function, including any automatic differentiation wrapper and the whitening
+   * matrix captured by the cost functor, is created once and kept by the constraint. Graphs then link the prepared
+   * cost function into each ceres::Problem through preparedCostFunction() instead of rebuilding it while the optimizer
+   * holds its lock. Calling this more than once has no further effect.
+   *
+   * The prepared cost function is shared, not copied, by every copy and clone of the constraint. Graph copies handed
+   * to other threads therefore evaluate the same object, possibly at the same time as the optimizer. A constraint may
+   * only be prepared if its cost function is immutable once constructed and its Evaluate() is safe to call from
+   * several threads at once. This holds for the ceres::AutoDiffCostFunction and ceres::NumericDiffCostFunction
+   * wrappers around a functor without mutable state. Constraints with stateful cost functions, e.g. ones that cache
+   * intermediate results between evaluations, should not be prepared.
+   *
+   * This must not be called concurrently with preparedCostFunction() on the same constraint.
+   *
+   * @throws std::logic_error if the cost function does not match the number of involved variables
+   */
+  void prepare();
+
+  /**
+   * @brief Returns true if prepare() has been called on this constraint, or the constraint it was copied from
+   */
+  bool prepared() const { return static_cast<bool>(prepared_cost_function_); }
+
+  /**
+   * @brief Return a cost function for inclusion in a ceres::Problem
+   *
+   * If the constraint has been prepared, this returns a lightweight wrapper that forwards to the prepared cost
+   * function. Otherwise, this is equivalent to costFunction(). In both cases Ceres takes ownership of the returned
+   * pointer.
+   *
+   * @return A base pointer to a ceres::CostFunction
+   */
+  ceres::CostFunction* preparedCostFunction() const;
+
   /**
    * @brief Create a new Ceres loss function and return a raw pointer to it.
    *
@@ -176,6 +252,23 @@ public:
 protected:
   UUID uuid_;  //!< The unique ID associated with this constraint
   std::vector<UUID> variables_;  //!< The ordered set of variables involved with this constraint
+
+  /**
+   * @brief Replace the UUID of this constraint with a content-addressed UUID
+   *
+   * Used by the content-addressed constructors of derived constraint types. The UUID is derived from the constraint
+   * type, the ordered list of variable UUIDs, and the measurement key, in the same way as the content-addressed
+   * Constraint constructor.
+   *
+   * @param[in] type            The constraint type, matching the string type() returns
+   * @param[in] measurement_key Everything that distinguishes this measurement from other measurements of the same type
+   *                            involving the same variables. See fuse_core::measurementKey().
+   */
+  void setContentAddressedUuid(const std::string& type, const std::string& measurement_key);
+
+private:
+  std::shared_ptr<const ceres::CostFunction> prepared_cost_function_;  //!< The cost function built by prepare(),
+                                                                       //!< shared by all copies of the constraint
 };
 
 /**
@@ -36,14 +36,18 @@
 
 #include <fuse_core/constraint.h>
 #include <fuse_core/macros.h>
+#include <fuse_core/spatial_index.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
+#include <fuse_core/variable_archive.h>
 
 #include <boost/range/any_range.hpp>
 #include <ceres/covariance.h>
+#include <ceres/crs_matrix.h>
 #include <ceres/solver.h>
 
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -69,6 +73,29 @@ using const_constraint_range = boost::any_range<const fuse_core::Constraint, boo
  */
 using const_variable_range = boost::any_range<const fuse_core::Variable, boost::forward_traversal_tag>;
 
+/**
+ * @brief A sparse matrix computed from the graph, along with the location of each variable within the matrix columns
+ *
+ * The matrix is stored in compressed row storage (CRS) format using the ceres::CRSMatrix structure. Each variable
+ * occupies a contiguous block of columns. The width of the block is the variable's local (tangent space) size, which
+ * is smaller than Variable::size() for variables with a local parameterization.
+ */
+struct SparseGraphMatrix
+{
+  /**
+   * @brief The range of matrix columns assigned to a single variable
+   */
+  struct ColumnBlock
+  {
+    int offset;  //!< The first matrix column used by the variable
+    int size;  //!< The number of matrix columns used by the variable
+  };
+
+  ceres::CRSMatrix matrix;  //!< The matrix values in compressed row storage format
+  std::vector<UUID> variable_uuids;  //!< The variables included in the matrix, in column order
+  std::unordered_map<UUID, ColumnBlock, uuid::hash> columns;  //!< The column block of each included variable
+};
+
 /**
  * @brief This is an interface definition describing the collection of constraints and variables that form the factor
  * graph, a graphical model of a nonlinear least-squares problem.
@@ -100,6 +127,20 @@ public:
    */
   virtual Graph::UniquePtr clone() const = 0;
 
+  /**
+   * @brief Return a graph object containing deep copies of only the requested variables
+   *
+   * The returned graph contains no constraints. Requested variables that do not exist in this graph are ignored, and
+   * the hold status and held dimensions of each copied variable are preserved. This is useful for sharing a small
+   * number of variable values without paying for a deep copy of the entire graph. The default implementation clones
+   * the entire graph and then removes everything that was not requested; derived classes are encouraged to provide a
+   * more efficient version.
+   *
+   * @param[in] variable_uuids The UUIDs of the variables to copy
+   * @return                   A new graph containing copies of the requested variables
+   */
+  virtual Graph::UniquePtr cloneVariables(const std::vector<UUID>& variable_uuids) const;
+
   /**
    * @brief Check if the constraint already exists in the graph
    *
@@ -188,6 +229,16 @@ public:
    */
   virtual const_variable_range getVariables() const = 0;
 
+  /**
+   * @brief Read-only access to the spatial index over the position variables in the graph
+   *
+   * The index is kept up to date as variables are added and removed, and after each call to optimize(). Sensor models
+   * can use it to find the variables near a location without iterating over every variable in the graph.
+   *
+   * @return The spatial index of the graph
+   */
+  virtual const SpatialIndex& spatialIndex() const = 0;
+
   /**
    * @brief Configure a variable to hold its current value constant during optimization
    *
@@ -200,6 +251,22 @@ public:
    */
   virtual void holdVariable(const UUID& variable_uuid, bool hold_constant = true) = 0;
 
+  /**
+   * @brief Configure individual dimensions of a variable to hold their current values constant during optimization
+   *
+   * The dimensions are indices into the variable's tangent space, i.e. the space of its local parameterization. For
+   * variables without a local parameterization, these are simply indices into the variable's data. This allows, for
+   * example, the z, roll, and pitch of a 3D pose to be held for a planar robot without adding stiff priors. The held
+   * dimensions replace any previously held dimensions of the variable; an empty list releases them all. Holding the
+   * entire variable with holdVariable() takes precedence.
+   *
+   * Throws std::out_of_range if the variable does not exist or a dimension is out of range.
+   *
+   * @param[in] variable_uuid   The variable to adjust
+   * @param[in] held_dimensions The tangent-space dimensions to hold constant
+   */
+  virtual void holdVariableDimensions(const UUID& variable_uuid, const std::vector<size_t>& held_dimensions) = 0;
+
   /**
    * @brief Marginalize out the provided variable from the graph
    *
@@ -249,12 +316,54 @@ public:
     std::vector<std::vector<double> >& covariance_matrices,
     const ceres::Covariance::Options& options = ceres::Covariance::Options()) const = 0;
 
+  /**
+   * @brief Evaluate the Jacobian of all constraint residuals with respect to the requested variables
+   *
+   * Each row of the Jacobian is a single residual, and each variable occupies a block of columns as described by the
+   * SparseGraphMatrix::columns mapping. When no variables are requested, all variables are included and the columns
+   * are ordered by variable UUID, so the column assignment does not depend on the graph's internal storage order.
+   * When a subset of variables is requested, the columns follow the order of the request, only the constraints
+   * connected to at least one requested variable are evaluated, and all other variables are treated as constants.
+   * Columns belonging to variables that are held constant will be zero.
+   *
+   * @param[in]  variable_uuids The variables to include in the Jacobian, in the desired column order. If empty,
+   *                            all variables are included.
+   * @param[out] jacobian       The evaluated Jacobian and the variable-to-column mapping
+   * @param[in]  num_threads    The number of threads to use while evaluating the constraints
+   */
+  virtual void getJacobian(
+    const std::vector<UUID>& variable_uuids,
+    SparseGraphMatrix& jacobian,
+    int num_threads = 1) const = 0;
+
+  /**
+   * @brief Compute the information matrix (J^T * J) of the graph with respect to the requested variables
+   *
+   * The Jacobian is computed using Graph::getJacobian(), and the information matrix shares the same column mapping.
+   * Both the rows and columns of the information matrix follow the SparseGraphMatrix::columns mapping. When a subset
+   * of variables is requested, the result is the information of those variables conditioned on the current values of
+   * all other variables, not the marginal information.
+   *
+   * @param[in]  variable_uuids The variables to include in the information matrix, in the desired order. If empty,
+   *                            all variables are included.
+   * @param[out] information    The information matrix and the variable-to-column mapping
+   * @param[in]  num_threads    The number of threads to use while evaluating the constraints
+   */
+  void getInformationMatrix(
+    const std::vector<UUID>& variable_uuids,
+    SparseGraphMatrix& information,
+    int num_threads = 1) const;
+
   /**
    * @brief Update the graph with the contents of a transaction
    *
+   * The default implementation adds the variables, adds the constraints, removes the constraints, and finally removes
+   * the variables using the individual add and remove functions. Derived classes may override this to apply the whole
+   * transaction more efficiently, but the final graph state must be the same.
+   *
    * @param[in]  transaction  A set of variable and constraints additions and deletions
    */
-  void update(const fuse_core::Transaction& transaction);
+  virtual void update(const fuse_core::Transaction& transaction);
 
   /**
    * @brief Optimize the values of the current set of variables, given the current set of constraints.
@@ -266,6 +375,24 @@ public:
    * @return              A Ceres Solver Summary structure containing information about the optimization process
    */
   virtual ceres::Solver::Summary optimize(const ceres::Solver::Options& options = ceres::Solver::Options()) = 0;
+
+  /**
+   * @brief Attach an archive of the variables that have been retired from this graph
+   *
+   * The archive is shared by pointer, not copied, with every copy of the graph. Copies of the graph remain cheap to
+   * create, and readers of any copy see the variables retired so far.
+   *
+   * @param[in] archive The archive of retired variables, or nullptr to detach the current archive
+   */
+  virtual void archive(VariableArchive::SharedPtr archive) = 0;
+
+  /**
+   * @brief Access the archive of variables that have been retired from this graph
+   *
+   * Variables in the archive no longer exist in the graph, but their final values may still be of interest to
+   * publishers (e.g. the full trajectory of a robot). This will be nullptr if no archive has been attached.
+   */
+  virtual VariableArchive::ConstSharedPtr archive() const = 0;
 };
 
 }  // namespace fuse_core
@@ -0,0 +1,120 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_MEASUREMENT_KEY_H
+#define FUSE_CORE_MEASUREMENT_KEY_H
+
+#include <Eigen/Core>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+namespace detail
+{
+  /**
+   * @brief Append the raw bytes of a single value to a measurement key
+   */
+  template <typename T>
+  void appendBytes(std::string& key, const T& value)
+  {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  /**
+   * @brief Append an arithmetic or enumeration value to a measurement key
+   */
+  template <typename T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, int>::type = 0>
+  void appendToKey(std::string& key, const T& value)
+  {
+    appendBytes(key, value);
+  }
+
+  /**
+   * @brief Append the size and values of a vector of arithmetic or enumeration values to a measurement key
+   */
+  template <typename T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, int>::type = 0>
+  void appendToKey(std::string& key, const std::vector<T>& values)
+  {
+    appendBytes(key, static_cast<uint64_t>(values.size()));
+    key.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  }
+
+  /**
+   * @brief Append the shape and coefficients of an Eigen matrix to a measurement key
+   *
+   * The coefficients are visited in row-major order, so the key does not depend on the storage order of the matrix.
+   */
+  template <typename Derived>
+  void appendToKey(std::string& key, const Eigen::MatrixBase<Derived>& matrix)
+  {
+    appendBytes(key, static_cast<uint64_t>(matrix.rows()));
+    appendBytes(key, static_cast<uint64_t>(matrix.cols()));
+    for (Eigen::Index row = 0; row < matrix.rows(); ++row)
+    {
+      for (Eigen::Index col = 0; col < matrix.cols(); ++col)
+      {
+        appendBytes(key, static_cast<double>(matrix(row, col)));
+      }
+    }
+  }
+}  // namespace detail
+
+/**
+ * @brief Build the measurement key used to derive a content-addressed constraint UUID
+ *
+ * The key is a byte string containing the shape and the values of each argument, in order. Supported arguments are
+ * Eigen matrices and vectors, std::vectors of arithmetic or enumeration values, and individual arithmetic or
+ * enumeration values. Two measurements with bitwise identical contents produce identical keys.
+ *
+ * @code{.cpp}
+ * fuse_core::Constraint(type, {position.uuid(), orientation.uuid()}, fuse_core::measurementKey(mean, covariance))
+ * @endcode
+ */
+template <typename... Args>
+std::string measurementKey(const Args&... args)
+{
+  std::string key;
+  int expand[] = {0, (detail::appendToKey(key, args), 0)...};  // NOLINT(whitespace/braces)
+  static_cast<void>(expand);
+  return key;
+}
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_MEASUREMENT_KEY_H
@@ -34,13 +34,18 @@
 #ifndef FUSE_CORE_MOTION_MODEL_H
 #define FUSE_CORE_MOTION_MODEL_H
 
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <ros/node_handle.h>
 #include <ros/time.h>
 
 #include <set>
 #include <string>
+#include <vector>
 
 
 namespace fuse_core
@@ -67,6 +72,11 @@ public:
    */
   virtual const std::string& name() const  = 0;
 
+  /**
+   * @brief Get the statistics of the callbacks scheduled by this motion model, or nullptr if they are not tracked
+   */
+  virtual CallbackStatistics::ConstSharedPtr callbackStatistics() const { return nullptr; }
+
   /**
    * @brief Perform any required post-construction initialization, such as subscribing to topics or reading from the
    * parameter server.
@@ -75,9 +85,30 @@ public:
    * encouraged to subnamespace any of their parameters to prevent conflicts and allow the same plugin to be used
    * multiple times with different settings and topics.
    *
+   * @param[in] name                       A unique name to give this plugin instance
+   * @param[in] parent_node_handle         The optimizer's public node handle. The plugin's topics should be
+   *                                       resolved with it, so that the optimizer's namespace and remappings apply.
+   * @param[in] parent_private_node_handle A node handle in the optimizer's private namespace. The plugin's private
+   *                                       namespace should be created beneath it. When the optimizer runs as a
+   *                                       nodelet, this is the nodelet's private namespace rather than the manager's.
+   */
+  virtual void initialize(
+    const std::string& name,
+    const ros::NodeHandle& parent_node_handle,
+    const ros::NodeHandle& parent_private_node_handle) = 0;
+
+  /**
+   * @brief Perform any required post-construction initialization, using the global and private namespaces of the
+   * ROS node as the parent namespaces
+   *
+   * This overload is provided for compatibility with code written before the parent node handles were added.
+   *
    * @param[in] name A unique name to give this plugin instance
    */
-  virtual void initialize(const std::string& name) = 0;
+  void initialize(const std::string& name)
+  {
+    initialize(name, ros::NodeHandle(), ros::NodeHandle("~"));
+  }
 
   /**
    * @brief Function to be executed whenever the optimizer has completed a Graph update
@@ -93,6 +124,30 @@ public:
    */
   virtual void graphCallback(Graph::ConstSharedPtr graph) {}
 
+  /**
+   * @brief The information this motion model requires after each optimization cycle
+   *
+   * The optimizer only constructs the information required by the loaded plugins. Override this to avoid an
+   * unnecessary deep copy of the Graph. If NotificationNeeds::TRANSACTION is requested, graphCallback() is
+   * called with an empty pointer, signalling only that an optimization cycle has completed. This method is called by
+   * the optimizer, in the optimizer's thread, before every notification.
+   *
+   * @return The notification needs of this motion model. The default is NotificationNeeds::GRAPH.
+   */
+  virtual NotificationNeeds notificationNeeds() const { return NotificationNeeds::GRAPH; }
+
+  /**
+   * @brief The variables this motion model requires when notificationNeeds() returns NotificationNeeds::VARIABLES
+   *
+   * The provided Graph will contain copies of at least these variables. It may not contain any constraints. Requested
+   * variables that do not exist in the optimized Graph are ignored. This method is called by the optimizer, in the
+   * optimizer's thread.
+   *
+   * @param[in] transaction The transaction that was just applied to the Graph
+   * @return                The UUIDs of the required variables
+   */
+  virtual std::vector<UUID> notificationVariables(const Transaction& transaction) const { return {}; }
+
   /**
    * @brief Augment a transaction structure such that the provided timestamps are connected by motion model constraints.
    *
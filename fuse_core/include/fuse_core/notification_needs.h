@@ -0,0 +1,61 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_NOTIFICATION_NEEDS_H
+#define FUSE_CORE_NOTIFICATION_NEEDS_H
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief The information a plugin requires from the optimizer after each optimization cycle
+ *
+ * Sensor models, motion models, and publishers declare their needs through their notificationNeeds() method. The
+ * optimizer inspects the needs of all loaded plugins and only constructs the information that is actually required.
+ * In particular, the deep copy of the Graph is skipped entirely when no plugin asks for it. The values are ordered by
+ * increasing cost.
+ */
+enum class NotificationNeeds
+{
+  NONE,         //!< The plugin is not notified at all
+  TRANSACTION,  //!< Only the transaction is required. The provided Graph pointer will be empty.
+  VARIABLES,    //!< A Graph containing the variables returned by notificationVariables() is required. The Graph may
+                //!< contain additional variables requested by other plugins, or may be the full Graph if another
+                //!< plugin requested it.
+  GRAPH         //!< A complete copy of the optimized Graph is required. This is the default.
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_NOTIFICATION_NEEDS_H
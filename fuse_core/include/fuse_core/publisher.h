@@ -34,10 +34,15 @@
 #ifndef FUSE_CORE_PUBLISHER_H
 #define FUSE_CORE_PUBLISHER_H
 
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
+#include <ros/callback_queue.h>
+#include <ros/node_handle.h>
 
 #include <string>
 #include <vector>
@@ -78,6 +83,24 @@ public:
    */
   virtual const std::string& name() const = 0;
 
+  /**
+   * @brief Get the statistics of the callbacks scheduled by this publisher, or nullptr if they are not tracked
+   */
+  virtual CallbackStatistics::ConstSharedPtr callbackStatistics() const { return nullptr; }
+
+  /**
+   * @brief Service this publisher's callbacks from a callback queue provided by the optimizer
+   *
+   * By default, each plugin services its own callbacks, e.g. with a local spinner. An optimizer that runs many plugins
+   * on a shared pool of threads calls this before initialize() to provide a queue that it services itself. The
+   * callbacks in such a queue are executed sequentially. This method is called by the optimizer, in the optimizer's
+   * thread.
+   *
+   * @param[in] callback_queue The queue for all of this publisher's callbacks. It outlives the plugin.
+   * @return                   True if the provided queue is used, false if the plugin services its own callbacks
+   */
+  virtual bool useCallbackQueue(ros::CallbackQueue* callback_queue) { return false; }
+
   /**
    * @brief Perform any required post-construction initialization, such as advertising publishers or reading from the
    * parameter server.
@@ -86,9 +109,30 @@ public:
    * encouraged to subnamespace any of their parameters to prevent conflicts and allow the same plugin to be used
    * multiple times with different settings and topics.
    *
+   * @param[in] name                       A unique name to give this plugin instance
+   * @param[in] parent_node_handle         The optimizer's public node handle. The plugin's topics should be
+   *                                       resolved with it, so that the optimizer's namespace and remappings apply.
+   * @param[in] parent_private_node_handle A node handle in the optimizer's private namespace. The plugin's private
+   *                                       namespace should be created beneath it. When the optimizer runs as a
+   *                                       nodelet, this is the nodelet's private namespace rather than the manager's.
+   */
+  virtual void initialize(
+    const std::string& name,
+    const ros::NodeHandle& parent_node_handle,
+    const ros::NodeHandle& parent_private_node_handle) = 0;
+
+  /**
+   * @brief Perform any required post-construction initialization, using the global and private namespaces of the
+   * ROS node as the parent namespaces
+   *
+   * This overload is provided for compatibility with code written before the parent node handles were added.
+   *
    * @param[in] name A unique name to give this plugin instance
    */
-  virtual void initialize(const std::string& name) = 0;
+  void initialize(const std::string& name)
+  {
+    initialize(name, ros::NodeHandle(), ros::NodeHandle("~"));
+  }
 
   /**
    * @brief Notify the publisher that an optimization cycle is complete, and about changes to the Graph.
@@ -103,6 +147,29 @@ public:
    * @param[in] graph       A read-only pointer to the graph object, allowing queries to be performed whenever needed
    */
   virtual void notify(Transaction::ConstSharedPtr transaction, Graph::ConstSharedPtr graph) = 0;
+
+  /**
+   * @brief The information this publisher requires after each optimization cycle
+   *
+   * The optimizer only constructs the information required by the loaded plugins. Override this to avoid an
+   * unnecessary deep copy of the Graph. If NotificationNeeds::TRANSACTION is requested, notify() is called with an
+   * empty Graph pointer. This method is called by the optimizer, in the optimizer's thread, before every notification.
+   *
+   * @return The notification needs of this publisher. The default is NotificationNeeds::GRAPH.
+   */
+  virtual NotificationNeeds notificationNeeds() const { return NotificationNeeds::GRAPH; }
+
+  /**
+   * @brief The variables this publisher requires when notificationNeeds() returns NotificationNeeds::VARIABLES
+   *
+   * The provided Graph will contain copies of at least these variables. It may not contain any constraints. Requested
+   * variables that do not exist in the optimized Graph are ignored. This method is called by the optimizer, in the
+   * optimizer's thread.
+   *
+   * @param[in] transaction The transaction that was just applied to the Graph
+   * @return                The UUIDs of the required variables
+   */
+  virtual std::vector<UUID> notificationVariables(const Transaction& transaction) const { return {}; }
 };
 
 }  // namespace fuse_core
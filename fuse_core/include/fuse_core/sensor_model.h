@@ -34,15 +34,20 @@
 #ifndef FUSE_CORE_SENSOR_MODEL_H
 #define FUSE_CORE_SENSOR_MODEL_H
 
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
 #include <ros/callback_queue.h>
+#include <ros/node_handle.h>
 #include <ros/time.h>
 
 #include <functional>
 #include <set>
 #include <string>
+#include <vector>
 
 
 namespace fuse_core
@@ -92,7 +97,56 @@ public:
    */
   virtual void graphCallback(Graph::ConstSharedPtr graph) {}
 
+  /**
+   * @brief Function to be executed whenever the optimizer reports its current load
+   *
+   * The load is a measure of how far the optimizer is falling behind. A value of 1.0 means the optimizer is exactly
+   * keeping up; larger values mean transactions are arriving faster than they can be optimized, and latency is
+   * building. Sensor models may use this as a backpressure signal to reduce the rate at which they produce
+   * transactions. This method is called by the optimizer, in the optimizer's thread, and should return quickly.
+   *
+   * @param[in] load The current optimizer load
+   */
+  virtual void backpressureCallback(double load) {}
+
+  /**
+   * @brief The information this sensor model requires after each optimization cycle
+   *
+   * The optimizer only constructs the information required by the loaded plugins. Override this to avoid an
+   * unnecessary deep copy of the Graph. If NotificationNeeds::TRANSACTION is requested, graphCallback() is
+   * called with an empty pointer, signalling only that an optimization cycle has completed. This method is called by
+   * the optimizer, in the optimizer's thread, before every notification.
+   *
+   * @return The notification needs of this sensor model. The default is NotificationNeeds::GRAPH.
+   */
+  virtual NotificationNeeds notificationNeeds() const { return NotificationNeeds::GRAPH; }
+
+  /**
+   * @brief The variables this sensor model requires when notificationNeeds() returns NotificationNeeds::VARIABLES
+   *
+   * The provided Graph will contain copies of at least these variables. It may not contain any constraints. Requested
+   * variables that do not exist in the optimized Graph are ignored. This method is called by the optimizer, in the
+   * optimizer's thread.
+   *
+   * @param[in] transaction The transaction that was just applied to the Graph
+   * @return                The UUIDs of the required variables
+   */
+  virtual std::vector<UUID> notificationVariables(const Transaction& transaction) const { return {}; }
+
    /**
+   * @brief Service this sensor model's callbacks from a callback queue provided by the optimizer
+   *
+   * By default, each plugin services its own callbacks, e.g. with a local spinner. An optimizer that runs many plugins
+   * on a shared pool of threads calls this before initialize() to provide a queue that it services itself. The
+   * callbacks in such a queue are executed sequentially. This method is called by the optimizer, in the optimizer's
+   * thread.
+   *
+   * @param[in] callback_queue The queue for all of this sensor model's callbacks. It outlives the plugin.
+   * @return                   True if the provided queue is used, false if the plugin services its own callbacks
+   */
+  virtual bool useCallbackQueue(ros::CallbackQueue* callback_queue) { return false; }
+
+  /**
    * @brief Perform any required post-construction initialization, such as subscribing to topics or reading from the
    * parameter server.
    *
@@ -105,11 +159,36 @@ public:
    * @param[in] transaction_callback_queue The callback queue the callback function should be inserted into. This
    *                                       will likely belong to the parent of the plugin, as no attempt to spin this
    *                                       queue is performed.
+   * @param[in] parent_node_handle         The optimizer's public node handle. The plugin's topics should be
+   *                                       resolved with it, so that the optimizer's namespace and remappings apply.
+   * @param[in] parent_private_node_handle A node handle in the optimizer's private namespace. The plugin's private
+   *                                       namespace should be created beneath it. When the optimizer runs as a
+   *                                       nodelet, this is the nodelet's private namespace rather than the manager's.
    */
   virtual void initialize(
     const std::string& name,
     TransactionCallback transaction_callback,
-    ros::CallbackQueue* transaction_callback_queue) = 0;
+    ros::CallbackQueue* transaction_callback_queue,
+    const ros::NodeHandle& parent_node_handle,
+    const ros::NodeHandle& parent_private_node_handle) = 0;
+
+  /**
+   * @brief Perform any required post-construction initialization, using the global and private namespaces of the
+   * ROS node as the parent namespaces
+   *
+   * This overload is provided for compatibility with code written before the parent node handles were added.
+   *
+   * @param[in] name                       A unique name to give this plugin instance
+   * @param[in] transaction_callback       The function to call every time a transaction is published
+   * @param[in] transaction_callback_queue The callback queue the callback function should be inserted into
+   */
+  void initialize(
+    const std::string& name,
+    TransactionCallback transaction_callback,
+    ros::CallbackQueue* transaction_callback_queue)
+  {
+    initialize(name, transaction_callback, transaction_callback_queue, ros::NodeHandle(), ros::NodeHandle("~"));
+  }
 
  /**
    * @brief Inject a transaction callback function into a callback queue
@@ -139,6 +218,11 @@ public:
    */
   virtual const std::string& name() const = 0;
 
+  /**
+   * @brief Get the statistics of the callbacks scheduled by this sensor model, or nullptr if they are not tracked
+   */
+  virtual CallbackStatistics::ConstSharedPtr callbackStatistics() const { return nullptr; }
+
 protected:
   /**
    * @brief Default Constructor
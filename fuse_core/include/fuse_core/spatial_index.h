@@ -0,0 +1,233 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_SPATIAL_INDEX_H
+#define FUSE_CORE_SPATIAL_INDEX_H
+
+#include <fuse_core/macros.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief A uniform grid over the position variables of a graph, supporting fast proximity queries
+ *
+ * Loop-closure candidate search and map association need to find every position variable near a query point. The
+ * spatial index hashes each indexed variable into a cell of a uniform grid, so a radius query only visits the cells
+ * overlapping the query sphere instead of every variable in the graph. Variables are inserted and removed
+ * individually, allowing the index to be maintained incrementally from transaction deltas. Because the indexed
+ * positions change whenever the graph is optimized, refresh() must be called after each solve to move variables into
+ * their new cells.
+ *
+ * Only variables with a registered type are indexed. The owner of the index, typically the graph, supplies the types;
+ * by default nothing is indexed. The first two (or three) elements of the variable data are used as the (x, y[, z])
+ * position. Variables with fewer than three elements are indexed at z = 0.
+ *
+ * This class is not thread-safe. It is designed to be owned by a Graph, and follows the same synchronization rules.
+ */
+class SpatialIndex
+{
+public:
+  SMART_PTR_DEFINITIONS(SpatialIndex);
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] cell_size      The edge length of each grid cell, in meters. The best performance is usually achieved
+   *                           when this is similar to the typical query radius.
+   * @param[in] variable_types The Variable::type() strings of the variables to index
+   */
+  explicit SpatialIndex(
+    double cell_size = 1.0,
+    const std::vector<std::string>& variable_types = std::vector<std::string>());
+
+  /**
+   * @brief The edge length of each grid cell, in meters
+   */
+  double cellSize() const { return cell_size_; }
+
+  /**
+   * @brief The Variable::type() strings of the indexed variables
+   */
+  std::vector<std::string> variableTypes() const;
+
+  /**
+   * @brief The number of indexed variables
+   */
+  size_t size() const { return entries_.size(); }
+
+  /**
+   * @brief Check if the variable is part of the index
+   */
+  bool contains(const UUID& variable_uuid) const { return entries_.find(variable_uuid) != entries_.end(); }
+
+  /**
+   * @brief Add a variable to the index
+   *
+   * The index shares ownership of the variable, and reads its current position whenever refresh() is called.
+   *
+   * @param[in] variable The variable to add
+   * @return             True if the variable was added, false if it is not an indexed type or is already indexed
+   */
+  bool insert(Variable::ConstSharedPtr variable);
+
+  /**
+   * @brief Remove a variable from the index
+   *
+   * @param[in] variable_uuid The UUID of the variable to remove
+   * @return                  True if the variable was removed, false if it was not indexed
+   */
+  bool remove(const UUID& variable_uuid);
+
+  /**
+   * @brief Remove all variables from the index
+   */
+  void clear();
+
+  /**
+   * @brief Re-read the position of every indexed variable, moving it to a new cell if needed
+   *
+   * Complexity: O(N), where N is the number of indexed variables
+   */
+  void refresh();
+
+  /**
+   * @brief Re-read the position of a single variable, moving it to a new cell if needed
+   *
+   * Variables that are not indexed are ignored.
+   *
+   * @param[in] variable_uuid The UUID of the variable to refresh
+   */
+  void refresh(const UUID& variable_uuid);
+
+  /**
+   * @brief Find all indexed variables within \p radius meters of the (x, y) position
+   *
+   * The z coordinate of three-dimensional positions is ignored, i.e. this finds the variables inside a vertical
+   * cylinder of the given radius around the query point.
+   *
+   * Complexity: O(C + K), where C is the number of grid cells overlapping the query circle in each non-empty z layer
+   *             and K is the number of variables in those cells
+   *
+   * @param[in] x      The x coordinate of the query point
+   * @param[in] y      The y coordinate of the query point
+   * @param[in] radius The search radius, in meters
+   * @return           The UUIDs of the variables within the radius, in no particular order
+   */
+  std::vector<UUID> query(double x, double y, double radius) const;
+
+  /**
+   * @brief Find all indexed variables within \p radius meters of the (x, y, z) position
+   *
+   * Complexity: O(C + K), where C is the number of grid cells overlapping the query sphere and K is the number of
+   *             variables in those cells
+   *
+   * @param[in] x      The x coordinate of the query point
+   * @param[in] y      The y coordinate of the query point
+   * @param[in] z      The z coordinate of the query point
+   * @param[in] radius The search radius, in meters
+   * @return           The UUIDs of the variables within the radius, in no particular order
+   */
+  std::vector<UUID> query(double x, double y, double z, double radius) const;
+
+private:
+  using Cell = std::array<int64_t, 3>;
+  using Position = std::array<double, 3>;
+
+  /**
+   * @brief Hash function for the grid cell coordinates
+   */
+  struct CellHash
+  {
+    size_t operator()(const Cell& cell) const;
+  };
+
+  /**
+   * @brief The indexed information about a single variable
+   */
+  struct Entry
+  {
+    Variable::ConstSharedPtr variable;  //!< The indexed variable
+    Position position;  //!< The position of the variable when it was last read
+    Cell cell;  //!< The grid cell containing the position
+  };
+
+  using Cells = std::unordered_map<Cell, std::vector<UUID>, CellHash>;
+  using Entries = std::unordered_map<UUID, Entry, uuid::hash>;
+
+  double cell_size_;  //!< The edge length of each grid cell
+  Cells cells_;  //!< The UUIDs of the variables in each non-empty grid cell
+  Entries entries_;  //!< The indexed variables
+  std::map<int64_t, size_t> layers_;  //!< The number of non-empty grid cells in each z layer
+  std::unordered_set<std::string> variable_types_;  //!< The Variable::type() strings of the indexed variables
+
+  /**
+   * @brief Compute the grid cell containing the position
+   */
+  Cell toCell(const Position& position) const;
+
+  /**
+   * @brief Read the position from the variable data
+   */
+  static Position toPosition(const Variable& variable);
+
+  /**
+   * @brief Add the UUID to the list of variables in the grid cell
+   */
+  void addToCell(const Cell& cell, const UUID& variable_uuid);
+
+  /**
+   * @brief Remove the UUID from the list of variables in the grid cell
+   */
+  void eraseFromCell(const Cell& cell, const UUID& variable_uuid);
+
+  /**
+   * @brief Re-read the position of the entry, moving it to a new cell if needed
+   */
+  void refresh(const UUID& variable_uuid, Entry& entry);
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_SPATIAL_INDEX_H
@@ -0,0 +1,111 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_SUBSET_LOCAL_PARAMETERIZATION_H
+#define FUSE_CORE_SUBSET_LOCAL_PARAMETERIZATION_H
+
+#include <ceres/local_parameterization.h>
+
+#include <memory>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief A local parameterization that holds a subset of the tangent-space dimensions of another local
+ * parameterization constant
+ *
+ * Ceres provides the SubsetParameterization to hold individual components of a Euclidean parameter block constant.
+ * This class provides the same capability for variables that already define their own local parameterization, such
+ * as a 3D orientation. The held dimensions are indices into the tangent space of the wrapped parameterization, and
+ * the optimizer only updates the remaining tangent-space dimensions. Unlike a stiff prior, this adds no residuals and
+ * shrinks the problem instead of degrading its conditioning.
+ *
+ * Plus() and ComputeJacobian() are called from the solver's inner loop, possibly from several threads at once. They
+ * use fixed-capacity stack buffers instead of allocating, which limits the size of the wrapped parameterization to
+ * MAX_GLOBAL_SIZE and MAX_LOCAL_SIZE.
+ */
+class SubsetLocalParameterization : public ceres::LocalParameterization
+{
+public:
+  static constexpr size_t MAX_GLOBAL_SIZE = 16;  //!< The largest supported GlobalSize() of the wrapped parameterization
+  static constexpr size_t MAX_LOCAL_SIZE = 16;  //!< The largest supported LocalSize() of the wrapped parameterization
+
+  /**
+   * @brief Constructor
+   *
+   * Throws std::invalid_argument if the \p parameterization is null or larger than MAX_GLOBAL_SIZE x MAX_LOCAL_SIZE,
+   * if all of the tangent-space dimensions are held, or if any of the \p held_dimensions is out of range.
+   *
+   * @param[in] parameterization The parameterization to wrap. This object takes ownership of the pointer.
+   * @param[in] held_dimensions  The tangent-space dimensions of \p parameterization to hold constant
+   */
+  SubsetLocalParameterization(
+    ceres::LocalParameterization* parameterization,
+    const std::vector<size_t>& held_dimensions);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~SubsetLocalParameterization() = default;
+
+  /**
+   * @brief Apply the reduced tangent-space \p delta to \p x. The held dimensions receive a zero update.
+   */
+  bool Plus(const double* x, const double* delta, double* x_plus_delta) const override;
+
+  /**
+   * @brief Compute the GlobalSize() x LocalSize() row-major Jacobian of Plus() with respect to \p delta at zero
+   */
+  bool ComputeJacobian(const double* x, double* jacobian) const override;
+
+  /**
+   * @brief The size of the parameter block
+   */
+  int GlobalSize() const override { return parameterization_->GlobalSize(); }
+
+  /**
+   * @brief The number of tangent-space dimensions that are allowed to change
+   */
+  int LocalSize() const override { return static_cast<int>(free_dimensions_.size()); }
+
+protected:
+  std::vector<size_t> free_dimensions_;  //!< The tangent-space dimensions of the wrapped parameterization that change
+  std::unique_ptr<ceres::LocalParameterization> parameterization_;  //!< The wrapped parameterization
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_SUBSET_LOCAL_PARAMETERIZATION_H
@@ -130,7 +130,7 @@ public:
    * @brief Add a constraint to this transaction
    *
    * The transaction will shared ownership of the provided constraint. This function also performs several checks
-   * to ensure the same constraint is not added twice, or added and removed.
+   * to ensure the same constraint is not added twice, or added and removed. An empty pointer is ignored.
    *
    * @param[in] constraint The constraint to be added
    * @param[in] overwrite  Flag indicating the provided constraint should overwrite an existing constraint with
@@ -153,7 +153,7 @@ public:
    * @brief Add a variable to this transaction
    *
    * The transaction will shared ownership of the provided variable. This function also performs several checks
-   * to ensure the same variable is not added twice, or added and removed.
+   * to ensure the same variable is not added twice, or added and removed. An empty pointer is ignored.
    *
    * @param[in] variable  The variable to be added
    * @param[in] overwrite Flag indicating the provided variable should overwrite an existing variable with the
@@ -181,6 +181,16 @@ public:
    */
   void merge(const Transaction& other, bool overwrite = false);
 
+  /**
+   * @brief Prepare the cost functions of all added constraints
+   *
+   * Sensor and motion models call this from their own threads before the transaction is sent to the optimizer, so the
+   * optimizer only has to link the prepared cost functions into its problem. See Constraint::prepare().
+   *
+   * @throws std::logic_error if any added constraint has an invalid cost function
+   */
+  void prepare();
+
   /**
    * @brief Print a human-readable description of the transaction to the provided stream.
    *
@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_VARIABLE_ARCHIVE_H
+#define FUSE_CORE_VARIABLE_ARCHIVE_H
+
+#include <fuse_core/macros.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <ros/time.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief An append-only store of the final values of variables that have been retired from the graph
+ *
+ * Once a variable is marginalized or pruned from the graph, its value is gone, yet publishers and other consumers
+ * often still want the full history (e.g. the complete trajectory of a robot). Keeping those variables in the graph
+ * makes every optimization and every graph copy more expensive. Instead, the optimizer writes the last known value of
+ * each retired variable into an archive, and consumers read from the archive in addition to the live graph.
+ *
+ * The archive is stored by column: the stamps, device ids, types, and variable values are each held in their own
+ * contiguous vector, and the values and optional covariances of all entries are packed into a single array. This
+ * keeps the per-entry overhead to a few dozen bytes and makes filtered queries a linear scan over small columns.
+ *
+ * The archive is shared by pointer between a graph and all of its copies, so appending and querying are guarded by
+ * an internal mutex.
+ */
+class VariableArchive
+{
+public:
+  SMART_PTR_DEFINITIONS(VariableArchive);
+
+  /**
+   * @brief A copy of a single archived variable
+   */
+  struct Entry
+  {
+    UUID uuid;  //!< The UUID of the archived variable
+    std::string type;  //!< The type string of the archived variable
+    ros::Time stamp;  //!< The timestamp associated with the variable
+    UUID device_id;  //!< The device associated with the variable
+    std::vector<double> data;  //!< The final value of the variable
+    std::vector<double> covariance;  //!< The row-major marginal covariance of the variable, or empty if not archived
+  };
+
+  /**
+   * @brief Constructor
+   */
+  VariableArchive();
+
+  /**
+   * @brief Append the current value of a variable to the archive
+   *
+   * @param[in] variable   The variable to archive
+   * @param[in] stamp      The timestamp associated with the variable
+   * @param[in] device_id  The device associated with the variable
+   * @param[in] covariance The row-major marginal covariance of the variable. This must be empty or contain exactly
+   *                       variable.size() * variable.size() elements. Throws std::invalid_argument otherwise.
+   */
+  void append(
+    const Variable& variable,
+    const ros::Time& stamp,
+    const UUID& device_id,
+    const std::vector<double>& covariance = std::vector<double>());
+
+  /**
+   * @brief Returns the number of archived variables
+   */
+  size_t size() const;
+
+  /**
+   * @brief Returns true if no variables have been archived
+   */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * @brief Retrieve all archived variables of a specific type and device within a time range
+   *
+   * The entries are returned in the order they were archived.
+   *
+   * @param[in] type      The requested variable type string, as returned by Variable::type()
+   * @param[in] device_id The requested device
+   * @param[in] begin     The earliest requested stamp (inclusive)
+   * @param[in] end       The latest requested stamp (inclusive)
+   * @return              Copies of all matching archive entries
+   */
+  std::vector<Entry> query(
+    const std::string& type,
+    const UUID& device_id,
+    const ros::Time& begin = ros::Time(0, 0),
+    const ros::Time& end = ros::TIME_MAX) const;
+
+  /**
+   * @brief Retrieve the archived variables of a specific type and device within a range of archive positions
+   *
+   * Entries are numbered in the order they were archived, starting at zero. A consumer can read only the entries
+   * appended since its previous query by passing the size() recorded at that time as the first position.
+   *
+   * @param[in] type      The requested variable type string, as returned by Variable::type()
+   * @param[in] device_id The requested device
+   * @param[in] first     The position of the first requested entry (inclusive)
+   * @param[in] last      The position after the last requested entry (exclusive). Positions beyond size() are ignored.
+   * @return              Copies of all matching archive entries, in the order they were archived
+   */
+  std::vector<Entry> query(
+    const std::string& type,
+    const UUID& device_id,
+    size_t first,
+    size_t last) const;
+
+private:
+  std::vector<size_t> covariance_offsets_;  //!< The start of each entry in covariances_, plus a final end offset
+  std::vector<double> covariances_;  //!< The packed covariance values of all entries
+  std::vector<size_t> data_offsets_;  //!< The start of each entry in data_, plus a final end offset
+  std::vector<double> data_;  //!< The packed variable values of all entries
+  std::vector<UUID> device_ids_;  //!< The device of each entry
+  mutable std::mutex mutex_;  //!< Synchronizes access to all columns
+  std::vector<ros::Time> stamps_;  //!< The stamp of each entry
+  std::vector<uint16_t> type_indices_;  //!< The index into type_names_ of each entry
+  std::vector<std::string> type_names_;  //!< The distinct variable types that have been archived
+  std::vector<UUID> uuids_;  //!< The UUID of each entry
+
+  /**
+   * @brief Retrieve the matching entries within both a time range and a range of archive positions
+   */
+  std::vector<Entry> collect(
+    const std::string& type,
+    const UUID& device_id,
+    const ros::Time& begin,
+    const ros::Time& end,
+    size_t first,
+    size_t last) const;
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_VARIABLE_ARCHIVE_H
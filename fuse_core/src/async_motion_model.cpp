@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/async_motion_model.h>
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/callback_wrapper.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/transaction.h>
@@ -40,8 +41,10 @@
 
 #include <boost/make_shared.hpp>
 
+#include <exception>
 #include <functional>
 #include <set>
+#include <stdexcept>
 #include <string>
 
 
@@ -49,6 +52,7 @@ namespace fuse_core
 {
 
 AsyncMotionModel::AsyncMotionModel(size_t thread_count) :
+  callback_statistics_(CallbackStatistics::make_shared()),
   name_("uninitialized"),
   spinner_(thread_count, &callback_queue_)
 {
@@ -62,26 +66,54 @@ bool AsyncMotionModel::apply(const std::set<ros::Time>& stamps, Transaction& tra
   // Thus, it is functionally similar to a service callback, and should be a familiar pattern for ROS developers.
   // This function blocks until the queryCallback() call completes, thus enforcing that motion models are generated
   // in order.
+  // The cost functions of the generated constraints are prepared in the motion model's thread as well. Any error is
+  // reported to the caller from this thread, as it would be had the constraints been prepared here.
+  std::exception_ptr prepare_error;
   auto callback = boost::make_shared<CallbackWrapper<bool> >(
-    std::bind(&AsyncMotionModel::applyCallback, this, std::ref(stamps), std::ref(transaction)));
+    [this, &stamps, &transaction, &prepare_error]()  // NOLINT(whitespace/braces)
+    {
+      if (!applyCallback(stamps, transaction))
+      {
+        return false;
+      }
+      try
+      {
+        transaction.prepare();
+      }
+      catch (const std::logic_error&)
+      {
+        prepare_error = std::current_exception();
+      }
+      return true;
+    });
   auto result = callback->getFuture();
-  callback_queue_.addCallback(callback);
+  callback_statistics_->addCallback("apply", callback, callback_queue_);
   result.wait();
+  if (prepare_error)
+  {
+    std::rethrow_exception(prepare_error);
+  }
   return result.get();
 }
 
 void AsyncMotionModel::graphCallback(Graph::ConstSharedPtr graph)
 {
-  callback_queue_.addCallback(boost::make_shared<CallbackWrapper<void>>(
-    std::bind(&AsyncMotionModel::onGraphUpdate, this, std::move(graph))));
+  callback_statistics_->addCallback(
+    "graphCallback",
+    boost::make_shared<CallbackWrapper<void>>(std::bind(&AsyncMotionModel::onGraphUpdate, this, std::move(graph))),
+    callback_queue_);
 }
 
-void AsyncMotionModel::initialize(const std::string& name)
+void AsyncMotionModel::initialize(
+  const std::string& name,
+  const ros::NodeHandle& parent_node_handle,
+  const ros::NodeHandle& parent_private_node_handle)
 {
   // Initialize internal state
   name_ = name;
+  node_handle_ = parent_node_handle;
   node_handle_.setCallbackQueue(&callback_queue_);
-  private_node_handle_ = ros::NodeHandle(ros::NodeHandle("~"), name_);
+  private_node_handle_ = ros::NodeHandle(parent_private_node_handle, name_);
   private_node_handle_.setCallbackQueue(&callback_queue_);
 
   // Call the derived onInit() function to perform implementation-specific initialization
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/async_publisher.h>
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/callback_wrapper.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/transaction.h>
@@ -47,24 +48,39 @@ namespace fuse_core
 {
 
 AsyncPublisher::AsyncPublisher(size_t thread_count) :
+  callback_statistics_(CallbackStatistics::make_shared()),
+  external_callback_queue_(nullptr),
   name_("uninitialized"),
   spinner_(thread_count, &callback_queue_)
 {
 }
 
-void AsyncPublisher::initialize(const std::string& name)
+void AsyncPublisher::initialize(
+  const std::string& name,
+  const ros::NodeHandle& parent_node_handle,
+  const ros::NodeHandle& parent_private_node_handle)
 {
   // Initialize internal state
   name_ = name;
-  node_handle_.setCallbackQueue(&callback_queue_);
-  private_node_handle_ = ros::NodeHandle(ros::NodeHandle("~"), name_);
-  private_node_handle_.setCallbackQueue(&callback_queue_);
+  node_handle_ = parent_node_handle;
+  node_handle_.setCallbackQueue(&callbackQueue());
+  private_node_handle_ = ros::NodeHandle(parent_private_node_handle, name_);
+  private_node_handle_.setCallbackQueue(&callbackQueue());
 
   // Call the derived onInit() function to perform implementation-specific initialization
   onInit();
 
-  // Start the async spinner to service the local callback queue
-  spinner_.start();
+  // Start the async spinner to service the local callback queue, unless the optimizer services the callbacks
+  if (!external_callback_queue_)
+  {
+    spinner_.start();
+  }
+}
+
+bool AsyncPublisher::useCallbackQueue(ros::CallbackQueue* callback_queue)
+{
+  external_callback_queue_ = callback_queue;
+  return (external_callback_queue_ != nullptr);
 }
 
 void AsyncPublisher::notify(Transaction::ConstSharedPtr transaction, Graph::ConstSharedPtr graph)
@@ -73,7 +89,7 @@ void AsyncPublisher::notify(Transaction::ConstSharedPtr transaction, Graph::Cons
   // This minimizes the time spent by the optimizer's thread calling this function.
   auto callback = boost::make_shared<fuse_core::CallbackWrapper<void>>(
     std::bind(&AsyncPublisher::notifyCallback, this, std::move(transaction), std::move(graph)));
-  callback_queue_.addCallback(callback);
+  callback_statistics_->addCallback("notify", callback, callbackQueue());
 }
 
 }  // namespace fuse_core
@@ -32,24 +32,84 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/async_sensor_model.h>
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/callback_wrapper.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/transaction.h>
 #include <ros/callback_queue.h>
+#include <ros/node_handle.h>
 #include <ros/time.h>
 
 #include <boost/make_shared.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 
 namespace fuse_core
 {
 
+namespace
+{
+
+/**
+ * @brief A callback that reports itself invalid when the wrapped function did not run
+ *
+ * The callback statistics do not count invalid callbacks as executions, so transactions cancelled by the
+ * "drop_oldest" shedding policy do not distort the injectCallback statistics.
+ */
+class CancellableCallback : public ros::CallbackInterface
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] callback The function to be called from the callback queue. Returns false if it was cancelled.
+   */
+  explicit CancellableCallback(std::function<bool()> callback) :
+    callback_(std::move(callback))
+  {
+  }
+
+  CallResult call() override
+  {
+    return callback_() ? Success : Invalid;
+  }
+
+private:
+  std::function<bool()> callback_;  //!< The function to execute
+};
+
+/**
+ * @brief Check if a transaction may be shed, i.e. decimated, merged, or dropped while the optimizer is overloaded
+ *
+ * Later transactions and other plugins may depend on the variables added by a transaction, so those transactions are
+ * always sent, and in order. Only transactions that add nothing but constraints are shed.
+ */
+bool isSheddable(const fuse_core::Transaction& transaction)
+{
+  return transaction.addedVariables().empty();
+}
+
+}  // namespace
+
 AsyncSensorModel::AsyncSensorModel(size_t thread_count) :
+  callback_statistics_(CallbackStatistics::make_shared()),
+  external_callback_queue_(nullptr),
+  in_flight_(std::make_shared<InFlight>()),
+  load_(0.0),
+  max_in_flight_(1),
   name_("uninitialized"),
+  priority_(0.0),
+  shed_count_(0),
+  shedding_policy_(SheddingPolicy::NONE),
   spinner_(thread_count, &callback_queue_),
   transaction_callback_queue_(nullptr)
 {
@@ -57,35 +117,199 @@ AsyncSensorModel::AsyncSensorModel(size_t thread_count) :
 
 void AsyncSensorModel::graphCallback(Graph::ConstSharedPtr graph)
 {
-  callback_queue_.addCallback(boost::make_shared<CallbackWrapper<void>>(
-    std::bind(&AsyncSensorModel::onGraphUpdate, this, std::move(graph))));
+  callback_statistics_->addCallback(
+    "graphCallback",
+    boost::make_shared<CallbackWrapper<void>>(std::bind(&AsyncSensorModel::onGraphUpdate, this, std::move(graph))),
+    callbackQueue());
+}
+
+void AsyncSensorModel::backpressureCallback(double load)
+{
+  load_ = load;
+  // Send any merged transactions as soon as the optimizer catches up
+  std::lock_guard<std::mutex> lock(shedding_mutex_);
+  if (merged_transaction_ && (load / (1.0 + priority_) <= 1.0))
+  {
+    sendTransaction(merged_stamps_, merged_transaction_, false);
+    merged_stamps_.clear();
+    merged_transaction_.reset();
+    shed_count_ = 0;
+  }
 }
 
 void AsyncSensorModel::initialize(
   const std::string& name,
   TransactionCallback transaction_callback,
-  ros::CallbackQueue* transaction_callback_queue)
+  ros::CallbackQueue* transaction_callback_queue,
+  const ros::NodeHandle& parent_node_handle,
+  const ros::NodeHandle& parent_private_node_handle)
 {
   // Initialize internal state
   name_ = name;
-  node_handle_.setCallbackQueue(&callback_queue_);
-  private_node_handle_ = ros::NodeHandle(ros::NodeHandle("~"), name_);
-  private_node_handle_.setCallbackQueue(&callback_queue_);
+  node_handle_ = parent_node_handle;
+  node_handle_.setCallbackQueue(&callbackQueue());
+  private_node_handle_ = ros::NodeHandle(parent_private_node_handle, name_);
+  private_node_handle_.setCallbackQueue(&callbackQueue());
   transaction_callback_ = transaction_callback;
   transaction_callback_queue_ = transaction_callback_queue;
 
+  // Read the load shedding settings
+  std::string shedding_policy;
+  private_node_handle_.param("shedding_policy", shedding_policy, std::string("none"));
+  if (shedding_policy == "none")
+  {
+    shedding_policy_ = SheddingPolicy::NONE;
+  }
+  else if (shedding_policy == "decimate")
+  {
+    shedding_policy_ = SheddingPolicy::DECIMATE;
+  }
+  else if (shedding_policy == "merge")
+  {
+    shedding_policy_ = SheddingPolicy::MERGE;
+  }
+  else if (shedding_policy == "drop_oldest")
+  {
+    shedding_policy_ = SheddingPolicy::DROP_OLDEST;
+  }
+  else
+  {
+    throw std::invalid_argument("The sensor model '" + name_ + "' has an unknown shedding_policy '" + shedding_policy +
+                                "'. Valid values are 'none', 'decimate', 'merge', and 'drop_oldest'.");
+  }
+  private_node_handle_.param("priority", priority_, 0.0);
+  if (priority_ < 0.0)
+  {
+    throw std::invalid_argument("The sensor model '" + name_ + "' priority must be non-negative.");
+  }
+  int max_in_flight;
+  private_node_handle_.param("max_in_flight", max_in_flight, 1);
+  max_in_flight_ = static_cast<size_t>(std::max(max_in_flight, 1));
+
   // Call the derived onInit() function to perform implementation-specific initialization
   onInit();
 
-  // Start the async spinner to service the local callback queue
-  spinner_.start();
+  // Start the async spinner to service the local callback queue, unless the optimizer services the callbacks
+  if (!external_callback_queue_)
+  {
+    spinner_.start();
+  }
+}
+
+bool AsyncSensorModel::useCallbackQueue(ros::CallbackQueue* callback_queue)
+{
+  external_callback_queue_ = callback_queue;
+  return (external_callback_queue_ != nullptr);
 }
 
 void AsyncSensorModel::injectCallback(
   const std::set<ros::Time>& stamps,
   const Transaction::SharedPtr& transaction)
 {
-  SensorModel::injectCallback(stamps, transaction, transaction_callback_, transaction_callback_queue_);
+  // Build the cost functions in this thread, so the optimizer only has to link them into its problem. This happens
+  // before the transaction is merged or queued, so an invalid constraint throws to the caller instead of being sent.
+  transaction->prepare();
+  std::lock_guard<std::mutex> lock(shedding_mutex_);
+  // Higher priority sensors tolerate a higher optimizer load before shedding
+  const double overload = load_ / (1.0 + priority_);
+  const bool overloaded = (overload > 1.0);
+  // Send one out of every N transactions, where N grows with the overload
+  const size_t decimation = overloaded ? static_cast<size_t>(std::ceil(overload)) : 1;
+  if ((shedding_policy_ != SheddingPolicy::NONE) && !isSheddable(*transaction))
+  {
+    // Send any older merged transaction first, so the order of the transactions is preserved
+    if (merged_transaction_)
+    {
+      sendTransaction(merged_stamps_, merged_transaction_, overloaded);
+      merged_stamps_.clear();
+      merged_transaction_.reset();
+      shed_count_ = 0;
+    }
+    sendTransaction(stamps, transaction, overloaded);
+    return;
+  }
+  switch (shedding_policy_)
+  {
+    case SheddingPolicy::DECIMATE:
+      if (++shed_count_ >= decimation)
+      {
+        sendTransaction(stamps, transaction, overloaded);
+        shed_count_ = 0;
+      }
+      break;
+    case SheddingPolicy::MERGE:
+      if (!merged_transaction_ && !overloaded)
+      {
+        sendTransaction(stamps, transaction, overloaded);
+        break;
+      }
+      // Accumulate into a copy, so the caller's transaction is never modified
+      if (!merged_transaction_)
+      {
+        merged_transaction_ = Transaction::make_shared(*transaction);
+      }
+      else
+      {
+        merged_transaction_->merge(*transaction, true);
+        merged_transaction_->stamp(std::max(merged_transaction_->stamp(), transaction->stamp()));
+      }
+      merged_stamps_.insert(stamps.begin(), stamps.end());
+      if (++shed_count_ >= decimation)
+      {
+        sendTransaction(merged_stamps_, merged_transaction_, overloaded);
+        merged_stamps_.clear();
+        merged_transaction_.reset();
+        shed_count_ = 0;
+      }
+      break;
+    default:
+      sendTransaction(stamps, transaction, overloaded);
+      break;
+  }
+}
+
+void AsyncSensorModel::sendTransaction(
+  const std::set<ros::Time>& stamps,
+  const Transaction::SharedPtr& transaction,
+  bool overloaded)
+{
+  // Transactions that cannot be shed are never registered for cancellation, and do not count towards max_in_flight
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  if ((shedding_policy_ == SheddingPolicy::DROP_OLDEST) && isSheddable(*transaction))
+  {
+    std::lock_guard<std::mutex> lock(in_flight_->mutex);
+    in_flight_->cancelled.push_back(cancelled);
+    while (overloaded && (in_flight_->cancelled.size() > max_in_flight_))
+    {
+      *in_flight_->cancelled.front() = true;
+      in_flight_->cancelled.pop_front();
+    }
+  }
+  // The transaction callback is executed by the optimizer's callback queue. Its latency shows how far the optimizer
+  // is behind this sensor.
+  auto in_flight = in_flight_;
+  auto transaction_callback = transaction_callback_;
+  callback_statistics_->addCallback(
+    "injectCallback",
+    boost::make_shared<CancellableCallback>(
+      [in_flight, cancelled, transaction_callback, stamps, transaction]()  // NOLINT
+      {
+        {
+          // Callbacks execute in order, so the oldest waiting transaction is the one being executed
+          std::lock_guard<std::mutex> lock(in_flight->mutex);
+          if (!in_flight->cancelled.empty() && (in_flight->cancelled.front() == cancelled))
+          {
+            in_flight->cancelled.pop_front();
+          }
+        }
+        if (*cancelled)
+        {
+          return false;
+        }
+        transaction_callback(stamps, transaction);
+        return true;
+      }),
+    *transaction_callback_queue_);
 }
 
 }  // namespace fuse_core
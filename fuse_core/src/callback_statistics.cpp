@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/callback_statistics.h>
+#include <ros/callback_queue_interface.h>
+#include <ros/time.h>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief The accumulated statistics of a single named callback
+ */
+class CallbackStatistics::Counters
+{
+public:
+  /**
+   * @brief Record that a callback has been inserted into the queue
+   */
+  void enqueued()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++queue_depth_;
+    max_queue_depth_ = std::max(max_queue_depth_, queue_depth_);
+  }
+
+  /**
+   * @brief Record that a callback has left the queue without being executed
+   */
+  void discarded()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --queue_depth_;
+  }
+
+  /**
+   * @brief Record that a callback has been executed
+   */
+  void executed(const ros::WallDuration& latency, const ros::WallDuration& execution_time)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --queue_depth_;
+    ++executed_;
+    total_latency_ += latency;
+    max_latency_ = std::max(max_latency_, latency);
+    total_execution_time_ += execution_time;
+    max_execution_time_ = std::max(max_execution_time_, execution_time);
+  }
+
+  /**
+   * @brief Copy the current statistics into a Summary
+   */
+  Summary summarize(const std::string& callback_name) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Summary summary;
+    summary.callback = callback_name;
+    summary.executed = executed_;
+    summary.queue_depth = queue_depth_;
+    summary.max_queue_depth = max_queue_depth_;
+    if (executed_ > 0)
+    {
+      summary.mean_latency = total_latency_ * (1.0 / executed_);
+      summary.mean_execution_time = total_execution_time_ * (1.0 / executed_);
+    }
+    summary.max_latency = max_latency_;
+    summary.max_execution_time = max_execution_time_;
+    return summary;
+  }
+
+private:
+  uint64_t executed_ = 0;
+  uint64_t max_queue_depth_ = 0;
+  ros::WallDuration max_execution_time_;
+  ros::WallDuration max_latency_;
+  mutable std::mutex mutex_;
+  uint64_t queue_depth_ = 0;
+  ros::WallDuration total_execution_time_;
+  ros::WallDuration total_latency_;
+};
+
+/**
+ * @brief A callback that measures the queue latency and the execution time of the callback it wraps
+ */
+class CallbackStatistics::InstrumentedCallback : public ros::CallbackInterface
+{
+public:
+  InstrumentedCallback(ros::CallbackInterfacePtr callback, std::shared_ptr<Counters> counters) :
+    callback_(std::move(callback)),
+    counters_(std::move(counters)),
+    enqueue_time_(ros::WallTime::now()),
+    finished_(false)
+  {
+    counters_->enqueued();
+  }
+
+  ~InstrumentedCallback() override
+  {
+    // The callback was removed from the queue without being called, e.g. by clearing or destroying the queue
+    if (!finished_)
+    {
+      counters_->discarded();
+    }
+  }
+
+  CallResult call() override
+  {
+    const auto start_time = ros::WallTime::now();
+    const auto result = callback_->call();
+    // A callback that asks to be tried again is still waiting in the queue. A callback that reports itself invalid was
+    // cancelled without doing any work.
+    if (result == Success)
+    {
+      counters_->executed(start_time - enqueue_time_, ros::WallTime::now() - start_time);
+      finished_ = true;
+    }
+    else if (result == Invalid)
+    {
+      counters_->discarded();
+      finished_ = true;
+    }
+    return result;
+  }
+
+  bool ready() override
+  {
+    return callback_->ready();
+  }
+
+private:
+  ros::CallbackInterfacePtr callback_;
+  std::shared_ptr<Counters> counters_;
+  ros::WallTime enqueue_time_;
+  bool finished_;  //!< Set once the callback has left the queue and the counters have been updated
+};
+
+void CallbackStatistics::addCallback(
+  const std::string& callback_name,
+  const ros::CallbackInterfacePtr& callback,
+  ros::CallbackQueueInterface& callback_queue)
+{
+  std::shared_ptr<Counters> counters;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = counters_[callback_name];
+    if (!entry)
+    {
+      entry = std::make_shared<Counters>();
+    }
+    counters = entry;
+  }
+  callback_queue.addCallback(boost::make_shared<InstrumentedCallback>(callback, std::move(counters)));
+}
+
+std::vector<CallbackStatistics::Summary> CallbackStatistics::summarize() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Summary> summaries;
+  summaries.reserve(counters_.size());
+  for (const auto& name__counters : counters_)
+  {
+    summaries.push_back(name__counters.second->summarize(name__counters.first));
+  }
+  return summaries;
+}
+
+}  // namespace fuse_core
@@ -33,6 +33,43 @@
  */
 #include <fuse_core/constraint.h>
 
+#include <ceres/cost_function.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace
+{
+
+/**
+ * @brief A cost function that forwards to a cost function owned by someone else
+ *
+ * Ceres deletes the cost functions handed to a ceres::Problem. This wrapper is what the Problem owns, so a prepared
+ * cost function can be shared by every Problem created from the constraint.
+ */
+class SharedCostFunction : public ceres::CostFunction
+{
+public:
+  explicit SharedCostFunction(std::shared_ptr<const ceres::CostFunction> cost_function) :
+    cost_function_(std::move(cost_function))
+  {
+    set_num_residuals(cost_function_->num_residuals());
+    *mutable_parameter_block_sizes() = cost_function_->parameter_block_sizes();
+  }
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    return cost_function_->Evaluate(parameters, residuals, jacobians);
+  }
+
+private:
+  std::shared_ptr<const ceres::CostFunction> cost_function_;
+};
+
+}  // namespace
 
 namespace fuse_core
 {
@@ -43,6 +80,71 @@ Constraint::Constraint(std::initializer_list<UUID> variable_uuid_list) :
 {
 }
 
+Constraint::Constraint(
+  const std::string& type,
+  std::initializer_list<UUID> variable_uuid_list,
+  const std::string& measurement_key) :
+  variables_(variable_uuid_list)
+{
+  setContentAddressedUuid(type, measurement_key);
+}
+
+void Constraint::setContentAddressedUuid(const std::string& type, const std::string& measurement_key)
+{
+  // Hash the variable UUIDs followed by the measurement key, using the constraint type as the namespace
+  std::string buffer;
+  buffer.reserve(variables_.size() * UUID::static_size() + measurement_key.size());
+  for (const auto& variable_uuid : variables_)
+  {
+    buffer.append(variable_uuid.begin(), variable_uuid.end());
+  }
+  buffer.append(measurement_key);
+  uuid_ = uuid::generate(type, buffer.data(), buffer.size());
+}
+
+void Constraint::prepare()
+{
+  if (prepared_cost_function_)
+  {
+    return;
+  }
+  std::shared_ptr<const ceres::CostFunction> cost_function(costFunction());
+  if (!cost_function)
+  {
+    throw std::logic_error("The " + type() + " constraint " + uuid::to_string(uuid_) + " has no cost function.");
+  }
+  const auto& parameter_block_sizes = cost_function->parameter_block_sizes();
+  if (parameter_block_sizes.size() != variables_.size())
+  {
+    throw std::logic_error("The " + type() + " constraint " + uuid::to_string(uuid_) + " involves " +
+                           std::to_string(variables_.size()) + " variables, but its cost function expects " +
+                           std::to_string(parameter_block_sizes.size()) + " parameter blocks.");
+  }
+  for (const auto& parameter_block_size : parameter_block_sizes)
+  {
+    if (parameter_block_size <= 0)
+    {
+      throw std::logic_error("The " + type() + " constraint " + uuid::to_string(uuid_) +
+                             " has a cost function with an empty parameter block.");
+    }
+  }
+  if (cost_function->num_residuals() <= 0)
+  {
+    throw std::logic_error("The " + type() + " constraint " + uuid::to_string(uuid_) +
+                           " has a cost function without residuals.");
+  }
+  prepared_cost_function_ = std::move(cost_function);
+}
+
+ceres::CostFunction* Constraint::preparedCostFunction() const
+{
+  if (prepared_cost_function_)
+  {
+    return new SharedCostFunction(prepared_cost_function_);
+  }
+  return costFunction();
+}
+
 std::ostream& operator <<(std::ostream& stream, const Constraint& constraint)
 {
   constraint.print(stream);
@@ -33,12 +33,46 @@
  */
 #include <fuse_core/graph.h>
 
+#include <Eigen/SparseCore>
+
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 
 namespace fuse_core
 {
 
+Graph::UniquePtr Graph::cloneVariables(const std::vector<UUID>& variable_uuids) const
+{
+  auto graph = clone();
+  // Remove all of the constraints
+  std::vector<UUID> constraint_uuids;
+  for (const auto& constraint : graph->getConstraints())
+  {
+    constraint_uuids.push_back(constraint.uuid());
+  }
+  for (const auto& constraint_uuid : constraint_uuids)
+  {
+    graph->removeConstraint(constraint_uuid);
+  }
+  // Remove all of the variables that were not requested
+  std::unordered_set<UUID, uuid::hash> requested_variables(variable_uuids.begin(), variable_uuids.end());
+  std::vector<UUID> removed_variables;
+  for (const auto& variable : graph->getVariables())
+  {
+    if (requested_variables.find(variable.uuid()) == requested_variables.end())
+    {
+      removed_variables.push_back(variable.uuid());
+    }
+  }
+  for (const auto& variable_uuid : removed_variables)
+  {
+    graph->removeVariable(variable_uuid);
+  }
+  return graph;
+}
+
 void Graph::marginalizeVariables(const std::vector<UUID>& variable_uuids)
 {
   for (const auto& variable_uuid : variable_uuids)
@@ -47,6 +81,41 @@ void Graph::marginalizeVariables(const std::vector<UUID>& variable_uuids)
   }
 }
 
+void Graph::getInformationMatrix(
+  const std::vector<UUID>& variable_uuids,
+  SparseGraphMatrix& information,
+  int num_threads) const
+{
+  SparseGraphMatrix jacobian;
+  getJacobian(variable_uuids, jacobian, num_threads);
+  if (jacobian.matrix.rows.empty())
+  {
+    // A CRS matrix always contains num_rows + 1 row offsets, even when there are no rows
+    jacobian.matrix.rows.push_back(0);
+  }
+
+  // Wrap the CRS Jacobian in an Eigen sparse matrix to perform the product
+  using SparseMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor, int>;
+  Eigen::Map<const SparseMatrix> J(
+    jacobian.matrix.num_rows,
+    jacobian.matrix.num_cols,
+    static_cast<int>(jacobian.matrix.values.size()),
+    jacobian.matrix.rows.data(),
+    jacobian.matrix.cols.data(),
+    jacobian.matrix.values.data());
+  SparseMatrix H = SparseMatrix(J.transpose()) * J;
+  H.makeCompressed();
+
+  // Copy the result back into the CRS format
+  information.matrix.num_rows = static_cast<int>(H.rows());
+  information.matrix.num_cols = static_cast<int>(H.cols());
+  information.matrix.rows.assign(H.outerIndexPtr(), H.outerIndexPtr() + H.outerSize() + 1);
+  information.matrix.cols.assign(H.innerIndexPtr(), H.innerIndexPtr() + H.nonZeros());
+  information.matrix.values.assign(H.valuePtr(), H.valuePtr() + H.nonZeros());
+  information.variable_uuids = std::move(jacobian.variable_uuids);
+  information.columns = std::move(jacobian.columns);
+}
+
 void Graph::update(const fuse_core::Transaction& transaction)
 {
   // Update the graph with a new transaction. In order to keep the graph consistent, variables are added first,
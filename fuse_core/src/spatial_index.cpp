@@ -0,0 +1,294 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/spatial_index.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+SpatialIndex::SpatialIndex(double cell_size, const std::vector<std::string>& variable_types) :
+  cell_size_(cell_size),
+  variable_types_(variable_types.begin(), variable_types.end())
+{
+  if (!(cell_size_ > 0.0))
+  {
+    throw std::invalid_argument("The spatial index cell size must be positive. Received " +
+                                std::to_string(cell_size_) + ".");
+  }
+}
+
+std::vector<std::string> SpatialIndex::variableTypes() const
+{
+  std::vector<std::string> variable_types(variable_types_.begin(), variable_types_.end());
+  std::sort(variable_types.begin(), variable_types.end());
+  return variable_types;
+}
+
+bool SpatialIndex::insert(Variable::ConstSharedPtr variable)
+{
+  if (!variable || (variable_types_.find(variable->type()) == variable_types_.end()))
+  {
+    return false;
+  }
+  const auto position = toPosition(*variable);
+  const auto cell = toCell(position);
+  const auto variable_uuid = variable->uuid();
+  if (!entries_.emplace(variable_uuid, Entry{std::move(variable), position, cell}).second)  // NOLINT
+  {
+    return false;
+  }
+  addToCell(cell, variable_uuid);
+  return true;
+}
+
+bool SpatialIndex::remove(const UUID& variable_uuid)
+{
+  auto entries_iter = entries_.find(variable_uuid);
+  if (entries_iter == entries_.end())
+  {
+    return false;
+  }
+  eraseFromCell(entries_iter->second.cell, variable_uuid);
+  entries_.erase(entries_iter);
+  return true;
+}
+
+void SpatialIndex::clear()
+{
+  cells_.clear();
+  entries_.clear();
+  layers_.clear();
+}
+
+void SpatialIndex::refresh()
+{
+  for (auto& uuid__entry : entries_)
+  {
+    refresh(uuid__entry.first, uuid__entry.second);
+  }
+}
+
+void SpatialIndex::refresh(const UUID& variable_uuid)
+{
+  auto entries_iter = entries_.find(variable_uuid);
+  if (entries_iter != entries_.end())
+  {
+    refresh(variable_uuid, entries_iter->second);
+  }
+}
+
+std::vector<UUID> SpatialIndex::query(double x, double y, double radius) const
+{
+  std::vector<UUID> result;
+  if (radius < 0.0)
+  {
+    return result;
+  }
+  const auto min_cell = toCell({x - radius, y - radius, 0.0});  // NOLINT
+  const auto max_cell = toCell({x + radius, y + radius, 0.0});  // NOLINT
+  const double radius_squared = radius * radius;
+  // When the grid is sparse, walking the occupied cells is cheaper than walking every cell in the bounding box
+  const double box_cells =
+    (max_cell[0] - min_cell[0] + 1.0) * (max_cell[1] - min_cell[1] + 1.0) * static_cast<double>(layers_.size());
+  auto check_cell = [&](const std::vector<UUID>& variable_uuids)
+  {
+    for (const auto& variable_uuid : variable_uuids)
+    {
+      const auto& position = entries_.at(variable_uuid).position;
+      const double dx = position[0] - x;
+      const double dy = position[1] - y;
+      if (dx * dx + dy * dy <= radius_squared)
+      {
+        result.push_back(variable_uuid);
+      }
+    }
+  };
+  if (box_cells > cells_.size())
+  {
+    for (const auto& cell__variable_uuids : cells_)
+    {
+      const auto& cell = cell__variable_uuids.first;
+      if (cell[0] >= min_cell[0] && cell[0] <= max_cell[0] && cell[1] >= min_cell[1] && cell[1] <= max_cell[1])
+      {
+        check_cell(cell__variable_uuids.second);
+      }
+    }
+    return result;
+  }
+  // Two-dimensional queries match every z layer that contains any variables
+  for (auto i = min_cell[0]; i <= max_cell[0]; ++i)
+  {
+    for (auto j = min_cell[1]; j <= max_cell[1]; ++j)
+    {
+      for (const auto& layer__cell_count : layers_)
+      {
+        auto cells_iter = cells_.find({i, j, layer__cell_count.first});  // NOLINT
+        if (cells_iter != cells_.end())
+        {
+          check_cell(cells_iter->second);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<UUID> SpatialIndex::query(double x, double y, double z, double radius) const
+{
+  std::vector<UUID> result;
+  if (radius < 0.0)
+  {
+    return result;
+  }
+  const auto min_cell = toCell({x - radius, y - radius, z - radius});  // NOLINT
+  const auto max_cell = toCell({x + radius, y + radius, z + radius});  // NOLINT
+  const double radius_squared = radius * radius;
+  auto check_cell = [&](const std::vector<UUID>& variable_uuids)
+  {
+    for (const auto& variable_uuid : variable_uuids)
+    {
+      const auto& position = entries_.at(variable_uuid).position;
+      const double dx = position[0] - x;
+      const double dy = position[1] - y;
+      const double dz = position[2] - z;
+      if (dx * dx + dy * dy + dz * dz <= radius_squared)
+      {
+        result.push_back(variable_uuid);
+      }
+    }
+  };
+  // When the grid is sparse, walking the occupied cells is cheaper than walking every cell in the bounding box
+  const double box_cells =
+    (max_cell[0] - min_cell[0] + 1.0) * (max_cell[1] - min_cell[1] + 1.0) * (max_cell[2] - min_cell[2] + 1.0);
+  if (box_cells > cells_.size())
+  {
+    for (const auto& cell__variable_uuids : cells_)
+    {
+      const auto& cell = cell__variable_uuids.first;
+      if (cell[0] >= min_cell[0] && cell[0] <= max_cell[0] && cell[1] >= min_cell[1] && cell[1] <= max_cell[1] &&
+          cell[2] >= min_cell[2] && cell[2] <= max_cell[2])
+      {
+        check_cell(cell__variable_uuids.second);
+      }
+    }
+    return result;
+  }
+  for (auto i = min_cell[0]; i <= max_cell[0]; ++i)
+  {
+    for (auto j = min_cell[1]; j <= max_cell[1]; ++j)
+    {
+      for (auto k = min_cell[2]; k <= max_cell[2]; ++k)
+      {
+        auto cells_iter = cells_.find({i, j, k});  // NOLINT
+        if (cells_iter != cells_.end())
+        {
+          check_cell(cells_iter->second);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+size_t SpatialIndex::CellHash::operator()(const Cell& cell) const
+{
+  return boost::hash_range(cell.begin(), cell.end());
+}
+
+SpatialIndex::Cell SpatialIndex::toCell(const Position& position) const
+{
+  return {static_cast<int64_t>(std::floor(position[0] / cell_size_)),  // NOLINT
+          static_cast<int64_t>(std::floor(position[1] / cell_size_)),
+          static_cast<int64_t>(std::floor(position[2] / cell_size_))};
+}
+
+SpatialIndex::Position SpatialIndex::toPosition(const Variable& variable)
+{
+  Position position = {0.0, 0.0, 0.0};  // NOLINT
+  std::copy_n(variable.data(), std::min<size_t>(variable.size(), position.size()), position.begin());
+  return position;
+}
+
+void SpatialIndex::addToCell(const Cell& cell, const UUID& variable_uuid)
+{
+  auto& variable_uuids = cells_[cell];
+  if (variable_uuids.empty())
+  {
+    ++layers_[cell[2]];
+  }
+  variable_uuids.push_back(variable_uuid);
+}
+
+void SpatialIndex::eraseFromCell(const Cell& cell, const UUID& variable_uuid)
+{
+  auto cells_iter = cells_.find(cell);
+  auto& variable_uuids = cells_iter->second;
+  auto position = std::find(variable_uuids.begin(), variable_uuids.end(), variable_uuid);
+  *position = variable_uuids.back();
+  variable_uuids.pop_back();
+  if (variable_uuids.empty())
+  {
+    cells_.erase(cells_iter);
+    auto layers_iter = layers_.find(cell[2]);
+    if (--layers_iter->second == 0)
+    {
+      layers_.erase(layers_iter);
+    }
+  }
+}
+
+void SpatialIndex::refresh(const UUID& variable_uuid, Entry& entry)
+{
+  entry.position = toPosition(*entry.variable);
+  const auto cell = toCell(entry.position);
+  if (cell != entry.cell)
+  {
+    eraseFromCell(entry.cell, variable_uuid);
+    addToCell(cell, variable_uuid);
+    entry.cell = cell;
+  }
+}
+
+}  // namespace fuse_core
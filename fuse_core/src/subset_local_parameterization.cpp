@@ -0,0 +1,124 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/subset_local_parameterization.h>
+
+#include <ceres/local_parameterization.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+constexpr size_t SubsetLocalParameterization::MAX_GLOBAL_SIZE;
+constexpr size_t SubsetLocalParameterization::MAX_LOCAL_SIZE;
+
+SubsetLocalParameterization::SubsetLocalParameterization(
+  ceres::LocalParameterization* parameterization,
+  const std::vector<size_t>& held_dimensions) :
+    parameterization_(parameterization)
+{
+  if (!parameterization_)
+  {
+    throw std::invalid_argument("A SubsetLocalParameterization requires a parameterization to wrap. Use a "
+                                "ceres::SubsetParameterization for variables without a local parameterization.");
+  }
+  const size_t global_size = parameterization_->GlobalSize();
+  const size_t local_size = parameterization_->LocalSize();
+  if ((global_size > MAX_GLOBAL_SIZE) || (local_size > MAX_LOCAL_SIZE))
+  {
+    throw std::invalid_argument("A SubsetLocalParameterization supports parameterizations with up to " +
+                                std::to_string(MAX_GLOBAL_SIZE) + " global and " + std::to_string(MAX_LOCAL_SIZE) +
+                                " local dimensions. The provided parameterization has " +
+                                std::to_string(global_size) + " and " + std::to_string(local_size) + ".");
+  }
+  for (const auto dimension : held_dimensions)
+  {
+    if (dimension >= local_size)
+    {
+      throw std::invalid_argument("The held dimension " + std::to_string(dimension) + " is out of range for a "
+                                  "local parameterization with " + std::to_string(local_size) + " dimensions.");
+    }
+  }
+  for (size_t dimension = 0; dimension < local_size; ++dimension)
+  {
+    if (std::find(held_dimensions.begin(), held_dimensions.end(), dimension) == held_dimensions.end())
+    {
+      free_dimensions_.push_back(dimension);
+    }
+  }
+  if (free_dimensions_.empty())
+  {
+    throw std::invalid_argument("A SubsetLocalParameterization cannot hold every dimension constant. Hold the "
+                                "entire parameter block constant instead.");
+  }
+}
+
+bool SubsetLocalParameterization::Plus(const double* x, const double* delta, double* x_plus_delta) const
+{
+  std::array<double, MAX_LOCAL_SIZE> full_delta;
+  full_delta.fill(0.0);
+  for (size_t i = 0; i < free_dimensions_.size(); ++i)
+  {
+    full_delta[free_dimensions_[i]] = delta[i];
+  }
+  return parameterization_->Plus(x, full_delta.data(), x_plus_delta);
+}
+
+bool SubsetLocalParameterization::ComputeJacobian(const double* x, double* jacobian) const
+{
+  // The reduced Jacobian is the full Jacobian with the columns of the held dimensions removed
+  const size_t global_size = parameterization_->GlobalSize();
+  const size_t full_local_size = parameterization_->LocalSize();
+  std::array<double, MAX_GLOBAL_SIZE * MAX_LOCAL_SIZE> full_jacobian;
+  if (!parameterization_->ComputeJacobian(x, full_jacobian.data()))
+  {
+    return false;
+  }
+  const size_t local_size = free_dimensions_.size();
+  for (size_t row = 0; row < global_size; ++row)
+  {
+    for (size_t column = 0; column < local_size; ++column)
+    {
+      jacobian[row * local_size + column] = full_jacobian[row * full_local_size + free_dimensions_[column]];
+    }
+  }
+  return true;
+}
+
+}  // namespace fuse_core
@@ -42,6 +42,10 @@ namespace fuse_core
 
 void Transaction::addConstraint(Constraint::SharedPtr constraint, bool overwrite)
 {
+  if (!constraint)
+  {
+    return;
+  }
   // If the constraint being added is in the 'removed' container, then delete it from
   // the 'removed' container instead of adding it to the 'added' container.
   UUID constraint_uuid = constraint->uuid();
@@ -93,6 +97,10 @@ void Transaction::removeConstraint(const UUID& constraint_uuid)
 
 void Transaction::addVariable(Variable::SharedPtr variable, bool overwrite)
 {
+  if (!variable)
+  {
+    return;
+  }
   // If the variable being added is in the 'removed' container, then delete it from
   // the 'removed' container instead of adding it to the 'added' container.
 
@@ -164,6 +172,14 @@ void Transaction::merge(const Transaction& other, bool overwrite)
   }
 }
 
+void Transaction::prepare()
+{
+  for (const auto& added_constraint : added_constraints_)
+  {
+    added_constraint->prepare();
+  }
+}
+
 void Transaction::print(std::ostream& stream) const
 {
   stream << "Added Variables:\n";
@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/variable_archive.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+VariableArchive::VariableArchive() :
+  covariance_offsets_(1, 0),
+  data_offsets_(1, 0)
+{
+}
+
+void VariableArchive::append(
+  const Variable& variable,
+  const ros::Time& stamp,
+  const UUID& device_id,
+  const std::vector<double>& covariance)
+{
+  const auto variable_size = variable.size();
+  if (!covariance.empty() && covariance.size() != variable_size * variable_size)
+  {
+    throw std::invalid_argument("The archived covariance of variable " + uuid::to_string(variable.uuid()) +
+                                " has " + std::to_string(covariance.size()) + " elements. Expected " +
+                                std::to_string(variable_size * variable_size) + ".");
+  }
+  const auto type = variable.type();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Variable types are stored once, and referenced by index from each entry
+  auto type_iter = std::find(type_names_.begin(), type_names_.end(), type);
+  if (type_iter == type_names_.end())
+  {
+    if (type_names_.size() > std::numeric_limits<uint16_t>::max())
+    {
+      throw std::length_error("The variable archive cannot hold more than " +
+                              std::to_string(std::numeric_limits<uint16_t>::max()) + " distinct variable types.");
+    }
+    type_iter = type_names_.insert(type_names_.end(), type);
+  }
+  type_indices_.push_back(static_cast<uint16_t>(std::distance(type_names_.begin(), type_iter)));
+  uuids_.push_back(variable.uuid());
+  stamps_.push_back(stamp);
+  device_ids_.push_back(device_id);
+  data_.insert(data_.end(), variable.data(), variable.data() + variable_size);
+  data_offsets_.push_back(data_.size());
+  covariances_.insert(covariances_.end(), covariance.begin(), covariance.end());
+  covariance_offsets_.push_back(covariances_.size());
+}
+
+size_t VariableArchive::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return uuids_.size();
+}
+
+std::vector<VariableArchive::Entry> VariableArchive::query(
+  const std::string& type,
+  const UUID& device_id,
+  const ros::Time& begin,
+  const ros::Time& end) const
+{
+  return collect(type, device_id, begin, end, 0, std::numeric_limits<size_t>::max());
+}
+
+std::vector<VariableArchive::Entry> VariableArchive::query(
+  const std::string& type,
+  const UUID& device_id,
+  size_t first,
+  size_t last) const
+{
+  return collect(type, device_id, ros::Time(0, 0), ros::TIME_MAX, first, last);
+}
+
+std::vector<VariableArchive::Entry> VariableArchive::collect(
+  const std::string& type,
+  const UUID& device_id,
+  const ros::Time& begin,
+  const ros::Time& end,
+  size_t first,
+  size_t last) const
+{
+  std::vector<Entry> entries;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto type_iter = std::find(type_names_.begin(), type_names_.end(), type);
+  if (type_iter == type_names_.end())
+  {
+    return entries;
+  }
+  const auto type_index = static_cast<uint16_t>(std::distance(type_names_.begin(), type_iter));
+  // Filter on the small columns first, and only touch the packed values of matching entries
+  last = std::min(last, uuids_.size());
+  for (size_t i = first; i < last; ++i)
+  {
+    if ((type_indices_[i] != type_index) ||
+        (device_ids_[i] != device_id) ||
+        (stamps_[i] < begin) ||
+        (stamps_[i] > end))
+    {
+      continue;
+    }
+    Entry entry;
+    entry.uuid = uuids_[i];
+    entry.type = type;
+    entry.stamp = stamps_[i];
+    entry.device_id = device_ids_[i];
+    entry.data.assign(data_.begin() + data_offsets_[i], data_.begin() + data_offsets_[i + 1]);
+    entry.covariance.assign(
+      covariances_.begin() + covariance_offsets_[i],
+      covariances_.begin() + covariance_offsets_[i + 1]);
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+}  // namespace fuse_core
@@ -39,6 +39,7 @@
 #include <fuse_core/uuid.h>
 
 #include <initializer_list>
+#include <string>
 
 
 /**
@@ -62,6 +63,15 @@ public:
   {
   }
 
+  ExampleConstraint(
+    const std::string& type,
+    std::initializer_list<fuse_core::UUID> variable_uuid_list,
+    const std::string& measurement_key) :
+    fuse_core::Constraint(type, variable_uuid_list, measurement_key),
+    data(0.0)
+  {
+  }
+
   void print(std::ostream& stream = std::cout) const override {}
   ceres::CostFunction* costFunction() const override { return nullptr; }
   fuse_core::Constraint::UniquePtr clone() const override { return ExampleConstraint::make_unique(*this); }
@@ -79,14 +79,14 @@ public:
 TEST(AsyncMotionModel, OnInit)
 {
   MyMotionModel motion_model;
-  motion_model.initialize("my_motion_model");
+  motion_model.initialize("my_motion_model", ros::NodeHandle(), ros::NodeHandle("~"));
   EXPECT_TRUE(motion_model.initialized);
 }
 
 TEST(AsyncMotionModel, OnGraphUpdate)
 {
   MyMotionModel motion_model;
-  motion_model.initialize("my_motion_model");
+  motion_model.initialize("my_motion_model", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Execute the graph callback in this thread. This should push a call to MyMotionModel::onGraphUpdate()
   // into MyMotionModel's callback queue, which will get executed by MyMotionModel's async spinner.
@@ -106,7 +106,7 @@ TEST(AsyncMotionModel, OnGraphUpdate)
 TEST(AsyncMotionModel, ApplyCallback)
 {
   MyMotionModel motion_model;
-  motion_model.initialize("my_motion_model");
+  motion_model.initialize("my_motion_model", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Call the motion model base class "apply()" method to send a transaction to the derived model. The AsyncMotionModel
   // will then inject a call to applyCallback() into the motion model's callback queue. There is a time delay there, so
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/async_publisher.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 
 #include <gtest/gtest.h>
@@ -65,6 +66,9 @@ public:
     initialized = true;
   }
 
+  const ros::NodeHandle& nodeHandle() const { return node_handle_; }
+  const ros::NodeHandle& privateNodeHandle() const { return private_node_handle_; }
+
   bool callback_processed;
   bool initialized;
 };
@@ -72,14 +76,35 @@ public:
 TEST(AsyncPublisher, OnInit)
 {
   MyPublisher publisher;
-  publisher.initialize("my_publisher");
+  publisher.initialize("my_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
   EXPECT_TRUE(publisher.initialized);
 }
 
+TEST(AsyncPublisher, Namespaces)
+{
+  // Run as a node, the plugin's namespaces are the node's namespace and beneath the node's private namespace
+  MyPublisher publisher1;
+  publisher1.initialize("my_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+  EXPECT_EQ(ros::NodeHandle().getNamespace(), publisher1.nodeHandle().getNamespace());
+  EXPECT_EQ(ros::NodeHandle("~").getNamespace() + "/my_publisher", publisher1.privateNodeHandle().getNamespace());
+
+  // When the optimizer supplies its own node handles (e.g. from a nodelet), the plugin's namespaces follow them
+  MyPublisher publisher2;
+  publisher2.initialize("my_publisher", ros::NodeHandle("/my_robot"), ros::NodeHandle("/my_optimizer"));
+  EXPECT_EQ("/my_robot", publisher2.nodeHandle().getNamespace());
+  EXPECT_EQ("/my_optimizer/my_publisher", publisher2.privateNodeHandle().getNamespace());
+
+  // The overload without node handles uses the node's namespaces, as before the node handles were added
+  MyPublisher publisher3;
+  publisher3.initialize("my_publisher");
+  EXPECT_EQ(publisher1.nodeHandle().getNamespace(), publisher3.nodeHandle().getNamespace());
+  EXPECT_EQ(publisher1.privateNodeHandle().getNamespace(), publisher3.privateNodeHandle().getNamespace());
+}
+
 TEST(AsyncPublisher, notifyCallback)
 {
   MyPublisher publisher;
-  publisher.initialize("my_publisher");
+  publisher.initialize("my_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Execute the notify() method in this thread. This should push a call to MyPublisher::notifyCallback()
   // into MyPublisher's callback queue, which will get executed by MyPublisher's async spinner.
@@ -97,6 +122,25 @@ TEST(AsyncPublisher, notifyCallback)
   EXPECT_TRUE(publisher.callback_processed);
 }
 
+TEST(AsyncPublisher, UseCallbackQueue)
+{
+  // The publisher's callbacks are added to the provided queue, which is serviced by the caller
+  ros::CallbackQueue callback_queue;
+  MyPublisher publisher;
+  EXPECT_FALSE(publisher.useCallbackQueue(nullptr));
+  EXPECT_TRUE(publisher.useCallbackQueue(&callback_queue));
+  publisher.initialize("my_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+  EXPECT_EQ(&callback_queue, publisher.privateNodeHandle().getCallbackQueue());
+
+  fuse_core::Transaction::ConstSharedPtr transaction;  // nullptr...which is fine because we do not actually use it
+  fuse_core::Graph::ConstSharedPtr graph;  // nullptr...which is fine because we do not actually use it
+  publisher.notify(transaction, graph);
+  ros::Duration(0.1).sleep();
+  EXPECT_FALSE(publisher.callback_processed);
+  callback_queue.callAvailable();
+  EXPECT_TRUE(publisher.callback_processed);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -32,11 +32,20 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/async_sensor_model.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 
 /**
@@ -85,14 +94,24 @@ public:
 TEST(AsyncSensorModel, OnInit)
 {
   MySensor sensor;
-  sensor.initialize("my_sensor", &transactionCallback, ros::getGlobalCallbackQueue());
+  sensor.initialize(
+    "my_sensor",
+    &transactionCallback,
+    ros::getGlobalCallbackQueue(),
+    ros::NodeHandle(),
+    ros::NodeHandle("~"));
   EXPECT_TRUE(sensor.initialized);
 }
 
 TEST(AsyncSensorModel, OnGraphUpdate)
 {
   MySensor sensor;
-  sensor.initialize("my_sensor", &transactionCallback, ros::getGlobalCallbackQueue());
+  sensor.initialize(
+    "my_sensor",
+    &transactionCallback,
+    ros::getGlobalCallbackQueue(),
+    ros::NodeHandle(),
+    ros::NodeHandle("~"));
 
   // Execute the graph callback in this thread. This should push a call to MySensor::onGraphUpdate()
   // into MySensor's callback queue, which will get executed by MySensor's async spinner.
@@ -112,7 +131,12 @@ TEST(AsyncSensorModel, OnGraphUpdate)
 TEST(AsyncSensorModel, InjectCallback)
 {
   MySensor sensor;
-  sensor.initialize("my_sensor", &transactionCallback, ros::getGlobalCallbackQueue());
+  sensor.initialize(
+    "my_sensor",
+    &transactionCallback,
+    ros::getGlobalCallbackQueue(),
+    ros::NodeHandle(),
+    ros::NodeHandle("~"));
 
   // Use the sensor to inject a callback into the global callback queue. This will get executed by main's spinner.
   // There is a time delay there. So, this call should return almost immediately, then we have to wait
@@ -129,6 +153,216 @@ TEST(AsyncSensorModel, InjectCallback)
   EXPECT_TRUE(received_transaction);
 }
 
+/**
+ * @brief Transaction callback that records the received transactions
+ */
+class TransactionRecorder
+{
+public:
+  void callback(const std::set<ros::Time>& stamps, const fuse_core::Transaction::SharedPtr& transaction)
+  {
+    received_stamps.push_back(stamps);
+    received_transactions.push_back(transaction);
+  }
+
+  std::vector<std::set<ros::Time>> received_stamps;
+  std::vector<fuse_core::Transaction::SharedPtr> received_transactions;
+};
+
+/**
+ * @brief Initialize a sensor with the requested shedding policy, using the provided queue for transactions
+ */
+void initializeShedding(
+  MySensor& sensor,
+  const std::string& name,
+  const std::string& policy,
+  TransactionRecorder& recorder,
+  ros::CallbackQueue& queue)
+{
+  ros::NodeHandle private_node_handle("~");
+  private_node_handle.setParam(name + "/shedding_policy", policy);
+  private_node_handle.setParam(name + "/max_in_flight", 1);
+  sensor.initialize(
+    name,
+    std::bind(&TransactionRecorder::callback, &recorder, std::placeholders::_1, std::placeholders::_2),
+    &queue,
+    ros::NodeHandle(),
+    ros::NodeHandle("~"));
+}
+
+TEST(AsyncSensorModel, SheddingNone)
+{
+  MySensor sensor;
+  TransactionRecorder recorder;
+  ros::CallbackQueue queue;
+  initializeShedding(sensor, "none_sensor", "none", recorder, queue);
+
+  sensor.backpressureCallback(4.0);
+  for (int i = 0; i < 4; ++i)
+  {
+    sensor.injectCallback({ros::Time(i + 1, 0)}, fuse_core::Transaction::make_shared());  // NOLINT
+  }
+  queue.callAvailable();
+  EXPECT_EQ(4u, recorder.received_stamps.size());
+}
+
+TEST(AsyncSensorModel, SheddingDecimate)
+{
+  MySensor sensor;
+  TransactionRecorder recorder;
+  ros::CallbackQueue queue;
+  initializeShedding(sensor, "decimate_sensor", "decimate", recorder, queue);
+
+  // The optimizer is keeping up, so nothing is shed
+  sensor.backpressureCallback(0.5);
+  for (int i = 0; i < 4; ++i)
+  {
+    sensor.injectCallback({ros::Time(i + 1, 0)}, fuse_core::Transaction::make_shared());  // NOLINT
+  }
+  queue.callAvailable();
+  EXPECT_EQ(4u, recorder.received_stamps.size());
+
+  // The optimizer is at twice its capacity, so every other transaction is shed
+  recorder.received_stamps.clear();
+  sensor.backpressureCallback(2.0);
+  for (int i = 0; i < 4; ++i)
+  {
+    sensor.injectCallback({ros::Time(i + 1, 0)}, fuse_core::Transaction::make_shared());  // NOLINT
+  }
+  queue.callAvailable();
+  ASSERT_EQ(2u, recorder.received_stamps.size());
+  EXPECT_EQ(std::set<ros::Time>({ros::Time(2, 0)}), recorder.received_stamps[0]);  // NOLINT
+  EXPECT_EQ(std::set<ros::Time>({ros::Time(4, 0)}), recorder.received_stamps[1]);  // NOLINT
+}
+
+TEST(AsyncSensorModel, SheddingMerge)
+{
+  MySensor sensor;
+  TransactionRecorder recorder;
+  ros::CallbackQueue queue;
+  initializeShedding(sensor, "merge_sensor", "merge", recorder, queue);
+
+  // The optimizer is at three times its capacity, so three transactions are merged into one
+  sensor.backpressureCallback(3.0);
+  for (int i = 0; i < 4; ++i)
+  {
+    sensor.injectCallback({ros::Time(i + 1, 0)}, fuse_core::Transaction::make_shared());  // NOLINT
+  }
+  queue.callAvailable();
+  ASSERT_EQ(1u, recorder.received_stamps.size());
+  EXPECT_EQ(std::set<ros::Time>({ros::Time(1, 0), ros::Time(2, 0), ros::Time(3, 0)}),  // NOLINT
+            recorder.received_stamps[0]);
+
+  // Once the optimizer catches up, the remaining merged transaction is sent immediately
+  sensor.backpressureCallback(0.5);
+  queue.callAvailable();
+  ASSERT_EQ(2u, recorder.received_stamps.size());
+  EXPECT_EQ(std::set<ros::Time>({ros::Time(4, 0)}), recorder.received_stamps[1]);  // NOLINT
+}
+
+TEST(AsyncSensorModel, SheddingMergeInvalidConstraint)
+{
+  MySensor sensor;
+  TransactionRecorder recorder;
+  ros::CallbackQueue queue;
+  initializeShedding(sensor, "merge_invalid_sensor", "merge", recorder, queue);
+
+  // A transaction that fails to prepare is rejected before it can be merged with the others
+  sensor.backpressureCallback(3.0);
+  auto invalid_transaction = fuse_core::Transaction::make_shared();
+  auto invalid_constraint =
+    ExampleConstraint::make_shared(std::initializer_list<fuse_core::UUID>{fuse_core::uuid::generate()});  // NOLINT
+  invalid_transaction->addConstraint(invalid_constraint);
+  EXPECT_THROW(sensor.injectCallback({ros::Time(1, 0)}, invalid_transaction), std::logic_error);  // NOLINT
+  sensor.injectCallback({ros::Time(2, 0)}, fuse_core::Transaction::make_shared());  // NOLINT
+
+  // Sending the merged transaction once the optimizer catches up does not throw, and excludes the rejected transaction
+  EXPECT_NO_THROW(sensor.backpressureCallback(0.5));
+  queue.callAvailable();
+  ASSERT_EQ(1u, recorder.received_stamps.size());
+  EXPECT_EQ(std::set<ros::Time>({ros::Time(2, 0)}), recorder.received_stamps[0]);  // NOLINT
+}
+
+TEST(AsyncSensorModel, SheddingDropOldest)
+{
+  MySensor sensor;
+  TransactionRecorder recorder;
+  ros::CallbackQueue queue;
+  initializeShedding(sensor, "drop_oldest_sensor", "drop_oldest", recorder, queue);
+
+  // Only the newest waiting transaction is kept while the optimizer is overloaded
+  sensor.backpressureCallback(2.0);
+  for (int i = 0; i < 4; ++i)
+  {
+    sensor.injectCallback({ros::Time(i + 1, 0)}, fuse_core::Transaction::make_shared());  // NOLINT
+  }
+  queue.callAvailable();
+  ASSERT_EQ(1u, recorder.received_stamps.size());
+  EXPECT_EQ(std::set<ros::Time>({ros::Time(4, 0)}), recorder.received_stamps[0]);  // NOLINT
+
+  // The cancelled transactions are not counted as executions
+  const auto summaries = sensor.callbackStatistics()->summarize();
+  const auto summary = std::find_if(summaries.begin(), summaries.end(),
+                                    [](const fuse_core::CallbackStatistics::Summary& summary)  // NOLINT
+                                    {
+                                      return summary.callback == "injectCallback";
+                                    });  // NOLINT
+  ASSERT_NE(summaries.end(), summary);
+  EXPECT_EQ(1u, summary->executed);
+  EXPECT_EQ(0u, summary->queue_depth);
+}
+
+TEST(AsyncSensorModel, SheddingKeepsAddedVariables)
+{
+  for (const std::string policy : {"decimate", "merge", "drop_oldest"})  // NOLINT(whitespace/braces)
+  {
+    MySensor sensor;
+    TransactionRecorder recorder;
+    ros::CallbackQueue queue;
+    initializeShedding(sensor, "keep_variables_" + policy + "_sensor", policy, recorder, queue);
+
+    // Every other transaction adds a variable. Those are never shed, even though the optimizer is overloaded.
+    sensor.backpressureCallback(4.0);
+    std::vector<fuse_core::Transaction::SharedPtr> variable_transactions;
+    for (int i = 0; i < 5; ++i)
+    {
+      auto transaction = fuse_core::Transaction::make_shared();
+      if (i % 2 == 1)
+      {
+        transaction->addVariable(ExampleVariable::make_shared());
+        variable_transactions.push_back(transaction);
+      }
+      sensor.injectCallback({ros::Time(i + 1, 0)}, transaction);  // NOLINT
+    }
+    queue.callAvailable();
+
+    // The transactions adding variables are received as sent and in order, and the order of all received
+    // transactions is preserved
+    std::vector<fuse_core::Transaction::SharedPtr> received_variable_transactions;
+    for (const auto& transaction : recorder.received_transactions)
+    {
+      if (!transaction->addedVariables().empty())
+      {
+        received_variable_transactions.push_back(transaction);
+      }
+    }
+    EXPECT_EQ(variable_transactions, received_variable_transactions) << "Policy: " << policy;
+    for (size_t i = 1; i < recorder.received_stamps.size(); ++i)
+    {
+      EXPECT_LT(*recorder.received_stamps[i - 1].rbegin(), *recorder.received_stamps[i].begin())
+        << "Policy: " << policy;
+    }
+  }
+}
+
+TEST(AsyncSensorModel, SheddingInvalidPolicy)
+{
+  MySensor sensor;
+  TransactionRecorder recorder;
+  ros::CallbackQueue queue;
+  EXPECT_THROW(initializeShedding(sensor, "invalid_sensor", "bogus", recorder, queue), std::invalid_argument);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
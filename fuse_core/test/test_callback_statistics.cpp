@@ -0,0 +1,172 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/callback_statistics.h>
+#include <fuse_core/callback_wrapper.h>
+#include <ros/callback_queue_interface.h>
+
+#include <boost/make_shared.hpp>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @brief A minimal callback queue that holds the callbacks until they are explicitly executed
+ */
+class TestCallbackQueue : public ros::CallbackQueueInterface
+{
+public:
+  void addCallback(const ros::CallbackInterfacePtr& callback, uint64_t /* removal_id */ = 0) override
+  {
+    callbacks.push_back(callback);
+  }
+
+  void removeByID(uint64_t /* removal_id */) override {}
+
+  void callAll()
+  {
+    for (const auto& callback : callbacks)
+    {
+      callback->call();
+    }
+    callbacks.clear();
+  }
+
+  std::vector<ros::CallbackInterfacePtr> callbacks;
+};
+
+/**
+ * @brief A callback that was cancelled before it could do any work
+ */
+class CancelledCallback : public ros::CallbackInterface
+{
+public:
+  CallResult call() override
+  {
+    return Invalid;
+  }
+};
+
+TEST(CallbackStatistics, Empty)
+{
+  fuse_core::CallbackStatistics statistics;
+  EXPECT_TRUE(statistics.summarize().empty());
+}
+
+TEST(CallbackStatistics, QueueDepth)
+{
+  fuse_core::CallbackStatistics statistics;
+  TestCallbackQueue queue;
+
+  // Schedule a few callbacks under two different names
+  int call_count = 0;
+  auto increment = [&call_count]() { ++call_count; };  // NOLINT
+  statistics.addCallback("first", boost::make_shared<fuse_core::CallbackWrapper<void>>(increment), queue);
+  statistics.addCallback("first", boost::make_shared<fuse_core::CallbackWrapper<void>>(increment), queue);
+  statistics.addCallback("second", boost::make_shared<fuse_core::CallbackWrapper<void>>(increment), queue);
+  ASSERT_EQ(3u, queue.callbacks.size());
+
+  // Nothing has been executed yet. The summaries are sorted by name.
+  auto summaries = statistics.summarize();
+  ASSERT_EQ(2u, summaries.size());
+  EXPECT_EQ("first", summaries[0].callback);
+  EXPECT_EQ(0u, summaries[0].executed);
+  EXPECT_EQ(2u, summaries[0].queue_depth);
+  EXPECT_EQ(2u, summaries[0].max_queue_depth);
+  EXPECT_EQ("second", summaries[1].callback);
+  EXPECT_EQ(1u, summaries[1].queue_depth);
+
+  // Execute the callbacks. The wrapped callbacks are called, and the queue depth returns to zero.
+  queue.callAll();
+  EXPECT_EQ(3, call_count);
+  summaries = statistics.summarize();
+  ASSERT_EQ(2u, summaries.size());
+  EXPECT_EQ(2u, summaries[0].executed);
+  EXPECT_EQ(0u, summaries[0].queue_depth);
+  EXPECT_EQ(2u, summaries[0].max_queue_depth);
+  EXPECT_LE(summaries[0].mean_latency, summaries[0].max_latency);
+  EXPECT_LE(summaries[0].mean_execution_time, summaries[0].max_execution_time);
+  EXPECT_EQ(1u, summaries[1].executed);
+  EXPECT_EQ(0u, summaries[1].queue_depth);
+}
+
+TEST(CallbackStatistics, ReturnValue)
+{
+  // The instrumented callback must not interfere with the future of the wrapped callback
+  fuse_core::CallbackStatistics statistics;
+  TestCallbackQueue queue;
+  auto callback = boost::make_shared<fuse_core::CallbackWrapper<int>>([]() { return 42; });  // NOLINT
+  auto result = callback->getFuture();
+  statistics.addCallback("answer", callback, queue);
+  queue.callAll();
+  EXPECT_EQ(42, result.get());
+}
+
+TEST(CallbackStatistics, Discarded)
+{
+  fuse_core::CallbackStatistics statistics;
+  TestCallbackQueue queue;
+
+  // A cancelled callback leaves the queue without being counted as an execution
+  statistics.addCallback("cancelled", boost::make_shared<CancelledCallback>(), queue);
+  queue.callAll();
+  auto summaries = statistics.summarize();
+  ASSERT_EQ(1u, summaries.size());
+  EXPECT_EQ(0u, summaries[0].executed);
+  EXPECT_EQ(0u, summaries[0].queue_depth);
+  EXPECT_EQ(1u, summaries[0].max_queue_depth);
+
+  // Callbacks dropped by the queue without being called are removed from the queue depth
+  int call_count = 0;
+  auto increment = [&call_count]() { ++call_count; };  // NOLINT
+  statistics.addCallback("dropped", boost::make_shared<fuse_core::CallbackWrapper<void>>(increment), queue);
+  statistics.addCallback("dropped", boost::make_shared<fuse_core::CallbackWrapper<void>>(increment), queue);
+  summaries = statistics.summarize();
+  ASSERT_EQ(2u, summaries.size());
+  EXPECT_EQ(2u, summaries[1].queue_depth);
+  queue.callbacks.clear();
+  summaries = statistics.summarize();
+  ASSERT_EQ(2u, summaries.size());
+  EXPECT_EQ(0, call_count);
+  EXPECT_EQ(0u, summaries[1].executed);
+  EXPECT_EQ(0u, summaries[1].queue_depth);
+  EXPECT_EQ(2u, summaries[1].max_queue_depth);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
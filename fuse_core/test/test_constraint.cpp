@@ -31,14 +31,86 @@
  *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  *  POSSIBILITY OF SUCH DAMAGE.
  */
+#include <fuse_core/eigen.h>
+#include <fuse_core/measurement_key.h>
 #include <fuse_core/uuid.h>
 #include <test/example_constraint.h>
 
+#include <ceres/sized_cost_function.h>
 #include <gtest/gtest.h>
 
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 
+/**
+ * @brief Constraint implementation that opts into content-addressed UUIDs
+ */
+class ContentConstraint : public ExampleConstraint
+{
+public:
+  ContentConstraint(const fuse_core::UUID& variable_uuid1, const fuse_core::UUID& variable_uuid2, double measurement) :
+    ExampleConstraint("ContentConstraint", {variable_uuid1, variable_uuid2}, fuse_core::measurementKey(measurement))
+  {
+  }
+};
+
+/**
+ * @brief A one-dimensional prior, r = x - measurement
+ */
+class PriorCostFunction : public ceres::SizedCostFunction<1, 1>
+{
+public:
+  explicit PriorCostFunction(double measurement) :
+    measurement_(measurement)
+  {
+  }
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    residuals[0] = parameters[0][0] - measurement_;
+    if (jacobians && jacobians[0])
+    {
+      jacobians[0][0] = 1.0;
+    }
+    return true;
+  }
+
+private:
+  double measurement_;
+};
+
+/**
+ * @brief Constraint implementation that counts the number of cost functions it creates
+ */
+class PriorConstraint : public ExampleConstraint
+{
+public:
+  SMART_PTR_DEFINITIONS(PriorConstraint);
+
+  PriorConstraint(std::initializer_list<fuse_core::UUID> variable_uuid_list, double measurement) :
+    ExampleConstraint(variable_uuid_list),
+    measurement(measurement),
+    cost_function_count(std::make_shared<int>(0))
+  {
+  }
+
+  ceres::CostFunction* costFunction() const override
+  {
+    ++(*cost_function_count);
+    return new PriorCostFunction(measurement);
+  }
+
+  fuse_core::Constraint::UniquePtr clone() const override { return PriorConstraint::make_unique(*this); }
+
+  double measurement;
+  std::shared_ptr<int> cost_function_count;
+};
+
+
 TEST(Constraint, Constructor)
 {
   // Create a constraint with a single UUID
@@ -97,6 +169,102 @@ TEST(Constraint, Type)
   ASSERT_EQ("ExampleConstraint", constraint.type());
 }
 
+TEST(Constraint, ContentAddressedUuid)
+{
+  // Identical measurements produce identical UUIDs
+  fuse_core::UUID variable_uuid1 = fuse_core::uuid::generate();
+  fuse_core::UUID variable_uuid2 = fuse_core::uuid::generate();
+  ContentConstraint constraint1(variable_uuid1, variable_uuid2, 1.5);
+  ContentConstraint constraint2(variable_uuid1, variable_uuid2, 1.5);
+  EXPECT_EQ(constraint1.uuid(), constraint2.uuid());
+
+  // Changing the measurement, the variables, or the variable order produces a different UUID
+  EXPECT_NE(constraint1.uuid(), ContentConstraint(variable_uuid1, variable_uuid2, 2.5).uuid());
+  EXPECT_NE(constraint1.uuid(), ContentConstraint(variable_uuid1, fuse_core::uuid::generate(), 1.5).uuid());
+  EXPECT_NE(constraint1.uuid(), ContentConstraint(variable_uuid2, variable_uuid1, 1.5).uuid());
+
+  // So does changing the constraint type
+  ExampleConstraint other_type("OtherConstraint", {variable_uuid1, variable_uuid2}, fuse_core::measurementKey(1.5));
+  EXPECT_NE(constraint1.uuid(), other_type.uuid());
+
+  // Constraints that do not opt in still receive random UUIDs
+  EXPECT_NE(ExampleConstraint{variable_uuid1}.uuid(), ExampleConstraint{variable_uuid1}.uuid());
+}
+
+TEST(Constraint, MeasurementKey)
+{
+  // Keys depend on the values of the matrix, not on its storage order
+  fuse_core::Matrix2d row_major;
+  row_major << 1.0, 2.0, 3.0, 4.0;
+  Eigen::Matrix2d column_major = row_major;
+  EXPECT_EQ(fuse_core::measurementKey(row_major), fuse_core::measurementKey(column_major));
+
+  // The shape of each argument is part of the key
+  fuse_core::Vector2d column;
+  column << 1.0, 2.0;
+  EXPECT_NE(fuse_core::measurementKey(column), fuse_core::measurementKey(column.transpose()));
+  std::vector<size_t> indices1 = {0, 1};
+  std::vector<size_t> indices2 = {0};
+  std::vector<size_t> indices3 = {1};
+  EXPECT_NE(fuse_core::measurementKey(indices1, indices2), fuse_core::measurementKey(indices2, indices1));
+  EXPECT_NE(fuse_core::measurementKey(indices2, indices3), fuse_core::measurementKey(indices3, indices2));
+}
+
+TEST(Constraint, Prepare)
+{
+  fuse_core::UUID variable_uuid = fuse_core::uuid::generate();
+  PriorConstraint constraint({variable_uuid}, 3.0);  // NOLINT(whitespace/braces)
+  EXPECT_FALSE(constraint.prepared());
+
+  // Without prepare(), a new cost function is created for every call
+  delete constraint.preparedCostFunction();
+  delete constraint.preparedCostFunction();
+  EXPECT_EQ(2, *constraint.cost_function_count);
+
+  // After prepare(), the cost function is created once and shared
+  constraint.prepare();
+  constraint.prepare();
+  EXPECT_TRUE(constraint.prepared());
+  EXPECT_EQ(3, *constraint.cost_function_count);
+  std::unique_ptr<ceres::CostFunction> cost_function(constraint.preparedCostFunction());
+  EXPECT_EQ(3, *constraint.cost_function_count);
+  ASSERT_EQ(1, cost_function->num_residuals());
+  ASSERT_EQ(1u, cost_function->parameter_block_sizes().size());
+  EXPECT_EQ(1, cost_function->parameter_block_sizes()[0]);
+
+  // The shared cost function evaluates the prepared one
+  double x = 5.0;
+  double* parameters[] = {&x};  // NOLINT(whitespace/braces)
+  double residual = 0.0;
+  double jacobian = 0.0;
+  double* jacobians[] = {&jacobian};  // NOLINT(whitespace/braces)
+  ASSERT_TRUE(cost_function->Evaluate(parameters, &residual, jacobians));
+  EXPECT_EQ(2.0, residual);
+  EXPECT_EQ(1.0, jacobian);
+
+  // Copies share the prepared cost function, and it outlives the original constraint
+  auto copy = constraint.clone();
+  EXPECT_TRUE(copy->prepared());
+  cost_function.reset();
+  cost_function.reset(copy->preparedCostFunction());
+  EXPECT_EQ(3, *constraint.cost_function_count);
+}
+
+TEST(Constraint, PrepareInvalid)
+{
+  // A cost function must exist
+  fuse_core::UUID variable_uuid1 = fuse_core::uuid::generate();
+  ExampleConstraint missing{variable_uuid1};
+  EXPECT_THROW(missing.prepare(), std::logic_error);
+  EXPECT_FALSE(missing.prepared());
+
+  // The cost function must have one parameter block per variable
+  fuse_core::UUID variable_uuid2 = fuse_core::uuid::generate();
+  PriorConstraint mismatched({variable_uuid1, variable_uuid2}, 3.0);  // NOLINT(whitespace/braces)
+  EXPECT_THROW(mismatched.prepare(), std::logic_error);
+  EXPECT_FALSE(mismatched.prepared());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,229 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/spatial_index.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief A position variable with two or three dimensions
+ */
+class ExamplePosition : public fuse_core::Variable
+{
+public:
+  SMART_PTR_DEFINITIONS(ExamplePosition);
+
+  explicit ExamplePosition(const std::vector<double>& position) :
+    data_(position),
+    uuid_(fuse_core::uuid::generate())
+  {
+  }
+
+  fuse_core::UUID uuid() const override { return uuid_; }
+  size_t size() const override { return data_.size(); }
+  const double* data() const override { return data_.data(); };
+  double* data() override { return data_.data(); };
+  void print(std::ostream& stream = std::cout) const override {}
+  fuse_core::Variable::UniquePtr clone() const override { return ExamplePosition::make_unique(*this); }
+
+private:
+  std::vector<double> data_;
+  fuse_core::UUID uuid_;
+};
+
+/**
+ * @brief A variable type that is not indexed
+ */
+class ExampleVelocity : public ExamplePosition
+{
+public:
+  using ExamplePosition::ExamplePosition;
+};
+
+/**
+ * @brief Sort the query result so it can be compared against the expected UUIDs
+ */
+std::vector<fuse_core::UUID> sorted(std::vector<fuse_core::UUID> uuids)
+{
+  std::sort(uuids.begin(), uuids.end());
+  return uuids;
+}
+
+TEST(SpatialIndex, Constructor)
+{
+  EXPECT_THROW(fuse_core::SpatialIndex(0.0), std::invalid_argument);
+  EXPECT_THROW(fuse_core::SpatialIndex(-1.0), std::invalid_argument);
+
+  // Without any registered types, nothing is indexed
+  EXPECT_TRUE(fuse_core::SpatialIndex().variableTypes().empty());
+
+  fuse_core::SpatialIndex index(2.5, {"ExamplePosition"});  // NOLINT
+  EXPECT_EQ(2.5, index.cellSize());
+  EXPECT_EQ(std::vector<std::string>({"ExamplePosition"}), index.variableTypes());  // NOLINT
+  EXPECT_EQ(0u, index.size());
+}
+
+TEST(SpatialIndex, InsertRemove)
+{
+  fuse_core::SpatialIndex index(1.0, {"ExamplePosition"});  // NOLINT
+  auto position = ExamplePosition::make_shared(std::vector<double>{1.0, 2.0});  // NOLINT
+  auto velocity = std::make_shared<ExampleVelocity>(std::vector<double>{1.0, 2.0});  // NOLINT
+
+  EXPECT_TRUE(index.insert(position));
+  EXPECT_FALSE(index.insert(position));
+  EXPECT_FALSE(index.insert(velocity));
+  EXPECT_FALSE(index.insert(nullptr));
+  EXPECT_EQ(1u, index.size());
+  EXPECT_TRUE(index.contains(position->uuid()));
+  EXPECT_FALSE(index.contains(velocity->uuid()));
+
+  EXPECT_TRUE(index.remove(position->uuid()));
+  EXPECT_FALSE(index.remove(position->uuid()));
+  EXPECT_EQ(0u, index.size());
+  EXPECT_TRUE(index.query(1.0, 2.0, 10.0).empty());
+}
+
+TEST(SpatialIndex, Query2D)
+{
+  fuse_core::SpatialIndex index(1.0, {"ExamplePosition"});  // NOLINT
+  auto p1 = ExamplePosition::make_shared(std::vector<double>{0.0, 0.0});  // NOLINT
+  auto p2 = ExamplePosition::make_shared(std::vector<double>{1.5, 0.0});  // NOLINT
+  auto p3 = ExamplePosition::make_shared(std::vector<double>{-3.0, 4.0});  // NOLINT
+  auto p4 = ExamplePosition::make_shared(std::vector<double>{100.0, -100.0});  // NOLINT
+  auto p5 = ExamplePosition::make_shared(std::vector<double>{0.5, 0.5, 20.0});  // NOLINT
+  for (const auto& position : {p1, p2, p3, p4, p5})
+  {
+    index.insert(position);
+  }
+
+  // Three-dimensional positions are compared at z = 0 by the two-dimensional query
+  EXPECT_EQ(sorted({p1->uuid(), p5->uuid()}), sorted(index.query(0.0, 0.0, 1.0)));  // NOLINT
+  EXPECT_EQ(sorted({p1->uuid(), p2->uuid(), p5->uuid()}), sorted(index.query(0.0, 0.0, 1.5)));  // NOLINT
+  EXPECT_EQ(sorted({p1->uuid(), p2->uuid(), p3->uuid(), p5->uuid()}), sorted(index.query(0.0, 0.0, 5.0)));  // NOLINT
+  EXPECT_EQ(sorted({p4->uuid()}), sorted(index.query(100.0, -100.0, 0.0)));  // NOLINT
+  EXPECT_EQ(5u, index.query(0.0, 0.0, 1000.0).size());
+  EXPECT_TRUE(index.query(50.0, 50.0, 1.0).empty());
+  EXPECT_TRUE(index.query(0.0, 0.0, -1.0).empty());
+}
+
+TEST(SpatialIndex, Query2DLayers)
+{
+  // Fill a dense 5x5 block of cells, so the two-dimensional query visits the cells of the bounding box in each layer
+  fuse_core::SpatialIndex index(1.0, {"ExamplePosition"});  // NOLINT
+  std::vector<fuse_core::UUID> expected;
+  for (int i = -2; i <= 2; ++i)
+  {
+    for (int j = -2; j <= 2; ++j)
+    {
+      auto position = ExamplePosition::make_shared(std::vector<double>{i + 0.0, j + 0.0});  // NOLINT
+      index.insert(position);
+      if (std::abs(i) + std::abs(j) <= 1)
+      {
+        expected.push_back(position->uuid());
+      }
+    }
+  }
+  auto p1 = ExamplePosition::make_shared(std::vector<double>{0.5, 0.5, 20.0});  // NOLINT
+  index.insert(p1);
+  expected.push_back(p1->uuid());
+  EXPECT_EQ(sorted(expected), sorted(index.query(0.0, 0.0, 1.0)));
+
+  // Moving the variable to a different layer is tracked by refresh()
+  p1->data()[2] = -5.0;
+  index.refresh();
+  EXPECT_EQ(sorted(expected), sorted(index.query(0.0, 0.0, 1.0)));
+
+  // The layer is no longer visited once its last variable is removed
+  EXPECT_TRUE(index.remove(p1->uuid()));
+  expected.pop_back();
+  EXPECT_EQ(sorted(expected), sorted(index.query(0.0, 0.0, 1.0)));
+}
+
+TEST(SpatialIndex, Query3D)
+{
+  fuse_core::SpatialIndex index(2.0, {"ExamplePosition"});  // NOLINT
+  auto p1 = ExamplePosition::make_shared(std::vector<double>{0.0, 0.0, 0.0});  // NOLINT
+  auto p2 = ExamplePosition::make_shared(std::vector<double>{0.0, 0.0, 3.0});  // NOLINT
+  auto p3 = ExamplePosition::make_shared(std::vector<double>{1.0, 1.0});  // NOLINT
+  for (const auto& position : {p1, p2, p3})
+  {
+    index.insert(position);
+  }
+
+  EXPECT_EQ(sorted({p1->uuid(), p3->uuid()}), sorted(index.query(0.0, 0.0, 0.0, 2.0)));  // NOLINT
+  EXPECT_EQ(sorted({p2->uuid()}), sorted(index.query(0.0, 0.0, 3.5, 1.0)));  // NOLINT
+  EXPECT_EQ(sorted({p1->uuid(), p2->uuid(), p3->uuid()}), sorted(index.query(0.0, 0.0, 1.5, 2.5)));  // NOLINT
+  EXPECT_EQ(3u, index.query(0.0, 0.0, 0.0, 1000.0).size());
+}
+
+TEST(SpatialIndex, Refresh)
+{
+  fuse_core::SpatialIndex index(1.0, {"ExamplePosition"});  // NOLINT
+  auto p1 = ExamplePosition::make_shared(std::vector<double>{0.0, 0.0});  // NOLINT
+  auto p2 = ExamplePosition::make_shared(std::vector<double>{0.0, 0.0});  // NOLINT
+  index.insert(p1);
+  index.insert(p2);
+
+  // The index does not see the new values until it is refreshed
+  p1->data()[0] = 10.0;
+  p2->data()[1] = 10.0;
+  EXPECT_EQ(2u, index.query(0.0, 0.0, 1.0).size());
+
+  index.refresh(p1->uuid());
+  EXPECT_EQ(sorted({p1->uuid()}), sorted(index.query(10.0, 0.0, 1.0)));  // NOLINT
+  EXPECT_EQ(sorted({p2->uuid()}), sorted(index.query(0.0, 0.0, 1.0)));  // NOLINT
+
+  index.refresh();
+  EXPECT_EQ(sorted({p2->uuid()}), sorted(index.query(0.0, 10.0, 1.0)));  // NOLINT
+  EXPECT_TRUE(index.query(0.0, 0.0, 1.0).empty());
+
+  // Removal still works after a variable moves between cells
+  EXPECT_TRUE(index.remove(p2->uuid()));
+  EXPECT_TRUE(index.query(0.0, 10.0, 1.0).empty());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
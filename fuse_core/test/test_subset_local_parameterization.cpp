@@ -0,0 +1,147 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/subset_local_parameterization.h>
+
+#include <ceres/local_parameterization.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+/**
+ * @brief A simple parameterization with three global and two tangent-space dimensions
+ *
+ * x_plus_delta = x + [d0, d1, d0 + d1]
+ */
+class ExampleParameterization : public ceres::LocalParameterization
+{
+public:
+  bool Plus(const double* x, const double* delta, double* x_plus_delta) const override
+  {
+    x_plus_delta[0] = x[0] + delta[0];
+    x_plus_delta[1] = x[1] + delta[1];
+    x_plus_delta[2] = x[2] + delta[0] + delta[1];
+    return true;
+  }
+
+  bool ComputeJacobian(const double* x, double* jacobian) const override
+  {
+    jacobian[0] = 1.0; jacobian[1] = 0.0;
+    jacobian[2] = 0.0; jacobian[3] = 1.0;
+    jacobian[4] = 1.0; jacobian[5] = 1.0;
+    return true;
+  }
+
+  int GlobalSize() const override { return 3; }
+  int LocalSize() const override { return 2; }
+};
+
+/**
+ * @brief An identity parameterization larger than the SubsetLocalParameterization supports
+ */
+class OversizedParameterization : public ceres::LocalParameterization
+{
+public:
+  static constexpr int SIZE = fuse_core::SubsetLocalParameterization::MAX_LOCAL_SIZE + 1;
+
+  bool Plus(const double* x, const double* delta, double* x_plus_delta) const override
+  {
+    for (int i = 0; i < SIZE; ++i)
+    {
+      x_plus_delta[i] = x[i] + delta[i];
+    }
+    return true;
+  }
+
+  bool ComputeJacobian(const double* x, double* jacobian) const override
+  {
+    std::fill(jacobian, jacobian + SIZE * SIZE, 0.0);
+    for (int i = 0; i < SIZE; ++i)
+    {
+      jacobian[i * SIZE + i] = 1.0;
+    }
+    return true;
+  }
+
+  int GlobalSize() const override { return SIZE; }
+  int LocalSize() const override { return SIZE; }
+};
+
+TEST(SubsetLocalParameterization, Constructor)
+{
+  EXPECT_THROW(fuse_core::SubsetLocalParameterization(nullptr, {0}), std::invalid_argument);  // NOLINT
+  EXPECT_THROW(fuse_core::SubsetLocalParameterization(new ExampleParameterization(), {2}),  // NOLINT
+               std::invalid_argument);
+  EXPECT_THROW(fuse_core::SubsetLocalParameterization(new ExampleParameterization(), {0, 1}),  // NOLINT
+               std::invalid_argument);
+  EXPECT_THROW(fuse_core::SubsetLocalParameterization(new OversizedParameterization(), {0}),  // NOLINT
+               std::invalid_argument);
+
+  fuse_core::SubsetLocalParameterization parameterization(new ExampleParameterization(), {0});  // NOLINT
+  EXPECT_EQ(3, parameterization.GlobalSize());
+  EXPECT_EQ(1, parameterization.LocalSize());
+}
+
+TEST(SubsetLocalParameterization, Plus)
+{
+  // Hold the first tangent-space dimension. Only the second dimension is updated.
+  fuse_core::SubsetLocalParameterization parameterization(new ExampleParameterization(), {0});  // NOLINT
+  const std::vector<double> x = {1.0, 2.0, 3.0};  // NOLINT
+  const std::vector<double> delta = {0.5};  // NOLINT
+  std::vector<double> x_plus_delta(3);
+  EXPECT_TRUE(parameterization.Plus(x.data(), delta.data(), x_plus_delta.data()));
+  EXPECT_DOUBLE_EQ(1.0, x_plus_delta[0]);
+  EXPECT_DOUBLE_EQ(2.5, x_plus_delta[1]);
+  EXPECT_DOUBLE_EQ(3.5, x_plus_delta[2]);
+}
+
+TEST(SubsetLocalParameterization, ComputeJacobian)
+{
+  // Hold the second tangent-space dimension. The Jacobian keeps only the first column.
+  fuse_core::SubsetLocalParameterization parameterization(new ExampleParameterization(), {1});  // NOLINT
+  const std::vector<double> x = {1.0, 2.0, 3.0};  // NOLINT
+  std::vector<double> jacobian(3);
+  EXPECT_TRUE(parameterization.ComputeJacobian(x.data(), jacobian.data()));
+  EXPECT_DOUBLE_EQ(1.0, jacobian[0]);
+  EXPECT_DOUBLE_EQ(0.0, jacobian[1]);
+  EXPECT_DOUBLE_EQ(1.0, jacobian[2]);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
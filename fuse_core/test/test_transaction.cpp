@@ -31,6 +31,7 @@
  *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  *  POSSIBILITY OF SUCH DAMAGE.
  */
+#include <fuse_core/measurement_key.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
 #include <test/example_constraint.h>
@@ -349,6 +350,13 @@ TEST(Transaction, AddConstraint)
       EXPECT_TRUE(testAddedConstraints(expected_constraints, transaction));
     }
   }
+
+  // Add an empty pointer. Verify it is ignored.
+  {
+    Transaction transaction;
+    transaction.addConstraint(ExampleConstraint::SharedPtr());
+    EXPECT_TRUE(transaction.addedConstraints().empty());
+  }
 }
 
 TEST(Transaction, RemoveConstraint)
@@ -527,6 +535,13 @@ TEST(Transaction, AddVariable)
       EXPECT_TRUE(testAddedVariables(expected_variables, transaction));
     }
   }
+
+  // Add an empty pointer. Verify it is ignored.
+  {
+    Transaction transaction;
+    transaction.addVariable(ExampleVariable::SharedPtr());
+    EXPECT_TRUE(transaction.addedVariables().empty());
+  }
 }
 
 TEST(Transaction, RemoveVariable)
@@ -666,6 +681,31 @@ TEST(Transaction, Merge)
   EXPECT_TRUE(testRemovedVariables(expected_removed_variables, transaction1));
 }
 
+TEST(Transaction, MergeDuplicateMeasurements)
+{
+  // Two separately constructed copies of the same measurement share a content-addressed UUID. Merging the
+  // transactions keeps only one of them.
+  UUID variable_uuid = fuse_core::uuid::generate();
+  auto create_constraint = [&variable_uuid](double measurement)  // NOLINT(whitespace/braces)
+  {
+    return ExampleConstraint::make_shared(
+      "ExampleConstraint",
+      std::initializer_list<UUID>{variable_uuid},  // NOLINT(whitespace/braces)
+      fuse_core::measurementKey(measurement));
+  };
+  auto constraint1 = create_constraint(1.0);
+  auto constraint2 = create_constraint(1.0);
+  auto constraint3 = create_constraint(2.0);
+
+  Transaction transaction1;
+  transaction1.addConstraint(constraint1);
+  Transaction transaction2;
+  transaction2.addConstraint(constraint2);
+  transaction2.addConstraint(constraint3);
+  transaction1.merge(transaction2);
+  EXPECT_TRUE(testAddedConstraints({constraint1, constraint3}, transaction1));  // NOLINT
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,134 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable_archive.h>
+#include <ros/time.h>
+#include <test/example_variable.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+
+TEST(VariableArchive, Append)
+{
+  fuse_core::VariableArchive archive;
+  EXPECT_TRUE(archive.empty());
+
+  ExampleVariable variable1;
+  variable1.data()[0] = 1.0;
+  ExampleVariable variable2;
+  variable2.data()[0] = 2.0;
+  auto device_id = fuse_core::uuid::generate("robot");
+  archive.append(variable1, ros::Time(10, 0), device_id);
+  archive.append(variable2, ros::Time(11, 0), device_id, {4.0});  // NOLINT
+  EXPECT_FALSE(archive.empty());
+  EXPECT_EQ(2u, archive.size());
+
+  // Changing the variable after it is archived does not change the archived value
+  variable1.data()[0] = 5.0;
+
+  auto entries = archive.query(variable1.type(), device_id);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(variable1.uuid(), entries[0].uuid);
+  EXPECT_EQ("ExampleVariable", entries[0].type);
+  EXPECT_EQ(ros::Time(10, 0), entries[0].stamp);
+  EXPECT_EQ(device_id, entries[0].device_id);
+  ASSERT_EQ(1u, entries[0].data.size());
+  EXPECT_EQ(1.0, entries[0].data[0]);
+  EXPECT_TRUE(entries[0].covariance.empty());
+  EXPECT_EQ(variable2.uuid(), entries[1].uuid);
+  EXPECT_EQ(ros::Time(11, 0), entries[1].stamp);
+  ASSERT_EQ(1u, entries[1].data.size());
+  EXPECT_EQ(2.0, entries[1].data[0]);
+  ASSERT_EQ(1u, entries[1].covariance.size());
+  EXPECT_EQ(4.0, entries[1].covariance[0]);
+
+  // The covariance must match the variable size
+  EXPECT_THROW(archive.append(variable1, ros::Time(12, 0), device_id, {1.0, 2.0}), std::invalid_argument);  // NOLINT
+  EXPECT_EQ(2u, archive.size());
+}
+
+TEST(VariableArchive, Query)
+{
+  fuse_core::VariableArchive archive;
+  auto robot1 = fuse_core::uuid::generate("robot1");
+  auto robot2 = fuse_core::uuid::generate("robot2");
+  std::vector<ExampleVariable> variables(6);
+  for (size_t i = 0; i < variables.size(); ++i)
+  {
+    variables[i].data()[0] = static_cast<double>(i);
+    archive.append(variables[i], ros::Time(10 + i / 2, 0), (i % 2 == 0) ? robot1 : robot2);
+  }
+
+  // Unknown types and devices return nothing
+  EXPECT_TRUE(archive.query("UnknownVariable", robot1).empty());
+  EXPECT_TRUE(archive.query("ExampleVariable", fuse_core::uuid::generate("robot3")).empty());
+
+  // All entries of a single device
+  auto entries = archive.query("ExampleVariable", robot2);
+  ASSERT_EQ(3u, entries.size());
+  EXPECT_EQ(variables[1].uuid(), entries[0].uuid);
+  EXPECT_EQ(variables[3].uuid(), entries[1].uuid);
+  EXPECT_EQ(variables[5].uuid(), entries[2].uuid);
+  EXPECT_EQ(5.0, entries[2].data[0]);
+
+  // The time range is inclusive
+  entries = archive.query("ExampleVariable", robot1, ros::Time(11, 0), ros::Time(12, 0));
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(variables[2].uuid(), entries[0].uuid);
+  EXPECT_EQ(variables[4].uuid(), entries[1].uuid);
+
+  entries = archive.query("ExampleVariable", robot1, ros::Time(10, 500), ros::Time(10, 999));
+  EXPECT_TRUE(entries.empty());
+
+  // The position range is half-open, and positions beyond the end of the archive are ignored
+  entries = archive.query("ExampleVariable", robot2, 3u, 10u);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(variables[3].uuid(), entries[0].uuid);
+  EXPECT_EQ(variables[5].uuid(), entries[1].uuid);
+
+  entries = archive.query("ExampleVariable", robot2, 0u, 3u);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(variables[1].uuid(), entries[0].uuid);
+
+  EXPECT_TRUE(archive.query("ExampleVariable", robot1, 6u, 6u).empty());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,190 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @brief Remove every constraint attached to a single, highly-connected variable
+ *
+ * A set of "hub" variables, such as a calibration or landmark variable, may be referenced by a large number of
+ * constraints. The cost of removing a single constraint should not depend on the number of other constraints that
+ * share the same variable.
+ */
+static void BM_removeConstraintHighDegree(benchmark::State& state)
+{
+  const auto constraint_count = static_cast<size_t>(state.range(0));
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    fuse_graphs::HashGraph graph;
+    auto hub = ExampleVariable::make_shared();
+    graph.addVariable(hub);
+    std::vector<fuse_core::UUID> constraint_uuids;
+    constraint_uuids.reserve(constraint_count);
+    for (size_t i = 0; i < constraint_count; ++i)
+    {
+      auto constraint = ExampleConstraint::make_shared(hub->uuid());
+      graph.addConstraint(constraint);
+      constraint_uuids.push_back(constraint->uuid());
+    }
+    state.ResumeTiming();
+
+    // Remove the constraints oldest-first, the typical pattern when the graph is used as a sliding window
+    for (const auto& constraint_uuid : constraint_uuids)
+    {
+      graph.removeConstraint(constraint_uuid);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_removeConstraintHighDegree)->RangeMultiplier(4)->Range(64, 16384)->Complexity();
+
+/**
+ * @brief Add a constraint to, and remove a constraint from, a variable that is already highly-connected
+ */
+static void BM_replaceConstraintHighDegree(benchmark::State& state)
+{
+  const auto constraint_count = static_cast<size_t>(state.range(0));
+  fuse_graphs::HashGraph graph;
+  auto hub = ExampleVariable::make_shared();
+  graph.addVariable(hub);
+  std::vector<fuse_core::UUID> constraint_uuids;
+  for (size_t i = 0; i < constraint_count; ++i)
+  {
+    auto constraint = ExampleConstraint::make_shared(hub->uuid());
+    graph.addConstraint(constraint);
+    constraint_uuids.push_back(constraint->uuid());
+  }
+
+  size_t next = 0;
+  for (auto _ : state)
+  {
+    // Remove an arbitrary existing constraint and add a new one in its place, keeping the variable degree constant
+    auto constraint = ExampleConstraint::make_shared(hub->uuid());
+    graph.removeConstraint(constraint_uuids[next]);
+    graph.addConstraint(constraint);
+    constraint_uuids[next] = constraint->uuid();
+    next = (next + 7919) % constraint_count;
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_replaceConstraintHighDegree)->RangeMultiplier(4)->Range(64, 16384)->Complexity();
+
+/**
+ * @brief Create a transaction containing a chain of variables, each with a few attached constraints
+ */
+fuse_core::Transaction createLargeTransaction(size_t variable_count)
+{
+  fuse_core::Transaction transaction;
+  for (size_t i = 0; i < variable_count; ++i)
+  {
+    auto variable = ExampleVariable::make_shared();
+    transaction.addVariable(variable);
+    for (size_t j = 0; j < 3; ++j)
+    {
+      transaction.addConstraint(ExampleConstraint::make_shared(variable->uuid()));
+    }
+  }
+  return transaction;
+}
+
+/**
+ * @brief Apply a large transaction to an empty graph using HashGraph's bulk update
+ */
+static void BM_updateLargeTransaction(benchmark::State& state)
+{
+  const auto transaction = createLargeTransaction(state.range(0));
+  for (auto _ : state)
+  {
+    fuse_graphs::HashGraph graph;
+    graph.update(transaction);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_updateLargeTransaction)->RangeMultiplier(8)->Range(64, 4096);
+
+/**
+ * @brief Apply a large transaction to an empty graph one element at a time, for comparison
+ */
+static void BM_updateLargeTransactionSequential(benchmark::State& state)
+{
+  const auto transaction = createLargeTransaction(state.range(0));
+  for (auto _ : state)
+  {
+    fuse_graphs::HashGraph graph;
+    graph.fuse_core::Graph::update(transaction);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_updateLargeTransactionSequential)->RangeMultiplier(8)->Range(64, 4096);
+
+/**
+ * @brief Deep copy a large graph using a varying number of threads
+ *
+ * The benchmark arguments are the number of variables in the graph and the number of copy threads. The time to
+ * destroy the copy is included in the measurement.
+ */
+static void BM_copy(benchmark::State& state)
+{
+  fuse_graphs::HashGraph graph(ceres::Problem::Options(), state.range(1));
+  for (int64_t i = 0; i < state.range(0); ++i)
+  {
+    auto variable = ExampleVariable::make_shared();
+    graph.addVariable(variable);
+    graph.addConstraint(ExampleConstraint::make_shared(variable->uuid()));
+  }
+  for (auto _ : state)
+  {
+    fuse_graphs::HashGraph copy(graph);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_copy)
+  ->Args({65536, 1})->Args({65536, 2})->Args({65536, 4})->Args({65536, 8})  // NOLINT(whitespace/braces)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
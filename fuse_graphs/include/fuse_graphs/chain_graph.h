@@ -0,0 +1,151 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_CHAIN_GRAPH_H
+#define FUSE_GRAPHS_CHAIN_GRAPH_H
+
+#include <fuse_core/graph.h>
+#include <fuse_core/macros.h>
+#include <fuse_graphs/hash_graph.h>
+
+#include <ceres/problem.h>
+#include <ceres/solver.h>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief A HashGraph that solves chain-structured problems with a dedicated block-tridiagonal solver
+ *
+ * Between loop closures, a typical pose graph is a Markov chain: motion constraints between consecutive stamps plus a
+ * few unary priors. The normal equations of such a graph are block-tridiagonal, and can be solved in time linear in
+ * the length of the chain, without the ordering analysis and symbolic factorization performed by Ceres's generic
+ * sparse solvers.
+ *
+ * Before each optimization, the free variables are arranged into levels using a breadth-first traversal that starts
+ * from a peripheral variable of each connected component. Every constraint connects variables in the same level or in
+ * adjacent levels, so each level becomes one block of a block-tridiagonal system. The graph is considered a chain if no
+ * level has more than the configured number of tangent-space dimensions. For a chain of poses, each level holds the
+ * variables of roughly one stamp. Loop closures fold the chain back onto itself and widen the levels. Once the widest
+ * level exceeds the limit, or when the graph contains something the chain solver does not support (such as a robust
+ * loss function), optimize() falls back to the standard Ceres solve performed by HashGraph.
+ *
+ * The chain solver is a Levenberg-Marquardt minimizer that honors the following Ceres Solver::Options:
+ * max_num_iterations, max_solver_time_in_seconds, function_tolerance, gradient_tolerance, parameter_tolerance,
+ * initial_trust_region_radius, max_trust_region_radius, min_relative_decrease, min_lm_diagonal, and max_lm_diagonal.
+ * All other options only apply when the solve falls back to Ceres.
+ *
+ * This class is not thread-safe. If used in a multi-threaded application, standard thread synchronization techniques
+ * should be used to guard access to the graph.
+ */
+class ChainGraph : public HashGraph
+{
+public:
+  SMART_PTR_DEFINITIONS(ChainGraph);
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] options        A configured Ceres Problem::Options object. See
+   *                           https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/problem.h#123
+   * @param[in] max_block_size The largest number of tangent-space dimensions allowed in a single block of the
+   *                           block-tridiagonal system. Graphs with wider blocks are optimized by Ceres instead.
+   */
+  explicit ChainGraph(
+    const ceres::Problem::Options& options = ceres::Problem::Options(),
+    size_t max_block_size = 30);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~ChainGraph() = default;
+
+  /**
+   * @brief Return a deep copy of the graph object
+   */
+  fuse_core::Graph::UniquePtr clone() const override;
+
+  /**
+   * @brief Check if the graph currently has a chain structure
+   *
+   * Complexity: O(N + M), where N is the number of variables and M is the number of constraints
+   *
+   * @return True if the next call to optimize() will use the block-tridiagonal solver, False if it will use Ceres
+   */
+  bool isChain() const;
+
+  /**
+   * @brief Optimize the values of the current set of variables, given the current set of constraints
+   *
+   * Chain-structured graphs are solved with the block-tridiagonal Levenberg-Marquardt solver, and all other graphs with
+   * HashGraph::optimize(). Either way, the variable values are updated in place and a Ceres Solver Summary is returned.
+   * The message field of the summary identifies which solver was used.
+   *
+   * @param[in] options An optional Ceres Solver::Options object that controls various aspects of the optimizer.
+   *                    See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/solver.h#59
+   * @return            A Ceres Solver Summary structure containing information about the optimization process
+   */
+  ceres::Solver::Summary optimize(const ceres::Solver::Options& options = ceres::Solver::Options()) override;
+
+protected:
+  /**
+   * @brief The block-tridiagonal layout of the free variables and the residuals that connect them
+   *
+   * Defined in the implementation file; only the chain solver needs the details.
+   */
+  struct Chain;
+
+  size_t max_block_size_;  //!< The largest number of tangent-space dimensions allowed in a single block
+
+  /**
+   * @brief Arrange the free variables into a block-tridiagonal layout
+   *
+   * @param[out] chain The layout of the graph. Only valid if this function returns true.
+   * @return           True if the graph has a chain structure, False otherwise
+   */
+  bool createChain(Chain& chain) const;
+
+  /**
+   * @brief Minimize the cost of a chain-structured graph using Levenberg-Marquardt
+   *
+   * @param[in]  options The Ceres options that control the minimizer
+   * @param[in]  chain   The layout of the graph, as created by createChain()
+   * @param[out] summary Information about the optimization process
+   */
+  void solveChain(const ceres::Solver::Options& options, Chain& chain, ceres::Solver::Summary& summary);
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_CHAIN_GRAPH_H
@@ -37,13 +37,17 @@
 #include <fuse_core/constraint.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
+#include <fuse_core/spatial_index.h>
+#include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
+#include <fuse_core/variable_archive.h>
 
 #include <ceres/covariance.h>
 #include <ceres/problem.h>
 #include <ceres/solver.h>
 
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -69,18 +73,36 @@ class HashGraph : public fuse_core::Graph
 public:
   SMART_PTR_DEFINITIONS(HashGraph);
 
+  /**
+   * @brief The Variable::type() strings of the position variables indexed by default
+   */
+  static const std::vector<std::string> DEFAULT_SPATIAL_INDEX_VARIABLE_TYPES;
+
   /**
    * @brief Constructor
    *
-   * @param[in] options A configured Ceres Problem::Options object
-   *                    See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/problem.h#123
+   * @param[in] options       A configured Ceres Problem::Options object. See
+   *                          https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/problem.h#123
+   * @param[in] clone_threads The maximum number of threads used to deep copy the graph in the copy constructor,
+   *                          clone(), and copy-assignment. A value of 0 uses the number of hardware threads. Small
+   *                          graphs are always copied by the calling thread.
+   * @param[in] spatial_index_cell_size The grid cell size, in meters, of the spatial index over the position variables
+   * @param[in] spatial_index_variable_types The Variable::type() strings of the position variables in the spatial
+   *                          index. By default, the fuse_variables::Position2DStamped and
+   *                          fuse_variables::Position3DStamped variables are indexed.
    */
-  explicit HashGraph(const ceres::Problem::Options& options = ceres::Problem::Options());
+  explicit HashGraph(
+    const ceres::Problem::Options& options = ceres::Problem::Options(),
+    size_t clone_threads = 1,
+    double spatial_index_cell_size = 1.0,
+    const std::vector<std::string>& spatial_index_variable_types = DEFAULT_SPATIAL_INDEX_VARIABLE_TYPES);
 
   /**
    * @brief Copy constructor
    * 
-   * Performs a deep copy of the graph
+   * Performs a deep copy of the graph. Large graphs are copied in parallel: the hash buckets of the source containers
+   * are partitioned across several threads, each thread clones the elements of its buckets, and the results are then
+   * merged into pre-sized destination containers. The copy uses the same clone_threads setting as the source graph.
    */
   HashGraph(const HashGraph& other);
 
@@ -103,6 +125,19 @@ public:
    */
   fuse_core::Graph::UniquePtr clone() const override;
 
+  /**
+   * @brief Return a graph object containing deep copies of only the requested variables
+   *
+   * The returned graph contains no constraints. Requested variables that do not exist in this graph are ignored, and
+   * the hold status of each copied variable is preserved.
+   *
+   * Complexity: O(N) (average), where N is the number of requested variables
+   *
+   * @param[in] variable_uuids The UUIDs of the variables to copy
+   * @return                   A new graph containing copies of the requested variables
+   */
+  fuse_core::Graph::UniquePtr cloneVariables(const std::vector<fuse_core::UUID>& variable_uuids) const override;
+
   /**
    * @brief Check if the constraint already exists in the graph
    *
@@ -136,7 +171,7 @@ public:
    * Behavior: If this constraint does not exist in the graph, the function will return false.
    * Exceptions: If the constraint UUID does not exist, a std::out_of_range exception will be thrown.
    *             If any unexpected errors occur, an exception will be thrown.
-   * Complexity: O(1) (average)
+   * Complexity: O(1) (average), independent of the number of constraints attached to each involved variable
    *
    * @param[in] constraint_uuid The UUID of the constraint to be removed
    * @return                    True if the constraint was removed, false otherwise
@@ -229,6 +264,31 @@ public:
    */
   fuse_core::const_variable_range getVariables() const noexcept override;
 
+  /**
+   * @brief Read-only access to the spatial index over the position variables in the graph
+   *
+   * The index is updated as variables are added and removed, and the indexed positions are refreshed at the end of
+   * each call to optimize().
+   *
+   * Exceptions: None
+   * Complexity: O(1)
+   *
+   * @return The spatial index of the graph
+   */
+  const fuse_core::SpatialIndex& spatialIndex() const noexcept override { return spatial_index_; }
+
+  /**
+   * @brief Attach an archive of the variables that have been retired from this graph
+   *
+   * See fuse_core::Graph::archive() for details.
+   */
+  void archive(fuse_core::VariableArchive::SharedPtr archive) override { archive_ = std::move(archive); }
+
+  /**
+   * @brief Access the archive of variables that have been retired from this graph, or nullptr if none is attached
+   */
+  fuse_core::VariableArchive::ConstSharedPtr archive() const override { return archive_; }
+
   /**
    * @brief Configure a variable to hold its current value during optimization
    *
@@ -244,6 +304,24 @@ public:
    */
   void holdVariable(const fuse_core::UUID& variable_uuid, bool hold_constant = true) override;
 
+  /**
+   * @brief Configure individual dimensions of a variable to hold their current values during optimization
+   *
+   * When the parameter block is constructed, the variable's local parameterization is wrapped in a
+   * fuse_core::SubsetLocalParameterization, or replaced by a ceres::SubsetParameterization if the variable has no local
+   * parameterization. The solver then works in the smaller tangent space without any additional residual blocks.
+   *
+   * Exceptions: If the variable does not exist or a dimension is out of range, a std::out_of_range exception will be
+   *             thrown.
+   * Complexity: O(1) (average)
+   *
+   * @param[in] variable_uuid   The variable to adjust
+   * @param[in] held_dimensions The tangent-space dimensions to hold constant. An empty list releases all dimensions.
+   */
+  void holdVariableDimensions(
+    const fuse_core::UUID& variable_uuid,
+    const std::vector<size_t>& held_dimensions) override;
+
   /**
    * @brief Marginalize out the provided variable from the graph
    *
@@ -283,6 +361,52 @@ public:
     std::vector<std::vector<double>>& covariance_matrices,
     const ceres::Covariance::Options& options = ceres::Covariance::Options()) const override;
 
+  /**
+   * @brief Evaluate the Jacobian of all constraint residuals with respect to the requested variables
+   *
+   * Each row of the Jacobian is a single residual, and each variable occupies a block of columns as described by the
+   * SparseGraphMatrix::columns mapping. When no variables are requested, all variables are included and the columns
+   * are ordered by variable UUID. When a subset of variables is requested, the columns follow the order of the request,
+   * only the constraints connected to at least one requested variable are evaluated, and all other variables are
+   * treated as constants. Columns belonging to variables that are held constant will be zero.
+   *
+   * Exceptions: If a requested variable does not exist, a std::out_of_range exception will be thrown.
+   *             If a variable is requested more than once, a std::invalid_argument exception will be thrown.
+   *             If the constraint evaluation fails, a std::runtime_error exception will be thrown.
+   * Complexity: O(N + M) when all variables are requested, where N is the number of variables and M is the number
+   *             of constraints in the graph. O(K) when a subset is requested, where K is the number of constraints
+   *             connected to the requested variables.
+   *
+   * @param[in]  variable_uuids The variables to include in the Jacobian, in the desired column order. If empty,
+   *                            all variables are included.
+   * @param[out] jacobian       The evaluated Jacobian and the variable-to-column mapping
+   * @param[in]  num_threads    The number of threads to use while evaluating the constraints
+   */
+  void getJacobian(
+    const std::vector<fuse_core::UUID>& variable_uuids,
+    fuse_core::SparseGraphMatrix& jacobian,
+    int num_threads = 1) const override;
+
+  /**
+   * @brief Update the graph with the contents of a transaction
+   *
+   * The transaction is applied as a single bulk operation instead of a sequence of individual add and remove calls.
+   * The entire transaction is validated in one pass before the graph is modified, then the container capacity is
+   * reserved and all of the insertions and erasures are performed without any additional checks. The final state of
+   * the graph is identical to adding the variables, adding the constraints, removing the constraints, and finally
+   * removing the variables one at a time, as done by fuse_core::Graph::update().
+   *
+   * Behavior: Empty pointers and variables or constraints that already exist are ignored, as are removals of unknown
+   *           variables and constraints.
+   * Exceptions: If an added constraint references a variable that is neither in the graph nor in the transaction, or
+   *             if a removed variable would still be used by a constraint, a std::logic_error exception will be
+   *             thrown. The graph is not modified if the transaction is rejected.
+   * Complexity: O(N) (average), where N is the number of elements in the transaction
+   *
+   * @param[in] transaction A set of variable and constraints additions and deletions
+   */
+  void update(const fuse_core::Transaction& transaction) override;
+
   /**
    * @brief Optimize the values of the current set of variables, given the current set of constraints.
    *
@@ -303,14 +427,84 @@ protected:
   using Constraints = std::unordered_map<fuse_core::UUID, fuse_core::Constraint::SharedPtr, fuse_core::uuid::hash>;
   using Variables = std::unordered_map<fuse_core::UUID, fuse_core::Variable::SharedPtr, fuse_core::uuid::hash>;
   using VariableSet = std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash>;
-  using CrossReference = std::unordered_map<fuse_core::UUID, std::vector<fuse_core::UUID>, fuse_core::uuid::hash>;
+  using HeldDimensions = std::unordered_map<fuse_core::UUID, std::vector<size_t>, fuse_core::uuid::hash>;
+
+  /**
+   * @brief A single entry in the variable->constraint cross reference
+   *
+   * In addition to the constraint UUID, the position of the variable within the constraint's variable list is stored.
+   * This allows the back-pointers held in the ConstraintPositions container to be updated when an entry is moved.
+   */
+  struct CrossReferenceEntry
+  {
+    fuse_core::UUID constraint_uuid;  //!< The constraint that uses the variable
+    size_t variable_index;  //!< The index of the variable within Constraint::variables()
+  };
+  using CrossReference = std::unordered_map<fuse_core::UUID,
+                                            std::vector<CrossReferenceEntry>,
+                                            fuse_core::uuid::hash>;
+
+  /**
+   * @brief The location of each constraint within the cross reference
+   *
+   * For each constraint, a vector is stored in the same order as Constraint::variables(). Each element is the index of
+   * the constraint's entry within that variable's cross reference vector. This allows a constraint to be removed from
+   * the cross reference using a swap-and-pop in constant time, instead of searching the variable's entire list of
+   * constraints.
+   */
+  using ConstraintPositions = std::unordered_map<fuse_core::UUID, std::vector<size_t>, fuse_core::uuid::hash>;
 
+  fuse_core::VariableArchive::SharedPtr archive_;  //!< The archive of retired variables, shared with all copies
   Constraints constraints_;  //!< The set of all constraints
   CrossReference constraints_by_variable_uuid_;  //!< Index all of the constraints by variable uuids
+  ConstraintPositions constraint_positions_;  //!< The location of each constraint in the cross reference
+  size_t clone_threads_;  //!< The maximum number of threads used when deep copying the graph
+  HeldDimensions held_dimensions_;  //!< The sorted tangent-space dimensions held constant for each variable
   ceres::Problem::Options problem_options_;  //!< User-defined options to be applied to all constructed ceres::Problems
+  fuse_core::SpatialIndex spatial_index_;  //!< The spatial index over the position variables
   Variables variables_;  //!< The set of all variables
   VariableSet variables_on_hold_;  //!< The set of variables that should be held constant
 
+  /**
+   * @brief The minimum number of elements each thread must clone before the copy is split across multiple threads
+   */
+  static constexpr size_t MINIMUM_CLONES_PER_THREAD = 4096;
+
+  /**
+   * @brief Deep copy the elements of a variable or constraint container, optionally using multiple threads
+   *
+   * @param[in]  source          The container to copy
+   * @param[out] destination     An empty container that will receive copies of all source elements
+   * @param[in]  partition_count The number of threads to use. The source hash buckets are split evenly between them.
+   */
+  template <typename Container>
+  static void deepCopy(const Container& source, Container& destination, size_t partition_count);
+
+  /**
+   * @brief Insert every variable into an empty spatial index
+   *
+   * Used after a copy, as the index of the source graph refers to the source variables.
+   */
+  void rebuildSpatialIndex();
+
+  /**
+   * @brief Add a constraint to the constraint container and the variable cross reference
+   *
+   * This function assumes the constraint does not already exist and that all of its variables exist. No checks
+   * are performed.
+   *
+   * @param[in] constraint The constraint to insert
+   */
+  void insertConstraint(fuse_core::Constraint::SharedPtr constraint);
+
+  /**
+   * @brief Remove a constraint from the constraint container and the variable cross reference
+   *
+   * @param[in] constraints_iter An iterator to the constraint to be removed. It must be a valid, dereferenceable
+   *                             iterator into the constraints_ container.
+   */
+  void eraseConstraint(Constraints::iterator constraints_iter);
+
   /**
    * @brief Populate a ceres::Problem object using the current set of variables and constraints
    *
@@ -320,6 +514,36 @@ protected:
    * @param[out] problem The ceres::Problem object to modify
    */
   void createProblem(ceres::Problem& problem) const;
+
+  /**
+   * @brief Populate a ceres::Problem object using only the constraints connected to the provided variables
+   *
+   * All constraints that use at least one of the provided variables are added to the problem, along with every
+   * variable used by those constraints. Variables that were not provided are held constant. No checks are performed
+   * for missing variables.
+   *
+   * @param[in]  variable_uuids The set of variables of interest
+   * @param[out] problem        The ceres::Problem object to modify
+   */
+  void createProblem(const std::vector<fuse_core::UUID>& variable_uuids, ceres::Problem& problem) const;
+
+  /**
+   * @brief Add a single variable to a ceres::Problem object, respecting the variable's hold status and held dimensions
+   *
+   * @param[in]  variable The variable to add
+   * @param[out] problem  The ceres::Problem object to modify
+   */
+  void addParameterBlock(fuse_core::Variable& variable, ceres::Problem& problem) const;
+
+  /**
+   * @brief Add a single constraint to a ceres::Problem object
+   *
+   * All of the variables used by the constraint must have been added to the problem already.
+   *
+   * @param[in]  constraint The constraint to add
+   * @param[out] problem    The ceres::Problem object to modify
+   */
+  void addResidualBlock(const fuse_core::Constraint& constraint, ceres::Problem& problem) const;
 };
 
 }  // namespace fuse_graphs
@@ -0,0 +1,85 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_HASH_GRAPH_PARAMS_H
+#define FUSE_GRAPHS_HASH_GRAPH_PARAMS_H
+
+#include <fuse_graphs/hash_graph.h>
+#include <ros/node_handle.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief Defines the HashGraph constructor arguments that can be configured from the parameter server
+ *
+ * Parameters:
+ *  - clone_threads (int, default: 0) The maximum number of threads used to deep copy the graph. A value of 0 uses the
+ *                                    number of hardware threads.
+ *  - spatial_index_cell_size (float, default: 1.0) The grid cell size, in meters, of the spatial index over the
+ *                                                  position variables
+ *  - spatial_index_variable_types (string list, default: [fuse_variables::Position2DStamped,
+ *                                 fuse_variables::Position3DStamped]) The Variable::type() strings of the position
+ *                                 variables in the spatial index
+ */
+struct HashGraphParams
+{
+  size_t clone_threads { 0 };  //!< The maximum number of threads used to deep copy the graph
+  double spatial_index_cell_size { 1.0 };  //!< The grid cell size, in meters, of the spatial index
+  //! The Variable::type() strings of the position variables in the spatial index
+  std::vector<std::string> spatial_index_variable_types = HashGraph::DEFAULT_SPATIAL_INDEX_VARIABLE_TYPES;
+
+  /**
+   * @brief Read the parameter values from the parameter server, keeping the current values for any missing parameters
+   *
+   * @param[in] nh The node handle in whose namespace the parameters are read
+   */
+  void loadFromROS(const ros::NodeHandle& nh)
+  {
+    int clone_threads_param = static_cast<int>(clone_threads);
+    nh.param("clone_threads", clone_threads_param, clone_threads_param);
+    clone_threads = static_cast<size_t>(std::max(0, clone_threads_param));
+    nh.param("spatial_index_cell_size", spatial_index_cell_size, spatial_index_cell_size);
+    nh.param("spatial_index_variable_types", spatial_index_variable_types, spatial_index_variable_types);
+  }
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_HASH_GRAPH_PARAMS_H
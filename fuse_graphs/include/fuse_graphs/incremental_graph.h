@@ -0,0 +1,208 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_INCREMENTAL_GRAPH_H
+#define FUSE_GRAPHS_INCREMENTAL_GRAPH_H
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/macros.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <fuse_graphs/hash_graph.h>
+
+#include <ceres/problem.h>
+#include <ceres/solver.h>
+
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief A HashGraph that only re-optimizes the portion of the graph affected by changes since the last optimization
+ *
+ * This is an approximate local re-solve, not an incremental factorization such as iSAM2. Each solve builds a new
+ * Ceres problem over the optimized region and relinearizes it from scratch; no factorization is carried over from
+ * one optimization to the next.
+ *
+ * Every graph modification marks the involved variables as affected: added variables, the variables of added or
+ * removed constraints, and variables that are released from hold. The next call to optimize() solves only for the
+ * affected variables. The constraints connected to those variables are included in the problem, and any other
+ * variables used by those constraints are held constant at their current values.
+ *
+ * After each solve, any variable that moved by more than the relinearization threshold is considered to have
+ * invalidated its neighbors. The change is measured in the tangent space of the variable's local parameterization,
+ * if it has one. The neighboring variables are added to the optimized region and the region is solved
+ * again. This "wildfire" expansion continues until no variable moves by more than the threshold, or until the maximum
+ * number of region expansions is reached. In the latter case the unprocessed neighbors remain marked as affected, and
+ * are optimized during the next call to optimize().
+ *
+ * For sliding-window or SLAM problems where each update touches a small part of the graph, this bounds the cost of
+ * each optimization by the size of the change instead of the size of the graph. The variables outside the optimized
+ * region keep their previous values, so the result generally differs from that of a batch HashGraph::optimize() over
+ * the same graph. This is true even with a zero threshold: each expansion only reaches one more constraint away, so
+ * the region covers the whole connected component only if the expansion limit is at least the component's diameter.
+ * With the default limit, a change propagates at most ten constraints away per optimization.
+ *
+ * To keep the error from accumulating, every Nth optimization (the full solve interval) is a batch optimization of
+ * the entire graph, identical to HashGraph::optimize(). An interval of zero disables the full solves.
+ *
+ * This class is not thread-safe. If used in a multi-threaded application, standard thread synchronization techniques
+ * should be used to guard access to the graph.
+ */
+class IncrementalGraph : public HashGraph
+{
+public:
+  SMART_PTR_DEFINITIONS(IncrementalGraph);
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] options      A configured Ceres Problem::Options object. See
+   *                         https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/problem.h#123
+   * @param[in] threshold    The relinearization threshold. The largest change in any single tangent-space component
+   *                         of a variable that is allowed before the neighbors of that variable are added to the
+   *                         optimized region.
+   * @param[in] expansions   The maximum number of times the optimized region is expanded during a single call to
+   *                         optimize()
+   * @param[in] full_solve_interval Every Nth call to optimize() that has work to do optimizes the entire graph
+   *                         instead of the affected region. A value of 0 never optimizes the entire graph.
+   */
+  explicit IncrementalGraph(
+    const ceres::Problem::Options& options = ceres::Problem::Options(),
+    double threshold = 0.1,
+    size_t expansions = 10,
+    size_t full_solve_interval = 10);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~IncrementalGraph() = default;
+
+  /**
+   * @brief Return a deep copy of the graph object, including the set of affected variables
+   */
+  fuse_core::Graph::UniquePtr clone() const override;
+
+  /**
+   * @brief Add a new constraint to the graph, marking all of its variables as affected
+   *
+   * See HashGraph::addConstraint() for details.
+   */
+  bool addConstraint(fuse_core::Constraint::SharedPtr constraint) override;
+
+  /**
+   * @brief Remove a constraint from the graph, marking all of its variables as affected
+   *
+   * See HashGraph::removeConstraint() for details.
+   */
+  bool removeConstraint(const fuse_core::UUID& constraint_uuid) override;
+
+  /**
+   * @brief Add a new variable to the graph, marking it as affected
+   *
+   * See HashGraph::addVariable() for details.
+   */
+  bool addVariable(fuse_core::Variable::SharedPtr variable) override;
+
+  /**
+   * @brief Remove a variable from the graph
+   *
+   * See HashGraph::removeVariable() for details.
+   */
+  bool removeVariable(const fuse_core::UUID& variable_uuid) override;
+
+  /**
+   * @brief Hold or release a variable. Released variables are marked as affected, if they exist in the graph.
+   *
+   * See HashGraph::holdVariable() for details.
+   */
+  void holdVariable(const fuse_core::UUID& variable_uuid, bool hold_constant = true) override;
+
+  /**
+   * @brief Hold or release individual dimensions of a variable, marking the variable as affected if it exists
+   *
+   * See HashGraph::holdVariableDimensions() for details.
+   */
+  void holdVariableDimensions(
+    const fuse_core::UUID& variable_uuid,
+    const std::vector<size_t>& held_dimensions) override;
+
+  /**
+   * @brief Apply a transaction to the graph, marking all of the involved variables as affected
+   *
+   * See HashGraph::update() for details.
+   */
+  void update(const fuse_core::Transaction& transaction) override;
+
+  /**
+   * @brief Optimize the values of the affected variables, expanding the optimized region as needed
+   *
+   * If no variables have been affected since the last optimization, no work is performed and a default-constructed
+   * summary is returned. Otherwise, the summary of the final solve is returned. Unlike HashGraph::optimize(), the
+   * variables outside of the optimized region are not updated, except during the periodic full solves; see the
+   * class description.
+   *
+   * Complexity: Proportional to the size of the optimized region, rather than to the size of the graph. The periodic
+   *             full solves have the complexity of HashGraph::optimize().
+   *
+   * @param[in] options An optional Ceres Solver::Options object that controls various aspects of the optimizer.
+   *                    See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/solver.h#59
+   * @return            A Ceres Solver Summary structure containing information about the final solve
+   */
+  ceres::Solver::Summary optimize(const ceres::Solver::Options& options = ceres::Solver::Options()) override;
+
+  /**
+   * @brief Read-only access to the variables that will be optimized during the next call to optimize()
+   */
+  std::vector<fuse_core::UUID> affectedVariables() const;
+
+protected:
+  VariableSet affected_variables_;  //!< The variables modified since the last optimization
+  size_t full_solve_interval_;  //!< The number of optimizations between full solves of the entire graph
+  size_t max_region_expansions_;  //!< The maximum number of region expansions performed by a single optimization
+  size_t optimizations_since_full_solve_;  //!< The number of region optimizations since the last full solve
+  double relinearization_threshold_;  //!< The variable change that triggers an expansion to the variable's neighbors
+
+  /**
+   * @brief Mark every variable used by a constraint as affected
+   */
+  void markAffected(const fuse_core::Constraint& constraint);
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_INCREMENTAL_GRAPH_H
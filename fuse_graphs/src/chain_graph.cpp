@@ -0,0 +1,601 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/chain_graph.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/subset_local_parameterization.h>
+#include <fuse_core/uuid.h>
+
+#include <ceres/cost_function.h>
+#include <ceres/local_parameterization.h>
+#include <ceres/loss_function.h>
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+struct ChainGraph::Chain
+{
+  /**
+   * @brief A variable optimized by the chain solver, and its location within the block-tridiagonal system
+   */
+  struct FreeVariable
+  {
+    fuse_core::Variable* variable;  //!< The graph variable. The solver updates its value in place.
+    std::unique_ptr<ceres::LocalParameterization> local_parameterization;  //!< The effective parameterization, or null
+    size_t block;  //!< The index of the block containing this variable
+    size_t offset;  //!< The position of this variable's tangent space within its block
+    size_t local_size;  //!< The number of free tangent-space dimensions
+  };
+
+  /**
+   * @brief A constraint's cost function, plus the buffers used to evaluate it
+   */
+  struct Residual
+  {
+    std::unique_ptr<ceres::CostFunction> cost_function;  //!< The cost function generated by the constraint
+    std::vector<double*> parameter_blocks;  //!< The value of each variable used by the constraint
+    std::vector<int> variable_indices;  //!< The index of each FreeVariable, or -1 if the variable is held constant
+    fuse_core::VectorXd values;  //!< The residual values from the latest evaluation
+    std::vector<fuse_core::MatrixXd> jacobians;  //!< The Jacobian of each free variable, in the variable's space
+    std::vector<double*> jacobian_pointers;  //!< The Ceres output pointer for each Jacobian, or null if held constant
+    std::vector<fuse_core::MatrixXd> local_jacobians;  //!< The Jacobian of each free variable, in the tangent space
+  };
+
+  std::vector<size_t> block_sizes;  //!< The number of tangent-space dimensions in each block
+  std::vector<FreeVariable> variables;  //!< The variables being optimized
+  std::vector<Residual> residuals;  //!< One entry for every constraint in the graph
+};
+
+ChainGraph::ChainGraph(const ceres::Problem::Options& options, size_t max_block_size) :
+  HashGraph(options),
+  max_block_size_(max_block_size)
+{
+}
+
+fuse_core::Graph::UniquePtr ChainGraph::clone() const
+{
+  return ChainGraph::make_unique(*this);
+}
+
+bool ChainGraph::isChain() const
+{
+  Chain chain;
+  return createChain(chain);
+}
+
+ceres::Solver::Summary ChainGraph::optimize(const ceres::Solver::Options& options)
+{
+  Chain chain;
+  if (!createChain(chain))
+  {
+    return HashGraph::optimize(options);
+  }
+  ceres::Solver::Summary summary;
+  solveChain(options, chain, summary);
+  // Move the position variables to their optimized locations in the spatial index
+  spatial_index_.refresh();
+  return summary;
+}
+
+bool ChainGraph::createChain(Chain& chain) const
+{
+  // The chain solver minimizes the plain sum of squared residuals. Robust loss functions are left to Ceres.
+  for (const auto& uuid__constraint : constraints_)
+  {
+    std::unique_ptr<ceres::LossFunction> loss_function(uuid__constraint.second->lossFunction());
+    if (loss_function)
+    {
+      return false;
+    }
+  }
+  // Collect the free variables. Held dimensions are removed from the tangent space the same way HashGraph does it.
+  std::unordered_map<fuse_core::UUID, size_t, fuse_core::uuid::hash> free_variable_indices;
+  free_variable_indices.reserve(variables_.size());
+  chain.variables.reserve(variables_.size());
+  for (const auto& uuid__variable : variables_)
+  {
+    if (variables_on_hold_.find(uuid__variable.first) != variables_on_hold_.end())
+    {
+      continue;
+    }
+    auto& variable = *uuid__variable.second;
+    std::unique_ptr<ceres::LocalParameterization> local_parameterization(variable.localParameterization());
+    size_t local_size = local_parameterization ? local_parameterization->LocalSize() : variable.size();
+    auto held_dimensions_iter = held_dimensions_.find(uuid__variable.first);
+    if (held_dimensions_iter != held_dimensions_.end())
+    {
+      const auto& held_dimensions = held_dimensions_iter->second;
+      if (held_dimensions.size() == local_size)
+      {
+        continue;
+      }
+      if (local_parameterization)
+      {
+        local_parameterization.reset(
+          new fuse_core::SubsetLocalParameterization(local_parameterization.release(), held_dimensions));
+      }
+      else
+      {
+        local_parameterization.reset(
+          new ceres::SubsetParameterization(
+            variable.size(),
+            std::vector<int>(held_dimensions.begin(), held_dimensions.end())));
+      }
+      local_size -= held_dimensions.size();
+    }
+    free_variable_indices.emplace(uuid__variable.first, chain.variables.size());
+    chain.variables.push_back({&variable, std::move(local_parameterization), 0, 0, local_size});  // NOLINT
+  }
+  // Two free variables are neighbors if any constraint uses both of them
+  std::vector<std::vector<size_t>> neighbors(chain.variables.size());
+  std::vector<size_t> constraint_variables;
+  for (const auto& uuid__constraint : constraints_)
+  {
+    constraint_variables.clear();
+    for (const auto& variable_uuid : uuid__constraint.second->variables())
+    {
+      auto free_variable_iter = free_variable_indices.find(variable_uuid);
+      if (free_variable_iter != free_variable_indices.end())
+      {
+        constraint_variables.push_back(free_variable_iter->second);
+      }
+    }
+    for (auto variable_index : constraint_variables)
+    {
+      for (auto neighbor_index : constraint_variables)
+      {
+        if (neighbor_index != variable_index)
+        {
+          neighbors[variable_index].push_back(neighbor_index);
+        }
+      }
+    }
+  }
+  // Assign the variables of each connected component to levels with a breadth-first traversal. The traversal starts
+  // from the last variable reached by a first traversal, which is an end of the chain when the component is a chain.
+  // The variables of any one constraint are all neighbors of each other, so their levels differ by at most one. Each
+  // level therefore becomes one block of a block-tridiagonal system.
+  std::vector<size_t> visited(chain.variables.size(), 0);
+  std::vector<size_t> depth(chain.variables.size(), 0);
+  std::vector<size_t> order;
+  size_t traversal = 0;
+  auto traverse = [&](size_t start)  // NOLINT(whitespace/braces)
+  {
+    ++traversal;
+    order.clear();
+    order.push_back(start);
+    visited[start] = traversal;
+    depth[start] = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+      for (auto neighbor_index : neighbors[order[i]])
+      {
+        if (visited[neighbor_index] != traversal)
+        {
+          visited[neighbor_index] = traversal;
+          depth[neighbor_index] = depth[order[i]] + 1;
+          order.push_back(neighbor_index);
+        }
+      }
+    }
+  };
+  for (size_t start = 0; start < chain.variables.size(); ++start)
+  {
+    if (visited[start] != 0)
+    {
+      continue;
+    }
+    traverse(start);
+    traverse(order.back());
+    const size_t first_block = chain.block_sizes.size();
+    chain.block_sizes.resize(first_block + depth[order.back()] + 1, 0);
+    for (auto variable_index : order)
+    {
+      auto& free_variable = chain.variables[variable_index];
+      free_variable.block = first_block + depth[variable_index];
+      free_variable.offset = chain.block_sizes[free_variable.block];
+      chain.block_sizes[free_variable.block] += free_variable.local_size;
+      if (chain.block_sizes[free_variable.block] > max_block_size_)
+      {
+        return false;
+      }
+    }
+  }
+  // The graph is a chain. Generate the cost functions and allocate the evaluation buffers.
+  chain.residuals.reserve(constraints_.size());
+  for (const auto& uuid__constraint : constraints_)
+  {
+    const auto& constraint = *uuid__constraint.second;
+    Chain::Residual residual;
+    residual.cost_function.reset(constraint.preparedCostFunction());
+    const auto& parameter_block_sizes = residual.cost_function->parameter_block_sizes();
+    const auto num_residuals = residual.cost_function->num_residuals();
+    residual.values.resize(num_residuals);
+    for (const auto& variable_uuid : constraint.variables())
+    {
+      const size_t index = residual.parameter_blocks.size();
+      residual.parameter_blocks.push_back(variables_.at(variable_uuid)->data());
+      auto free_variable_iter = free_variable_indices.find(variable_uuid);
+      if (free_variable_iter == free_variable_indices.end())
+      {
+        residual.variable_indices.push_back(-1);
+        residual.jacobians.emplace_back();
+        residual.local_jacobians.emplace_back();
+        continue;
+      }
+      const auto& free_variable = chain.variables[free_variable_iter->second];
+      residual.variable_indices.push_back(static_cast<int>(free_variable_iter->second));
+      residual.jacobians.emplace_back(num_residuals, parameter_block_sizes[index]);
+      residual.local_jacobians.emplace_back(num_residuals, free_variable.local_size);
+    }
+    for (auto& jacobian : residual.jacobians)
+    {
+      residual.jacobian_pointers.push_back(jacobian.size() > 0 ? jacobian.data() : nullptr);
+    }
+    chain.residuals.push_back(std::move(residual));
+  }
+  return true;
+}
+
+void ChainGraph::solveChain(const ceres::Solver::Options& options, Chain& chain, ceres::Solver::Summary& summary)
+{
+  const auto start_time = std::chrono::steady_clock::now();
+  const size_t block_count = chain.block_sizes.size();
+
+  // The normal equations J'J * step = -J'r, stored as the diagonal blocks, the blocks just above the diagonal, and the
+  // gradient J'r split by block
+  std::vector<fuse_core::MatrixXd> diagonal(block_count);
+  std::vector<fuse_core::MatrixXd> upper(block_count);
+  std::vector<fuse_core::VectorXd> gradient(block_count);
+  for (size_t block = 0; block < block_count; ++block)
+  {
+    diagonal[block].resize(chain.block_sizes[block], chain.block_sizes[block]);
+    gradient[block].resize(chain.block_sizes[block]);
+    if (block + 1 < block_count)
+    {
+      upper[block].resize(chain.block_sizes[block], chain.block_sizes[block + 1]);
+    }
+  }
+
+  // Evaluate the total cost at the current variable values. When requested, also build the normal equations.
+  fuse_core::MatrixXd parameterization_jacobian;
+  auto evaluate = [&](bool linearize, double& cost)  // NOLINT(whitespace/braces)
+  {
+    cost = 0.0;
+    if (linearize)
+    {
+      for (size_t block = 0; block < block_count; ++block)
+      {
+        diagonal[block].setZero();
+        upper[block].setZero();
+        gradient[block].setZero();
+      }
+    }
+    for (auto& residual : chain.residuals)
+    {
+      if (!residual.cost_function->Evaluate(
+            residual.parameter_blocks.data(),
+            residual.values.data(),
+            linearize ? residual.jacobian_pointers.data() : nullptr))
+      {
+        return false;
+      }
+      cost += 0.5 * residual.values.squaredNorm();
+      if (!linearize)
+      {
+        continue;
+      }
+      // Move each Jacobian into the tangent space of its variable
+      for (size_t i = 0; i < residual.variable_indices.size(); ++i)
+      {
+        if (residual.variable_indices[i] < 0)
+        {
+          continue;
+        }
+        const auto& free_variable = chain.variables[residual.variable_indices[i]];
+        if (!free_variable.local_parameterization)
+        {
+          residual.local_jacobians[i] = residual.jacobians[i];
+          continue;
+        }
+        parameterization_jacobian.resize(free_variable.variable->size(), free_variable.local_size);
+        free_variable.local_parameterization->ComputeJacobian(
+          free_variable.variable->data(),
+          parameterization_jacobian.data());
+        residual.local_jacobians[i].noalias() = residual.jacobians[i] * parameterization_jacobian;
+      }
+      // Accumulate the upper triangle of the block-tridiagonal system
+      for (size_t i = 0; i < residual.variable_indices.size(); ++i)
+      {
+        if (residual.variable_indices[i] < 0)
+        {
+          continue;
+        }
+        const auto& row_variable = chain.variables[residual.variable_indices[i]];
+        const auto& row_jacobian = residual.local_jacobians[i];
+        gradient[row_variable.block].segment(row_variable.offset, row_variable.local_size).noalias() +=
+          row_jacobian.transpose() * residual.values;
+        for (size_t j = 0; j < residual.variable_indices.size(); ++j)
+        {
+          if (residual.variable_indices[j] < 0)
+          {
+            continue;
+          }
+          const auto& column_variable = chain.variables[residual.variable_indices[j]];
+          const auto& column_jacobian = residual.local_jacobians[j];
+          if (column_variable.block == row_variable.block)
+          {
+            diagonal[row_variable.block].block(
+              row_variable.offset,
+              column_variable.offset,
+              row_variable.local_size,
+              column_variable.local_size).noalias() += row_jacobian.transpose() * column_jacobian;
+          }
+          else if (column_variable.block == row_variable.block + 1)
+          {
+            upper[row_variable.block].block(
+              row_variable.offset,
+              column_variable.offset,
+              row_variable.local_size,
+              column_variable.local_size).noalias() += row_jacobian.transpose() * column_jacobian;
+          }
+        }
+      }
+    }
+    return true;
+  };
+
+  // Solve (J'J + D/radius) * step = -J'r using a block LDL' factorization, where D is the clamped diagonal of J'J.
+  // Each block is factored once on the way down the chain, and the step is recovered on the way back up.
+  std::vector<fuse_core::VectorXd> step(block_count);
+  std::vector<fuse_core::MatrixXd> coupling(block_count);
+  auto solve = [&](double radius)  // NOLINT(whitespace/braces)
+  {
+    for (size_t block = 0; block < block_count; ++block)
+    {
+      fuse_core::MatrixXd schur = diagonal[block];
+      schur.diagonal() += diagonal[block].diagonal().cwiseMax(options.min_lm_diagonal).cwiseMin(
+        options.max_lm_diagonal) / radius;
+      step[block] = -gradient[block];
+      if (block > 0)
+      {
+        schur.noalias() -= upper[block - 1].transpose() * coupling[block - 1];
+        step[block].noalias() -= upper[block - 1].transpose() * step[block - 1];
+      }
+      Eigen::LLT<fuse_core::MatrixXd> factorization(schur);
+      if (factorization.info() != Eigen::Success)
+      {
+        return false;
+      }
+      step[block] = factorization.solve(step[block]);
+      if (block + 1 < block_count)
+      {
+        coupling[block] = factorization.solve(upper[block]);
+      }
+    }
+    for (size_t block = block_count - 1; block-- > 0;)
+    {
+      step[block].noalias() -= coupling[block] * step[block + 1];
+    }
+    return true;
+  };
+
+  // Count the problem dimensions the same way Ceres does
+  summary.num_parameter_blocks = variables_.size();
+  summary.num_parameters = 0;
+  for (const auto& uuid__variable : variables_)
+  {
+    summary.num_parameters += uuid__variable.second->size();
+  }
+  summary.num_residual_blocks = chain.residuals.size();
+  summary.num_residuals = 0;
+  for (const auto& residual : chain.residuals)
+  {
+    summary.num_residuals += residual.values.size();
+  }
+  summary.num_successful_steps = 0;
+  summary.num_unsuccessful_steps = 0;
+
+  auto finish = [&](ceres::TerminationType termination_type, const std::string& message)  // NOLINT
+  {
+    summary.termination_type = termination_type;
+    summary.message = "Chain solver: " + message;
+    summary.total_time_in_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  };
+
+  double cost;
+  if (!evaluate(true, cost))
+  {
+    summary.initial_cost = summary.final_cost = 0.0;
+    finish(ceres::FAILURE, "Residual and Jacobian evaluation failed.");
+    return;
+  }
+  summary.initial_cost = summary.final_cost = cost;
+  if (chain.variables.empty())
+  {
+    finish(ceres::CONVERGENCE, "No non-constant variables found.");
+    return;
+  }
+
+  // Levenberg-Marquardt, using the same trust region update as Ceres
+  double radius = options.initial_trust_region_radius;
+  double decrease_factor = 2.0;
+  std::vector<double> previous_values;
+  std::vector<double> candidate;
+  while (true)
+  {
+    double max_gradient = 0.0;
+    for (const auto& block_gradient : gradient)
+    {
+      max_gradient = std::max(max_gradient, block_gradient.cwiseAbs().maxCoeff());
+    }
+    if (max_gradient <= options.gradient_tolerance)
+    {
+      finish(ceres::CONVERGENCE, "Gradient tolerance reached.");
+      return;
+    }
+    if (summary.num_successful_steps + summary.num_unsuccessful_steps >= options.max_num_iterations)
+    {
+      finish(ceres::NO_CONVERGENCE, "Maximum number of iterations reached.");
+      return;
+    }
+    if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >
+        options.max_solver_time_in_seconds)
+    {
+      finish(ceres::NO_CONVERGENCE, "Maximum solver time reached.");
+      return;
+    }
+    if (radius < options.min_trust_region_radius)
+    {
+      finish(ceres::CONVERGENCE, "Minimum trust region radius reached.");
+      return;
+    }
+
+    // Compute a step and the decrease in cost predicted by the linear model
+    double model_cost_change = 0.0;
+    double step_norm_squared = 0.0;
+    bool step_valid = solve(radius);
+    if (step_valid)
+    {
+      for (size_t block = 0; block < block_count; ++block)
+      {
+        fuse_core::VectorXd hessian_step = diagonal[block] * step[block];
+        if (block + 1 < block_count)
+        {
+          hessian_step.noalias() += 2.0 * upper[block] * step[block + 1];
+        }
+        model_cost_change -= step[block].dot(gradient[block] + 0.5 * hessian_step);
+        step_norm_squared += step[block].squaredNorm();
+      }
+      step_valid = std::isfinite(model_cost_change) && model_cost_change > 0.0;
+    }
+
+    if (step_valid)
+    {
+      // Stop if the step is negligible compared to the current variable values
+      double value_norm_squared = 0.0;
+      for (const auto& free_variable : chain.variables)
+      {
+        const double* data = free_variable.variable->data();
+        for (size_t i = 0; i < free_variable.variable->size(); ++i)
+        {
+          value_norm_squared += data[i] * data[i];
+        }
+      }
+      if (std::sqrt(step_norm_squared) <=
+          options.parameter_tolerance * (std::sqrt(value_norm_squared) + options.parameter_tolerance))
+      {
+        finish(ceres::CONVERGENCE, "Parameter tolerance reached.");
+        return;
+      }
+      // Apply the step in place, remembering the current values in case the step is rejected
+      previous_values.clear();
+      for (const auto& free_variable : chain.variables)
+      {
+        auto& variable = *free_variable.variable;
+        previous_values.insert(previous_values.end(), variable.data(), variable.data() + variable.size());
+        const double* delta = step[free_variable.block].data() + free_variable.offset;
+        if (free_variable.local_parameterization)
+        {
+          candidate.resize(variable.size());
+          free_variable.local_parameterization->Plus(variable.data(), delta, candidate.data());
+          std::copy(candidate.begin(), candidate.end(), variable.data());
+        }
+        else
+        {
+          for (size_t i = 0; i < variable.size(); ++i)
+          {
+            variable.data()[i] += delta[i];
+          }
+        }
+      }
+    }
+
+    double candidate_cost = std::numeric_limits<double>::infinity();
+    const bool step_successful = step_valid && evaluate(false, candidate_cost) && std::isfinite(candidate_cost) &&
+      (cost - candidate_cost) / model_cost_change > options.min_relative_decrease;
+    if (!step_successful)
+    {
+      // Restore the previous values and shrink the trust region
+      if (step_valid)
+      {
+        auto previous_value = previous_values.cbegin();
+        for (const auto& free_variable : chain.variables)
+        {
+          auto& variable = *free_variable.variable;
+          std::copy(previous_value, previous_value + variable.size(), variable.data());
+          previous_value += variable.size();
+        }
+      }
+      ++summary.num_unsuccessful_steps;
+      radius /= decrease_factor;
+      decrease_factor *= 2.0;
+      continue;
+    }
+
+    // Accept the step and grow the trust region based on how well the linear model predicted the cost
+    ++summary.num_successful_steps;
+    const double relative_decrease = (cost - candidate_cost) / model_cost_change;
+    radius = std::min(
+      options.max_trust_region_radius,
+      radius / std::max(1.0 / 3.0, 1.0 - std::pow(2.0 * relative_decrease - 1.0, 3)));
+    decrease_factor = 2.0;
+    const double cost_change = cost - candidate_cost;
+    summary.final_cost = candidate_cost;
+    if (cost_change <= options.function_tolerance * cost)
+    {
+      finish(ceres::CONVERGENCE, "Function tolerance reached.");
+      return;
+    }
+    if (!evaluate(true, cost))
+    {
+      finish(ceres::FAILURE, "Residual and Jacobian evaluation failed.");
+      return;
+    }
+  }
+}
+
+}  // namespace fuse_graphs
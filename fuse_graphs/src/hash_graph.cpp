@@ -32,14 +32,23 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_graphs/hash_graph.h>
+#include <fuse_core/subset_local_parameterization.h>
 #include <fuse_core/uuid.h>
 
 #include <boost/iterator/transform_iterator.hpp>
+#include <boost/range/distance.hpp>
+#include <ceres/local_parameterization.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <future>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -47,32 +56,68 @@
 namespace fuse_graphs
 {
 
-HashGraph::HashGraph(const ceres::Problem::Options& options) :
-  problem_options_(options)
+const std::vector<std::string> HashGraph::DEFAULT_SPATIAL_INDEX_VARIABLE_TYPES =
 {
+  "fuse_variables::Position2DStamped",
+  "fuse_variables::Position3DStamped"
+};
+
+HashGraph::HashGraph(
+  const ceres::Problem::Options& options,
+  size_t clone_threads,
+  double spatial_index_cell_size,
+  const std::vector<std::string>& spatial_index_variable_types) :
+  clone_threads_(clone_threads),
+  problem_options_(options),
+  spatial_index_(spatial_index_cell_size, spatial_index_variable_types)
+{
+  if (clone_threads_ == 0)
+  {
+    clone_threads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
 }
 
 HashGraph::HashGraph(const HashGraph& other) :
-  constraints_by_variable_uuid_(other.constraints_by_variable_uuid_),
+  fuse_core::Graph(other),
+  archive_(other.archive_),
+  clone_threads_(other.clone_threads_),
+  held_dimensions_(other.held_dimensions_),
   problem_options_(other.problem_options_),
+  spatial_index_(other.spatial_index_.cellSize(), other.spatial_index_.variableTypes()),
   variables_on_hold_(other.variables_on_hold_)
 {
-  // Make a deep copy of the constraints
-  std::transform(other.constraints_.begin(),
-                 other.constraints_.end(),
-                 std::inserter(constraints_, constraints_.end()),
-                 [](const Constraints::value_type& uuid__constraint) -> Constraints::value_type
-                 {
-                   return {uuid__constraint.first, uuid__constraint.second->clone()};
-                 });  // NOLINT(whitespace/braces)
-  // Make a deep copy of the variables
-  std::transform(other.variables_.begin(),
-                 other.variables_.end(),
-                 std::inserter(variables_, variables_.end()),
-                 [](const Variables::value_type& uuid__variable) -> Variables::value_type
-                 {
-                   return {uuid__variable.first, uuid__variable.second->clone()};
-                 });  // NOLINT(whitespace/braces)
+  // Decide how many partitions each container is split into. Each partition must be large enough to justify the
+  // cost of launching a thread.
+  auto partition_count = [this](size_t element_count)
+  {
+    return std::max<size_t>(1, std::min(clone_threads_, element_count / MINIMUM_CLONES_PER_THREAD));
+  };
+  const auto constraint_partition_count = partition_count(other.constraints_.size());
+  const auto variable_partition_count = partition_count(other.variables_.size());
+  if (constraint_partition_count == 1 && variable_partition_count == 1)
+  {
+    // Small graph. Copy everything in the current thread.
+    constraints_by_variable_uuid_ = other.constraints_by_variable_uuid_;
+    constraint_positions_ = other.constraint_positions_;
+    deepCopy(other.constraints_, constraints_, 1);
+    deepCopy(other.variables_, variables_, 1);
+    rebuildSpatialIndex();
+    return;
+  }
+  // The cross reference containers hold plain data and are copied by their own threads, while the variables and
+  // constraints are deep copied by partitioning their hash buckets across additional threads.
+  auto cross_reference_copy = std::async(
+    std::launch::async,
+    [this, &other]() { constraints_by_variable_uuid_ = other.constraints_by_variable_uuid_; });  // NOLINT
+  auto positions_copy = std::async(
+    std::launch::async,
+    [this, &other]() { constraint_positions_ = other.constraint_positions_; });  // NOLINT
+  deepCopy(other.variables_, variables_, variable_partition_count);
+  deepCopy(other.constraints_, constraints_, constraint_partition_count);
+  // Wait for the remaining copies to complete. Calling get() propagates any exception thrown by the copy.
+  cross_reference_copy.get();
+  positions_copy.get();
+  rebuildSpatialIndex();
 }
 
 HashGraph& HashGraph::operator=(const HashGraph& other)
@@ -80,9 +125,14 @@ HashGraph& HashGraph::operator=(const HashGraph& other)
   // Make a copy (might throw an exception)
   HashGraph tmp(other);
   // Then swap (won't throw an exception)
+  std::swap(archive_, tmp.archive_);
   std::swap(constraints_, tmp.constraints_);
   std::swap(constraints_by_variable_uuid_, tmp.constraints_by_variable_uuid_);
+  std::swap(constraint_positions_, tmp.constraint_positions_);
+  std::swap(clone_threads_, tmp.clone_threads_);
+  std::swap(held_dimensions_, tmp.held_dimensions_);
   std::swap(problem_options_, tmp.problem_options_);
+  std::swap(spatial_index_, tmp.spatial_index_);
   std::swap(variables_, tmp.variables_);
   std::swap(variables_on_hold_, tmp.variables_on_hold_);
   return *this;
@@ -93,6 +143,38 @@ fuse_core::Graph::UniquePtr HashGraph::clone() const
   return HashGraph::make_unique(*this);
 }
 
+fuse_core::Graph::UniquePtr HashGraph::cloneVariables(const std::vector<fuse_core::UUID>& variable_uuids) const
+{
+  auto graph = HashGraph::make_unique(
+    problem_options_,
+    clone_threads_,
+    spatial_index_.cellSize(),
+    spatial_index_.variableTypes());
+  graph->archive_ = archive_;
+  graph->variables_.reserve(variable_uuids.size());
+  for (const auto& variable_uuid : variable_uuids)
+  {
+    auto variables_iter = variables_.find(variable_uuid);
+    if (variables_iter == variables_.end())
+    {
+      continue;
+    }
+    fuse_core::Variable::SharedPtr variable = variables_iter->second->clone();
+    graph->spatial_index_.insert(variable);
+    graph->variables_.emplace(variable_uuid, std::move(variable));
+    if (variables_on_hold_.find(variable_uuid) != variables_on_hold_.end())
+    {
+      graph->variables_on_hold_.insert(variable_uuid);
+    }
+    auto held_dimensions_iter = held_dimensions_.find(variable_uuid);
+    if (held_dimensions_iter != held_dimensions_.end())
+    {
+      graph->held_dimensions_.insert(*held_dimensions_iter);
+    }
+  }
+  return graph;
+}
+
 bool HashGraph::constraintExists(const fuse_core::UUID& constraint_uuid) const noexcept
 {
   // map.find() does not itself throw exceptions, but may as a result of the key comparison operator. Because the UUID
@@ -118,12 +200,7 @@ bool HashGraph::addConstraint(fuse_core::Constraint::SharedPtr constraint)
     }
   }
   // Add the constraint to the list of known constraints
-  constraints_.emplace(constraint->uuid(), constraint);
-  // Also add it to the variable-constraint cross reference
-  for (const auto& variable_uuid : constraint->variables())
-  {
-    constraints_by_variable_uuid_[variable_uuid].push_back(constraint->uuid());
-  }
+  insertConstraint(std::move(constraint));
   return true;
 }
 
@@ -135,14 +212,7 @@ bool HashGraph::removeConstraint(const fuse_core::UUID& constraint_uuid)
   {
     return false;
   }
-  // Remove the constraint from the cross-reference data structure
-  for (const auto& variable_uuid : constraints_iter->second->variables())
-  {
-    auto& constraints = constraints_by_variable_uuid_.at(variable_uuid);
-    constraints.erase(std::remove(constraints.begin(), constraints.end(), constraint_uuid), constraints.end());
-  }
-  // And remove the constraint
-  constraints_.erase(constraints_iter);  // This does not throw
+  eraseConstraint(constraints_iter);
   return true;
 }
 
@@ -182,6 +252,7 @@ bool HashGraph::addVariable(fuse_core::Variable::SharedPtr variable)
   {
     return false;
   }
+  spatial_index_.insert(variable);
   variables_.emplace(variable->uuid(), variable);
   return true;
 }
@@ -199,11 +270,14 @@ bool HashGraph::removeVariable(const fuse_core::UUID& variable_uuid)
   if (cross_reference_iter != constraints_by_variable_uuid_.end() && !cross_reference_iter->second.empty())
   {
     throw std::logic_error("Attempting to remove a variable (" + fuse_core::uuid::to_string(variable_uuid)
-      + ") that is used by existing constraints (" + fuse_core::uuid::to_string(cross_reference_iter->second.front())
+      + ") that is used by existing constraints ("
+      + fuse_core::uuid::to_string(cross_reference_iter->second.front().constraint_uuid)
       + " plus " + std::to_string(cross_reference_iter->second.size() - 1) + " others)");
   }
   // Remove the variable from all containers
   variables_.erase(variables_iter);  // Does not throw
+  held_dimensions_.erase(variable_uuid);
+  spatial_index_.remove(variable_uuid);
   if (cross_reference_iter != constraints_by_variable_uuid_.end())
   {
     constraints_by_variable_uuid_.erase(cross_reference_iter);
@@ -247,6 +321,31 @@ void HashGraph::holdVariable(const fuse_core::UUID& variable_uuid, bool hold_con
   }
 }
 
+void HashGraph::holdVariableDimensions(
+  const fuse_core::UUID& variable_uuid,
+  const std::vector<size_t>& held_dimensions)
+{
+  if (held_dimensions.empty())
+  {
+    held_dimensions_.erase(variable_uuid);
+    return;
+  }
+  const auto& variable = getVariable(variable_uuid);
+  // The tangent space is the space of the local parameterization, if the variable has one
+  std::unique_ptr<ceres::LocalParameterization> local_parameterization(variable.localParameterization());
+  const size_t local_size = local_parameterization ? local_parameterization->LocalSize() : variable.size();
+  std::vector<size_t> sorted_dimensions(held_dimensions);
+  std::sort(sorted_dimensions.begin(), sorted_dimensions.end());
+  sorted_dimensions.erase(std::unique(sorted_dimensions.begin(), sorted_dimensions.end()), sorted_dimensions.end());
+  if (sorted_dimensions.back() >= local_size)
+  {
+    throw std::out_of_range("Dimension " + std::to_string(sorted_dimensions.back()) + " of variable "
+      + fuse_core::uuid::to_string(variable_uuid) + " is out of range. The variable has " + std::to_string(local_size)
+      + " tangent-space dimensions.");
+  }
+  held_dimensions_[variable_uuid] = std::move(sorted_dimensions);
+}
+
 void HashGraph::marginalizeVariable(const fuse_core::UUID& variable_uuid)
 {
   throw std::runtime_error("The function 'marginalizeVariable()' has not been implemented yet.");
@@ -335,6 +434,199 @@ void HashGraph::getCovariance(
   }
 }
 
+void HashGraph::getJacobian(
+  const std::vector<fuse_core::UUID>& variable_uuids,
+  fuse_core::SparseGraphMatrix& jacobian,
+  int num_threads) const
+{
+  // Determine the column order of the variables. If no variables were requested, sort all of the variables by UUID
+  // so the column assignment is independent of the hash map iteration order.
+  jacobian.variable_uuids.clear();
+  if (variable_uuids.empty())
+  {
+    jacobian.variable_uuids.reserve(variables_.size());
+    for (const auto& uuid__variable : variables_)
+    {
+      jacobian.variable_uuids.push_back(uuid__variable.first);
+    }
+    std::sort(jacobian.variable_uuids.begin(), jacobian.variable_uuids.end());
+  }
+  else
+  {
+    VariableSet unique_variables;
+    for (const auto& variable_uuid : variable_uuids)
+    {
+      if (!variableExists(variable_uuid))
+      {
+        throw std::out_of_range("The variable UUID " + fuse_core::uuid::to_string(variable_uuid) + " does not exist.");
+      }
+      if (!unique_variables.insert(variable_uuid).second)
+      {
+        throw std::invalid_argument("The variable UUID " + fuse_core::uuid::to_string(variable_uuid) +
+                                    " was requested more than once.");
+      }
+    }
+    jacobian.variable_uuids = variable_uuids;
+  }
+  // Construct the ceres::Problem object from scratch. When only a subset of variables was requested, limit the problem
+  // to the constraints that involve those variables.
+  ceres::Problem problem(problem_options_);
+  if (variable_uuids.empty())
+  {
+    createProblem(problem);
+  }
+  else
+  {
+    createProblem(variable_uuids, problem);
+  }
+  // Assign the column blocks, and tell Ceres which parameter blocks to evaluate and in what order
+  ceres::Problem::EvaluateOptions options;
+  options.num_threads = num_threads;
+  options.parameter_blocks.reserve(jacobian.variable_uuids.size());
+  jacobian.columns.clear();
+  jacobian.columns.reserve(jacobian.variable_uuids.size());
+  int column_offset = 0;
+  for (const auto& variable_uuid : jacobian.variable_uuids)
+  {
+    double* data = variables_.at(variable_uuid)->data();
+    const int column_size = problem.ParameterBlockLocalSize(data);
+    options.parameter_blocks.push_back(data);
+    jacobian.columns.emplace(variable_uuid, fuse_core::SparseGraphMatrix::ColumnBlock{column_offset, column_size});
+    column_offset += column_size;
+  }
+  // Evaluate the Jacobian
+  if (!problem.Evaluate(options, nullptr, nullptr, nullptr, &jacobian.matrix))
+  {
+    throw std::runtime_error("Could not evaluate the graph Jacobian.");
+  }
+}
+
+void HashGraph::update(const fuse_core::Transaction& transaction)
+{
+  // The Transaction class guarantees that each variable and constraint appears at most once, and that nothing is
+  // both added and removed by the same transaction. That allows the whole transaction to be validated against the
+  // graph contents directly, without building any temporary lookup structures.
+
+  // Reserve the space needed for the new elements so the containers are rehashed at most once
+  const auto added_variable_count = static_cast<size_t>(boost::distance(transaction.addedVariables()));
+  const auto added_constraint_count = static_cast<size_t>(boost::distance(transaction.addedConstraints()));
+  variables_.reserve(variables_.size() + added_variable_count);
+  constraints_.reserve(constraints_.size() + added_constraint_count);
+  constraint_positions_.reserve(constraint_positions_.size() + added_constraint_count);
+
+  // Insert the new variables first, as the added constraints are validated against them. The inserted variables are
+  // tracked so they can be removed again if the transaction is rejected.
+  std::vector<fuse_core::UUID> inserted_variables;
+  inserted_variables.reserve(added_variable_count);
+  for (const auto& variable : transaction.addedVariables())
+  {
+    if (variable && variables_.emplace(variable->uuid(), variable).second)
+    {
+      inserted_variables.push_back(variable->uuid());
+      spatial_index_.insert(variable);
+    }
+  }
+  auto reject = [this, &inserted_variables](const std::string& message)
+  {
+    for (const auto& variable_uuid : inserted_variables)
+    {
+      variables_.erase(variable_uuid);
+      spatial_index_.remove(variable_uuid);
+    }
+    throw std::logic_error(message);
+  };
+
+  // Verify all of the variables referenced by the new constraints exist
+  std::vector<fuse_core::Constraint::SharedPtr> inserted_constraints;
+  inserted_constraints.reserve(added_constraint_count);
+  for (const auto& constraint : transaction.addedConstraints())
+  {
+    if (!constraint || constraintExists(constraint->uuid()))
+    {
+      continue;
+    }
+    for (const auto& variable_uuid : constraint->variables())
+    {
+      if (!variableExists(variable_uuid))
+      {
+        reject("Attempting to add a constraint (" + fuse_core::uuid::to_string(constraint->uuid()) +
+               ") that uses an unknown variable (" + fuse_core::uuid::to_string(variable_uuid) + ")");
+      }
+    }
+    inserted_constraints.push_back(constraint);
+  }
+
+  // Verify that none of the removed variables are still in use once the constraint changes are applied. The number of
+  // constraints that will use each removed variable is computed from the current cross reference, then adjusted by
+  // the constraints added and removed by this transaction.
+  std::unordered_map<fuse_core::UUID, int64_t, fuse_core::uuid::hash> removed_variables;
+  for (const auto& variable_uuid : transaction.removedVariables())
+  {
+    if (variableExists(variable_uuid))
+    {
+      auto cross_reference_iter = constraints_by_variable_uuid_.find(variable_uuid);
+      auto usage_count = (cross_reference_iter == constraints_by_variable_uuid_.end()) ?
+        0 : static_cast<int64_t>(cross_reference_iter->second.size());
+      removed_variables.emplace(variable_uuid, usage_count);
+    }
+  }
+  if (!removed_variables.empty())
+  {
+    auto adjust_usage = [&removed_variables](const fuse_core::Constraint& constraint, int64_t change)
+    {
+      for (const auto& variable_uuid : constraint.variables())
+      {
+        auto removed_variables_iter = removed_variables.find(variable_uuid);
+        if (removed_variables_iter != removed_variables.end())
+        {
+          removed_variables_iter->second += change;
+        }
+      }
+    };
+    for (const auto& constraint : inserted_constraints)
+    {
+      adjust_usage(*constraint, 1);
+    }
+    for (const auto& constraint_uuid : transaction.removedConstraints())
+    {
+      auto constraints_iter = constraints_.find(constraint_uuid);
+      if (constraints_iter != constraints_.end())
+      {
+        adjust_usage(*constraints_iter->second, -1);
+      }
+    }
+    for (const auto& uuid__usage_count : removed_variables)
+    {
+      if (uuid__usage_count.second > 0)
+      {
+        reject("Attempting to remove a variable (" + fuse_core::uuid::to_string(uuid__usage_count.first) +
+               ") that is used by " + std::to_string(uuid__usage_count.second) + " existing constraints");
+      }
+    }
+  }
+
+  // The transaction is valid. Apply the remaining changes without repeating any of the checks.
+  for (auto& constraint : inserted_constraints)
+  {
+    insertConstraint(std::move(constraint));
+  }
+  for (const auto& constraint_uuid : transaction.removedConstraints())
+  {
+    auto constraints_iter = constraints_.find(constraint_uuid);
+    if (constraints_iter != constraints_.end())
+    {
+      eraseConstraint(constraints_iter);
+    }
+  }
+  for (const auto& uuid__usage_count : removed_variables)
+  {
+    variables_.erase(uuid__usage_count.first);
+    constraints_by_variable_uuid_.erase(uuid__usage_count.first);
+    held_dimensions_.erase(uuid__usage_count.first);
+    spatial_index_.remove(uuid__usage_count.first);
+  }
+}
+
 ceres::Solver::Summary HashGraph::optimize(const ceres::Solver::Options& options)
 {
   // Construct the ceres::Problem object from scratch
@@ -343,42 +635,226 @@ ceres::Solver::Summary HashGraph::optimize(const ceres::Solver::Options& options
   // Run the solver. This will update the variables in place.
   ceres::Solver::Summary summary;
   ceres::Solve(options, &problem, &summary);
+  // Move the position variables to their optimized locations in the spatial index
+  spatial_index_.refresh();
   // Return the optimization summary
   return summary;
 }
 
+void HashGraph::rebuildSpatialIndex()
+{
+  spatial_index_.clear();
+  for (const auto& uuid__variable : variables_)
+  {
+    spatial_index_.insert(uuid__variable.second);
+  }
+}
+
+void HashGraph::insertConstraint(fuse_core::Constraint::SharedPtr constraint)
+{
+  // Add it to the variable-constraint cross reference, remembering where each entry was placed
+  const auto& variable_uuids = constraint->variables();
+  auto& positions = constraint_positions_[constraint->uuid()];
+  positions.reserve(variable_uuids.size());
+  for (size_t variable_index = 0; variable_index < variable_uuids.size(); ++variable_index)
+  {
+    auto& constraints = constraints_by_variable_uuid_[variable_uuids[variable_index]];
+    positions.push_back(constraints.size());
+    constraints.push_back({constraint->uuid(), variable_index});  // NOLINT(whitespace/braces)
+  }
+  // Then add the constraint to the list of known constraints
+  constraints_.emplace(constraint->uuid(), std::move(constraint));
+}
+
+void HashGraph::eraseConstraint(Constraints::iterator constraints_iter)
+{
+  // Remove the constraint from the cross-reference data structure. Instead of searching each variable's list of
+  // constraints, the stored position is used to swap the last entry into the removed slot. The moved entry's
+  // back-pointer is then updated to its new location.
+  auto positions_iter = constraint_positions_.find(constraints_iter->first);
+  auto& positions = positions_iter->second;
+  const auto& variable_uuids = constraints_iter->second->variables();
+  for (size_t variable_index = 0; variable_index < variable_uuids.size(); ++variable_index)
+  {
+    auto& constraints = constraints_by_variable_uuid_.at(variable_uuids[variable_index]);
+    // The position must be read inside the loop. If the same variable appears more than once in the constraint, an
+    // earlier iteration may have moved one of this constraint's own entries.
+    const auto position = positions[variable_index];
+    const auto& moved_entry = constraints.back();
+    constraint_positions_.at(moved_entry.constraint_uuid)[moved_entry.variable_index] = position;
+    constraints[position] = moved_entry;
+    constraints.pop_back();
+  }
+  // And remove the constraint
+  constraint_positions_.erase(positions_iter);  // This does not throw
+  constraints_.erase(constraints_iter);  // This does not throw
+}
+
+template <typename Container>
+void HashGraph::deepCopy(const Container& source, Container& destination, size_t partition_count)
+{
+  // Pre-size the destination so the merge never triggers a rehash
+  destination.reserve(source.size());
+  if (partition_count <= 1)
+  {
+    for (const auto& uuid__element : source)
+    {
+      destination.emplace(uuid__element.first, uuid__element.second->clone());
+    }
+    return;
+  }
+  // Split the source hash buckets into contiguous ranges, and clone the elements of each range in its own thread.
+  // Concurrent read-only access to the source container is safe, and each thread writes to its own output vector.
+  using Element = std::pair<fuse_core::UUID, typename Container::mapped_type>;
+  std::vector<std::vector<Element>> partitions(partition_count);
+  std::vector<std::future<void>> clone_tasks;
+  clone_tasks.reserve(partition_count);
+  const auto bucket_count = source.bucket_count();
+  for (size_t partition_index = 0; partition_index < partition_count; ++partition_index)
+  {
+    const auto bucket_begin = (bucket_count * partition_index) / partition_count;
+    const auto bucket_end = (bucket_count * (partition_index + 1)) / partition_count;
+    auto& partition = partitions[partition_index];
+    partition.reserve(source.size() / partition_count);
+    clone_tasks.push_back(std::async(
+      std::launch::async,
+      [&source, &partition, bucket_begin, bucket_end]()
+      {
+        for (auto bucket = bucket_begin; bucket < bucket_end; ++bucket)
+        {
+          for (auto iter = source.begin(bucket); iter != source.end(bucket); ++iter)
+          {
+            partition.emplace_back(iter->first, iter->second->clone());
+          }
+        }
+      }));  // NOLINT(whitespace/braces)
+  }
+  // Wait for every thread to finish before rethrowing any errors, as the threads reference the local partitions
+  for (auto& clone_task : clone_tasks)
+  {
+    clone_task.wait();
+  }
+  for (auto& clone_task : clone_tasks)
+  {
+    clone_task.get();
+  }
+  // Merge the cloned elements into the destination
+  for (auto& partition : partitions)
+  {
+    for (auto& element : partition)
+    {
+      destination.emplace(element.first, std::move(element.second));
+    }
+  }
+}
+
 void HashGraph::createProblem(ceres::Problem& problem) const
 {
   // Add all the variables to the problem
   for (auto& uuid__variable : variables_)
   {
-    fuse_core::Variable& variable = *(uuid__variable.second);
-    problem.AddParameterBlock(
-      variable.data(),
-      variable.size(),
-      variable.localParameterization());
-    // Handle variables that are held constant
-    if (variables_on_hold_.find(variable.uuid()) != variables_on_hold_.end())
-    {
-      problem.SetParameterBlockConstant(variable.data());
-    }
+    addParameterBlock(*uuid__variable.second, problem);
   }
   // Add the constraints
   for (auto& uuid__constraint : constraints_)
   {
-    fuse_core::Constraint& constraint = *(uuid__constraint.second);
-    // We need the memory address of each variable value referenced by this constraint
-    std::vector<double*> parameter_blocks;
-    parameter_blocks.reserve(constraint.variables().size());
-    for (const auto& uuid : constraint.variables())
+    addResidualBlock(*uuid__constraint.second, problem);
+  }
+}
+
+void HashGraph::createProblem(const std::vector<fuse_core::UUID>& variable_uuids, ceres::Problem& problem) const
+{
+  // Find all of the constraints connected to the requested variables using the cross reference
+  std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> constraint_uuids;
+  for (const auto& variable_uuid : variable_uuids)
+  {
+    auto cross_reference_iter = constraints_by_variable_uuid_.find(variable_uuid);
+    if (cross_reference_iter != constraints_by_variable_uuid_.end())
     {
-      parameter_blocks.push_back(variables_.at(uuid)->data());
+      for (const auto& entry : cross_reference_iter->second)
+      {
+        constraint_uuids.insert(entry.constraint_uuid);
+      }
     }
-    problem.AddResidualBlock(
-      constraint.costFunction(),
-      constraint.lossFunction(),
-      parameter_blocks);
   }
+  // Add the requested variables, plus every other variable used by the connected constraints. The additional variables
+  // are held constant.
+  VariableSet added_variables(variable_uuids.begin(), variable_uuids.end());
+  for (const auto& variable_uuid : added_variables)
+  {
+    addParameterBlock(*variables_.at(variable_uuid), problem);
+  }
+  for (const auto& constraint_uuid : constraint_uuids)
+  {
+    const auto& constraint = *constraints_.at(constraint_uuid);
+    for (const auto& variable_uuid : constraint.variables())
+    {
+      if (added_variables.insert(variable_uuid).second)
+      {
+        auto& variable = *variables_.at(variable_uuid);
+        addParameterBlock(variable, problem);
+        problem.SetParameterBlockConstant(variable.data());
+      }
+    }
+    addResidualBlock(constraint, problem);
+  }
+}
+
+void HashGraph::addParameterBlock(fuse_core::Variable& variable, ceres::Problem& problem) const
+{
+  ceres::LocalParameterization* local_parameterization = variable.localParameterization();
+  // Handle variables that are held constant
+  if (variables_on_hold_.find(variable.uuid()) != variables_on_hold_.end())
+  {
+    problem.AddParameterBlock(variable.data(), variable.size(), local_parameterization);
+    problem.SetParameterBlockConstant(variable.data());
+    return;
+  }
+  // Handle variables with individual dimensions held constant by restricting the tangent space
+  auto held_dimensions_iter = held_dimensions_.find(variable.uuid());
+  if (held_dimensions_iter == held_dimensions_.end())
+  {
+    problem.AddParameterBlock(variable.data(), variable.size(), local_parameterization);
+    return;
+  }
+  const auto& held_dimensions = held_dimensions_iter->second;
+  const size_t local_size = local_parameterization ? local_parameterization->LocalSize() : variable.size();
+  if (held_dimensions.size() == local_size)
+  {
+    problem.AddParameterBlock(variable.data(), variable.size(), local_parameterization);
+    problem.SetParameterBlockConstant(variable.data());
+  }
+  else if (local_parameterization)
+  {
+    problem.AddParameterBlock(
+      variable.data(),
+      variable.size(),
+      new fuse_core::SubsetLocalParameterization(local_parameterization, held_dimensions));
+  }
+  else
+  {
+    problem.AddParameterBlock(
+      variable.data(),
+      variable.size(),
+      new ceres::SubsetParameterization(
+        variable.size(),
+        std::vector<int>(held_dimensions.begin(), held_dimensions.end())));
+  }
+}
+
+void HashGraph::addResidualBlock(const fuse_core::Constraint& constraint, ceres::Problem& problem) const
+{
+  // We need the memory address of each variable value referenced by this constraint
+  std::vector<double*> parameter_blocks;
+  parameter_blocks.reserve(constraint.variables().size());
+  for (const auto& uuid : constraint.variables())
+  {
+    parameter_blocks.push_back(variables_.at(uuid)->data());
+  }
+  problem.AddResidualBlock(
+    constraint.preparedCostFunction(),
+    constraint.lossFunction(),
+    parameter_blocks);
 }
 
 }  // namespace fuse_graphs
@@ -0,0 +1,292 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/incremental_graph.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/uuid.h>
+
+#include <ceres/local_parameterization.h>
+#include <Eigen/Core>
+#include <Eigen/QR>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief Compute the largest change in any tangent-space component of a variable since a previous value
+ *
+ * Variables without a local parameterization are compared component-by-component. Otherwise the raw change is
+ * mapped into the tangent space through the (pseudo-)inverse of the local parameterization Jacobian at the previous
+ * value, so the threshold means the same thing for a quaternion as for a position.
+ *
+ * @param[in] variable The variable, holding its current value
+ * @param[in] previous The previous value of the variable, with variable.size() elements
+ * @return            The largest absolute tangent-space component of the change
+ */
+double tangentChange(const fuse_core::Variable& variable, const double* previous)
+{
+  const auto size = static_cast<Eigen::Index>(variable.size());
+  fuse_core::VectorXd change = Eigen::Map<const fuse_core::VectorXd>(variable.data(), size)
+                             - Eigen::Map<const fuse_core::VectorXd>(previous, size);
+  std::unique_ptr<ceres::LocalParameterization> local_parameterization(variable.localParameterization());
+  if (!local_parameterization)
+  {
+    return change.lpNorm<Eigen::Infinity>();
+  }
+  fuse_core::MatrixXd jacobian(local_parameterization->GlobalSize(), local_parameterization->LocalSize());
+  local_parameterization->ComputeJacobian(previous, jacobian.data());
+  const fuse_core::VectorXd tangent_change = jacobian.colPivHouseholderQr().solve(change);
+  return tangent_change.lpNorm<Eigen::Infinity>();
+}
+
+}  // namespace
+
+namespace fuse_graphs
+{
+
+IncrementalGraph::IncrementalGraph(
+  const ceres::Problem::Options& options,
+  double threshold,
+  size_t expansions,
+  size_t full_solve_interval) :
+  HashGraph(options),
+  full_solve_interval_(full_solve_interval),
+  max_region_expansions_(expansions),
+  optimizations_since_full_solve_(0),
+  relinearization_threshold_(threshold)
+{
+}
+
+fuse_core::Graph::UniquePtr IncrementalGraph::clone() const
+{
+  return IncrementalGraph::make_unique(*this);
+}
+
+bool IncrementalGraph::addConstraint(fuse_core::Constraint::SharedPtr constraint)
+{
+  if (!HashGraph::addConstraint(constraint))
+  {
+    return false;
+  }
+  markAffected(*constraint);
+  return true;
+}
+
+bool IncrementalGraph::removeConstraint(const fuse_core::UUID& constraint_uuid)
+{
+  // The constraint's variables must be captured before the constraint is deleted
+  auto constraints_iter = constraints_.find(constraint_uuid);
+  if (constraints_iter == constraints_.end())
+  {
+    return false;
+  }
+  markAffected(*constraints_iter->second);
+  return HashGraph::removeConstraint(constraint_uuid);
+}
+
+bool IncrementalGraph::addVariable(fuse_core::Variable::SharedPtr variable)
+{
+  if (!HashGraph::addVariable(variable))
+  {
+    return false;
+  }
+  affected_variables_.insert(variable->uuid());
+  return true;
+}
+
+bool IncrementalGraph::removeVariable(const fuse_core::UUID& variable_uuid)
+{
+  if (!HashGraph::removeVariable(variable_uuid))
+  {
+    return false;
+  }
+  affected_variables_.erase(variable_uuid);
+  return true;
+}
+
+void IncrementalGraph::holdVariable(const fuse_core::UUID& variable_uuid, bool hold_constant)
+{
+  HashGraph::holdVariable(variable_uuid, hold_constant);
+  if (!hold_constant && variableExists(variable_uuid))
+  {
+    affected_variables_.insert(variable_uuid);
+  }
+}
+
+void IncrementalGraph::holdVariableDimensions(
+  const fuse_core::UUID& variable_uuid,
+  const std::vector<size_t>& held_dimensions)
+{
+  HashGraph::holdVariableDimensions(variable_uuid, held_dimensions);
+  if (variableExists(variable_uuid))
+  {
+    affected_variables_.insert(variable_uuid);
+  }
+}
+
+void IncrementalGraph::update(const fuse_core::Transaction& transaction)
+{
+  // Collect the variables of the removed constraints before the constraints are deleted. Nothing is marked until the
+  // transaction has been accepted by the graph.
+  std::vector<fuse_core::UUID> affected;
+  for (const auto& constraint_uuid : transaction.removedConstraints())
+  {
+    auto constraints_iter = constraints_.find(constraint_uuid);
+    if (constraints_iter != constraints_.end())
+    {
+      const auto& variable_uuids = constraints_iter->second->variables();
+      affected.insert(affected.end(), variable_uuids.begin(), variable_uuids.end());
+    }
+  }
+  // Constraints already in the graph, such as re-sent measurements with content-addressed UUIDs, are dropped by the
+  // update and must not mark their variables
+  for (const auto& constraint : transaction.addedConstraints())
+  {
+    if (!constraintExists(constraint->uuid()))
+    {
+      const auto& variable_uuids = constraint->variables();
+      affected.insert(affected.end(), variable_uuids.begin(), variable_uuids.end());
+    }
+  }
+  HashGraph::update(transaction);
+  affected_variables_.insert(affected.begin(), affected.end());
+  for (const auto& variable : transaction.addedVariables())
+  {
+    affected_variables_.insert(variable->uuid());
+  }
+  for (const auto& variable_uuid : transaction.removedVariables())
+  {
+    affected_variables_.erase(variable_uuid);
+  }
+}
+
+ceres::Solver::Summary IncrementalGraph::optimize(const ceres::Solver::Options& options)
+{
+  ceres::Solver::Summary summary;
+  // Skip any affected variable that is no longer part of the graph instead of failing the lookup
+  std::vector<fuse_core::UUID> region;
+  region.reserve(affected_variables_.size());
+  for (const auto& variable_uuid : affected_variables_)
+  {
+    if (variableExists(variable_uuid))
+    {
+      region.push_back(variable_uuid);
+    }
+  }
+  affected_variables_.clear();
+  if (region.empty())
+  {
+    return summary;
+  }
+  // Periodically optimize the entire graph, so the error left behind by the local solves does not accumulate
+  if (full_solve_interval_ > 0 && ++optimizations_since_full_solve_ >= full_solve_interval_)
+  {
+    optimizations_since_full_solve_ = 0;
+    return HashGraph::optimize(options);
+  }
+  VariableSet region_set(region.begin(), region.end());
+  size_t expansion = 0;
+  while (!region.empty())
+  {
+    // Record the current value of every variable in the region so the change can be measured after the solve
+    std::unordered_map<fuse_core::UUID, std::vector<double>, fuse_core::uuid::hash> initial_values;
+    initial_values.reserve(region.size());
+    for (const auto& variable_uuid : region)
+    {
+      const auto& variable = getVariable(variable_uuid);
+      initial_values.emplace(variable_uuid, std::vector<double>(variable.data(), variable.data() + variable.size()));
+    }
+    // Solve for the region only. Variables outside the region are held constant at their current values.
+    ceres::Problem problem(problem_options_);
+    createProblem(region, problem);
+    ceres::Solve(options, &problem, &summary);
+    // Any variable that moved by more than the threshold invalidates the constraints linking it to its neighbors.
+    // Those neighbors join the region.
+    std::vector<fuse_core::UUID> expanded_region;
+    for (const auto& entry : initial_values)
+    {
+      // Only the variables in the region were modified, so only they need to be moved in the spatial index
+      spatial_index_.refresh(entry.first);
+      if (tangentChange(getVariable(entry.first), entry.second.data()) <= relinearization_threshold_)
+      {
+        continue;
+      }
+      auto cross_reference_iter = constraints_by_variable_uuid_.find(entry.first);
+      if (cross_reference_iter == constraints_by_variable_uuid_.end())
+      {
+        continue;
+      }
+      for (const auto& cross_reference_entry : cross_reference_iter->second)
+      {
+        for (const auto& neighbor_uuid : constraints_.at(cross_reference_entry.constraint_uuid)->variables())
+        {
+          if (region_set.insert(neighbor_uuid).second)
+          {
+            expanded_region.push_back(neighbor_uuid);
+          }
+        }
+      }
+    }
+    if (expanded_region.empty())
+    {
+      break;
+    }
+    if (++expansion > max_region_expansions_)
+    {
+      // Out of expansions. The neighbors are optimized during the next cycle instead.
+      affected_variables_.insert(expanded_region.begin(), expanded_region.end());
+      break;
+    }
+    // Re-solve the whole region, including the new neighbors
+    region.insert(region.end(), expanded_region.begin(), expanded_region.end());
+  }
+  return summary;
+}
+
+std::vector<fuse_core::UUID> IncrementalGraph::affectedVariables() const
+{
+  return std::vector<fuse_core::UUID>(affected_variables_.begin(), affected_variables_.end());
+}
+
+void IncrementalGraph::markAffected(const fuse_core::Constraint& constraint)
+{
+  const auto& variable_uuids = constraint.variables();
+  affected_variables_.insert(variable_uuids.begin(), variable_uuids.end());
+}
+
+}  // namespace fuse_graphs
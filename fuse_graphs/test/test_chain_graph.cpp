@@ -0,0 +1,322 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/macros.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/chain_graph.h>
+#include <fuse_graphs/hash_graph.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <ceres/autodiff_cost_function.h>
+#include <ceres/loss_function.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Cost function measuring the difference between two scalar variables
+ */
+class RelativeFunctor
+{
+public:
+  explicit RelativeFunctor(const double& delta) :
+    delta_(delta)
+  {
+  }
+
+  template <typename T>
+  bool operator()(const T* const variable1, const T* const variable2, T* residual) const
+  {
+    residual[0] = variable2[0] - variable1[0] - T(delta_);
+    return true;
+  }
+
+private:
+  double delta_;
+};
+
+/**
+ * @brief Binary constraint used to build chains of connected variables
+ */
+class RelativeConstraint : public fuse_core::Constraint
+{
+public:
+  SMART_PTR_DEFINITIONS(RelativeConstraint);
+
+  RelativeConstraint(const fuse_core::UUID& variable1_uuid, const fuse_core::UUID& variable2_uuid, double delta) :
+    fuse_core::Constraint{variable1_uuid, variable2_uuid},  // NOLINT(whitespace/braces)
+    delta(delta)
+  {
+  }
+
+  void print(std::ostream& stream = std::cout) const override {}
+  fuse_core::Constraint::UniquePtr clone() const override { return RelativeConstraint::make_unique(*this); }
+  ceres::CostFunction* costFunction() const override
+  {
+    return new ceres::AutoDiffCostFunction<RelativeFunctor, 1, 1, 1>(new RelativeFunctor(delta));
+  }
+
+  double delta;
+};
+
+/**
+ * @brief Cost function measuring the difference between a two-dimensional variable and the origin
+ */
+class PointFunctor
+{
+public:
+  template <typename T>
+  bool operator()(const T* const variable, T* residual) const
+  {
+    residual[0] = variable[0];
+    residual[1] = variable[1];
+    return true;
+  }
+};
+
+/**
+ * @brief Unary constraint on a two-dimensional variable
+ */
+class PointConstraint : public fuse_core::Constraint
+{
+public:
+  SMART_PTR_DEFINITIONS(PointConstraint);
+
+  explicit PointConstraint(const fuse_core::UUID& variable_uuid) :
+    fuse_core::Constraint{variable_uuid}  // NOLINT(whitespace/braces)
+  {
+  }
+
+  void print(std::ostream& stream = std::cout) const override {}
+  fuse_core::Constraint::UniquePtr clone() const override { return PointConstraint::make_unique(*this); }
+  ceres::CostFunction* costFunction() const override
+  {
+    return new ceres::AutoDiffCostFunction<PointFunctor, 2, 2>(new PointFunctor());
+  }
+};
+
+/**
+ * @brief Unary constraint with a robust loss function
+ */
+class RobustConstraint : public ExampleConstraint
+{
+public:
+  SMART_PTR_DEFINITIONS(RobustConstraint);
+
+  explicit RobustConstraint(const fuse_core::UUID& variable_uuid) :
+    ExampleConstraint(variable_uuid)
+  {
+  }
+
+  fuse_core::Constraint::UniquePtr clone() const override { return RobustConstraint::make_unique(*this); }
+  ceres::LossFunction* lossFunction() const override { return new ceres::HuberLoss(1.0); }
+};
+
+/**
+ * @brief Build a chain of variables anchored at zero, with each variable one unit beyond the previous
+ *
+ * The initial values are offset from the solution so the optimizer has some work to do.
+ */
+fuse_core::Transaction createChain(std::vector<ExampleVariable::SharedPtr>& variables, size_t length)
+{
+  fuse_core::Transaction transaction;
+  for (size_t i = 0; i < length; ++i)
+  {
+    auto variable = ExampleVariable::make_shared();
+    variable->data()[0] = 0.5 * static_cast<double>(i);
+    transaction.addVariable(variable);
+    if (i == 0)
+    {
+      transaction.addConstraint(ExampleConstraint::make_shared(variable->uuid()));
+    }
+    else
+    {
+      transaction.addConstraint(RelativeConstraint::make_shared(variables.back()->uuid(), variable->uuid(), 1.0));
+    }
+    variables.push_back(variable);
+  }
+  return transaction;
+}
+
+/**
+ * @brief Check if the summary was produced by the chain solver
+ */
+bool usedChainSolver(const ceres::Solver::Summary& summary)
+{
+  return summary.message.compare(0, 12, "Chain solver") == 0;
+}
+
+TEST(ChainGraph, IsChain)
+{
+  // An empty graph is trivially a chain
+  fuse_graphs::ChainGraph graph;
+  EXPECT_TRUE(graph.isChain());
+
+  // So is a sequence of relative constraints
+  std::vector<ExampleVariable::SharedPtr> variables;
+  graph.update(createChain(variables, 10));
+  EXPECT_TRUE(graph.isChain());
+
+  // A loop closure folds the chain in half, doubling the size of each block
+  graph.addConstraint(RelativeConstraint::make_shared(variables.front()->uuid(), variables.back()->uuid(), 9.0));
+  EXPECT_TRUE(graph.isChain());
+  fuse_graphs::ChainGraph narrow_graph(ceres::Problem::Options(), 1);
+  std::vector<ExampleVariable::SharedPtr> narrow_variables;
+  narrow_graph.update(createChain(narrow_variables, 10));
+  EXPECT_TRUE(narrow_graph.isChain());
+  narrow_graph.addConstraint(
+    RelativeConstraint::make_shared(narrow_variables.front()->uuid(), narrow_variables.back()->uuid(), 9.0));
+  EXPECT_FALSE(narrow_graph.isChain());
+
+  // Robust loss functions are not supported by the chain solver
+  auto robust_constraint = RobustConstraint::make_shared(variables[5]->uuid());
+  graph.addConstraint(robust_constraint);
+  EXPECT_FALSE(graph.isChain());
+  graph.removeConstraint(robust_constraint->uuid());
+  EXPECT_TRUE(graph.isChain());
+}
+
+TEST(ChainGraph, Optimize)
+{
+  // Build the same chain, with a conflicting measurement at the end, in a chain graph and a batch graph
+  std::vector<ExampleVariable::SharedPtr> chain_variables;
+  fuse_graphs::ChainGraph chain_graph;
+  chain_graph.update(createChain(chain_variables, 20));
+  auto chain_conflict = ExampleConstraint::make_shared(chain_variables.back()->uuid());
+  chain_conflict->data = 30.0;
+  chain_graph.addConstraint(chain_conflict);
+
+  std::vector<ExampleVariable::SharedPtr> batch_variables;
+  fuse_graphs::HashGraph batch_graph;
+  batch_graph.update(createChain(batch_variables, 20));
+  auto batch_conflict = ExampleConstraint::make_shared(batch_variables.back()->uuid());
+  batch_conflict->data = 30.0;
+  batch_graph.addConstraint(batch_conflict);
+
+  auto chain_summary = chain_graph.optimize();
+  auto batch_summary = batch_graph.optimize();
+  EXPECT_TRUE(usedChainSolver(chain_summary));
+  EXPECT_EQ(ceres::CONVERGENCE, chain_summary.termination_type);
+  EXPECT_EQ(20, chain_summary.num_parameter_blocks);
+  EXPECT_EQ(21, chain_summary.num_residual_blocks);
+  EXPECT_NEAR(batch_summary.initial_cost, chain_summary.initial_cost, 1.0e-9);
+  EXPECT_NEAR(batch_summary.final_cost, chain_summary.final_cost, 1.0e-6);
+  for (size_t i = 0; i < batch_variables.size(); ++i)
+  {
+    EXPECT_NEAR(batch_variables[i]->data()[0], chain_variables[i]->data()[0], 1.0e-4);
+  }
+}
+
+TEST(ChainGraph, Fallback)
+{
+  // A loop closure that makes the blocks too large sends the optimization to Ceres
+  std::vector<ExampleVariable::SharedPtr> variables;
+  fuse_graphs::ChainGraph graph(ceres::Problem::Options(), 1);
+  graph.update(createChain(variables, 10));
+  graph.addConstraint(RelativeConstraint::make_shared(variables.front()->uuid(), variables.back()->uuid(), 9.0));
+  auto summary = graph.optimize();
+  EXPECT_FALSE(usedChainSolver(summary));
+  for (size_t i = 0; i < variables.size(); ++i)
+  {
+    EXPECT_NEAR(static_cast<double>(i), variables[i]->data()[0], 1.0e-4);
+  }
+}
+
+TEST(ChainGraph, HeldVariables)
+{
+  // Holding a variable in the middle of the chain splits it into two independent chains
+  std::vector<ExampleVariable::SharedPtr> variables;
+  fuse_graphs::ChainGraph graph;
+  graph.update(createChain(variables, 10));
+  variables[5]->data()[0] = 10.0;
+  graph.holdVariable(variables[5]->uuid());
+  EXPECT_TRUE(graph.isChain());
+  EXPECT_TRUE(usedChainSolver(graph.optimize()));
+  EXPECT_EQ(10.0, variables[5]->data()[0]);
+  // The first half spreads the disagreement between the anchor at zero and the held variable equally across its six
+  // residuals, and the second half simply continues from the held value
+  for (size_t i = 0; i < 5; ++i)
+  {
+    EXPECT_NEAR((5.0 + 11.0 * static_cast<double>(i)) / 6.0, variables[i]->data()[0], 1.0e-4);
+  }
+  for (size_t i = 6; i < variables.size(); ++i)
+  {
+    EXPECT_NEAR(10.0 + static_cast<double>(i - 5), variables[i]->data()[0], 1.0e-4);
+  }
+}
+
+TEST(ChainGraph, HeldDimensions)
+{
+  // Held dimensions are removed from the tangent space of the chain solver
+  fuse_graphs::ChainGraph graph;
+  auto variable = ExampleVariable::make_shared(2);
+  variable->data()[0] = 1.0;
+  variable->data()[1] = 2.0;
+  graph.addVariable(variable);
+  graph.addConstraint(PointConstraint::make_shared(variable->uuid()));
+  graph.holdVariableDimensions(variable->uuid(), {0});  // NOLINT(whitespace/braces)
+  EXPECT_TRUE(usedChainSolver(graph.optimize()));
+  EXPECT_EQ(1.0, variable->data()[0]);
+  EXPECT_NEAR(0.0, variable->data()[1], 1.0e-6);
+
+  // Holding every dimension leaves nothing to optimize
+  variable->data()[1] = 2.0;
+  graph.holdVariableDimensions(variable->uuid(), {0, 1});  // NOLINT(whitespace/braces)
+  EXPECT_TRUE(usedChainSolver(graph.optimize()));
+  EXPECT_EQ(1.0, variable->data()[0]);
+  EXPECT_EQ(2.0, variable->data()[1]);
+}
+
+TEST(ChainGraph, Clone)
+{
+  std::vector<ExampleVariable::SharedPtr> variables;
+  fuse_graphs::ChainGraph graph;
+  graph.update(createChain(variables, 5));
+  auto clone = graph.clone();
+  EXPECT_NE(nullptr, dynamic_cast<fuse_graphs::ChainGraph*>(clone.get()));
+  EXPECT_TRUE(usedChainSolver(clone->optimize()));
+  // Only the clone was optimized
+  EXPECT_EQ(2.0, variables.back()->data()[0]);
+  EXPECT_NEAR(4.0, clone->getVariable(variables.back()->uuid()).data()[0], 1.0e-4);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
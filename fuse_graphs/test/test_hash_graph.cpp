@@ -32,8 +32,10 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/constraint.h>
+#include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
+#include <fuse_core/variable_archive.h>
 #include <fuse_graphs/hash_graph.h>
 #include <test/covariance_constraint.h>
 #include <test/example_constraint.h>
@@ -42,6 +44,8 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -418,6 +422,74 @@ TEST(HashGraph, RemoveConstraint)
   EXPECT_FALSE(graph.removeConstraint(constraint1->uuid()));
 }
 
+TEST(HashGraph, RemoveConstraintHighDegree)
+{
+  // Test removing constraints in arbitrary order from a variable involved in many constraints
+
+  // Create the graph
+  fuse_graphs::HashGraph graph;
+
+  // Add a single "hub" variable, and a few "leaf" variables
+  auto hub = ExampleVariable::make_shared();
+  graph.addVariable(hub);
+
+  std::vector<ExampleVariable::SharedPtr> leaves;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    leaves.push_back(ExampleVariable::make_shared());
+    graph.addVariable(leaves.back());
+  }
+
+  // Connect many constraints to the hub variable. Some constraints reference the same variable more than once.
+  std::vector<fuse_core::UUID> constraint_uuids;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    const auto& leaf = leaves[i % leaves.size()];
+    fuse_core::Constraint::SharedPtr constraint;
+    if (i % 3 == 0)
+    {
+      constraint = CovarianceConstraint::make_shared(hub->uuid(), hub->uuid(), leaf->uuid());
+    }
+    else if (i % 3 == 1)
+    {
+      constraint = CovarianceConstraint::make_shared(leaf->uuid(), hub->uuid(), leaf->uuid());
+    }
+    else
+    {
+      constraint = ExampleConstraint::make_shared(hub->uuid());
+    }
+    graph.addConstraint(constraint);
+    constraint_uuids.push_back(constraint->uuid());
+  }
+
+  // Remove the constraints in a scrambled order, verifying the state of the graph after each removal
+  std::vector<fuse_core::UUID> removal_order;
+  for (size_t i = 0; i < constraint_uuids.size(); ++i)
+  {
+    removal_order.push_back(constraint_uuids[(i * 37) % constraint_uuids.size()]);
+  }
+  for (size_t i = 0; i < removal_order.size(); ++i)
+  {
+    // The hub variable is still in use, so removing it should throw
+    EXPECT_THROW(graph.removeVariable(hub->uuid()), std::logic_error);
+    // Remove the next constraint
+    EXPECT_TRUE(graph.removeConstraint(removal_order[i]));
+    EXPECT_FALSE(graph.constraintExists(removal_order[i]));
+    // Verify the remaining constraints still exist
+    for (size_t j = i + 1; j < removal_order.size(); ++j)
+    {
+      EXPECT_TRUE(graph.constraintExists(removal_order[j]));
+    }
+  }
+
+  // All of the constraints are gone. Verify the variables may now be removed.
+  EXPECT_TRUE(graph.removeVariable(hub->uuid()));
+  for (const auto& leaf : leaves)
+  {
+    EXPECT_TRUE(graph.removeVariable(leaf->uuid()));
+  }
+}
+
 TEST(HashGraph, GetConstraint)
 {
   // Test accessing the constraints in the graph
@@ -570,6 +642,129 @@ TEST(HashGraph, HoldVariable)
   EXPECT_NEAR(-3.0, variable2->data()[0], 1.0e-7);
 }
 
+TEST(HashGraph, HoldVariableDimensions)
+{
+  // Test holding individual dimensions of a variable. The held dimensions should remain constant, while the other
+  // dimensions are optimized.
+
+  // Create the graph
+  fuse_graphs::HashGraph graph;
+
+  // Add a two-dimensional variable. The example constraint only involves the first dimension.
+  auto variable1 = ExampleVariable::make_shared(2);
+  variable1->data()[0] = 1.0;
+  variable1->data()[1] = 2.0;
+  graph.addVariable(variable1);
+
+  auto constraint1 = ExampleConstraint::make_shared(variable1->uuid());
+  constraint1->data = 5.0;
+  graph.addConstraint(constraint1);
+
+  // Verify the dimensions are checked
+  EXPECT_THROW(graph.holdVariableDimensions(ExampleVariable().uuid(), {0}), std::out_of_range);  // NOLINT
+  EXPECT_THROW(graph.holdVariableDimensions(variable1->uuid(), {2}), std::out_of_range);  // NOLINT
+
+  // Hold the first dimension. The variable should not change.
+  EXPECT_NO_THROW(graph.holdVariableDimensions(variable1->uuid(), {0}));  // NOLINT
+  EXPECT_NO_THROW(graph.optimize());
+  EXPECT_NEAR(1.0, variable1->data()[0], 1.0e-7);
+  EXPECT_NEAR(2.0, variable1->data()[1], 1.0e-7);
+
+  // The held dimensions are preserved by copies of the graph
+  auto copy = graph.clone();
+  EXPECT_NO_THROW(copy->optimize());
+  EXPECT_NEAR(1.0, copy->getVariable(variable1->uuid()).data()[0], 1.0e-7);
+
+  // Release the held dimensions. The first dimension is now free to change.
+  EXPECT_NO_THROW(graph.holdVariableDimensions(variable1->uuid(), {}));  // NOLINT
+  EXPECT_NO_THROW(graph.optimize());
+  EXPECT_NEAR(5.0, variable1->data()[0], 1.0e-7);
+  EXPECT_NEAR(2.0, variable1->data()[1], 1.0e-7);
+}
+
+/**
+ * @brief Example variable that is included in the spatial index
+ *
+ * Single-element position variables are indexed along the x axis.
+ */
+class ExamplePosition : public ExampleVariable
+{
+public:
+  std::string type() const override { return "fuse_variables::Position2DStamped"; }
+  fuse_core::Variable::UniquePtr clone() const override
+  {
+    return fuse_core::Variable::UniquePtr(new ExamplePosition(*this));
+  }
+};
+
+TEST(HashGraph, SpatialIndex)
+{
+  // Test that the spatial index follows the variables in the graph
+  fuse_graphs::HashGraph graph;
+
+  auto position1 = std::make_shared<ExamplePosition>();
+  position1->data()[0] = 1.0;
+  auto position2 = std::make_shared<ExamplePosition>();
+  position2->data()[0] = 2.0;
+  auto other = ExampleVariable::make_shared();
+  graph.addVariable(position1);
+  graph.addVariable(position2);
+  graph.addVariable(other);
+  EXPECT_EQ(2u, graph.spatialIndex().size());
+  EXPECT_FALSE(graph.spatialIndex().contains(other->uuid()));
+  EXPECT_EQ(std::vector<fuse_core::UUID>{position1->uuid()}, graph.spatialIndex().query(1.0, 0.0, 0.5));  // NOLINT
+
+  // Variables added and removed by a transaction are indexed
+  auto position3 = std::make_shared<ExamplePosition>();
+  position3->data()[0] = 3.0;
+  fuse_core::Transaction transaction;
+  transaction.addVariable(position3);
+  transaction.removeVariable(position2->uuid());
+  graph.update(transaction);
+  EXPECT_EQ(2u, graph.spatialIndex().size());
+  EXPECT_TRUE(graph.spatialIndex().query(2.0, 0.0, 0.5).empty());
+  EXPECT_EQ(std::vector<fuse_core::UUID>{position3->uuid()}, graph.spatialIndex().query(3.0, 0.0, 0.5));  // NOLINT
+
+  // A rejected transaction leaves the index unchanged
+  auto position4 = std::make_shared<ExamplePosition>();
+  fuse_core::Transaction rejected;
+  rejected.addVariable(position4);
+  rejected.addConstraint(ExampleConstraint::make_shared(fuse_core::uuid::generate()));
+  EXPECT_THROW(graph.update(rejected), std::logic_error);
+  EXPECT_FALSE(graph.spatialIndex().contains(position4->uuid()));
+
+  // The index is refreshed after optimization
+  auto constraint = ExampleConstraint::make_shared(position1->uuid());
+  constraint->data = 10.0;
+  graph.addConstraint(constraint);
+  graph.optimize();
+  EXPECT_TRUE(graph.spatialIndex().query(1.0, 0.0, 0.5).empty());
+  EXPECT_EQ(std::vector<fuse_core::UUID>{position1->uuid()}, graph.spatialIndex().query(10.0, 0.0, 0.5));  // NOLINT
+
+  // Copies have their own index over their own variables
+  fuse_graphs::HashGraph copy(graph);
+  EXPECT_EQ(2u, copy.spatialIndex().size());
+  EXPECT_EQ(std::vector<fuse_core::UUID>{position1->uuid()}, copy.spatialIndex().query(10.0, 0.0, 0.5));  // NOLINT
+  auto subset = graph.cloneVariables({position3->uuid(), other->uuid()});  // NOLINT
+  EXPECT_EQ(std::vector<fuse_core::UUID>{position3->uuid()}, subset->spatialIndex().query(3.0, 0.0, 0.5));  // NOLINT
+  EXPECT_EQ(1u, subset->spatialIndex().size());
+
+  // Removed variables are no longer indexed
+  graph.removeConstraint(constraint->uuid());
+  graph.removeVariable(position1->uuid());
+  EXPECT_TRUE(graph.spatialIndex().query(10.0, 0.0, 0.5).empty());
+  EXPECT_EQ(1u, graph.spatialIndex().size());
+  EXPECT_EQ(2u, copy.spatialIndex().size());
+
+  // The graph decides which variable types are indexed, and passes them on to its subsets
+  fuse_graphs::HashGraph custom_graph(ceres::Problem::Options(), 1, 1.0, {"OtherPosition"});  // NOLINT
+  custom_graph.addVariable(position3);
+  EXPECT_EQ(0u, custom_graph.spatialIndex().size());
+  EXPECT_EQ(
+    std::vector<std::string>{"OtherPosition"},  // NOLINT
+    custom_graph.cloneVariables({position3->uuid()})->spatialIndex().variableTypes());  // NOLINT
+}
+
 TEST(HashGraph, GetCovariance)
 {
   // Create variables that match the Ceres unit test
@@ -688,6 +883,263 @@ TEST(HashGraph, MarginalizeVariables)
   // TODO(swilliams): Write a marginalization unit test after the function has been implemented
 }
 
+TEST(HashGraph, GetJacobian)
+{
+  // Create a graph with a few variables and constraints
+  fuse_graphs::HashGraph graph;
+
+  auto variable1 = ExampleVariable::make_shared();
+  variable1->data()[0] = 1.0;
+  graph.addVariable(variable1);
+  auto variable2 = ExampleVariable::make_shared();
+  variable2->data()[0] = 2.0;
+  graph.addVariable(variable2);
+  auto variable3 = ExampleVariable::make_shared();
+  variable3->data()[0] = 3.0;
+  graph.addVariable(variable3);
+
+  // Add two constraints on variable1 and one on variable2. Variable3 is unconstrained.
+  graph.addConstraint(ExampleConstraint::make_shared(variable1->uuid()));
+  graph.addConstraint(ExampleConstraint::make_shared(variable1->uuid()));
+  graph.addConstraint(ExampleConstraint::make_shared(variable2->uuid()));
+
+  // Compute the full Jacobian
+  fuse_core::SparseGraphMatrix jacobian;
+  graph.getJacobian({}, jacobian);  // NOLINT(whitespace/braces)
+
+  // All variables should be included, sorted by UUID
+  ASSERT_EQ(3u, jacobian.variable_uuids.size());
+  EXPECT_TRUE(std::is_sorted(jacobian.variable_uuids.begin(), jacobian.variable_uuids.end()));
+  ASSERT_EQ(3u, jacobian.columns.size());
+  for (size_t i = 0; i < jacobian.variable_uuids.size(); ++i)
+  {
+    EXPECT_EQ(static_cast<int>(i), jacobian.columns.at(jacobian.variable_uuids[i]).offset);
+    EXPECT_EQ(1, jacobian.columns.at(jacobian.variable_uuids[i]).size);
+  }
+  EXPECT_EQ(3, jacobian.matrix.num_rows);
+  EXPECT_EQ(3, jacobian.matrix.num_cols);
+
+  // Compute the information matrix. Each constraint contributes 1.0 to the diagonal entry of its variable.
+  fuse_core::SparseGraphMatrix information;
+  graph.getInformationMatrix({}, information);  // NOLINT(whitespace/braces)
+  ASSERT_EQ(3, information.matrix.num_rows);
+  ASSERT_EQ(3, information.matrix.num_cols);
+  std::vector<double> dense(9, 0.0);
+  for (int row = 0; row < information.matrix.num_rows; ++row)
+  {
+    for (int i = information.matrix.rows[row]; i < information.matrix.rows[row + 1]; ++i)
+    {
+      dense[3 * row + information.matrix.cols[i]] = information.matrix.values[i];
+    }
+  }
+  const auto column1 = information.columns.at(variable1->uuid()).offset;
+  const auto column2 = information.columns.at(variable2->uuid()).offset;
+  const auto column3 = information.columns.at(variable3->uuid()).offset;
+  EXPECT_NEAR(2.0, dense[3 * column1 + column1], 1.0e-9);
+  EXPECT_NEAR(1.0, dense[3 * column2 + column2], 1.0e-9);
+  EXPECT_NEAR(0.0, dense[3 * column3 + column3], 1.0e-9);
+  EXPECT_NEAR(0.0, dense[3 * column1 + column2], 1.0e-9);
+
+  // Compute the Jacobian of a subset of the variables. Only the constraints connected to variable2 are evaluated.
+  graph.getJacobian({variable2->uuid()}, jacobian);  // NOLINT(whitespace/braces)
+  ASSERT_EQ(1u, jacobian.variable_uuids.size());
+  EXPECT_EQ(variable2->uuid(), jacobian.variable_uuids[0]);
+  EXPECT_EQ(0, jacobian.columns.at(variable2->uuid()).offset);
+  EXPECT_EQ(1, jacobian.matrix.num_rows);
+  EXPECT_EQ(1, jacobian.matrix.num_cols);
+  ASSERT_EQ(1u, jacobian.matrix.values.size());
+  EXPECT_NEAR(1.0, jacobian.matrix.values[0], 1.0e-9);
+
+  // Requesting unknown or duplicate variables should throw
+  EXPECT_THROW(graph.getJacobian({ExampleVariable().uuid()}, jacobian), std::out_of_range);  // NOLINT
+  EXPECT_THROW(graph.getJacobian({variable1->uuid(), variable1->uuid()}, jacobian), std::invalid_argument);  // NOLINT
+}
+
+TEST(HashGraph, Update)
+{
+  // Test applying a transaction to the graph in a single operation
+
+  // Create a graph with a few variables and constraints
+  fuse_graphs::HashGraph graph;
+
+  auto variable1 = ExampleVariable::make_shared();
+  graph.addVariable(variable1);
+  auto variable2 = ExampleVariable::make_shared();
+  graph.addVariable(variable2);
+  auto constraint1 = ExampleConstraint::make_shared(variable1->uuid());
+  graph.addConstraint(constraint1);
+  auto constraint2 = ExampleConstraint::make_shared(variable2->uuid());
+  graph.addConstraint(constraint2);
+
+  // Create a transaction that adds new variables and constraints, and removes some of the existing ones
+  auto variable3 = ExampleVariable::make_shared();
+  auto variable4 = ExampleVariable::make_shared();
+  auto constraint3 = CovarianceConstraint::make_shared(variable1->uuid(), variable3->uuid(), variable4->uuid());
+  auto constraint4 = ExampleConstraint::make_shared(variable4->uuid());
+
+  fuse_core::Transaction transaction;
+  transaction.addVariable(variable3);
+  transaction.addVariable(variable4);
+  transaction.addVariable(variable1);  // Already exists, should be ignored
+  transaction.addConstraint(constraint3);
+  transaction.addConstraint(constraint4);
+  transaction.removeConstraint(constraint2->uuid());
+  transaction.removeVariable(variable2->uuid());
+
+  // Apply the transaction using the default, one-element-at-a-time implementation as a reference
+  fuse_graphs::HashGraph expected(graph);
+  expected.fuse_core::Graph::update(transaction);
+
+  // Apply the transaction using the bulk update
+  graph.update(transaction);
+
+  // Verify the graphs match
+  for (const auto& variable : {variable1, variable2, variable3, variable4})  // NOLINT(whitespace/braces)
+  {
+    EXPECT_EQ(expected.variableExists(variable->uuid()), graph.variableExists(variable->uuid()));
+  }
+  for (const auto& constraint : std::vector<fuse_core::Constraint::SharedPtr>{constraint1, constraint2, constraint3,
+                                                                               constraint4})
+  {
+    EXPECT_EQ(expected.constraintExists(constraint->uuid()), graph.constraintExists(constraint->uuid()));
+  }
+  EXPECT_TRUE(graph.variableExists(variable3->uuid()));
+  EXPECT_FALSE(graph.variableExists(variable2->uuid()));
+  EXPECT_TRUE(graph.constraintExists(constraint3->uuid()));
+  EXPECT_FALSE(graph.constraintExists(constraint2->uuid()));
+
+  // Verify the cross reference was updated. Variable4 is still used by constraint3 and constraint4.
+  EXPECT_THROW(graph.removeVariable(variable4->uuid()), std::logic_error);
+  EXPECT_TRUE(graph.removeConstraint(constraint3->uuid()));
+  EXPECT_TRUE(graph.removeConstraint(constraint4->uuid()));
+  EXPECT_TRUE(graph.removeVariable(variable4->uuid()));
+}
+
+TEST(HashGraph, UpdateRejected)
+{
+  // Test that an invalid transaction leaves the graph unmodified
+
+  fuse_graphs::HashGraph graph;
+  auto variable1 = ExampleVariable::make_shared();
+  graph.addVariable(variable1);
+  auto constraint1 = ExampleConstraint::make_shared(variable1->uuid());
+  graph.addConstraint(constraint1);
+
+  // Add a constraint that references an unknown variable. The valid parts of the transaction must not be applied.
+  {
+    auto variable2 = ExampleVariable::make_shared();
+    auto constraint2 = ExampleConstraint::make_shared(variable2->uuid());
+    auto constraint3 = ExampleConstraint::make_shared(ExampleVariable().uuid());
+    fuse_core::Transaction transaction;
+    transaction.addVariable(variable2);
+    transaction.addConstraint(constraint2);
+    transaction.addConstraint(constraint3);
+    transaction.removeConstraint(constraint1->uuid());
+    EXPECT_THROW(graph.update(transaction), std::logic_error);
+    EXPECT_FALSE(graph.variableExists(variable2->uuid()));
+    EXPECT_FALSE(graph.constraintExists(constraint2->uuid()));
+    EXPECT_TRUE(graph.constraintExists(constraint1->uuid()));
+  }
+
+  // Remove a variable that would still be used by a new constraint
+  {
+    auto variable2 = ExampleVariable::make_shared();
+    auto constraint2 = CovarianceConstraint::make_shared(variable1->uuid(), variable2->uuid(), variable2->uuid());
+    fuse_core::Transaction transaction;
+    transaction.addVariable(variable2);
+    transaction.addConstraint(constraint2);
+    transaction.removeConstraint(constraint1->uuid());
+    transaction.removeVariable(variable1->uuid());
+    EXPECT_THROW(graph.update(transaction), std::logic_error);
+    EXPECT_FALSE(graph.variableExists(variable2->uuid()));
+    EXPECT_TRUE(graph.variableExists(variable1->uuid()));
+    EXPECT_TRUE(graph.constraintExists(constraint1->uuid()));
+  }
+
+  // Removing the variable along with all of its constraints succeeds
+  {
+    fuse_core::Transaction transaction;
+    transaction.removeConstraint(constraint1->uuid());
+    transaction.removeVariable(variable1->uuid());
+    EXPECT_NO_THROW(graph.update(transaction));
+    EXPECT_FALSE(graph.variableExists(variable1->uuid()));
+    EXPECT_FALSE(graph.constraintExists(constraint1->uuid()));
+  }
+}
+
+TEST(HashGraph, CloneVariables)
+{
+  // Create a graph with a few variables and constraints
+  fuse_graphs::HashGraph graph;
+
+  auto variable1 = ExampleVariable::make_shared();
+  variable1->data()[0] = 1.0;
+  graph.addVariable(variable1);
+  auto variable2 = ExampleVariable::make_shared();
+  variable2->data()[0] = 2.0;
+  graph.addVariable(variable2);
+  auto variable3 = ExampleVariable::make_shared();
+  variable3->data()[0] = 3.0;
+  graph.addVariable(variable3);
+  graph.holdVariable(variable3->uuid());
+  auto constraint1 = ExampleConstraint::make_shared(variable1->uuid());
+  graph.addConstraint(constraint1);
+  auto constraint2 = ExampleConstraint::make_shared(variable3->uuid());
+  graph.addConstraint(constraint2);
+
+  // Copy a subset of the variables, using both the HashGraph and the generic implementations
+  const auto missing_uuid = ExampleVariable().uuid();
+  const std::vector<fuse_core::UUID> requested = {variable1->uuid(), variable3->uuid(), missing_uuid};  // NOLINT
+  std::vector<fuse_core::Graph::UniquePtr> copies;
+  copies.push_back(graph.cloneVariables(requested));
+  copies.push_back(graph.fuse_core::Graph::cloneVariables(requested));
+
+  for (const auto& copy : copies)
+  {
+    // Only the requested variables should exist
+    EXPECT_TRUE(copy->variableExists(variable1->uuid()));
+    EXPECT_FALSE(copy->variableExists(variable2->uuid()));
+    EXPECT_TRUE(copy->variableExists(variable3->uuid()));
+    EXPECT_FALSE(copy->variableExists(missing_uuid));
+    // No constraints should exist
+    EXPECT_FALSE(copy->constraintExists(constraint1->uuid()));
+    EXPECT_FALSE(copy->constraintExists(constraint2->uuid()));
+    // The variables should be deep copies
+    EXPECT_TRUE(compareVariables(*variable1, copy->getVariable(variable1->uuid()))) << failure_description;
+    EXPECT_NE(variable1->data(), copy->getVariable(variable1->uuid()).data());
+    // Since there are no constraints, the variables can be removed
+    auto mutable_copy = copy->clone();
+    EXPECT_TRUE(mutable_copy->removeVariable(variable1->uuid()));
+    EXPECT_TRUE(mutable_copy->removeVariable(variable3->uuid()));
+  }
+}
+
+TEST(HashGraph, Archive)
+{
+  // A graph has no archive by default
+  fuse_graphs::HashGraph graph;
+  EXPECT_FALSE(graph.archive());
+
+  auto variable1 = ExampleVariable::make_shared();
+  graph.addVariable(variable1);
+  auto archive = fuse_core::VariableArchive::make_shared();
+  graph.archive(archive);
+  EXPECT_EQ(archive, graph.archive());
+
+  // Every kind of copy shares the same archive instance
+  fuse_graphs::HashGraph copy(graph);
+  EXPECT_EQ(archive, copy.archive());
+  fuse_graphs::HashGraph assigned;
+  assigned = graph;
+  EXPECT_EQ(archive, assigned.archive());
+  EXPECT_EQ(archive, graph.clone()->archive());
+  EXPECT_EQ(archive, graph.cloneVariables({variable1->uuid()})->archive());  // NOLINT
+
+  // Entries appended after the copy are visible through the copies
+  archive->append(*variable1, ros::Time(1, 0), fuse_core::uuid::NIL);
+  EXPECT_EQ(1u, copy.archive()->size());
+}
+
 TEST(HashGraph, Copy)
 {
     // Create the graph
@@ -770,6 +1222,61 @@ TEST(HashGraph, Copy)
   }
 }
 
+TEST(HashGraph, CopyParallel)
+{
+  // Create a graph large enough to be copied using several threads
+  fuse_graphs::HashGraph graph(ceres::Problem::Options(), 4);
+
+  std::vector<ExampleVariable::SharedPtr> variables;
+  std::vector<ExampleConstraint::SharedPtr> constraints;
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    auto variable = ExampleVariable::make_shared();
+    variable->data()[0] = static_cast<double>(i);
+    graph.addVariable(variable);
+    variables.push_back(variable);
+
+    auto constraint = ExampleConstraint::make_shared(variable->uuid());
+    constraint->data = -static_cast<double>(i);
+    graph.addConstraint(constraint);
+    constraints.push_back(constraint);
+  }
+
+  auto verify = [&](const fuse_core::Graph& other)
+  {
+    for (const auto& variable : variables)
+    {
+      ASSERT_TRUE(other.variableExists(variable->uuid()));
+      const auto& copy = other.getVariable(variable->uuid());
+      EXPECT_EQ(variable->data()[0], copy.data()[0]);
+      // The variable must be a deep copy
+      EXPECT_NE(variable->data(), copy.data());
+    }
+    for (const auto& constraint : constraints)
+    {
+      ASSERT_TRUE(other.constraintExists(constraint->uuid()));
+      const auto& copy = other.getConstraint(constraint->uuid());
+      EXPECT_TRUE(compareConstraints(*constraint, copy)) << failure_description;
+      EXPECT_NE(constraint.get(), &copy);
+    }
+  };
+
+  // Test the copy constructor
+  fuse_graphs::HashGraph copy(graph);
+  verify(copy);
+  // Test the assignment operator
+  fuse_graphs::HashGraph assigned;
+  assigned = graph;
+  verify(assigned);
+  // Test the clone method
+  verify(*graph.clone());
+
+  // The cross reference must also have been copied. Removing a constraint should allow the variable to be removed.
+  EXPECT_THROW(copy.removeVariable(variables.front()->uuid()), std::logic_error);
+  EXPECT_TRUE(copy.removeConstraint(constraints.front()->uuid()));
+  EXPECT_TRUE(copy.removeVariable(variables.front()->uuid()));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
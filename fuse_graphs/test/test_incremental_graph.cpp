@@ -0,0 +1,394 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/macros.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/incremental_graph.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <ceres/autodiff_cost_function.h>
+#include <ceres/local_parameterization.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+
+/**
+ * @brief Cost function measuring the difference between two scalar variables
+ */
+class RelativeFunctor
+{
+public:
+  explicit RelativeFunctor(const double& delta) :
+    delta_(delta)
+  {
+  }
+
+  template <typename T>
+  bool operator()(const T* const variable1, const T* const variable2, T* residual) const
+  {
+    residual[0] = variable2[0] - variable1[0] - T(delta_);
+    return true;
+  }
+
+private:
+  double delta_;
+};
+
+/**
+ * @brief Binary constraint used to build chains of connected variables
+ */
+class RelativeConstraint : public fuse_core::Constraint
+{
+public:
+  SMART_PTR_DEFINITIONS(RelativeConstraint);
+
+  RelativeConstraint(const fuse_core::UUID& variable1_uuid, const fuse_core::UUID& variable2_uuid, double delta) :
+    fuse_core::Constraint{variable1_uuid, variable2_uuid},  // NOLINT(whitespace/braces)
+    delta(delta)
+  {
+  }
+
+  void print(std::ostream& stream = std::cout) const override {}
+  fuse_core::Constraint::UniquePtr clone() const override { return RelativeConstraint::make_unique(*this); }
+  ceres::CostFunction* costFunction() const override
+  {
+    return new ceres::AutoDiffCostFunction<RelativeFunctor, 1, 1, 1>(new RelativeFunctor(delta));
+  }
+
+  double delta;
+};
+
+/**
+ * @brief Local parameterization that scales each tangent-space step by a factor of ten
+ */
+class ScaledParameterization : public ceres::LocalParameterization
+{
+public:
+  bool Plus(const double* x, const double* delta, double* x_plus_delta) const override
+  {
+    x_plus_delta[0] = x[0] + 10.0 * delta[0];
+    return true;
+  }
+
+  bool ComputeJacobian(const double* x, double* jacobian) const override
+  {
+    jacobian[0] = 10.0;
+    return true;
+  }
+
+  int GlobalSize() const override { return 1; }
+  int LocalSize() const override { return 1; }
+};
+
+/**
+ * @brief Scalar variable whose tangent space is scaled relative to its parameter value
+ */
+class ScaledVariable : public ExampleVariable
+{
+public:
+  SMART_PTR_DEFINITIONS(ScaledVariable);
+
+  fuse_core::Variable::UniquePtr clone() const override { return ScaledVariable::make_unique(*this); }
+  ceres::LocalParameterization* localParameterization() const override { return new ScaledParameterization(); }
+};
+
+/**
+ * @brief Check if the provided list of UUIDs contains exactly the expected set of UUIDs
+ */
+bool sameSet(std::vector<fuse_core::UUID> expected, std::vector<fuse_core::UUID> actual)
+{
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  return expected == actual;
+}
+
+/**
+ * @brief Build a chain of variables anchored at zero, with each variable one unit beyond the previous
+ */
+template <typename VariableType = ExampleVariable>
+fuse_core::Transaction createChain(std::vector<ExampleVariable::SharedPtr>& variables, size_t length)
+{
+  fuse_core::Transaction transaction;
+  for (size_t i = 0; i < length; ++i)
+  {
+    auto variable = VariableType::make_shared();
+    variable->data()[0] = static_cast<double>(i);
+    transaction.addVariable(variable);
+    if (i == 0)
+    {
+      transaction.addConstraint(ExampleConstraint::make_shared(variable->uuid()));
+    }
+    else
+    {
+      transaction.addConstraint(RelativeConstraint::make_shared(variables.back()->uuid(), variable->uuid(), 1.0));
+    }
+    variables.push_back(variable);
+  }
+  return transaction;
+}
+
+TEST(IncrementalGraph, AffectedVariables)
+{
+  // Verify each type of graph modification marks the correct variables
+  fuse_graphs::IncrementalGraph graph;
+
+  // An empty variable is rejected without marking anything
+  EXPECT_FALSE(graph.addVariable(fuse_core::Variable::SharedPtr()));
+  EXPECT_TRUE(graph.affectedVariables().empty());
+
+  auto variable1 = ExampleVariable::make_shared();
+  auto variable2 = ExampleVariable::make_shared();
+  graph.addVariable(variable1);
+  graph.addVariable(variable2);
+  EXPECT_TRUE(sameSet({variable1->uuid(), variable2->uuid()}, graph.affectedVariables()));  // NOLINT
+
+  // Optimizing clears the affected set
+  graph.optimize();
+  EXPECT_TRUE(graph.affectedVariables().empty());
+
+  // Adding a constraint marks all of its variables
+  auto constraint = RelativeConstraint::make_shared(variable1->uuid(), variable2->uuid(), 1.0);
+  graph.addConstraint(constraint);
+  EXPECT_TRUE(sameSet({variable1->uuid(), variable2->uuid()}, graph.affectedVariables()));  // NOLINT
+  graph.optimize();
+
+  // So does removing one
+  graph.removeConstraint(constraint->uuid());
+  EXPECT_TRUE(sameSet({variable1->uuid(), variable2->uuid()}, graph.affectedVariables()));  // NOLINT
+  graph.optimize();
+
+  // Holding a variable does not require an optimization, but releasing it does
+  graph.holdVariable(variable1->uuid(), true);
+  EXPECT_TRUE(graph.affectedVariables().empty());
+  graph.holdVariable(variable1->uuid(), false);
+  EXPECT_TRUE(sameSet({variable1->uuid()}, graph.affectedVariables()));  // NOLINT
+
+  // Removed variables are no longer affected
+  graph.removeVariable(variable1->uuid());
+  EXPECT_TRUE(graph.affectedVariables().empty());
+
+  // Releasing variables that are not in the graph does not mark them
+  graph.holdVariable(variable1->uuid(), false);
+  graph.holdVariableDimensions(variable1->uuid(), {});
+  EXPECT_TRUE(graph.affectedVariables().empty());
+  EXPECT_NO_THROW(graph.optimize());
+
+  // Transactions mark the added variables and the variables of added and removed constraints
+  auto variable3 = ExampleVariable::make_shared();
+  auto constraint2 = RelativeConstraint::make_shared(variable2->uuid(), variable3->uuid(), 1.0);
+  fuse_core::Transaction transaction;
+  transaction.addVariable(variable3);
+  transaction.addConstraint(constraint2);
+  graph.update(transaction);
+  EXPECT_TRUE(sameSet({variable2->uuid(), variable3->uuid()}, graph.affectedVariables()));  // NOLINT
+  graph.optimize();
+
+  fuse_core::Transaction removal;
+  removal.removeConstraint(constraint2->uuid());
+  graph.update(removal);
+  EXPECT_TRUE(sameSet({variable2->uuid(), variable3->uuid()}, graph.affectedVariables()));  // NOLINT
+
+  // Rejected transactions do not mark anything
+  graph.optimize();
+  fuse_core::Transaction rejected;
+  rejected.addConstraint(ExampleConstraint::make_shared(fuse_core::uuid::generate()));
+  EXPECT_THROW(graph.update(rejected), std::logic_error);
+  EXPECT_TRUE(graph.affectedVariables().empty());
+
+  // Copies keep the pending work
+  graph.addVariable(variable1);
+  auto copy = graph.clone();
+  EXPECT_TRUE(sameSet({variable1->uuid()}, dynamic_cast<fuse_graphs::IncrementalGraph&>(*copy).affectedVariables()));
+}
+
+TEST(IncrementalGraph, OptimizeAffectedRegion)
+{
+  // Only the variables affected since the last optimization are solved
+  fuse_graphs::IncrementalGraph graph;
+
+  auto variable1 = ExampleVariable::make_shared();
+  variable1->data()[0] = 1.0;
+  graph.addVariable(variable1);
+  auto constraint1 = ExampleConstraint::make_shared(variable1->uuid());
+  constraint1->data = 5.0;
+  graph.addConstraint(constraint1);
+  graph.optimize();
+  EXPECT_NEAR(5.0, variable1->data()[0], 1.0e-7);
+
+  // Move the first variable behind the graph's back, then add an unrelated variable. The first variable is not part
+  // of the affected region, so it must not be touched by the next optimization.
+  variable1->data()[0] = 0.0;
+  auto variable2 = ExampleVariable::make_shared();
+  variable2->data()[0] = 2.5;
+  graph.addVariable(variable2);
+  auto constraint2 = ExampleConstraint::make_shared(variable2->uuid());
+  constraint2->data = -3.0;
+  graph.addConstraint(constraint2);
+  graph.optimize();
+  EXPECT_EQ(0.0, variable1->data()[0]);
+  EXPECT_NEAR(-3.0, variable2->data()[0], 1.0e-7);
+
+  // With nothing affected, optimize is a no-op
+  variable2->data()[0] = 1.0;
+  graph.optimize();
+  EXPECT_EQ(1.0, variable2->data()[0]);
+}
+
+TEST(IncrementalGraph, RegionExpansion)
+{
+  // Build identical chains in an incremental graph and a batch graph
+  std::vector<ExampleVariable::SharedPtr> incremental_variables;
+  fuse_graphs::IncrementalGraph incremental_graph(ceres::Problem::Options(), 0.0, 100);
+  incremental_graph.update(createChain(incremental_variables, 10));
+  incremental_graph.optimize();
+
+  // Add a conflicting measurement to the end of the chain. With a zero threshold, every change propagates along the
+  // chain and the incremental result matches the batch result.
+  auto conflict = ExampleConstraint::make_shared(incremental_variables.back()->uuid());
+  conflict->data = 20.0;
+  incremental_graph.addConstraint(conflict);
+  incremental_graph.optimize();
+
+  std::vector<ExampleVariable::SharedPtr> batch_variables;
+  fuse_graphs::HashGraph batch_graph;
+  batch_graph.update(createChain(batch_variables, 10));
+  auto batch_conflict = ExampleConstraint::make_shared(batch_variables.back()->uuid());
+  batch_conflict->data = 20.0;
+  batch_graph.addConstraint(batch_conflict);
+  batch_graph.optimize();
+
+  for (size_t i = 0; i < batch_variables.size(); ++i)
+  {
+    EXPECT_NEAR(batch_variables[i]->data()[0], incremental_variables[i]->data()[0], 1.0e-3);
+  }
+
+  // With an infinite threshold, only the variable touched by the new constraint is solved
+  std::vector<ExampleVariable::SharedPtr> local_variables;
+  fuse_graphs::IncrementalGraph local_graph(ceres::Problem::Options(), std::numeric_limits<double>::infinity());
+  local_graph.update(createChain(local_variables, 10));
+  local_graph.optimize();
+  auto local_conflict = ExampleConstraint::make_shared(local_variables.back()->uuid());
+  local_conflict->data = 20.0;
+  local_graph.addConstraint(local_conflict);
+  local_graph.optimize();
+  for (size_t i = 0; i + 1 < local_variables.size(); ++i)
+  {
+    EXPECT_NEAR(static_cast<double>(i), local_variables[i]->data()[0], 1.0e-7);
+  }
+  EXPECT_NEAR(14.5, local_variables.back()->data()[0], 1.0e-7);
+}
+
+TEST(IncrementalGraph, FullSolveInterval)
+{
+  // With an infinite threshold the region never expands, but every second optimization solves the entire graph
+  std::vector<ExampleVariable::SharedPtr> incremental_variables;
+  fuse_graphs::IncrementalGraph incremental_graph(
+    ceres::Problem::Options(),
+    std::numeric_limits<double>::infinity(),
+    10,
+    2);
+  incremental_graph.update(createChain(incremental_variables, 10));
+  incremental_graph.optimize();
+  auto conflict = ExampleConstraint::make_shared(incremental_variables.back()->uuid());
+  conflict->data = 20.0;
+  incremental_graph.addConstraint(conflict);
+  incremental_graph.optimize();
+  EXPECT_TRUE(incremental_graph.affectedVariables().empty());
+
+  std::vector<ExampleVariable::SharedPtr> batch_variables;
+  fuse_graphs::HashGraph batch_graph;
+  batch_graph.update(createChain(batch_variables, 10));
+  auto batch_conflict = ExampleConstraint::make_shared(batch_variables.back()->uuid());
+  batch_conflict->data = 20.0;
+  batch_graph.addConstraint(batch_conflict);
+  batch_graph.optimize();
+
+  for (size_t i = 0; i < batch_variables.size(); ++i)
+  {
+    EXPECT_NEAR(batch_variables[i]->data()[0], incremental_variables[i]->data()[0], 1.0e-3);
+  }
+
+  // Optimizations with nothing to do do not count toward the interval
+  incremental_graph.optimize();
+  auto conflict2 = ExampleConstraint::make_shared(incremental_variables.front()->uuid());
+  conflict2->data = -20.0;
+  incremental_graph.addConstraint(conflict2);
+  const double last_value = incremental_variables.back()->data()[0];
+  incremental_graph.optimize();
+  EXPECT_EQ(last_value, incremental_variables.back()->data()[0]);
+}
+
+TEST(IncrementalGraph, TangentSpaceThreshold)
+{
+  // Build identical chains of scaled variables in an incremental graph and a batch graph. A conflicting measurement
+  // moves the last variable by 5.5, which is only 0.55 in the tangent space.
+  std::vector<ExampleVariable::SharedPtr> incremental_variables;
+  fuse_graphs::IncrementalGraph incremental_graph(ceres::Problem::Options(), 1.0);
+  incremental_graph.update(createChain<ScaledVariable>(incremental_variables, 10));
+  incremental_graph.optimize();
+  auto conflict = ExampleConstraint::make_shared(incremental_variables.back()->uuid());
+  conflict->data = 20.0;
+  incremental_graph.addConstraint(conflict);
+  incremental_graph.optimize();
+
+  std::vector<ExampleVariable::SharedPtr> batch_variables;
+  fuse_graphs::HashGraph batch_graph;
+  batch_graph.update(createChain<ScaledVariable>(batch_variables, 10));
+  auto batch_conflict = ExampleConstraint::make_shared(batch_variables.back()->uuid());
+  batch_conflict->data = 20.0;
+  batch_graph.addConstraint(batch_conflict);
+  batch_graph.optimize();
+
+  // The tangent-space change is below the threshold, so the neighbors are not relinearized. Unlike the batch
+  // optimization, the rest of the chain keeps its previous values.
+  for (size_t i = 0; i + 1 < incremental_variables.size(); ++i)
+  {
+    EXPECT_NEAR(static_cast<double>(i), incremental_variables[i]->data()[0], 1.0e-7);
+    EXPECT_GT(batch_variables[i]->data()[0], static_cast<double>(i) + 0.1);
+  }
+  EXPECT_NEAR(14.5, incremental_variables.back()->data()[0], 1.0e-7);
+  EXPECT_GT(batch_variables.back()->data()[0] - incremental_variables.back()->data()[0], 0.1);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
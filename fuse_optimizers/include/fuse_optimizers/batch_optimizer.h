@@ -42,6 +42,8 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <set>
@@ -65,7 +67,21 @@ namespace fuse_optimizers
  * that continuously grow in size, this means that the optimization period is not overly important. The time spent
  * waiting versus the time spent optimizing will approach zero as the problem size increases.
  *
+ * Each optimization cycle is pipelined with the notification of the plugins. Once the graph has been optimized, the
+ * information required by the plugins is captured and handed to a separate notification thread through a bounded
+ * queue, and the next optimization cycle may start while the plugins are being notified. The sustained cycle rate is
+ * then limited by the slower of the two threads, rather than by their sum. When the cycles are run by an external
+ * scheduler, the plugins are notified at the end of each cycle instead.
+ *
+ * The optimizer reports its load to the sensor models once per optimization period, allowing them to shed data
+ * gracefully instead of building latency. The load is the larger of two ratios: the duration of the last (or current)
+ * optimization cycle relative to the optimization period, and the number of received transactions that have not yet
+ * been applied to the graph relative to the \p backpressure_queue_size.
+ *
  * Parameters:
+ *  - backpressure_queue_size (int, default: 100) The number of transactions waiting to be applied to the graph that
+ *                                                corresponds to a load of 1.0. A value <= 0 bases the load on the
+ *                                                optimization cycle duration alone.
  *  - ignition_sensors (string list, default: "") The optimization will wait until a transaction is received from one
  *                                                of these sensors. This is useful, for example, for providing an
  *                                                initial guess of the robot's position and orientation. Any
@@ -78,6 +94,10 @@ namespace fuse_optimizers
  *      type: string  (The plugin loader class string for the desired motion model type)
  *    - ...
  *    @endcode
+ *  - notification_queue_size (int, default: 1) The number of optimized cycles that may wait for their plugin
+ *                                              notifications before the next optimization cycle blocks. A value of 0
+ *                                              notifies the plugins from the optimization thread, at the end of each
+ *                                              cycle.
  *  - optimization_period (float, default: 10.0) The minimum time delay, in seconds, between optimization cycles.
  *  - publishers (struct array) The set of publisher plugins to load
  *    @code{.yaml}
@@ -122,6 +142,12 @@ public:
   virtual ~BatchOptimizer();
 
 protected:
+  /**
+   * @brief Function called instead of waking the optimization thread when an external scheduler owns the optimization
+   * cycles. See the protected constructor.
+   */
+  using OptimizationScheduler = std::function<void()>;
+
   /**
    * Structure containing the information required to process a transaction after it was received.
    */
@@ -149,19 +175,34 @@ protected:
    */
   using TransactionQueue = std::multimap<ros::Time, TransactionQueueElement>;
 
+  int backpressure_queue_size_;  //!< The number of waiting transactions that corresponds to a load of 1.0
   fuse_core::Transaction::SharedPtr combined_transaction_;  //!< Transaction used aggregate constraints and variables
                                                             //!< from multiple sensors and motions models before being
                                                             //!< applied to the graph.
+  size_t combined_transaction_count_;  //!< The number of sensor transactions merged into the combined transaction
+  std::atomic<double> cycle_duration_;  //!< The wall time, in seconds, spent in the last optimization cycle
+  std::atomic<double> cycle_start_time_;  //!< The wall time, in seconds, the current optimization cycle started, or
+                                          //!< zero if no optimization cycle is running
   std::mutex combined_transaction_mutex_;  //!< Synchronize access to the combined transaction across different threads
   std::vector<std::string> ignition_sensors_;  //!< The set of sensors whose transactions will trigger the optimizer
                                                //!< thread to start running. This is designed to keep the system idle
                                                //!< until the origin constraint has been received.
+  std::deque<Notification> notification_queue_;  //!< Optimized cycles waiting for their plugin notifications
+  std::condition_variable notification_queue_condition_;  //!< Signals changes of the notification queue in either
+                                                          //!< direction, and shutdown requests
+  std::mutex notification_queue_mutex_;  //!< Synchronize access to the notification queue
+  int notification_queue_size_;  //!< The maximum number of queued notifications. Zero disables the notification thread.
+  std::thread notification_thread_;  //!< Thread used to notify the plugins while the next cycle is optimized
   std::atomic<bool> optimization_request_;  //!< Flag to trigger a new optimization
   std::condition_variable optimization_requested_;  //!< Condition variable used by the optimization thread to wait
                                                     //!< until a new optimization is requested by the main thread
+  ros::Duration optimization_period_;  //!< The minimum time delay between optimization cycles
   std::mutex optimization_requested_mutex_;  //!< Required condition variable mutex
+  OptimizationScheduler optimization_scheduler_;  //!< External scheduler notified of optimization requests. When
+                                                 //!< empty, the optimizer runs its own optimization thread.
   std::thread optimization_thread_;  //!< Thread used to run the optimizer as a background process
   ros::Timer optimize_timer_;  //!< Trigger an optimization operation at a fixed frequency
+  std::atomic<bool> shutdown_request_;  //!< Flag to stop the optimization thread when the optimizer is destroyed
   TransactionQueue pending_transactions_;  //!< The set of received transactions that have not been added to the
                                            //!< optimizer yet. Transactions are added by the main thread, and removed
                                            //!< and processed by the optimization thread.
@@ -171,6 +212,28 @@ protected:
   ros::Duration transaction_timeout_;  //!< Parameter that controls how long to wait for a transaction to be processed
                                        //!< successfully before kicking it out of the queue.
 
+  /**
+   * @brief Constructor for optimizers whose optimization cycles are run by an external scheduler
+   *
+   * No optimization thread is created. Instead, the \p optimization_scheduler is called whenever an optimization has
+   * been requested, and the owner is expected to call optimizationCycle() from a thread of its choosing. The owner
+   * may also service the callbacks of the sensor models and publishers through the \p plugin_callback_queue_provider.
+   * This allows several optimizers to share a single pool of threads.
+   *
+   * @param[in] graph                          The derived graph object
+   * @param[in] node_handle                    A node handle in the global namespace
+   * @param[in] private_node_handle            A node handle in the node's private namespace
+   * @param[in] optimization_scheduler         The function called when a new optimization cycle is requested
+   * @param[in] plugin_callback_queue_provider The function providing the callback queue of each plugin, or empty if
+   *                                           the plugins service their own callbacks
+   */
+  BatchOptimizer(
+    fuse_core::Graph::UniquePtr graph,
+    const ros::NodeHandle& node_handle,
+    const ros::NodeHandle& private_node_handle,
+    OptimizationScheduler optimization_scheduler,
+    PluginCallbackQueueProvider plugin_callback_queue_provider);
+
   /**
    * @brief Generate motion model constraints for pending transactions
    *
@@ -181,10 +244,34 @@ protected:
    */
   void applyMotionModelsToQueue();
 
+  /**
+   * @brief Compute the current optimizer load
+   *
+   * See the class documentation for details.
+   */
+  double load();
+
+  /**
+   * @brief Function that notifies the plugins of completed optimization cycles, designed to be run in a separate thread
+   *
+   * This function waits for a queued notification or a shutdown signal, then either sends the notification or exits.
+   */
+  void notificationLoop();
+
+  /**
+   * @brief Perform a single optimization cycle
+   *
+   * The combined transaction is applied to the graph, the graph is optimized, and the information required by the
+   * plugins is captured. That information is queued for the notification thread if it is running, or sent to the
+   * plugins directly otherwise. The optimization request flag is cleared once the cycle is complete.
+   */
+  void optimizationCycle();
+
   /**
    * @brief Function that optimizes all constraints, designed to be run in a separate thread.
    *
-   * This function waits for an optimization or shutdown signal, then either calls optimize() or exits appropriately.
+   * This function waits for an optimization or shutdown signal, then either calls optimizationCycle() or exits
+   * appropriately.
    */
   void optimizationLoop();
 
@@ -192,7 +279,8 @@ protected:
    * @brief Callback fired at a fixed frequency to trigger a new optimization cycle.
    *
    * This callback checks if a current optimization cycle is still running. If not, a new optimization cycle is started.
-   * If so, we simply wait for the next timer event to start another optimization cycle.
+   * If so, we simply wait for the next timer event to start another optimization cycle. The current load is reported
+   * to the sensor models in either case.
    *
    * @param event  The ROS timer event metadata
    */
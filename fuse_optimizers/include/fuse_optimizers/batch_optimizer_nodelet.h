@@ -0,0 +1,90 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_OPTIMIZERS_BATCH_OPTIMIZER_NODELET_H
+#define FUSE_OPTIMIZERS_BATCH_OPTIMIZER_NODELET_H
+
+#include <fuse_optimizers/batch_optimizer.h>
+#include <nodelet/nodelet.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
+
+
+namespace fuse_optimizers
+{
+
+/**
+ * @brief A nodelet wrapper around the BatchOptimizer
+ *
+ * Loading the optimizer into a nodelet manager allows sensor drivers loaded into the same manager to deliver their
+ * messages to the sensor model plugins by pointer, without serialization or copies. This is particularly useful for
+ * high-bandwidth inputs such as point clouds and images. See fuse_core::AsyncSensorModel for how sensor models should
+ * subscribe to take advantage of this.
+ *
+ * The optimizer uses the nodelet's node handles, so all BatchOptimizer parameters and plugin parameters are read
+ * from the nodelet's private namespace, exactly as they would be for the batch_optimizer_node, and the plugins'
+ * topics follow the nodelet's namespace and remappings. The graph is configured from the same namespace; see
+ * fuse_graphs::HashGraphParams. The optimizer's transaction and timer callbacks are serviced
+ * sequentially by a callback queue owned by the nodelet, so that no callback referencing the optimizer outlives it
+ * in the manager's queues.
+ */
+class BatchOptimizerNodelet : public nodelet::Nodelet
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  BatchOptimizerNodelet();
+
+  /**
+   * @brief Destructor
+   *
+   * Stops servicing the optimizer's callback queue and discards any pending callbacks before the optimizer is
+   * destroyed.
+   */
+  virtual ~BatchOptimizerNodelet();
+
+private:
+  ros::CallbackQueue callback_queue_;  //!< The queue servicing the optimizer's transaction and timer callbacks
+  BatchOptimizer::UniquePtr optimizer_;  //!< The optimizer instance
+  ros::AsyncSpinner spinner_;  //!< A single thread servicing the callback queue, so callbacks run sequentially
+
+  /**
+   * @brief Construct the optimizer and load all of the configured plugins
+   */
+  void onInit() override;
+};
+
+}  // namespace fuse_optimizers
+
+#endif  // FUSE_OPTIMIZERS_BATCH_OPTIMIZER_NODELET_H
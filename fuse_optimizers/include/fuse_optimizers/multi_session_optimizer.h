@@ -0,0 +1,115 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_OPTIMIZERS_MULTI_SESSION_OPTIMIZER_H
+#define FUSE_OPTIMIZERS_MULTI_SESSION_OPTIMIZER_H
+
+#include <fuse_core/graph.h>
+#include <fuse_core/macros.h>
+#include <fuse_optimizers/task_scheduler.h>
+#include <ros/ros.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace fuse_optimizers
+{
+
+/**
+ * @brief Hosts many independent batch optimization sessions, e.g. one per robot, within a single process
+ *
+ * Each session is a complete BatchOptimizer, with its own graph, plugins, and configuration. Instead of every session
+ * and every plugin spawning its own threads, all sessions share a fixed pool of worker threads. Each session is given
+ * a private callback queue for the optimizer's timer and the sensor model transactions, and a callback queue for each
+ * of its sensor models and publishers. All of these queues, along with the optimization cycles themselves, are
+ * serviced by the worker pool. Motion models keep their own threads, as the optimizer blocks while they generate
+ * constraints.
+ *
+ * The queues are scheduled fairly by a TaskScheduler. A queue becomes ready whenever a callback is added to it, and
+ * the optimizer's queue also whenever an optimization is requested. Ready queues are serviced in first-come,
+ * first-served order. A queue is never serviced by more than one worker at a time, so the optimizer callbacks of a
+ * session execute sequentially, exactly as they would with a stand-alone BatchOptimizer, and so do the callbacks of
+ * each plugin. During each turn, a worker executes the callbacks that were pending when the turn started and, for the
+ * optimizer's queue, at most one optimization cycle. A queue with more work is then moved to the back of the line, so
+ * a single busy session or plugin cannot starve the others.
+ *
+ * Parameters:
+ *  - sessions (string list) The names of the sessions to create. The configuration of each session is read from the
+ *                           private sub-namespace of the same name, using the same parameters as the BatchOptimizer.
+ *                           The session's global node handle, and therefore the topics of its plugins, are also
+ *                           placed in the sub-namespace of the same name.
+ *  - thread_count (int, default: number of hardware threads) The number of worker threads shared by all sessions
+ */
+class MultiSessionOptimizer
+{
+public:
+  SMART_PTR_DEFINITIONS(MultiSessionOptimizer);
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] graph               A prototype graph object. Every session receives a clone of this graph, including
+   *                                any variables and constraints it already contains. Pass an empty graph to start
+   *                                every session from scratch.
+   * @param[in] node_handle         A node handle in the global namespace
+   * @param[in] private_node_handle A node handle in the node's private namespace
+   */
+  MultiSessionOptimizer(
+    fuse_core::Graph::UniquePtr graph,
+    const ros::NodeHandle& node_handle = ros::NodeHandle(),
+    const ros::NodeHandle& private_node_handle = ros::NodeHandle("~"));
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~MultiSessionOptimizer();
+
+  /**
+   * @brief The names of the configured sessions
+   */
+  std::vector<std::string> sessionNames() const;
+
+protected:
+  struct Session;
+
+  ros::NodeHandle node_handle_;  //!< Node handle in the public namespace
+  ros::NodeHandle private_node_handle_;  //!< Node handle in the private namespace for reading configuration settings
+  TaskScheduler scheduler_;  //!< The worker pool shared by all sessions
+  std::vector<std::unique_ptr<Session>> sessions_;  //!< The hosted optimization sessions
+};
+
+}  // namespace fuse_optimizers
+
+#endif  // FUSE_OPTIMIZERS_MULTI_SESSION_OPTIMIZER_H
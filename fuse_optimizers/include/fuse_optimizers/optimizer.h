@@ -37,12 +37,16 @@
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
 #include <fuse_core/motion_model.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/publisher.h>
 #include <fuse_core/sensor_model.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/variable_archive.h>
 #include <pluginlib/class_loader.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 
+#include <functional>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -87,6 +91,11 @@ namespace fuse_optimizers
  *  - name: string
  *    type: string
  *  - ...
+ * archive_retired_variables: bool  # Archive the final value of Stamped variables removed from the graph. The
+ *                                  # archive is never trimmed, so it grows with the trajectory. Default: false
+ * archive_covariance: bool  # Also archive the marginal covariance of each retired variable. Default: false
+ * diagnostics_period: float  # Period, in seconds, of the plugin callback statistics published on /diagnostics.
+ *                            # A value <= 0 disables the diagnostics. Default: 1.0
  * @endcode
  */
 class Optimizer
@@ -99,7 +108,8 @@ public:
    *
    * @param[in] graph               The derived graph object. This allows different graph implementations to be used
    *                                with the same optimizer code.
-   * @param[in] node_handle         A node handle in the global namespace
+   * @param[in] node_handle         A node handle in the global namespace. Sensor model transactions are delivered to
+   *                                the callback queue assigned to this node handle.
    * @param[in] private_node_handle A node handle in the node's private namespace
    */
   Optimizer(
@@ -122,20 +132,67 @@ protected:
   using SensorModelUniquePtr = class_loader::ClassLoader::UniquePtr<fuse_core::SensorModel>;
   using SensorModels = std::unordered_map<std::string, SensorModelUniquePtr>;
 
+  /**
+   * @brief Function providing a callback queue, serviced by the optimizer, to a sensor model or publisher plugin
+   *
+   * See fuse_core::SensorModel::useCallbackQueue(). The returned queue must outlive the plugin.
+   */
+  using PluginCallbackQueueProvider = std::function<ros::CallbackQueue*()>;
+
+  /**
+   * @brief The graph information sent to the plugins after an optimization cycle
+   *
+   * A notification is created by snapshot() and delivered by notify(). It does not reference the optimizer's graph, so
+   * it may be delivered while the next optimization cycle is already modifying the graph.
+   */
+  struct Notification
+  {
+    fuse_core::Transaction::ConstSharedPtr transaction;  //!< The additions and removals applied during the cycle
+    fuse_core::Graph::ConstSharedPtr graph;  //!< The copy of the graph information required by the plugins, if any
+    std::unordered_map<std::string, fuse_core::NotificationNeeds> motion_model_needs;  //!< Needs of each motion model
+    std::unordered_map<std::string, fuse_core::NotificationNeeds> publisher_needs;  //!< Needs of each publisher
+    std::unordered_map<std::string, fuse_core::NotificationNeeds> sensor_model_needs;  //!< Needs of each sensor model
+  };
+
   // Some internal book-keeping data structures
   using MotionModelGroup = std::vector<std::string>;  //!< A set of motion model names
   using AssociatedMotionModels = std::unordered_map<std::string, MotionModelGroup>;  //!< sensor -> motion models group
 
   AssociatedMotionModels associated_motion_models_;  //!< Tracks what motion models should be used for each sensor
+  fuse_core::VariableArchive::SharedPtr archive_;  //!< The archive of retired variables, or nullptr if disabled
+  bool archive_covariance_;  //!< Flag indicating the marginal covariance of retired variables should be archived
+  ros::Publisher diagnostics_publisher_;  //!< Publishes the callback statistics of every plugin
   fuse_core::Graph::UniquePtr graph_;  //!< The graph object that holds all variables and constraints
   pluginlib::ClassLoader<fuse_core::MotionModel> motion_model_loader_;  //!< Pluginlib class loader for MotionModels
   MotionModels motion_models_;  //!< The set of motion models, addressable by name
   ros::NodeHandle node_handle_;  //!< Node handle in the public namespace for subscribing and advertising
   ros::NodeHandle private_node_handle_;  //!< Node handle in the private namespace for reading configuration settings
+  PluginCallbackQueueProvider plugin_callback_queue_provider_;  //!< Provides the callback queues of the sensor models
+                                                               //!< and publishers, or empty if they service their own
   pluginlib::ClassLoader<fuse_core::Publisher> publisher_loader_;  //!< Pluginlib class loader for Publishers
   Publishers publishers_;  //!< The set of publishers to execute after every graph optimization
   pluginlib::ClassLoader<fuse_core::SensorModel> sensor_model_loader_;  //!< Pluginlib class loader for SensorModels
   SensorModels sensor_models_;  //!< The set of sensor models, addressable by name
+  ros::Timer diagnostics_timer_;  //!< Triggers the publication of the plugin diagnostics at a fixed period. Declared
+                                 //!< last so the timer is stopped before any plugin is destroyed.
+
+  /**
+   * @brief Constructor for optimizers that service the callbacks of the plugins themselves
+   *
+   * Before each sensor model and publisher is initialized, the \p plugin_callback_queue_provider is called and the
+   * returned queue is offered to the plugin. Plugins that accept it no longer service their own callbacks. Motion
+   * models always service their own callbacks, as the optimizer blocks while they generate constraints.
+   *
+   * @param[in] graph                          The derived graph object
+   * @param[in] node_handle                    A node handle in the global namespace
+   * @param[in] private_node_handle            A node handle in the node's private namespace
+   * @param[in] plugin_callback_queue_provider The function providing the callback queue of each plugin
+   */
+  Optimizer(
+    fuse_core::Graph::UniquePtr graph,
+    const ros::NodeHandle& node_handle,
+    const ros::NodeHandle& private_node_handle,
+    PluginCallbackQueueProvider plugin_callback_queue_provider);
 
   /**
    * @brief Callback fired every time a SensorModel plugin creates a new transaction
@@ -150,6 +207,36 @@ protected:
     const std::set<ros::Time>& stamps,
     const fuse_core::Transaction::SharedPtr& transaction) = 0;
 
+  /**
+   * @brief Write the final values of all Stamped variables removed by the transaction into the archive
+   *
+   * This must be called before the transaction is applied to the graph, while the removed variables still exist.
+   * Variables that are not derived from fuse_variables::Stamped are not archived. If archiving is disabled, this does
+   * nothing.
+   *
+   * @param[in] transaction The transaction that is about to be applied to the graph
+   */
+  void archiveRetiredVariables(const fuse_core::Transaction& transaction);
+
+  /**
+   * @brief Report the current optimizer load to all of the sensor models
+   *
+   * See fuse_core::SensorModel::backpressureCallback() for the meaning of the load value.
+   *
+   * @param[in] load The current optimizer load
+   */
+  void notifyBackpressure(double load);
+
+  /**
+   * @brief Publish the callback queue depth, latency, and execution time of every plugin that tracks them
+   *
+   * One diagnostic status is published for each plugin, named after the optimizer's private namespace and the plugin
+   * name. This makes it possible to identify the plugin that is limiting the throughput of the system.
+   *
+   * @param[in] event The ROS timer event metadata
+   */
+  void diagnosticsTimerCallback(const ros::TimerEvent& event);
+
   /**
    * @brief Configure the motion model plugins specified on the parameter server
    *
@@ -193,12 +280,43 @@ protected:
   /**
    * @brief Send the sensors, motion models, and publishers updated graph information
    *
+   * This is equivalent to calling notify() on the result of snapshot().
+   *
+   * This must be called from the thread that modifies the graph, as the graph is read during the call.
+   *
    * @param[in] transaction A read-only pointer to a transaction containing all recent additions and removals
-   * @param[in] graph       A read-only pointer to the graph object
+   * @param[in] graph       The optimized graph object. Copies are made as required by the plugins.
    */
   void notify(
     fuse_core::Transaction::ConstSharedPtr transaction,
-    fuse_core::Graph::ConstSharedPtr graph);
+    const fuse_core::Graph& graph);
+
+  /**
+   * @brief Send the sensors, motion models, and publishers the graph information captured by snapshot()
+   *
+   * The graph is not accessed, so this may be called from a different thread than the one that modifies the graph.
+   *
+   * @param[in] notification The graph information to send
+   */
+  void notify(const Notification& notification);
+
+  /**
+   * @brief Capture the graph information required by the sensors, motion models, and publishers
+   *
+   * The notification needs of every plugin are queried first, and only the information that is actually required is
+   * constructed. A deep copy of the graph is created only if at least one plugin requests the full graph. If plugins
+   * only request specific variables, a single graph containing copies of the union of all requested variables is
+   * shared between them. If no plugin requires any graph information, nothing is copied.
+   *
+   * This must be called from the thread that modifies the graph, as the graph is read during the call.
+   *
+   * @param[in] transaction A read-only pointer to a transaction containing all recent additions and removals
+   * @param[in] graph       The optimized graph object. Copies are made as required by the plugins.
+   * @return                The information to send to the plugins
+   */
+  Notification snapshot(
+    fuse_core::Transaction::ConstSharedPtr transaction,
+    const fuse_core::Graph& graph) const;
 };
 
 }  // namespace fuse_optimizers
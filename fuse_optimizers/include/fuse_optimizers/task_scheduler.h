@@ -0,0 +1,149 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_OPTIMIZERS_TASK_SCHEDULER_H
+#define FUSE_OPTIMIZERS_TASK_SCHEDULER_H
+
+#include <fuse_core/macros.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace fuse_optimizers
+{
+
+/**
+ * @brief Services many independent sources of work, e.g. callback queues, from a shared pool of worker threads
+ *
+ * Each source of work is registered as a task. A task becomes ready whenever schedule() is called for it, and ready
+ * tasks are serviced in first-come, first-served order. A task is never executed by more than one worker at a time,
+ * so the work of a single task is performed sequentially. Each execution of a task, or turn, should perform the work
+ * that was pending when the turn started, and report whether more work remains. A task with remaining work, or that
+ * was scheduled again during its turn, is then moved to the back of the line, so a single busy task cannot starve the
+ * others.
+ *
+ * All functions are thread-safe.
+ */
+class TaskScheduler
+{
+public:
+  SMART_PTR_DEFINITIONS(TaskScheduler);
+
+  /**
+   * @brief A single turn of a task
+   *
+   * An exception thrown by the task is logged and ends the turn as if no work remained.
+   *
+   * @return True if more work remains after this turn, false otherwise
+   */
+  using Task = std::function<bool()>;
+
+  /**
+   * @brief The identifier of a registered task
+   */
+  using TaskId = size_t;
+
+  /**
+   * @brief Constructor
+   *
+   * No worker threads are created until start() is called.
+   */
+  TaskScheduler();
+
+  /**
+   * @brief Destructor. Stops the worker threads.
+   */
+  virtual ~TaskScheduler();
+
+  /**
+   * @brief Register a new task. The task is not executed until it is scheduled.
+   *
+   * @param[in] task The function executed during each turn of the task
+   * @return         The identifier of the new task
+   */
+  TaskId addTask(Task task);
+
+  /**
+   * @brief Mark the task as ready to be serviced by the worker pool
+   *
+   * If the task is currently being serviced, it is moved to the back of the ready queue at the end of its turn.
+   * Tasks scheduled before start() wait until the workers are started. Tasks scheduled after stop() are ignored.
+   *
+   * @param[in] task_id The identifier returned by addTask()
+   * @throws std::out_of_range if \p task_id does not refer to a registered task
+   */
+  void schedule(TaskId task_id);
+
+  /**
+   * @brief Start the worker threads
+   *
+   * @param[in] thread_count The number of worker threads shared by all tasks
+   * @throws std::logic_error if the workers were already started
+   */
+  void start(size_t thread_count);
+
+  /**
+   * @brief Stop the worker threads, waiting for any turns in progress to complete
+   *
+   * Ready tasks are discarded, and the scheduler cannot be started again.
+   */
+  void stop();
+
+protected:
+  struct TaskState;
+
+  std::deque<TaskState*> ready_tasks_;  //!< Tasks waiting to be serviced, in the order they became ready
+  std::condition_variable ready_tasks_condition_;  //!< Wakes a worker when a task becomes ready
+  std::mutex ready_tasks_mutex_;  //!< Guards the ready queue, the registered tasks, and the state of every task
+  bool shutdown_request_;  //!< Flag to stop the worker threads. Guarded by ready_tasks_mutex_.
+  std::vector<std::unique_ptr<TaskState>> tasks_;  //!< The registered tasks, indexed by their identifiers
+  std::vector<std::thread> workers_;  //!< The thread pool shared by all tasks
+
+  /**
+   * @brief Function executed by each worker thread
+   *
+   * Repeatedly takes the next ready task, executes a single turn, then re-queues the task if it has more work.
+   */
+  void workerLoop();
+};
+
+}  // namespace fuse_optimizers
+
+#endif  // FUSE_OPTIMIZERS_TASK_SCHEDULER_H
@@ -37,11 +37,13 @@
 #include <ros/ros.h>
 
 #include <algorithm>
+#include <deque>
 #include <mutex>
 #include <set>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <utility>
 
 
 namespace fuse_optimizers
@@ -51,9 +53,33 @@ BatchOptimizer::BatchOptimizer(
   fuse_core::Graph::UniquePtr graph,
   const ros::NodeHandle& node_handle,
   const ros::NodeHandle& private_node_handle) :
-    fuse_optimizers::Optimizer(std::move(graph), node_handle, private_node_handle),
+    BatchOptimizer(
+      std::move(graph),
+      node_handle,
+      private_node_handle,
+      OptimizationScheduler(),
+      PluginCallbackQueueProvider())
+{
+}
+
+BatchOptimizer::BatchOptimizer(
+  fuse_core::Graph::UniquePtr graph,
+  const ros::NodeHandle& node_handle,
+  const ros::NodeHandle& private_node_handle,
+  OptimizationScheduler optimization_scheduler,
+  PluginCallbackQueueProvider plugin_callback_queue_provider) :
+    fuse_optimizers::Optimizer(
+      std::move(graph),
+      node_handle,
+      private_node_handle,
+      std::move(plugin_callback_queue_provider)),
     combined_transaction_(fuse_core::Transaction::make_shared()),
+    combined_transaction_count_(0),
+    cycle_duration_(0.0),
+    cycle_start_time_(0.0),
     optimization_request_(false),
+    optimization_scheduler_(std::move(optimization_scheduler)),
+    shutdown_request_(false),
     start_time_(ros::TIME_MAX),
     started_(false)
 {
@@ -66,6 +92,17 @@ BatchOptimizer::BatchOptimizer(
                     default_optimization_period << "s) instead.");
     optimization_period = default_optimization_period;
   }
+  optimization_period_ = ros::Duration(optimization_period);
+
+  private_node_handle_.param("backpressure_queue_size", backpressure_queue_size_, 100);
+
+  private_node_handle_.param("notification_queue_size", notification_queue_size_, 1);
+  if (notification_queue_size_ < 0)
+  {
+    ROS_WARN_STREAM("The requested notification_queue_size is < 0. Plugin notifications will be sent from the "
+                    "optimization thread instead.");
+    notification_queue_size_ = 0;
+  }
 
   double transaction_timeout;
   double default_transaction_timeout = 10.0;
@@ -101,23 +138,42 @@ BatchOptimizer::BatchOptimizer(
 
   // Configure a timer to trigger optimizations
   optimize_timer_ = node_handle_.createTimer(
-    ros::Duration(optimization_period),
+    optimization_period_,
     &BatchOptimizer::optimizerTimerCallback,
     this);
 
-  // Start the optimization thread
-  optimization_thread_ = std::thread(&BatchOptimizer::optimizationLoop, this);
+  // Start the optimization and notification threads, unless the optimization cycles are run by an external scheduler
+  if (!optimization_scheduler_)
+  {
+    if (notification_queue_size_ > 0)
+    {
+      notification_thread_ = std::thread(&BatchOptimizer::notificationLoop, this);
+    }
+    optimization_thread_ = std::thread(&BatchOptimizer::optimizationLoop, this);
+  }
 }
 
 BatchOptimizer::~BatchOptimizer()
 {
+  // Ask the optimization thread to exit. When running as a nodelet, the optimizer may be destroyed while ROS is still
+  // running, so ros::ok() alone is not sufficient.
+  {
+    std::lock_guard<std::mutex> lock(optimization_requested_mutex_);
+    std::lock_guard<std::mutex> notification_queue_lock(notification_queue_mutex_);
+    shutdown_request_ = true;
+  }
   // Wake up any sleeping threads
   optimization_requested_.notify_all();
+  notification_queue_condition_.notify_all();
   // Wait for the threads to shutdown
   if (optimization_thread_.joinable())
   {
     optimization_thread_.join();
   }
+  if (notification_thread_.joinable())
+  {
+    notification_thread_.join();
+  }
 }
 
 void BatchOptimizer::applyMotionModelsToQueue()
@@ -159,49 +215,136 @@ void BatchOptimizer::applyMotionModelsToQueue()
       std::lock_guard<std::mutex> combined_transaction_lock(combined_transaction_mutex_);
       combined_transaction_->merge(*element.transaction);
       combined_transaction_->merge(motion_transaction, true);
+      ++combined_transaction_count_;
     }
     // We are done with this transaction. Delete it from the queue.
     pending_transactions_.erase(pending_transactions_.begin());
   }
 }
 
+double BatchOptimizer::load()
+{
+  // Measure how far the optimization cycles overrun the optimization period. A cycle that is still running counts
+  // with its duration so far, so a single very long cycle is detected before it completes.
+  double cycle_duration = cycle_duration_;
+  const double cycle_start_time = cycle_start_time_;
+  if (cycle_start_time > 0.0)
+  {
+    cycle_duration = std::max(cycle_duration, ros::WallTime::now().toSec() - cycle_start_time);
+  }
+  double load = cycle_duration / optimization_period_.toSec();
+  // Measure the number of transactions that have been received but not yet applied to the graph
+  if (backpressure_queue_size_ > 0)
+  {
+    size_t queue_depth;
+    {
+      std::lock_guard<std::mutex> lock(pending_transactions_mutex_);
+      queue_depth = pending_transactions_.size();
+    }
+    {
+      std::lock_guard<std::mutex> lock(combined_transaction_mutex_);
+      queue_depth += combined_transaction_count_;
+    }
+    load = std::max(load, static_cast<double>(queue_depth) / backpressure_queue_size_);
+  }
+  return load;
+}
+
+void BatchOptimizer::notificationLoop()
+{
+  // Send notifications until told to exit. Any notifications still queued at shutdown are discarded.
+  while (true)
+  {
+    Notification notification;
+    {
+      std::unique_lock<std::mutex> lock(notification_queue_mutex_);
+      notification_queue_condition_.wait(
+        lock,
+        [this]{ return !notification_queue_.empty() || shutdown_request_; });  // NOLINT
+      if (shutdown_request_)
+      {
+        break;
+      }
+      notification = std::move(notification_queue_.front());
+      notification_queue_.pop_front();
+    }
+    // Let the optimization thread know there is space in the queue
+    notification_queue_condition_.notify_all();
+    notify(notification);
+  }
+}
+
 void BatchOptimizer::optimizationLoop()
 {
   // Optimize constraints until told to exit
-  while (ros::ok())
+  while (ros::ok() && !shutdown_request_)
   {
     // Wait for the next signal to start the next optimization cycle
     {
       std::unique_lock<std::mutex> lock(optimization_requested_mutex_);
-      optimization_requested_.wait(lock, [this]{ return optimization_request_ || !ros::ok(); });  // NOLINT
+      optimization_requested_.wait(
+        lock,
+        [this]{ return optimization_request_ || shutdown_request_ || !ros::ok(); });  // NOLINT
     }
     // If a shutdown is requested, exit now.
-    if (!ros::ok())
+    if (!ros::ok() || shutdown_request_)
     {
       break;
     }
-    // Copy the combined transaction so it can be shared with all the plugins
-    fuse_core::Transaction::ConstSharedPtr const_transaction;
+    optimizationCycle();
+  }
+}
+
+void BatchOptimizer::optimizationCycle()
+{
+  const auto cycle_start_time = ros::WallTime::now();
+  cycle_start_time_ = cycle_start_time.toSec();
+  // Copy the combined transaction so it can be shared with all the plugins
+  fuse_core::Transaction::ConstSharedPtr const_transaction;
+  {
+    std::lock_guard<std::mutex> lock(combined_transaction_mutex_);
+    const_transaction = combined_transaction_->clone();
+    combined_transaction_ = fuse_core::Transaction::make_shared();
+    combined_transaction_count_ = 0;
+  }
+  // Archive the final values of any retired variables, then update the graph
+  archiveRetiredVariables(*const_transaction);
+  graph_->update(*const_transaction);
+  // Optimize the entire graph
+  graph_->optimize();
+  // Optimization is complete. Capture the graph information required by the plugins before the next cycle modifies the
+  // graph. Copies of the graph are only made if they are required by the plugins.
+  auto notification = snapshot(const_transaction, *graph_);
+  if (notification_thread_.joinable())
+  {
+    // Hand the notification to the notification thread, so the next cycle can start while the plugins are notified.
+    // If the notification thread has fallen behind, wait for it. The wait is part of the cycle duration, so the load
+    // reflects the slower of the two threads.
     {
-      std::lock_guard<std::mutex> lock(combined_transaction_mutex_);
-      const_transaction = combined_transaction_->clone();
-      combined_transaction_ = fuse_core::Transaction::make_shared();
+      std::unique_lock<std::mutex> lock(notification_queue_mutex_);
+      notification_queue_condition_.wait(
+        lock,
+        [this]{ return (notification_queue_.size() < static_cast<size_t>(notification_queue_size_)) ||  // NOLINT
+                       shutdown_request_; });
+      notification_queue_.push_back(std::move(notification));
     }
-    // Update the graph
-    graph_->update(*const_transaction);
-    // Optimize the entire graph
-    graph_->optimize();
-    // Make a copy of the graph to share
-    fuse_core::Graph::ConstSharedPtr const_graph = graph_->clone();
-    // Optimization is complete. Notify all the things about the graph changes.
-    notify(const_transaction, const_graph);
-    // Clear the request flag now that this optimization cycle is complete
-    optimization_request_ = false;
+    notification_queue_condition_.notify_all();
   }
+  else
+  {
+    notify(notification);
+  }
+  // Record the duration of this cycle for the load computation
+  cycle_duration_ = (ros::WallTime::now() - cycle_start_time).toSec();
+  cycle_start_time_ = 0.0;
+  // Clear the request flag now that this optimization cycle is complete
+  optimization_request_ = false;
 }
 
 void BatchOptimizer::optimizerTimerCallback(const ros::TimerEvent& event)
 {
+  // Let the sensor models know if the optimizer is falling behind
+  notifyBackpressure(load());
   // If an "ignition" transaction hasn't been received, then we can't do anything yet.
   if (!started_)
   {
@@ -222,7 +365,14 @@ void BatchOptimizer::optimizerTimerCallback(const ros::TimerEvent& event)
   // will not be waiting on the condition variable signal, so nothing will happen.
   if (optimization_request_)
   {
-    optimization_requested_.notify_one();
+    if (optimization_scheduler_)
+    {
+      optimization_scheduler_();
+    }
+    else
+    {
+      optimization_requested_.notify_one();
+    }
   }
 }
 
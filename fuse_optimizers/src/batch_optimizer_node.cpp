@@ -32,14 +32,23 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/hash_graph_params.h>
 #include <fuse_optimizers/batch_optimizer.h>
 #include <ros/ros.h>
 
+#include <ceres/problem.h>
+
 
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "batch_optimizer_node");
-  fuse_optimizers::BatchOptimizer optimizer(fuse_graphs::HashGraph::make_unique());
+  fuse_graphs::HashGraphParams graph_params;
+  graph_params.loadFromROS(ros::NodeHandle("~"));
+  fuse_optimizers::BatchOptimizer optimizer(fuse_graphs::HashGraph::make_unique(
+    ceres::Problem::Options(),
+    graph_params.clone_threads,
+    graph_params.spatial_index_cell_size,
+    graph_params.spatial_index_variable_types));
   ros::spin();
 
   return 0;
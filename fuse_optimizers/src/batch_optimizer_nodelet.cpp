@@ -0,0 +1,90 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/hash_graph_params.h>
+#include <fuse_optimizers/batch_optimizer.h>
+#include <fuse_optimizers/batch_optimizer_nodelet.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <ros/callback_queue.h>
+#include <ros/node_handle.h>
+#include <ros/spinner.h>
+
+#include <ceres/problem.h>
+
+#include <utility>
+
+
+namespace fuse_optimizers
+{
+
+BatchOptimizerNodelet::BatchOptimizerNodelet() :
+  spinner_(1, &callback_queue_)
+{
+}
+
+BatchOptimizerNodelet::~BatchOptimizerNodelet()
+{
+  // The queued transaction and timer callbacks reference the optimizer. Stop the spinner, which waits for any
+  // callback in progress, then disable and clear the queue so that nothing queued runs after the optimizer is gone.
+  // Disabling the queue also drops any transactions the sensor models inject while the optimizer shuts down.
+  spinner_.stop();
+  callback_queue_.disable();
+  callback_queue_.clear();
+  optimizer_.reset();
+}
+
+void BatchOptimizerNodelet::onInit()
+{
+  // The sensor models inject their transactions into the queue of the optimizer's node handle. Service the
+  // optimizer's timers on the same queue, with a single thread, so that, as in the batch_optimizer_node, all optimizer
+  // callbacks are executed sequentially.
+  ros::NodeHandle node_handle = getNodeHandle();
+  node_handle.setCallbackQueue(&callback_queue_);
+  ros::NodeHandle private_node_handle = getPrivateNodeHandle();
+  private_node_handle.setCallbackQueue(&callback_queue_);
+  fuse_graphs::HashGraphParams graph_params;
+  graph_params.loadFromROS(private_node_handle);
+  auto graph = fuse_graphs::HashGraph::make_unique(
+    ceres::Problem::Options(),
+    graph_params.clone_threads,
+    graph_params.spatial_index_cell_size,
+    graph_params.spatial_index_variable_types);
+  optimizer_ = BatchOptimizer::make_unique(std::move(graph), node_handle, private_node_handle);
+  spinner_.start();
+}
+
+}  // namespace fuse_optimizers
+
+PLUGINLIB_EXPORT_CLASS(fuse_optimizers::BatchOptimizerNodelet, nodelet::Nodelet);
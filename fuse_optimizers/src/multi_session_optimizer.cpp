@@ -0,0 +1,237 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/graph.h>
+#include <fuse_optimizers/batch_optimizer.h>
+#include <fuse_optimizers/multi_session_optimizer.h>
+#include <fuse_optimizers/task_scheduler.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief A callback queue serviced by the multi-session worker pool
+ *
+ * The queue is registered as a task with the scheduler, and every added callback schedules a turn. Each turn executes
+ * the callbacks pending at its start, followed by any additional work, e.g. a requested optimization cycle.
+ */
+class SessionCallbackQueue : public ros::CallbackQueue
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] scheduler The scheduler servicing this queue. It must outlive any callback added to the queue.
+   * @param[in] work      Additional work performed at the end of every turn, or empty
+   */
+  explicit SessionCallbackQueue(
+    fuse_optimizers::TaskScheduler& scheduler,
+    std::function<void()> work = std::function<void()>()) :
+      scheduler_(scheduler),
+      work_(std::move(work))
+  {
+    task_id_ = scheduler_.addTask(
+      [this]()  // NOLINT(whitespace/braces)
+      {
+        callAvailable();
+        if (work_)
+        {
+          work_();
+        }
+        // Callbacks that could not be executed during this turn are left in the queue without being re-added
+        return !isEmpty();
+      });
+  }
+
+  void addCallback(const ros::CallbackInterfacePtr& callback, uint64_t removal_id = 0) override
+  {
+    ros::CallbackQueue::addCallback(callback, removal_id);
+    scheduler_.schedule(task_id_);
+  }
+
+  /**
+   * @brief Schedule a turn, e.g. when additional work is requested without adding a callback
+   */
+  void schedule()
+  {
+    scheduler_.schedule(task_id_);
+  }
+
+private:
+  fuse_optimizers::TaskScheduler& scheduler_;  //!< The scheduler servicing this queue
+  fuse_optimizers::TaskScheduler::TaskId task_id_;  //!< The task registered for this queue
+  std::function<void()> work_;  //!< Additional work performed at the end of every turn
+};
+
+/**
+ * @brief A batch optimizer whose optimization cycles and plugin callbacks are executed by the multi-session worker pool
+ */
+class SessionOptimizer : public fuse_optimizers::BatchOptimizer
+{
+public:
+  SessionOptimizer(
+    fuse_core::Graph::UniquePtr graph,
+    const ros::NodeHandle& node_handle,
+    const ros::NodeHandle& private_node_handle,
+    OptimizationScheduler optimization_scheduler,
+    PluginCallbackQueueProvider plugin_callback_queue_provider) :
+      fuse_optimizers::BatchOptimizer(
+        std::move(graph),
+        node_handle,
+        private_node_handle,
+        std::move(optimization_scheduler),
+        std::move(plugin_callback_queue_provider))
+  {
+  }
+
+  /**
+   * @brief Run a single optimization cycle if one has been requested by the optimizer timer
+   */
+  void optimizeIfRequested()
+  {
+    if (optimization_request_)
+    {
+      optimizationCycle();
+    }
+  }
+};
+
+}  // namespace
+
+namespace fuse_optimizers
+{
+
+struct MultiSessionOptimizer::Session
+{
+  std::string name;  //!< The session name, which is also its parameter namespace
+  std::unique_ptr<SessionCallbackQueue> callback_queue;  //!< The queue for the optimizer timer and sensor model
+                                                         //!< transactions, which also runs the optimization cycles
+  std::vector<std::unique_ptr<SessionCallbackQueue>> plugin_callback_queues;  //!< The queues of the sensor models and
+                                                                              //!< publishers
+  std::unique_ptr<SessionOptimizer> optimizer;  //!< The session's optimizer. Destroyed before the callback queues.
+
+  explicit Session(const std::string& name) :
+    name(name)
+  {
+  }
+};
+
+MultiSessionOptimizer::MultiSessionOptimizer(
+  fuse_core::Graph::UniquePtr graph,
+  const ros::NodeHandle& node_handle,
+  const ros::NodeHandle& private_node_handle) :
+    node_handle_(node_handle),
+    private_node_handle_(private_node_handle)
+{
+  std::vector<std::string> session_names;
+  private_node_handle_.getParam("sessions", session_names);
+  if (session_names.empty())
+  {
+    throw std::invalid_argument("The 'sessions' parameter must contain at least one session name.");
+  }
+
+  int default_thread_count = std::max(1u, std::thread::hardware_concurrency());
+  int thread_count;
+  private_node_handle_.param("thread_count", thread_count, default_thread_count);
+  if (thread_count <= 0)
+  {
+    ROS_WARN_STREAM("The requested thread_count is <= 0. Using the default value (" <<
+                    default_thread_count << ") instead.");
+    thread_count = default_thread_count;
+  }
+
+  // Create each session. The timer and transaction callbacks of a session are added to its own callback queue, and
+  // each of its sensor models and publishers is given a queue as well. All of them are serviced by the worker pool.
+  // Callbacks added while the sessions are still being configured are simply queued until the workers are started.
+  for (const auto& session_name : session_names)
+  {
+    auto session = std::unique_ptr<Session>(new Session(session_name));
+    Session* session_ptr = session.get();
+    session->callback_queue.reset(new SessionCallbackQueue(
+      scheduler_,
+      [session_ptr]() { session_ptr->optimizer->optimizeIfRequested(); }));  // NOLINT
+    // The plugins derive their node handles from these, so their topics are in the session's namespace as well
+    ros::NodeHandle session_node_handle(node_handle_, session_name);
+    session_node_handle.setCallbackQueue(session->callback_queue.get());
+    ros::NodeHandle session_private_node_handle(private_node_handle_, session_name);
+    session_private_node_handle.setCallbackQueue(session->callback_queue.get());
+    session->optimizer.reset(new SessionOptimizer(
+      graph->clone(),
+      session_node_handle,
+      session_private_node_handle,
+      [session_ptr]() { session_ptr->callback_queue->schedule(); },  // NOLINT
+      [this, session_ptr]()  // NOLINT(whitespace/braces)
+      {
+        session_ptr->plugin_callback_queues.emplace_back(new SessionCallbackQueue(scheduler_));
+        return session_ptr->plugin_callback_queues.back().get();
+      }));
+    sessions_.push_back(std::move(session));
+  }
+
+  // Start the shared worker pool
+  scheduler_.start(static_cast<size_t>(thread_count));
+}
+
+MultiSessionOptimizer::~MultiSessionOptimizer()
+{
+  // Stop the workers, waiting for any in-progress turns to complete
+  scheduler_.stop();
+  // Destroy the sessions while the scheduler is still valid. The plugins may still add callbacks to the session queues
+  // while they are being destroyed; these are ignored now that the scheduler is stopped.
+  sessions_.clear();
+}
+
+std::vector<std::string> MultiSessionOptimizer::sessionNames() const
+{
+  std::vector<std::string> session_names;
+  session_names.reserve(sessions_.size());
+  for (const auto& session : sessions_)
+  {
+    session_names.push_back(session->name);
+  }
+  return session_names;
+}
+
+}  // namespace fuse_optimizers
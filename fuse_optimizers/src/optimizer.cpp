@@ -31,20 +31,76 @@
  *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  *  POSSIBILITY OF SUCH DAMAGE.
  */
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <diagnostic_msgs/DiagnosticStatus.h>
+#include <diagnostic_msgs/KeyValue.h>
+#include <fuse_core/callback_statistics.h>
 #include <fuse_core/graph.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
 #include <fuse_optimizers/optimizer.h>
+#include <fuse_variables/stamped.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 
 #include <XmlRpcValue.h>
 
+#include <algorithm>
 #include <functional>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 
+namespace
+{
+
+/**
+ * @brief Query the notification needs of a single plugin, collecting any requested variables
+ *
+ * If the plugin throws an exception, an error is logged and the full graph is provided to the plugin, as before the
+ * notification needs were introduced.
+ *
+ * @param[in]    plugin              The sensor model, motion model, or publisher to query
+ * @param[in]    transaction         The transaction that was just applied to the graph
+ * @param[in]    plugin_kind         A description of the plugin type, used for error messages
+ * @param[in]    plugin_name         The name of the plugin, used for error messages
+ * @param[inout] requested_variables The set of variables requested by all plugins
+ * @return                           The notification needs of the plugin
+ */
+template <typename Plugin>
+fuse_core::NotificationNeeds queryNotificationNeeds(
+  const Plugin& plugin,
+  const fuse_core::Transaction& transaction,
+  const std::string& plugin_kind,
+  const std::string& plugin_name,
+  std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash>& requested_variables)
+{
+  try
+  {
+    auto needs = plugin.notificationNeeds();
+    if (needs == fuse_core::NotificationNeeds::VARIABLES)
+    {
+      auto variable_uuids = plugin.notificationVariables(transaction);
+      requested_variables.insert(variable_uuids.begin(), variable_uuids.end());
+    }
+    return needs;
+  }
+  catch (const std::exception& e)
+  {
+    ROS_ERROR_STREAM("Failed querying the notification needs of " << plugin_kind << " '" << plugin_name << "'. " <<
+                     "Error: " << e.what());
+    return fuse_core::NotificationNeeds::GRAPH;
+  }
+}
+
+}  // namespace
+
 namespace fuse_optimizers
 {
 
@@ -52,17 +108,119 @@ Optimizer::Optimizer(
   fuse_core::Graph::UniquePtr graph,
   const ros::NodeHandle& node_handle,
   const ros::NodeHandle& private_node_handle) :
+    Optimizer(std::move(graph), node_handle, private_node_handle, PluginCallbackQueueProvider())
+{
+}
+
+Optimizer::Optimizer(
+  fuse_core::Graph::UniquePtr graph,
+  const ros::NodeHandle& node_handle,
+  const ros::NodeHandle& private_node_handle,
+  PluginCallbackQueueProvider plugin_callback_queue_provider) :
+    archive_covariance_(false),
     graph_(std::move(graph)),
     motion_model_loader_("fuse_core", "fuse_core::MotionModel"),
     node_handle_(node_handle),
     private_node_handle_(private_node_handle),
+    plugin_callback_queue_provider_(std::move(plugin_callback_queue_provider)),
     publisher_loader_("fuse_core", "fuse_core::Publisher"),
     sensor_model_loader_("fuse_core", "fuse_core::SensorModel")
 {
+  // Configure the archive of retired variables. The archive is attached to the graph, and is therefore available to
+  // every plugin that receives a copy of the graph.
+  bool archive_retired_variables;
+  private_node_handle_.param("archive_retired_variables", archive_retired_variables, false);
+  private_node_handle_.param("archive_covariance", archive_covariance_, false);
+  if (archive_retired_variables)
+  {
+    archive_ = fuse_core::VariableArchive::make_shared();
+    graph_->archive(archive_);
+  }
+
   // Load all configured plugins
   loadMotionModels();
   loadSensorModels();
   loadPublishers();
+
+  // Periodically publish the callback statistics of all of the plugins
+  double diagnostics_period;
+  private_node_handle_.param("diagnostics_period", diagnostics_period, 1.0);
+  if (diagnostics_period > 0)
+  {
+    diagnostics_publisher_ = node_handle_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+    diagnostics_timer_ = node_handle_.createTimer(
+      ros::Duration(diagnostics_period),
+      &Optimizer::diagnosticsTimerCallback,
+      this);
+  }
+}
+
+void Optimizer::notifyBackpressure(double load)
+{
+  for (const auto& name__sensor_model : sensor_models_)
+  {
+    name__sensor_model.second->backpressureCallback(load);
+  }
+}
+
+void Optimizer::diagnosticsTimerCallback(const ros::TimerEvent& /* event */)
+{
+  diagnostic_msgs::DiagnosticArray diagnostics;
+  diagnostics.header.stamp = ros::Time::now();
+  auto add_status = [this, &diagnostics](
+    const std::string& plugin_name,
+    const fuse_core::CallbackStatistics::ConstSharedPtr& statistics)
+  {
+    if (!statistics)
+    {
+      return;
+    }
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = private_node_handle_.getNamespace() + ": " + plugin_name;
+    auto add_value = [&status](const std::string& key, const std::string& value)
+    {
+      diagnostic_msgs::KeyValue key_value;
+      key_value.key = key;
+      key_value.value = value;
+      status.values.push_back(std::move(key_value));
+    };
+    uint64_t queue_depth = 0;
+    for (const auto& summary : statistics->summarize())
+    {
+      queue_depth += summary.queue_depth;
+      add_value(summary.callback + " executed", std::to_string(summary.executed));
+      add_value(summary.callback + " queue depth", std::to_string(summary.queue_depth));
+      add_value(summary.callback + " max queue depth", std::to_string(summary.max_queue_depth));
+      add_value(summary.callback + " mean latency (s)", std::to_string(summary.mean_latency.toSec()));
+      add_value(summary.callback + " max latency (s)", std::to_string(summary.max_latency.toSec()));
+      add_value(summary.callback + " mean execution time (s)", std::to_string(summary.mean_execution_time.toSec()));
+      add_value(summary.callback + " max execution time (s)", std::to_string(summary.max_execution_time.toSec()));
+    }
+    status.message = std::to_string(queue_depth) + " callbacks pending";
+    diagnostics.status.push_back(std::move(status));
+  };
+  for (const auto& name__motion_model : motion_models_)
+  {
+    add_status(name__motion_model.first, name__motion_model.second->callbackStatistics());
+  }
+  for (const auto& name__publisher : publishers_)
+  {
+    add_status(name__publisher.first, name__publisher.second->callbackStatistics());
+  }
+  for (const auto& name__sensor_model : sensor_models_)
+  {
+    add_status(name__sensor_model.first, name__sensor_model.second->callbackStatistics());
+  }
+  // The plugin containers are unordered. Sort the statuses so consecutive messages are easy to compare.
+  std::sort(
+    diagnostics.status.begin(),
+    diagnostics.status.end(),
+    [](const diagnostic_msgs::DiagnosticStatus& lhs, const diagnostic_msgs::DiagnosticStatus& rhs)
+    {
+      return lhs.name < rhs.name;
+    });  // NOLINT
+  diagnostics_publisher_.publish(diagnostics);
 }
 
 void Optimizer::loadMotionModels()
@@ -100,7 +258,7 @@ void Optimizer::loadMotionModels()
     // Create a motion model object using pluginlib. This will throw if the plugin name is not found.
     auto motion_model = motion_model_loader_.createUniqueInstance(motion_model_type);
     // Initialize the publisher
-    motion_model->initialize(motion_model_name);
+    motion_model->initialize(motion_model_name, node_handle_, private_node_handle_);
     // Store the publisher in a member variable for use later
     motion_models_.emplace(motion_model_name, std::move(motion_model));
   }
@@ -133,6 +291,13 @@ void Optimizer::loadSensorModels()
                                   "-{name: string, type: string, motion_models: [name1, name2, ...]}");
     }
   }
+  // Transactions are delivered to the callback queue that services the optimizer's node handle. This is the global
+  // callback queue unless the node handle was given a queue of its own.
+  auto transaction_callback_queue = dynamic_cast<ros::CallbackQueue*>(node_handle_.getCallbackQueue());
+  if (!transaction_callback_queue)
+  {
+    transaction_callback_queue = ros::getGlobalCallbackQueue();
+  }
   for (int32_t sensor_index = 0; sensor_index < sensor_model_list.size(); ++sensor_index)
   {
     // Get the setting we need from the parameter server
@@ -140,11 +305,18 @@ void Optimizer::loadSensorModels()
     std::string sensor_type = static_cast<std::string>(sensor_model_list[sensor_index]["type"]);
     // Create a sensor object using pluginlib. This will throw if the plugin name is not found.
     auto sensor_model = sensor_model_loader_.createUniqueInstance(sensor_type);
+    // Offer the sensor a callback queue serviced by the derived optimizer, if any
+    if (plugin_callback_queue_provider_)
+    {
+      sensor_model->useCallbackQueue(plugin_callback_queue_provider_());
+    }
     // Initialize the sensor
     sensor_model->initialize(
       sensor_name,
       std::bind(&Optimizer::transactionCallback, this, sensor_name, std::placeholders::_1, std::placeholders::_2),
-      ros::getGlobalCallbackQueue());
+      transaction_callback_queue,
+      node_handle_,
+      private_node_handle_);
     // Store the sensor in a member variable for use later
     sensor_models_.emplace(sensor_name, std::move(sensor_model));
     // Parse out the list of associated motion models, if any
@@ -202,8 +374,13 @@ void Optimizer::loadPublishers()
     std::string publisher_type = static_cast<std::string>(publishers_list[publisher_index]["type"]);
     // Create a Publisher object using pluginlib. This will throw if the plugin name is not found.
     auto publisher = publisher_loader_.createUniqueInstance(publisher_type);
+    // Offer the publisher a callback queue serviced by the derived optimizer, if any
+    if (plugin_callback_queue_provider_)
+    {
+      publisher->useCallbackQueue(plugin_callback_queue_provider_());
+    }
     // Initialize the publisher
-    publisher->initialize(publisher_name);
+    publisher->initialize(publisher_name, node_handle_, private_node_handle_);
     // Store the publisher in a member variable for use later
     publishers_.emplace(publisher_name, std::move(publisher));
   }
@@ -239,15 +416,89 @@ bool Optimizer::applyMotionModels(
   return success;
 }
 
+void Optimizer::archiveRetiredVariables(const fuse_core::Transaction& transaction)
+{
+  if (!archive_)
+  {
+    return;
+  }
+  // Collect the removed variables that still exist in the graph and carry a stamp
+  std::vector<std::pair<const fuse_core::Variable*, const fuse_variables::Stamped*>> retired_variables;
+  for (const auto& variable_uuid : transaction.removedVariables())
+  {
+    if (!graph_->variableExists(variable_uuid))
+    {
+      continue;
+    }
+    const auto& variable = graph_->getVariable(variable_uuid);
+    auto stamped_variable = dynamic_cast<const fuse_variables::Stamped*>(&variable);
+    if (stamped_variable)
+    {
+      retired_variables.emplace_back(&variable, stamped_variable);
+    }
+  }
+  if (retired_variables.empty())
+  {
+    return;
+  }
+  // Compute the marginal covariance of all retired variables in a single request, if requested
+  std::vector<std::vector<double>> covariances(retired_variables.size());
+  if (archive_covariance_)
+  {
+    std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>> covariance_requests;
+    covariance_requests.reserve(retired_variables.size());
+    for (const auto& retired_variable : retired_variables)
+    {
+      covariance_requests.emplace_back(retired_variable.first->uuid(), retired_variable.first->uuid());
+    }
+    try
+    {
+      graph_->getCovariance(covariance_requests, covariances);
+    }
+    catch (const std::exception& e)
+    {
+      ROS_WARN_STREAM_THROTTLE(10.0, "Failed to compute the covariance of the retired variables. They will be " <<
+                               "archived without covariance. Error: " << e.what());
+      covariances.assign(retired_variables.size(), std::vector<double>());
+    }
+  }
+  for (size_t i = 0; i < retired_variables.size(); ++i)
+  {
+    const auto& retired_variable = retired_variables[i];
+    archive_->append(
+      *retired_variable.first,
+      retired_variable.second->stamp(),
+      retired_variable.second->deviceId(),
+      covariances[i]);
+  }
+}
+
 void Optimizer::notify(
   fuse_core::Transaction::ConstSharedPtr transaction,
-  fuse_core::Graph::ConstSharedPtr graph)
+  const fuse_core::Graph& graph)
 {
+  notify(snapshot(std::move(transaction), graph));
+}
+
+void Optimizer::notify(const Notification& notification)
+{
+  // A plugin that requested a subset of the variables may receive the full graph if it was needed by another plugin
+  const auto& shared_graph = notification.graph;
+  auto select_graph = [&shared_graph](fuse_core::NotificationNeeds needs) -> fuse_core::Graph::ConstSharedPtr
+  {
+    return (needs >= fuse_core::NotificationNeeds::VARIABLES) ? shared_graph : fuse_core::Graph::ConstSharedPtr();
+  };
+  // Send the information to the plugins
   for (const auto& name__sensor_model : sensor_models_)
   {
+    auto needs = notification.sensor_model_needs.at(name__sensor_model.first);
+    if (needs == fuse_core::NotificationNeeds::NONE)
+    {
+      continue;
+    }
     try
     {
-      name__sensor_model.second->graphCallback(graph);
+      name__sensor_model.second->graphCallback(select_graph(needs));
     }
     catch (const std::exception& e)
     {
@@ -258,9 +509,14 @@ void Optimizer::notify(
   }
   for (const auto& name__motion_model : motion_models_)
   {
+    auto needs = notification.motion_model_needs.at(name__motion_model.first);
+    if (needs == fuse_core::NotificationNeeds::NONE)
+    {
+      continue;
+    }
     try
     {
-      name__motion_model.second->graphCallback(graph);
+      name__motion_model.second->graphCallback(select_graph(needs));
     }
     catch (const std::exception& e)
     {
@@ -271,9 +527,14 @@ void Optimizer::notify(
   }
   for (const auto& name__publisher : publishers_)
   {
+    auto needs = notification.publisher_needs.at(name__publisher.first);
+    if (needs == fuse_core::NotificationNeeds::NONE)
+    {
+      continue;
+    }
     try
     {
-      name__publisher.second->notify(transaction, graph);
+      name__publisher.second->notify(notification.transaction, select_graph(needs));
     }
     catch (const std::exception& e)
     {
@@ -284,4 +545,51 @@ void Optimizer::notify(
   }
 }
 
+Optimizer::Notification Optimizer::snapshot(
+  fuse_core::Transaction::ConstSharedPtr transaction,
+  const fuse_core::Graph& graph) const
+{
+  // Query the notification needs of every plugin. The needs are queried exactly once per cycle, and the same values
+  // are used to both construct the shared graph information and to decide what each plugin receives.
+  Notification notification;
+  std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> requested_variables;
+  for (const auto& name__sensor_model : sensor_models_)
+  {
+    notification.sensor_model_needs[name__sensor_model.first] = queryNotificationNeeds(
+      *name__sensor_model.second, *transaction, "sensor", name__sensor_model.first, requested_variables);
+  }
+  for (const auto& name__motion_model : motion_models_)
+  {
+    notification.motion_model_needs[name__motion_model.first] = queryNotificationNeeds(
+      *name__motion_model.second, *transaction, "motion model", name__motion_model.first, requested_variables);
+  }
+  for (const auto& name__publisher : publishers_)
+  {
+    notification.publisher_needs[name__publisher.first] = queryNotificationNeeds(
+      *name__publisher.second, *transaction, "publisher", name__publisher.first, requested_variables);
+  }
+  // Build only the graph information that is actually required
+  auto max_needs = fuse_core::NotificationNeeds::NONE;
+  for (const auto* needs : {&notification.sensor_model_needs,  // NOLINT(whitespace/braces)
+                            &notification.motion_model_needs,
+                            &notification.publisher_needs})
+  {
+    for (const auto& name__needs : *needs)
+    {
+      max_needs = std::max(max_needs, name__needs.second);
+    }
+  }
+  if (max_needs == fuse_core::NotificationNeeds::GRAPH)
+  {
+    notification.graph = graph.clone();
+  }
+  else if (max_needs == fuse_core::NotificationNeeds::VARIABLES)
+  {
+    notification.graph = graph.cloneVariables(
+      std::vector<fuse_core::UUID>(requested_variables.begin(), requested_variables.end()));
+  }
+  notification.transaction = std::move(transaction);
+  return notification;
+}
+
 }  // namespace fuse_optimizers
@@ -0,0 +1,201 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_optimizers/task_scheduler.h>
+#include <ros/console.h>
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+
+namespace fuse_optimizers
+{
+
+struct TaskScheduler::TaskState
+{
+  /**
+   * @brief The scheduling state of a task
+   */
+  enum class State
+  {
+    IDLE,        //!< No work is pending
+    QUEUED,      //!< The task is waiting in the ready queue
+    RUNNING,     //!< A worker is servicing the task
+    RESCHEDULED  //!< A worker is servicing the task, and more work arrived in the meantime
+  };
+
+  Task task;  //!< The function executed during each turn
+  State state;  //!< The scheduling state. Guarded by the ready_tasks_mutex_.
+
+  explicit TaskState(Task task) :
+    task(std::move(task)),
+    state(State::IDLE)
+  {
+  }
+};
+
+TaskScheduler::TaskScheduler() :
+  shutdown_request_(false)
+{
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  stop();
+}
+
+TaskScheduler::TaskId TaskScheduler::addTask(Task task)
+{
+  std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+  tasks_.push_back(std::unique_ptr<TaskState>(new TaskState(std::move(task))));
+  return tasks_.size() - 1;
+}
+
+void TaskScheduler::schedule(TaskId task_id)
+{
+  {
+    std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+    if (shutdown_request_)
+    {
+      return;
+    }
+    auto& task = *tasks_.at(task_id);
+    switch (task.state)
+    {
+      case TaskState::State::IDLE:
+        task.state = TaskState::State::QUEUED;
+        ready_tasks_.push_back(&task);
+        break;
+      case TaskState::State::RUNNING:
+        // Re-queue the task at the end of its current turn
+        task.state = TaskState::State::RESCHEDULED;
+        return;
+      case TaskState::State::QUEUED:
+      case TaskState::State::RESCHEDULED:
+        return;
+    }
+  }
+  ready_tasks_condition_.notify_one();
+}
+
+void TaskScheduler::start(size_t thread_count)
+{
+  std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+  if (!workers_.empty() || shutdown_request_)
+  {
+    throw std::logic_error("The task scheduler workers can only be started once.");
+  }
+  for (size_t i = 0; i < thread_count; ++i)
+  {
+    workers_.emplace_back(&TaskScheduler::workerLoop, this);
+  }
+}
+
+void TaskScheduler::stop()
+{
+  // Ask the workers to exit, and wait for any in-progress turns to complete
+  {
+    std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+    shutdown_request_ = true;
+    ready_tasks_.clear();
+  }
+  ready_tasks_condition_.notify_all();
+  for (auto& worker : workers_)
+  {
+    if (worker.joinable())
+    {
+      worker.join();
+    }
+  }
+}
+
+void TaskScheduler::workerLoop()
+{
+  while (true)
+  {
+    // Wait for the next ready task
+    TaskState* task;
+    {
+      std::unique_lock<std::mutex> lock(ready_tasks_mutex_);
+      ready_tasks_condition_.wait(lock, [this]{ return shutdown_request_ || !ready_tasks_.empty(); });  // NOLINT
+      if (shutdown_request_)
+      {
+        return;
+      }
+      task = ready_tasks_.front();
+      ready_tasks_.pop_front();
+      task->state = TaskState::State::RUNNING;
+    }
+    // Execute a single turn. Work that remains after the turn is not always announced by another call to schedule(),
+    // e.g. callbacks left in a callback queue, so the result of the turn is checked in addition to the state.
+    // An exception thrown by the task must not terminate the worker, and with it the process. The failed turn is
+    // logged and treated as having no remaining work; the task runs again the next time it is scheduled.
+    bool work_remains = false;
+    try
+    {
+      work_remains = task->task();
+    }
+    catch (const std::exception& e)
+    {
+      ROS_ERROR_STREAM("A scheduled task threw an exception. Error: " << e.what());
+    }
+    catch (...)
+    {
+      ROS_ERROR_STREAM("A scheduled task threw an exception. Error: unknown");
+    }
+    bool requeued = false;
+    {
+      std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+      if (!shutdown_request_ && (work_remains || task->state == TaskState::State::RESCHEDULED))
+      {
+        task->state = TaskState::State::QUEUED;
+        ready_tasks_.push_back(task);
+        requeued = true;
+      }
+      else
+      {
+        task->state = TaskState::State::IDLE;
+      }
+    }
+    if (requeued)
+    {
+      ready_tasks_condition_.notify_one();
+    }
+  }
+}
+
+}  // namespace fuse_optimizers
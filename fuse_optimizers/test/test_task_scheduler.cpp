@@ -0,0 +1,241 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_optimizers/task_scheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief Records the order in which the task turns are executed
+ */
+class TurnRecorder
+{
+public:
+  void record(char task_name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    turns_ += task_name;
+  }
+
+  std::string turns()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return turns_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::string turns_;
+};
+
+/**
+ * @brief Wait until the condition is true, or a timeout expires
+ */
+bool waitFor(const std::function<bool()>& condition)
+{
+  const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition())
+  {
+    if (std::chrono::steady_clock::now() > timeout)
+    {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+TEST(TaskScheduler, Fairness)
+{
+  // A busy task with four units of work and two tasks with two units each. Every turn performs a single unit. With a
+  // single worker, the busy task goes to the back of the line after each turn, so the other tasks are not starved.
+  TurnRecorder recorder;
+  fuse_optimizers::TaskScheduler scheduler;
+  auto make_task = [&recorder](char task_name, int units)
+  {
+    return [&recorder, task_name, units]() mutable
+    {
+      recorder.record(task_name);
+      return --units > 0;
+    };
+  };
+  auto a = scheduler.addTask(make_task('A', 4));
+  auto b = scheduler.addTask(make_task('B', 2));
+  auto c = scheduler.addTask(make_task('C', 2));
+  scheduler.schedule(a);
+  scheduler.schedule(b);
+  scheduler.schedule(c);
+  // Scheduling a task that is already waiting does not add a second turn
+  scheduler.schedule(a);
+  scheduler.start(1);
+
+  ASSERT_TRUE(waitFor([&recorder]() { return recorder.turns().size() >= 8; }));  // NOLINT
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ("ABCABCAA", recorder.turns());
+}
+
+TEST(TaskScheduler, ScheduleDuringTurn)
+{
+  // A task scheduled again during its turn runs again, but only after the tasks that were already waiting
+  TurnRecorder recorder;
+  fuse_optimizers::TaskScheduler scheduler;
+  fuse_optimizers::TaskScheduler::TaskId a;
+  int a_turns = 0;
+  a = scheduler.addTask(
+    [&]()  // NOLINT(whitespace/braces)
+    {
+      recorder.record('A');
+      if (++a_turns < 3)
+      {
+        scheduler.schedule(a);
+      }
+      return false;
+    });
+  auto b = scheduler.addTask(
+    [&recorder]()  // NOLINT(whitespace/braces)
+    {
+      recorder.record('B');
+      return false;
+    });
+  scheduler.schedule(a);
+  scheduler.schedule(b);
+  scheduler.start(1);
+
+  ASSERT_TRUE(waitFor([&recorder]() { return recorder.turns().size() >= 4; }));  // NOLINT
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ("ABAA", recorder.turns());
+}
+
+TEST(TaskScheduler, Sequential)
+{
+  // A task is never executed by two workers at once, and no request is lost, even when it is scheduled from many
+  // threads while it is running
+  const int thread_count = 4;
+  const int schedule_count = 1000;
+  std::atomic<int> active(0);
+  std::atomic<int> max_active(0);
+  std::atomic<int> requested(0);
+  std::atomic<int> serviced(0);
+  fuse_optimizers::TaskScheduler scheduler;
+  auto task = scheduler.addTask(
+    [&]()  // NOLINT(whitespace/braces)
+    {
+      const int now_active = ++active;
+      int previous_max = max_active;
+      while (now_active > previous_max && !max_active.compare_exchange_weak(previous_max, now_active)) {}
+      serviced = requested.load();
+      std::this_thread::yield();
+      --active;
+      return false;
+    });
+  scheduler.start(thread_count);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i)
+  {
+    threads.emplace_back(
+      [&]()  // NOLINT(whitespace/braces)
+      {
+        for (int j = 0; j < schedule_count; ++j)
+        {
+          ++requested;
+          scheduler.schedule(task);
+        }
+      });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  EXPECT_TRUE(waitFor([&]() { return serviced == thread_count * schedule_count; }));  // NOLINT
+  EXPECT_EQ(1, max_active);
+}
+
+TEST(TaskScheduler, Exception)
+{
+  // A turn that throws is logged and the task goes idle. The worker survives, and the task runs again the next time
+  // it is scheduled.
+  std::atomic<int> turns(0);
+  fuse_optimizers::TaskScheduler scheduler;
+  auto task = scheduler.addTask(
+    [&turns]()  // NOLINT(whitespace/braces)
+    {
+      if (++turns == 1)
+      {
+        throw std::runtime_error("Failed turn");
+      }
+      return false;
+    });
+  scheduler.start(1);
+  scheduler.schedule(task);
+  ASSERT_TRUE(waitFor([&turns]() { return turns == 1; }));  // NOLINT
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, turns);
+
+  scheduler.schedule(task);
+  ASSERT_TRUE(waitFor([&turns]() { return turns == 2; }));  // NOLINT
+}
+
+TEST(TaskScheduler, Stop)
+{
+  std::atomic<int> turns(0);
+  fuse_optimizers::TaskScheduler scheduler;
+  auto task = scheduler.addTask([&turns]() { ++turns; return false; });  // NOLINT
+  scheduler.start(2);
+  scheduler.schedule(task);
+  ASSERT_TRUE(waitFor([&turns]() { return turns == 1; }));  // NOLINT
+  EXPECT_THROW(scheduler.schedule(task + 1), std::out_of_range);
+
+  // Once stopped, scheduled tasks are ignored and the workers cannot be restarted
+  scheduler.stop();
+  scheduler.schedule(task);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, turns);
+  EXPECT_THROW(scheduler.start(1), std::logic_error);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,220 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_PUBLISHERS_GRAPH_MARKER_PUBLISHER_H
+#define FUSE_PUBLISHERS_GRAPH_MARKER_PUBLISHER_H
+
+#include <fuse_core/async_publisher.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/macros.h>
+#include <fuse_core/notification_needs.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <geometry_msgs/Point.h>
+#include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
+#include <visualization_msgs/MarkerArray.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_publishers
+{
+
+/**
+ * @brief Publisher plugin that visualizes the variables and constraints of the graph as rviz markers
+ *
+ * Each position variable (Position2DStamped or Position3DStamped) is drawn as a sphere, and each constraint is drawn
+ * as a set of line segments connecting the positions of its variables. Variables that are not positions are drawn at
+ * the position with the same stamp and device, if one exists. Constraints involving fewer than two distinct positions
+ * are not drawn.
+ *
+ * Rebuilding the full marker array every cycle is prohibitively expensive for large graphs, both for this publisher
+ * and for rviz. Instead, every variable and constraint is assigned a stable marker id, and only the markers that
+ * changed are sent: new elements are added, elements that moved by more than the update tolerance are modified, and
+ * removed elements are deleted. When a new subscriber connects, all markers are cleared and sent again.
+ *
+ * The optimizer is only asked for copies of the position variables. The constraints, and the position used to draw
+ * each non-position variable, are tracked from the transactions instead, so a full copy of the graph is never needed.
+ *
+ * To keep large graphs cheap to visualize, the number of markers may be limited. When a limit is exceeded, only every
+ * N-th element is drawn, where N is the smallest power of two that satisfies the limit. Elements are selected using a
+ * hash of their UUID, so the same elements are drawn every cycle, and the elements drawn at a coarser level of detail
+ * are always a subset of the elements drawn at a finer level.
+ *
+ * Parameters:
+ *  - constraint_scale (double, default: 0.01) The width of the constraint lines, in meters
+ *  - frame_id (string, default: map) The frame of the variable positions
+ *  - max_constraint_markers (int, default: 0) The maximum number of constraints to draw, or 0 for no limit
+ *  - max_variable_markers (int, default: 0) The maximum number of variables to draw, or 0 for no limit
+ *  - update_tolerance (double, default: 0.001) A drawn element is only updated when it moves further than this
+ *  - variable_scale (double, default: 0.05) The diameter of the variable spheres, in meters
+ *
+ * Publishes:
+ *  - markers (visualization_msgs::MarkerArray) The changes to the graph markers since the previous message
+ */
+class GraphMarkerPublisher : public fuse_core::AsyncPublisher
+{
+public:
+  SMART_PTR_DEFINITIONS(GraphMarkerPublisher);
+
+  /**
+   * @brief Constructor
+   */
+  GraphMarkerPublisher();
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~GraphMarkerPublisher() = default;
+
+  /**
+   * @brief Perform any required post-construction initialization, such as advertising publishers or reading from the
+   * parameter server.
+   */
+  void onInit() override;
+
+  /**
+   * @brief Request copies of the position variables
+   *
+   * The variables are always requested so that notificationVariables() sees every transaction, but none are returned
+   * while no one is subscribed to the markers.
+   */
+  fuse_core::NotificationNeeds notificationNeeds() const override { return fuse_core::NotificationNeeds::VARIABLES; }
+
+  /**
+   * @brief Return the UUIDs of all position variables, or nothing if no one is subscribed to the markers
+   *
+   * Everything is sent again when a subscriber connects, so the positions are tracked even without subscribers.
+   *
+   * @param[in] transaction The transaction that was just applied to the graph
+   * @return                The UUIDs of the position variables to draw
+   */
+  std::vector<fuse_core::UUID> notificationVariables(const fuse_core::Transaction& transaction) const override;
+
+  /**
+   * @brief Notify the publisher about variables that have been added or removed
+   *
+   * @param[in] transaction A Transaction object, describing the set of variables that have been added and/or removed
+   * @param[in] graph       A read-only pointer to the graph object, allowing queries to be performed whenever needed
+   */
+  void notifyCallback(
+    fuse_core::Transaction::ConstSharedPtr transaction,
+    fuse_core::Graph::ConstSharedPtr graph) override;
+
+protected:
+  /**
+   * @brief The state of a marker that has been sent to the subscribers
+   */
+  struct PublishedMarker
+  {
+    int32_t id;  //!< The marker id
+    uint64_t cycle;  //!< The last publishing cycle in which the element was drawn
+    std::vector<geometry_msgs::Point> points;  //!< The points of the marker when it was last sent
+  };
+
+  using AnchorMap = std::unordered_map<fuse_core::UUID, std::pair<fuse_core::UUID, fuse_core::UUID>,
+                                       fuse_core::uuid::hash>;
+  using ConstraintMap = std::unordered_map<fuse_core::UUID, std::vector<fuse_core::UUID>, fuse_core::uuid::hash>;
+  using PositionMap = std::unordered_map<fuse_core::UUID, geometry_msgs::Point, fuse_core::uuid::hash>;
+  using PublishedMarkerMap = std::unordered_map<fuse_core::UUID, PublishedMarker, fuse_core::uuid::hash>;
+
+  /**
+   * @brief Track the constraints and the non-position variables added and removed by a transaction
+   *
+   * @param[in] transaction The transaction that was just applied to the graph
+   */
+  void updateTrackedElements(const fuse_core::Transaction& transaction);
+
+  /**
+   * @brief Find the position at which a variable should be drawn
+   *
+   * @param[in]  positions     The positions of all position variables in the graph
+   * @param[in]  variable_uuid The variable to locate
+   * @param[out] position      The position of the variable
+   * @return                   False if the variable has no associated position
+   */
+  bool findPosition(
+    const PositionMap& positions,
+    const fuse_core::UUID& variable_uuid,
+    geometry_msgs::Point& position) const;
+
+  /**
+   * @brief Add an add/modify marker to the array if the element is new or has moved
+   *
+   * @param[in]    uuid      The UUID of the variable or constraint
+   * @param[in]    points    The current points of the marker
+   * @param[in]    prototype A marker populated with the namespace, type, scale, and color of the element
+   * @param[inout] published The markers already sent for this kind of element
+   * @param[inout] markers   The array of changed markers
+   */
+  void updateMarker(
+    const fuse_core::UUID& uuid,
+    std::vector<geometry_msgs::Point>&& points,
+    const visualization_msgs::Marker& prototype,
+    PublishedMarkerMap& published,
+    visualization_msgs::MarkerArray& markers);
+
+  /**
+   * @brief Add delete markers for every element that was not drawn during the current cycle
+   */
+  void deleteStaleMarkers(
+    const std::string& ns,
+    PublishedMarkerMap& published,
+    visualization_msgs::MarkerArray& markers);
+
+  AnchorMap anchors_;  //!< The possible 2D and 3D positions used to draw each stamped non-position variable
+  visualization_msgs::Marker constraint_prototype_;  //!< The common properties of all constraint markers
+  ConstraintMap constraints_;  //!< The variables used by each constraint in the graph
+  uint64_t cycle_;  //!< The current publishing cycle, used to detect markers that are no longer drawn
+  std::string frame_id_;  //!< The frame of the variable positions
+  ros::Publisher marker_publisher_;  //!< The publisher that sends the marker changes
+  int max_constraint_markers_;  //!< The maximum number of constraints to draw, or 0 for no limit
+  int max_variable_markers_;  //!< The maximum number of variables to draw, or 0 for no limit
+  int32_t next_id_;  //!< The marker id assigned to the next new element
+  mutable std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> position_variables_;  //!< Updated by the optimizer
+  PublishedMarkerMap published_constraints_;  //!< The constraint markers that have been sent to the subscribers
+  PublishedMarkerMap published_variables_;  //!< The variable markers that have been sent to the subscribers
+  bool resend_;  //!< Flag indicating all markers should be cleared and sent again, e.g. for a new subscriber
+  double update_tolerance_;  //!< The distance an element must move before its marker is updated
+  visualization_msgs::Marker variable_prototype_;  //!< The common properties of all variable markers
+};
+
+}  // namespace fuse_publishers
+
+#endif  // FUSE_PUBLISHERS_GRAPH_MARKER_PUBLISHER_H
@@ -37,10 +37,18 @@
 #include <fuse_core/async_publisher.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/macros.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable_archive.h>
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
 #include <ros/ros.h>
 
+#include <map>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 
 namespace fuse_publishers
@@ -49,6 +57,12 @@ namespace fuse_publishers
 /**
  * @brief Publisher plugin that publishes all of the stamped 2D poses as a nav_msgs::Path message.
  *
+ * Poses that have been retired from the graph are read from the graph's variable archive, if one is attached, so the
+ * published path covers the full trajectory and not just the poses that remain in the graph. The archive is read
+ * incrementally: each notification only reads the entries appended since the previous one, and the archived poses
+ * are kept by the publisher. Only the 2D pose variables of the published device are requested from the optimizer, so
+ * the graph is never copied in its entirety.
+ *
  * Parameters:
  *  - device_id (uuid string, default: 00000000-0000-0000-0000-000000000000) The device/robot ID to publish
  *  - device_name (string) Used to generate the device/robot ID if the device_id is not provided
@@ -75,6 +89,22 @@ public:
    */
   void onInit() override;
 
+  /**
+   * @brief Request copies of the 2D pose variables of the published device instead of the entire graph
+   */
+  fuse_core::NotificationNeeds notificationNeeds() const override { return fuse_core::NotificationNeeds::VARIABLES; }
+
+  /**
+   * @brief Return the UUIDs of all 2D pose variables of the published device
+   *
+   * The pose variables are tracked using the variables added and removed by each transaction, so the graph never has
+   * to be searched.
+   *
+   * @param[in] transaction The transaction that was just applied to the graph
+   * @return                The UUIDs of the 2D pose variables of the published device
+   */
+  std::vector<fuse_core::UUID> notificationVariables(const fuse_core::Transaction& transaction) const override;
+
   /**
    * @brief Notify the publisher about variables that have been added or removed
    *
@@ -86,10 +116,26 @@ public:
     fuse_core::Graph::ConstSharedPtr graph) override;
 
 protected:
+  fuse_core::VariableArchive::ConstSharedPtr archive_;  //!< The archive read by the previous notification
+  size_t archive_position_;  //!< The number of archive entries that have already been read
+  std::map<ros::Time, geometry_msgs::PoseStamped> archived_poses_;  //!< The complete poses read from the archive
+  std::map<ros::Time, geometry_msgs::Point> archived_positions_;  //!< Archived positions without an orientation yet
+  std::map<ros::Time, double> archived_yaws_;  //!< Archived orientations without a position yet
   fuse_core::UUID device_id_;  //!< The UUID of the device to be published
   std::string frame_id_;  //!< The name of the frame for this path
+  mutable std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> pose_variables_;  //!< The device's 2D poses
   ros::Publisher path_publisher_;  //!< The publisher that sends the entire robot trajectory as a path
   ros::Publisher pose_array_publisher_;  //!< The publisher that sends the entire robot trajectory as a pose array
+
+  /**
+   * @brief Read the entries appended to the archive since the previous call into the archived poses
+   *
+   * If a different archive is attached to the graph, the previously archived poses are discarded and the new archive
+   * is read from the beginning.
+   *
+   * @param[in] archive The archive attached to the graph
+   */
+  void readArchive(fuse_core::VariableArchive::ConstSharedPtr archive);
 };
 
 }  // namespace fuse_publishers
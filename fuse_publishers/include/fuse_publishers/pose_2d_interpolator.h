@@ -0,0 +1,166 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_PUBLISHERS_POSE_2D_INTERPOLATOR_H
+#define FUSE_PUBLISHERS_POSE_2D_INTERPOLATOR_H
+
+#include <fuse_core/eigen.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/macros.h>
+#include <fuse_core/uuid.h>
+#include <geometry_msgs/Pose.h>
+#include <geometry_msgs/PoseWithCovariance.h>
+#include <ros/time.h>
+
+#include <map>
+
+
+namespace fuse_publishers
+{
+
+/**
+ * @brief Computes the pose of a device at arbitrary timestamps by interpolating between the optimized states
+ *
+ * Consumers often need the pose at a time that does not coincide with any state in the graph, for example to deskew a
+ * laser scan or to tag a detection. Adding a new state to the graph for each such query would grow the graph at the
+ * query rate. Instead, this class interpolates between the two neighboring Position2DStamped/Orientation2DStamped
+ * states of the requested device. The graph is never modified.
+ *
+ * If both neighboring states also have VelocityLinear2DStamped and VelocityAngular2DStamped variables, the velocities
+ * (expressed in the body frame) are used to construct a cubic Hermite spline between the states, which follows the
+ * curved motion of the device much more closely. Otherwise, the position is interpolated linearly and the yaw is
+ * interpolated along the shortest arc.
+ *
+ * The neighboring states are indexed once, during construction. Each query is then a logarithmic-time lookup,
+ * making the class suitable for high-rate queries against a single graph. Create a new instance for every graph
+ * update.
+ */
+class Pose2DInterpolator
+{
+public:
+  SMART_PTR_DEFINITIONS(Pose2DInterpolator);
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] graph     The optimized graph. The graph must not be modified while this object exists.
+   * @param[in] device_id The device whose poses will be queried
+   */
+  explicit Pose2DInterpolator(
+    fuse_core::Graph::ConstSharedPtr graph,
+    const fuse_core::UUID& device_id = fuse_core::uuid::NIL);
+
+  /**
+   * @brief Returns true if the graph contains no poses for the device
+   */
+  bool empty() const { return states_.empty(); }
+
+  /**
+   * @brief The stamp of the earliest pose of the device. Queries before this time will fail.
+   */
+  ros::Time earliestStamp() const;
+
+  /**
+   * @brief The stamp of the latest pose of the device. Queries after this time will fail.
+   */
+  ros::Time latestStamp() const;
+
+  /**
+   * @brief Compute the pose of the device at the requested time
+   *
+   * @param[in]  stamp The requested time
+   * @param[out] pose  The interpolated pose
+   * @return           False if the requested time is outside of the range spanned by the device's poses
+   */
+  bool getPose(const ros::Time& stamp, geometry_msgs::Pose& pose) const;
+
+  /**
+   * @brief Compute the pose and an approximate covariance of the device at the requested time
+   *
+   * The covariance is the blend of the marginal covariances of the two neighboring poses, weighted by the
+   * interpolation fraction. This ignores the information added by the motion between the poses, and is therefore
+   * a slightly conservative approximation. Computing the marginal covariances is expensive; use getPose() when the
+   * covariance is not needed.
+   *
+   * @param[in]  stamp The requested time
+   * @param[out] pose  The interpolated pose and covariance. Only the x, y, and yaw rows/columns are populated.
+   * @return           False if the requested time is outside of the range spanned by the device's poses, or the
+   *                   covariance could not be computed
+   */
+  bool getPoseWithCovariance(const ros::Time& stamp, geometry_msgs::PoseWithCovariance& pose) const;
+
+private:
+  /**
+   * @brief The optimized values of a single state of the device
+   */
+  struct State
+  {
+    fuse_core::UUID position_uuid;  //!< The UUID of the Position2DStamped variable
+    fuse_core::UUID orientation_uuid;  //!< The UUID of the Orientation2DStamped variable
+    fuse_core::Vector3d pose;  //!< The (x, y, yaw) pose of the state
+    bool has_velocity;  //!< Flag indicating that both linear and angular velocity variables exist for this state
+    fuse_core::Vector3d velocity;  //!< The body-frame (vx, vy, vyaw) velocity of the state, if available
+  };
+
+  using StateMap = std::map<ros::Time, State>;
+
+  /**
+   * @brief Find the states that bracket the requested time
+   *
+   * @param[in]  stamp    The requested time
+   * @param[out] previous The state at or before the requested time
+   * @param[out] next     The state at or after the requested time. This may be the same as \p previous.
+   * @param[out] fraction The fraction of the interval between the two states at which the requested time falls
+   * @return              False if the requested time is outside of the range spanned by the states
+   */
+  bool findNeighbors(
+    const ros::Time& stamp,
+    StateMap::const_iterator& previous,
+    StateMap::const_iterator& next,
+    double& fraction) const;
+
+  /**
+   * @brief Compute the (x, y, yaw) pose between two states
+   */
+  fuse_core::Vector3d interpolate(
+    const StateMap::const_iterator& previous,
+    const StateMap::const_iterator& next,
+    double fraction) const;
+
+  fuse_core::Graph::ConstSharedPtr graph_;  //!< The graph the states were read from
+  StateMap states_;  //!< The poses of the device, sorted by stamp
+};
+
+}  // namespace fuse_publishers
+
+#endif  // FUSE_PUBLISHERS_POSE_2D_INTERPOLATOR_H
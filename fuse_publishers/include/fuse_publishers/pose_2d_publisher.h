@@ -39,11 +39,14 @@
 #include <fuse_core/macros.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
+#include <geometry_msgs/TransformStamped.h>
 #include <ros/ros.h>
+#include <tf2/buffer_core.h>
 #include <tf2_ros/transform_broadcaster.h>
 #include <tf2_ros/transform_listener.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 
@@ -68,6 +71,13 @@ namespace fuse_publishers
  * updated to the current publication time. Although this is "wrong", it keeps the tf tree populated with recent
  * transform data so that other nodes can execute tf queries.
  *
+ * Computing the map->odom transform requires the odom->base transform at the time of the optimized pose, which may
+ * not have been received yet when the optimizer finishes. Rather than waiting for it, the optimized pose is stored as
+ * pending and a request is registered with the tf buffer. The map->odom transform is computed as soon as the matching
+ * odom->base transform arrives. If a newer pose is optimized first, the older pending pose is discarded. A pose older
+ * than the tf cache is discarded immediately, with a warning. Because nothing waits on tf anymore, the former
+ * tf_timeout parameter has been removed and is ignored if set.
+ *
  * Parameters:
  *  - base_frame (string, default: base_link)  Name for the robot's base frame
  *  - device_id (uuid string, default: 00000000-0000-0000-0000-000000000000) The device/robot ID to publish
@@ -78,7 +88,6 @@ namespace fuse_publishers
  *  - publish_to_tf (bool, default: false)  Flag indicating that the optimized pose should be published to tf
  *  - tf_cache_time (seconds, default: 10.0)  How long to keep a history of transforms (for map->odom lookup)
  *  - tf_publish_frequency (Hz, default: 10.0)  How often the latest pose should be published to tf
- *  - tf_timeout (seconds, default: 0.1)  The maximum amount of time to wait for a transform to become available
  *
  * Publishes:
  *  - pose (geometry_msgs::PoseStamped)  The most recent optimized robot pose (i.e. the map->base transform)
@@ -102,7 +111,7 @@ public:
   /**
    * @brief Destructor
    */
-  virtual ~Pose2DPublisher() = default;
+  virtual ~Pose2DPublisher();
 
   /**
    * @brief Perform any required post-construction initialization, such as advertising publishers or reading from the
@@ -133,6 +142,26 @@ public:
    */
   void tfPublishTimerCallback(const ros::TimerEvent& event);
 
+  /**
+   * @brief Callback fired by the tf buffer once a requested odom->base transform becomes available, or the request
+   *        fails
+   *
+   * This is called from the tf listener thread. If the transform is for the currently pending pose, the map->odom
+   * transform is computed and stored for publication. If the request failed, the pending pose is dropped.
+   *
+   * @param[in] request_handle The handle of the completed request
+   * @param[in] target_frame   The target frame of the request
+   * @param[in] source_frame   The source frame of the request
+   * @param[in] time           The requested transform time
+   * @param[in] result         Flag indicating if the transform is now available or the request failed
+   */
+  void odomTransformableCallback(
+    tf2::TransformableRequestHandle request_handle,
+    const std::string& target_frame,
+    const std::string& source_frame,
+    ros::Time time,
+    tf2::TransformableResult result);
+
 protected:
   std::string base_frame_;  //!< The name of the robot's base_link frame
   fuse_core::UUID device_id_;  //!< The UUID of the device to be published
@@ -147,9 +176,23 @@ protected:
                                                              //!< inserts the received transforms into the tf buffer
   tf2_ros::TransformBroadcaster tf_publisher_;  //!< Publish the map->odom or map->base transform to the tf system
   ros::Timer tf_publish_timer_;  //!< Timer that publishes tf messages to ensure the tf transform doesn't get stale
-  ros::Duration tf_timeout_;  //!< The max time to wait for a tf transform to become available
+  geometry_msgs::TransformStamped pending_map_to_base_;  //!< The most recent map->base transform that is waiting for
+                                                        //!< the odom->base transform at the same time
+  std::mutex tf_mutex_;  //!< Synchronize access to the tf transforms between the publisher and tf listener threads
+  tf2::TransformableCallbackHandle tf_callback_handle_;  //!< Handle of the callback registered with the tf buffer
+  tf2::TransformableRequestHandle tf_request_handle_;  //!< Handle of the outstanding odom->base request, if any
   geometry_msgs::TransformStamped tf_transform_;  //!< The transform to be published to tf
   bool use_tf_lookup_;  //!< Internal flag indicating that a tf frame lookup is required
+
+  /**
+   * @brief Compute the map->odom transform from the map->base transform and the odom->base transform in the tf buffer
+   *
+   * The tf buffer is queried without waiting. The odom->base transform must already be available.
+   *
+   * @param[in] map_to_base The optimized map->base transform
+   * @return                True if the tf_transform_ was updated, false otherwise
+   */
+  bool updateMapToOdom(const geometry_msgs::TransformStamped& map_to_base);
 };
 
 }  // namespace fuse_publishers
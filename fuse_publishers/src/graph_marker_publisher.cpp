@@ -0,0 +1,430 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_publishers/graph_marker_publisher.h>
+#include <fuse_core/async_publisher.h>
+#include <fuse_core/constraint.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/notification_needs.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/position_3d_stamped.h>
+#include <fuse_variables/stamped.h>
+#include <geometry_msgs/Point.h>
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
+#include <visualization_msgs/MarkerArray.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Register this publisher with ROS as a plugin.
+PLUGINLIB_EXPORT_CLASS(fuse_publishers::GraphMarkerPublisher, fuse_core::Publisher);
+
+
+// Some file-scope functions in an anonymous namespace
+namespace
+{
+
+/**
+ * @brief Compute the level of detail decimation, the smallest power of two that reduces the count below the limit
+ */
+size_t computeDecimation(const size_t count, const int max_count)
+{
+  if (max_count <= 0)
+  {
+    return 1;
+  }
+  size_t decimation = 1;
+  while (count > decimation * static_cast<size_t>(max_count))
+  {
+    decimation *= 2;
+  }
+  return decimation;
+}
+
+/**
+ * @brief Check if an element is drawn at the provided decimation. The selection is stable from cycle to cycle.
+ */
+bool isSelected(const fuse_core::UUID& uuid, const size_t decimation)
+{
+  return (decimation == 1) || (fuse_core::uuid::hash()(uuid) % decimation == 0);
+}
+
+/**
+ * @brief The type string of the 3D position variables
+ */
+const std::string& position3DType()
+{
+  static const std::string type = fuse_variables::Position3DStamped(ros::Time(0, 0)).type();
+  return type;
+}
+
+/**
+ * @brief Check if a variable is drawn as a position, using its type instead of a dynamic_cast
+ */
+bool isPosition(const fuse_core::Variable& variable)
+{
+  return (variable.type() == fuse_variables::Position2DStamped::TYPE) || (variable.type() == position3DType());
+}
+
+/**
+ * @brief Check if any point has moved further than the tolerance
+ */
+bool hasMoved(
+  const std::vector<geometry_msgs::Point>& previous,
+  const std::vector<geometry_msgs::Point>& current,
+  const double tolerance)
+{
+  if (previous.size() != current.size())
+  {
+    return true;
+  }
+  for (size_t i = 0; i < current.size(); ++i)
+  {
+    const double dx = current[i].x - previous[i].x;
+    const double dy = current[i].y - previous[i].y;
+    const double dz = current[i].z - previous[i].z;
+    if (dx * dx + dy * dy + dz * dz > tolerance * tolerance)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+namespace fuse_publishers
+{
+
+GraphMarkerPublisher::GraphMarkerPublisher() :
+  fuse_core::AsyncPublisher(1),
+  cycle_(0),
+  frame_id_("map"),
+  max_constraint_markers_(0),
+  max_variable_markers_(0),
+  next_id_(0),
+  resend_(true),
+  update_tolerance_(0.001)
+{
+}
+
+void GraphMarkerPublisher::onInit()
+{
+  // Configure the publisher
+  double constraint_scale = 0.01;
+  double variable_scale = 0.05;
+  private_node_handle_.getParam("constraint_scale", constraint_scale);
+  private_node_handle_.getParam("frame_id", frame_id_);
+  private_node_handle_.getParam("max_constraint_markers", max_constraint_markers_);
+  private_node_handle_.getParam("max_variable_markers", max_variable_markers_);
+  private_node_handle_.getParam("update_tolerance", update_tolerance_);
+  private_node_handle_.getParam("variable_scale", variable_scale);
+
+  // Define the properties shared by all markers of each kind
+  variable_prototype_.header.frame_id = frame_id_;
+  variable_prototype_.ns = "variables";
+  variable_prototype_.type = visualization_msgs::Marker::SPHERE;
+  variable_prototype_.pose.orientation.w = 1.0;
+  variable_prototype_.scale.x = variable_scale;
+  variable_prototype_.scale.y = variable_scale;
+  variable_prototype_.scale.z = variable_scale;
+  variable_prototype_.color.r = 0.1;
+  variable_prototype_.color.g = 0.4;
+  variable_prototype_.color.b = 0.9;
+  variable_prototype_.color.a = 1.0;
+  constraint_prototype_.header.frame_id = frame_id_;
+  constraint_prototype_.ns = "constraints";
+  constraint_prototype_.type = visualization_msgs::Marker::LINE_LIST;
+  constraint_prototype_.pose.orientation.w = 1.0;
+  constraint_prototype_.scale.x = constraint_scale;
+  constraint_prototype_.color.r = 0.2;
+  constraint_prototype_.color.g = 0.8;
+  constraint_prototype_.color.b = 0.2;
+  constraint_prototype_.color.a = 0.8;
+
+  // Advertise the topic. Only changes are sent, so a new subscriber needs all of the markers to be sent again. The
+  // connection callback is executed by this publisher's callback queue, the same as notifyCallback().
+  marker_publisher_ = private_node_handle_.advertise<visualization_msgs::MarkerArray>(
+    "markers",
+    100,
+    [this](const ros::SingleSubscriberPublisher&) { resend_ = true; });  // NOLINT(whitespace/braces)
+}
+
+std::vector<fuse_core::UUID> GraphMarkerPublisher::notificationVariables(
+  const fuse_core::Transaction& transaction) const
+{
+  for (const auto& variable : transaction.addedVariables())
+  {
+    if (isPosition(*variable))
+    {
+      position_variables_.insert(variable->uuid());
+    }
+  }
+  for (const auto& variable_uuid : transaction.removedVariables())
+  {
+    position_variables_.erase(variable_uuid);
+  }
+  if (marker_publisher_.getNumSubscribers() == 0)
+  {
+    return {};
+  }
+  return std::vector<fuse_core::UUID>(position_variables_.begin(), position_variables_.end());
+}
+
+void GraphMarkerPublisher::notifyCallback(
+  fuse_core::Transaction::ConstSharedPtr transaction,
+  fuse_core::Graph::ConstSharedPtr graph)
+{
+  // The constraints are tracked even without subscribers, as the graph copy does not contain them
+  updateTrackedElements(*transaction);
+  // Exit early if no one is listening. Everything will be sent again when a subscriber connects. The graph is also
+  // missing if a subscriber connected after the optimizer queried the notification needs.
+  if (!graph || (marker_publisher_.getNumSubscribers() == 0))
+  {
+    return;
+  }
+  visualization_msgs::MarkerArray markers;
+  if (resend_)
+  {
+    visualization_msgs::Marker delete_all;
+    delete_all.header.frame_id = frame_id_;
+    delete_all.action = visualization_msgs::Marker::DELETEALL;
+    markers.markers.push_back(delete_all);
+    published_constraints_.clear();
+    published_variables_.clear();
+    resend_ = false;
+  }
+  ++cycle_;
+
+  // Collect the positions of every position variable. The graph may also hold variables requested by other plugins.
+  PositionMap positions;
+  for (const auto& variable : graph->getVariables())
+  {
+    if (!isPosition(variable))
+    {
+      continue;
+    }
+    geometry_msgs::Point position;
+    position.x = variable.data()[0];
+    position.y = variable.data()[1];
+    position.z = (variable.size() > 2) ? variable.data()[2] : 0.0;
+    positions.emplace(variable.uuid(), position);
+  }
+
+  // Update the variable markers
+  const auto variable_decimation = computeDecimation(positions.size(), max_variable_markers_);
+  for (const auto& uuid__position : positions)
+  {
+    if (isSelected(uuid__position.first, variable_decimation))
+    {
+      updateMarker(uuid__position.first, {uuid__position.second}, variable_prototype_, published_variables_, markers);
+    }
+  }
+  deleteStaleMarkers(variable_prototype_.ns, published_variables_, markers);
+
+  // Update the constraint markers. Each constraint is drawn as segments from its first position to the others.
+  const auto constraint_decimation = computeDecimation(constraints_.size(), max_constraint_markers_);
+  for (const auto& uuid__variables : constraints_)
+  {
+    if (!isSelected(uuid__variables.first, constraint_decimation))
+    {
+      continue;
+    }
+    // Variables of the same pose (e.g. a position and an orientation) share a single position
+    std::vector<geometry_msgs::Point> constraint_positions;
+    for (const auto& variable_uuid : uuid__variables.second)
+    {
+      geometry_msgs::Point position;
+      if (!findPosition(positions, variable_uuid, position))
+      {
+        continue;
+      }
+      auto is_same_position = [&position](const geometry_msgs::Point& other)
+      {
+        return (other.x == position.x) && (other.y == position.y) && (other.z == position.z);
+      };
+      if (std::none_of(constraint_positions.begin(), constraint_positions.end(), is_same_position))
+      {
+        constraint_positions.push_back(position);
+      }
+    }
+    if (constraint_positions.size() < 2)
+    {
+      continue;
+    }
+    std::vector<geometry_msgs::Point> points;
+    points.reserve(2 * (constraint_positions.size() - 1));
+    for (size_t i = 1; i < constraint_positions.size(); ++i)
+    {
+      points.push_back(constraint_positions.front());
+      points.push_back(constraint_positions[i]);
+    }
+    updateMarker(uuid__variables.first, std::move(points), constraint_prototype_, published_constraints_, markers);
+  }
+  deleteStaleMarkers(constraint_prototype_.ns, published_constraints_, markers);
+
+  if (!markers.markers.empty())
+  {
+    marker_publisher_.publish(markers);
+  }
+}
+
+void GraphMarkerPublisher::updateTrackedElements(const fuse_core::Transaction& transaction)
+{
+  // Non-position variables are drawn at the position with the same stamp and device, if one exists. The position may
+  // be added later, so both candidates are remembered and resolved each cycle. This is done once per added variable.
+  for (const auto& variable : transaction.addedVariables())
+  {
+    if (isPosition(*variable))
+    {
+      continue;
+    }
+    auto stamped_variable = dynamic_cast<const fuse_variables::Stamped*>(variable.get());
+    if (stamped_variable)
+    {
+      anchors_.emplace(
+        variable->uuid(),
+        std::make_pair(
+          fuse_core::uuid::generate(
+            fuse_variables::Position2DStamped::TYPE, stamped_variable->stamp(), stamped_variable->deviceId()),
+          fuse_core::uuid::generate(position3DType(), stamped_variable->stamp(), stamped_variable->deviceId())));
+    }
+  }
+  for (const auto& constraint : transaction.addedConstraints())
+  {
+    constraints_.emplace(constraint->uuid(), constraint->variables());
+  }
+  for (const auto& constraint_uuid : transaction.removedConstraints())
+  {
+    constraints_.erase(constraint_uuid);
+  }
+  for (const auto& variable_uuid : transaction.removedVariables())
+  {
+    anchors_.erase(variable_uuid);
+  }
+}
+
+bool GraphMarkerPublisher::findPosition(
+  const PositionMap& positions,
+  const fuse_core::UUID& variable_uuid,
+  geometry_msgs::Point& position) const
+{
+  auto position_iter = positions.find(variable_uuid);
+  if (position_iter == positions.end())
+  {
+    auto anchor_iter = anchors_.find(variable_uuid);
+    if (anchor_iter == anchors_.end())
+    {
+      return false;
+    }
+    position_iter = positions.find(anchor_iter->second.first);
+    if (position_iter == positions.end())
+    {
+      position_iter = positions.find(anchor_iter->second.second);
+    }
+    if (position_iter == positions.end())
+    {
+      return false;
+    }
+  }
+  position = position_iter->second;
+  return true;
+}
+
+void GraphMarkerPublisher::updateMarker(
+  const fuse_core::UUID& uuid,
+  std::vector<geometry_msgs::Point>&& points,
+  const visualization_msgs::Marker& prototype,
+  PublishedMarkerMap& published,
+  visualization_msgs::MarkerArray& markers)
+{
+  auto published_iter = published.find(uuid);
+  if (published_iter == published.end())
+  {
+    published_iter = published.emplace(uuid, PublishedMarker{next_id_++, cycle_, {}}).first;  // NOLINT
+  }
+  else
+  {
+    published_iter->second.cycle = cycle_;
+    if (!hasMoved(published_iter->second.points, points, update_tolerance_))
+    {
+      return;
+    }
+  }
+  published_iter->second.points = std::move(points);
+  // ADD is also used to modify an existing marker
+  markers.markers.push_back(prototype);
+  auto& marker = markers.markers.back();
+  marker.id = published_iter->second.id;
+  marker.action = visualization_msgs::Marker::ADD;
+  if (marker.type == visualization_msgs::Marker::SPHERE)
+  {
+    marker.pose.position = published_iter->second.points.front();
+  }
+  else
+  {
+    marker.points = published_iter->second.points;
+  }
+}
+
+void GraphMarkerPublisher::deleteStaleMarkers(
+  const std::string& ns,
+  PublishedMarkerMap& published,
+  visualization_msgs::MarkerArray& markers)
+{
+  for (auto published_iter = published.begin(); published_iter != published.end();)
+  {
+    if (published_iter->second.cycle == cycle_)
+    {
+      ++published_iter;
+      continue;
+    }
+    visualization_msgs::Marker marker;
+    marker.header.frame_id = frame_id_;
+    marker.ns = ns;
+    marker.id = published_iter->second.id;
+    marker.action = visualization_msgs::Marker::DELETE;
+    markers.markers.push_back(marker);
+    published_iter = published.erase(published_iter);
+  }
+}
+
+}  // namespace fuse_publishers
@@ -47,6 +47,8 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
 #include <algorithm>
+#include <iterator>
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -129,6 +131,7 @@ namespace fuse_publishers
 
 Path2DPublisher::Path2DPublisher() :
   fuse_core::AsyncPublisher(1),
+  archive_position_(0),
   device_id_(fuse_core::uuid::NIL),
   frame_id_("map")
 {
@@ -153,6 +156,24 @@ void Path2DPublisher::onInit()
   pose_array_publisher_ = private_node_handle_.advertise<geometry_msgs::PoseArray>("pose_array", 1);
 }
 
+std::vector<fuse_core::UUID> Path2DPublisher::notificationVariables(const fuse_core::Transaction& transaction) const
+{
+  for (const auto& variable : transaction.addedVariables())
+  {
+    ros::Time stamp;
+    if (checkVariable(*variable, fuse_variables::Orientation2DStamped::TYPE, device_id_, stamp) ||
+        checkVariable(*variable, fuse_variables::Position2DStamped::TYPE, device_id_, stamp))
+    {
+      pose_variables_.insert(variable->uuid());
+    }
+  }
+  for (const auto& variable_uuid : transaction.removedVariables())
+  {
+    pose_variables_.erase(variable_uuid);
+  }
+  return std::vector<fuse_core::UUID>(pose_variables_.begin(), pose_variables_.end());
+}
+
 void Path2DPublisher::notifyCallback(
   fuse_core::Transaction::ConstSharedPtr transaction,
   fuse_core::Graph::ConstSharedPtr graph)
@@ -162,8 +183,14 @@ void Path2DPublisher::notifyCallback(
   {
     return;
   }
-  // Extract all of the 2D pose variables to the path
-  std::vector<geometry_msgs::PoseStamped> poses;
+  // Catch up on any poses that have been retired from the graph into the archive since the last notification
+  auto archive = graph->archive();
+  if (archive)
+  {
+    readArchive(std::move(archive));
+  }
+  // Extract the 2D pose variables that are still in the graph. The poses are keyed by stamp, which keeps them sorted.
+  std::map<ros::Time, geometry_msgs::PoseStamped> live_poses;
   for (const auto& variable : graph->getVariables())
   {
     // Use the orientation variable as the "reference" variable
@@ -175,21 +202,35 @@ void Path2DPublisher::notifyCallback(
       {
         pose.header.stamp = stamp;
         pose.header.frame_id = frame_id_;
-        poses.push_back(pose);
+        live_poses[stamp] = pose;
       }
     }
   }
+  // Merge the archived and live poses in stamp order. The live poses take precedence over any archived values.
+  std::vector<geometry_msgs::PoseStamped> poses;
+  poses.reserve(archived_poses_.size() + live_poses.size());
+  auto archived_iter = archived_poses_.begin();
+  for (const auto& stamp__pose : live_poses)
+  {
+    for (; (archived_iter != archived_poses_.end()) && (archived_iter->first < stamp__pose.first); ++archived_iter)
+    {
+      poses.push_back(archived_iter->second);
+    }
+    if ((archived_iter != archived_poses_.end()) && (archived_iter->first == stamp__pose.first))
+    {
+      ++archived_iter;
+    }
+    poses.push_back(stamp__pose.second);
+  }
+  for (; archived_iter != archived_poses_.end(); ++archived_iter)
+  {
+    poses.push_back(archived_iter->second);
+  }
   // Exit if there are no poses
   if (poses.empty())
   {
     return;
   }
-  // Sort the poses by timestamp
-  auto compare_stamps = [](const geometry_msgs::PoseStamped& pose1, const geometry_msgs::PoseStamped& pose2)
-  {
-    return pose1.header.stamp < pose2.header.stamp;
-  };
-  std::sort(poses.begin(), poses.end(), compare_stamps);
   // Define the header for the aggregate message
   std_msgs::Header header;
   header.stamp = poses.back().header.stamp;
@@ -207,6 +248,7 @@ void Path2DPublisher::notifyCallback(
   {
     geometry_msgs::PoseArray pose_array_msg;
     pose_array_msg.header = header;
+    pose_array_msg.poses.reserve(poses.size());
     std::transform(poses.begin(),
                    poses.end(),
                    std::back_inserter(pose_array_msg.poses),
@@ -218,4 +260,54 @@ void Path2DPublisher::notifyCallback(
   }
 }
 
+void Path2DPublisher::readArchive(fuse_core::VariableArchive::ConstSharedPtr archive)
+{
+  if (archive != archive_)
+  {
+    archive_ = std::move(archive);
+    archive_position_ = 0;
+    archived_poses_.clear();
+    archived_positions_.clear();
+    archived_yaws_.clear();
+  }
+  // Only read the entries appended since the previous call. The size is captured once so both queries cover the same
+  // entries, even if the optimizer appends more in the meantime.
+  const auto archive_size = archive_->size();
+  if (archive_size == archive_position_)
+  {
+    return;
+  }
+  for (const auto& entry :
+       archive_->query(fuse_variables::Position2DStamped::TYPE, device_id_, archive_position_, archive_size))
+  {
+    auto& position = archived_positions_[entry.stamp];
+    position.x = entry.data[fuse_variables::Position2DStamped::X];
+    position.y = entry.data[fuse_variables::Position2DStamped::Y];
+    position.z = 0.0;
+  }
+  for (const auto& entry :
+       archive_->query(fuse_variables::Orientation2DStamped::TYPE, device_id_, archive_position_, archive_size))
+  {
+    archived_yaws_[entry.stamp] = entry.data[fuse_variables::Orientation2DStamped::YAW];
+  }
+  archive_position_ = archive_size;
+  // Move every stamp that now has both a position and an orientation into the complete poses
+  for (auto yaw_iter = archived_yaws_.begin(); yaw_iter != archived_yaws_.end();)
+  {
+    auto position_iter = archived_positions_.find(yaw_iter->first);
+    if (position_iter == archived_positions_.end())
+    {
+      ++yaw_iter;
+      continue;
+    }
+    auto& pose = archived_poses_[yaw_iter->first];
+    pose.header.stamp = yaw_iter->first;
+    pose.header.frame_id = frame_id_;
+    pose.pose.position = position_iter->second;
+    pose.pose.orientation = tf2::toMsg(tf2::Quaternion(tf2::Vector3(0, 0, 1), yaw_iter->second));
+    archived_positions_.erase(position_iter);
+    yaw_iter = archived_yaws_.erase(yaw_iter);
+  }
+}
+
 }  // namespace fuse_publishers
@@ -0,0 +1,283 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_publishers/pose_2d_interpolator.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/uuid.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/velocity_angular_2d_stamped.h>
+#include <fuse_variables/velocity_linear_2d_stamped.h>
+#include <geometry_msgs/Pose.h>
+#include <geometry_msgs/PoseWithCovariance.h>
+#include <ros/ros.h>
+#include <tf2/utils.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief Wrap an angle to the [-Pi, +Pi] range
+ */
+double wrapAngle(const double angle)
+{
+  return std::remainder(angle, 2.0 * M_PI);
+}
+
+/**
+ * @brief Read the 3x3 (x, y, yaw) covariance blocks returned by the graph for a position/orientation pair
+ */
+fuse_core::Matrix3d toPoseCovariance(const std::vector<std::vector<double>>& covariance_blocks, const size_t offset)
+{
+  const auto& position_position = covariance_blocks[offset];
+  const auto& position_orientation = covariance_blocks[offset + 1];
+  const auto& orientation_orientation = covariance_blocks[offset + 2];
+  fuse_core::Matrix3d covariance;
+  covariance << position_position[0], position_position[1], position_orientation[0],
+                position_position[2], position_position[3], position_orientation[1],
+                position_orientation[0], position_orientation[1], orientation_orientation[0];
+  return covariance;
+}
+
+/**
+ * @brief Convert an (x, y, yaw) pose into a pose message
+ */
+void toMsg(const fuse_core::Vector3d& pose, geometry_msgs::Pose& msg)
+{
+  msg.position.x = pose.x();
+  msg.position.y = pose.y();
+  msg.position.z = 0.0;
+  msg.orientation = tf2::toMsg(tf2::Quaternion(tf2::Vector3(0, 0, 1), pose.z()));
+}
+
+}  // namespace
+
+namespace fuse_publishers
+{
+
+Pose2DInterpolator::Pose2DInterpolator(
+  fuse_core::Graph::ConstSharedPtr graph,
+  const fuse_core::UUID& device_id) :
+    graph_(std::move(graph))
+{
+  // Index every pose of the requested device. The orientation variable is used as the "reference" variable.
+  for (const auto& variable : graph_->getVariables())
+  {
+    if (variable.type() != fuse_variables::Orientation2DStamped::TYPE)
+    {
+      continue;
+    }
+    const auto& orientation = static_cast<const fuse_variables::Orientation2DStamped&>(variable);
+    if (orientation.deviceId() != device_id)
+    {
+      continue;
+    }
+    State state;
+    state.orientation_uuid = orientation.uuid();
+    state.position_uuid = fuse_variables::Position2DStamped(orientation.stamp(), device_id).uuid();
+    if (!graph_->variableExists(state.position_uuid))
+    {
+      continue;
+    }
+    const auto& position = graph_->getVariable(state.position_uuid);
+    state.pose << position.data()[fuse_variables::Position2DStamped::X],
+                  position.data()[fuse_variables::Position2DStamped::Y],
+                  orientation.yaw();
+    // Use the velocities, if both are available for this state
+    const auto linear_velocity_uuid = fuse_variables::VelocityLinear2DStamped(orientation.stamp(), device_id).uuid();
+    const auto angular_velocity_uuid = fuse_variables::VelocityAngular2DStamped(orientation.stamp(), device_id).uuid();
+    state.has_velocity = graph_->variableExists(linear_velocity_uuid) && graph_->variableExists(angular_velocity_uuid);
+    if (state.has_velocity)
+    {
+      const auto& linear_velocity = graph_->getVariable(linear_velocity_uuid);
+      const auto& angular_velocity = graph_->getVariable(angular_velocity_uuid);
+      state.velocity << linear_velocity.data()[fuse_variables::VelocityLinear2DStamped::X],
+                        linear_velocity.data()[fuse_variables::VelocityLinear2DStamped::Y],
+                        angular_velocity.data()[fuse_variables::VelocityAngular2DStamped::YAW];
+    }
+    else
+    {
+      state.velocity.setZero();
+    }
+    states_.emplace(orientation.stamp(), state);
+  }
+}
+
+ros::Time Pose2DInterpolator::earliestStamp() const
+{
+  return states_.empty() ? ros::Time(0, 0) : states_.begin()->first;
+}
+
+ros::Time Pose2DInterpolator::latestStamp() const
+{
+  return states_.empty() ? ros::Time(0, 0) : states_.rbegin()->first;
+}
+
+bool Pose2DInterpolator::getPose(const ros::Time& stamp, geometry_msgs::Pose& pose) const
+{
+  StateMap::const_iterator previous;
+  StateMap::const_iterator next;
+  double fraction;
+  if (!findNeighbors(stamp, previous, next, fraction))
+  {
+    return false;
+  }
+  toMsg(interpolate(previous, next, fraction), pose);
+  return true;
+}
+
+bool Pose2DInterpolator::getPoseWithCovariance(const ros::Time& stamp, geometry_msgs::PoseWithCovariance& pose) const
+{
+  StateMap::const_iterator previous;
+  StateMap::const_iterator next;
+  double fraction;
+  if (!findNeighbors(stamp, previous, next, fraction))
+  {
+    return false;
+  }
+  // Request the marginal covariances of both neighbors at once. Grouping the requests is much faster.
+  std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>> requests;
+  for (const auto& state : {previous->second, next->second})  // NOLINT(whitespace/braces)
+  {
+    requests.emplace_back(state.position_uuid, state.position_uuid);
+    requests.emplace_back(state.position_uuid, state.orientation_uuid);
+    requests.emplace_back(state.orientation_uuid, state.orientation_uuid);
+  }
+  std::vector<std::vector<double>> covariance_blocks;
+  try
+  {
+    graph_->getCovariance(requests, covariance_blocks);
+  }
+  catch (const std::exception& e)
+  {
+    ROS_WARN_STREAM_THROTTLE(10.0, "Failed to compute the pose covariance at time " << stamp << ". Error: " <<
+                             e.what());
+    return false;
+  }
+  fuse_core::Matrix3d covariance = (1.0 - fraction) * toPoseCovariance(covariance_blocks, 0) +
+                                   fraction * toPoseCovariance(covariance_blocks, 3);
+  // Populate the x, y, and yaw rows/columns of the 6x6 message covariance
+  const size_t indices[] = {0, 1, 5};  // NOLINT(whitespace/braces)
+  pose.covariance.fill(0.0);
+  for (size_t row = 0; row < 3; ++row)
+  {
+    for (size_t col = 0; col < 3; ++col)
+    {
+      pose.covariance[6 * indices[row] + indices[col]] = covariance(row, col);
+    }
+  }
+  toMsg(interpolate(previous, next, fraction), pose.pose);
+  return true;
+}
+
+bool Pose2DInterpolator::findNeighbors(
+  const ros::Time& stamp,
+  StateMap::const_iterator& previous,
+  StateMap::const_iterator& next,
+  double& fraction) const
+{
+  next = states_.lower_bound(stamp);
+  if (next == states_.end())
+  {
+    return false;
+  }
+  if (next->first == stamp)
+  {
+    previous = next;
+    fraction = 0.0;
+    return true;
+  }
+  if (next == states_.begin())
+  {
+    return false;
+  }
+  previous = std::prev(next);
+  fraction = (stamp - previous->first).toSec() / (next->first - previous->first).toSec();
+  return true;
+}
+
+fuse_core::Vector3d Pose2DInterpolator::interpolate(
+  const StateMap::const_iterator& previous,
+  const StateMap::const_iterator& next,
+  const double fraction) const
+{
+  const auto& pose0 = previous->second.pose;
+  const auto& pose1 = next->second.pose;
+  if (previous == next)
+  {
+    return pose0;
+  }
+  // Unwrap the second yaw so the interpolation follows the shortest arc
+  fuse_core::Vector3d end = pose1;
+  end.z() = pose0.z() + wrapAngle(pose1.z() - pose0.z());
+  fuse_core::Vector3d result;
+  if (previous->second.has_velocity && next->second.has_velocity)
+  {
+    // Cubic Hermite spline using the world-frame velocities as the endpoint tangents
+    auto to_world = [](const fuse_core::Vector3d& pose, const fuse_core::Vector3d& velocity)
+    {
+      const double cos_yaw = std::cos(pose.z());
+      const double sin_yaw = std::sin(pose.z());
+      return fuse_core::Vector3d(
+        cos_yaw * velocity.x() - sin_yaw * velocity.y(),
+        sin_yaw * velocity.x() + cos_yaw * velocity.y(),
+        velocity.z());
+    };
+    const double dt = (next->first - previous->first).toSec();
+    const double s = fraction;
+    const double s2 = s * s;
+    const double s3 = s2 * s;
+    const double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    const double h10 = s3 - 2.0 * s2 + s;
+    const double h01 = -2.0 * s3 + 3.0 * s2;
+    const double h11 = s3 - s2;
+    result = h00 * pose0 + h10 * dt * to_world(pose0, previous->second.velocity) +
+             h01 * end + h11 * dt * to_world(pose1, next->second.velocity);
+  }
+  else
+  {
+    result = (1.0 - fraction) * pose0 + fraction * end;
+  }
+  result.z() = wrapAngle(result.z());
+  return result;
+}
+
+}  // namespace fuse_publishers
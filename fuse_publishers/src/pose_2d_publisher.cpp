@@ -48,8 +48,10 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -60,6 +62,10 @@ PLUGINLIB_EXPORT_CLASS(fuse_publishers::Pose2DPublisher, fuse_core::Publisher);
 
 static const ros::Time TIME_ZERO = ros::Time(0, 0);
 
+// The handle returned by tf2::BufferCore::addTransformableRequest() when the requested time is older than the tf cache.
+// No callback is ever made for such a request.
+static const tf2::TransformableRequestHandle TF_REQUEST_TOO_OLD = 0xffffffffffffffffULL;
+
 // Some file-scope functions in an anonymous namespace
 namespace
 {
@@ -140,10 +146,22 @@ Pose2DPublisher::Pose2DPublisher() :
   device_id_(fuse_core::uuid::NIL),
   latest_stamp_(0, 0),
   publish_to_tf_(false),
+  tf_callback_handle_(0),
+  tf_request_handle_(0),
   use_tf_lookup_(false)
 {
 }
 
+Pose2DPublisher::~Pose2DPublisher()
+{
+  // Stop receiving transforms, then stop the tf buffer from calling back into this object
+  tf_listener_.reset();
+  if (tf_buffer_)
+  {
+    tf_buffer_->removeTransformableCallback(tf_callback_handle_);
+  }
+}
+
 void Pose2DPublisher::onInit()
 {
   // Read configuration from the parameter server
@@ -177,18 +195,10 @@ void Pose2DPublisher::onInit()
         tf_cache_time = default_tf_cache_time;
       }
 
-      double tf_timeout;
-      double default_tf_timeout = 0.1;
-      private_node_handle_.param("tf_timeout", tf_timeout, default_tf_timeout);
-      if (tf_timeout <= 0)
-      {
-        ROS_WARN_STREAM("The requested tf_timeout is <= 0. Using the default value (" <<
-                        default_tf_timeout << "s) instead.");
-        tf_timeout = default_tf_timeout;
-      }
-      tf_timeout_ = ros::Duration(tf_timeout);
-
       tf_buffer_ = std::make_unique<tf2_ros::Buffer>(ros::Duration(tf_cache_time));
+      tf_callback_handle_ = tf_buffer_->addTransformableCallback(
+        std::bind(&Pose2DPublisher::odomTransformableCallback, this, std::placeholders::_1, std::placeholders::_2,
+                  std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
       tf_listener_ = std::make_unique<tf2_ros::TransformListener>(*tf_buffer_, node_handle_);
     }
 
@@ -260,28 +270,63 @@ void Pose2DPublisher::notifyCallback(
     map_to_base.transform.translation.y = pose.position.y;
     map_to_base.transform.translation.z = pose.position.z;
     map_to_base.transform.rotation = pose.orientation;
-    // If we are suppose to publish the map->odom frame instead, do that transformation now
+    // If we are suppose to publish the map->odom frame instead, do that transformation once the base->odom
+    // transform is available. The odometry source may lag behind the optimizer, so rather than blocking this thread
+    // until it catches up, the map->base transform is stored and a request is registered with the tf buffer.
     if (use_tf_lookup_)
     {
-      // We need to lookup the base->odom frame first, so we can compute the map->odom transform from the
-      // map->base transform
-      try
       {
-        auto base_to_odom = tf_buffer_->lookupTransform(base_frame_, odom_frame_, latest_stamp_, tf_timeout_);
-        geometry_msgs::TransformStamped map_to_odom;
-        tf2::doTransform(base_to_odom, map_to_odom, map_to_base);
-        map_to_odom.child_frame_id = odom_frame_;  // The child frame is not populated for some reason
-        tf_transform_ = map_to_odom;
+        std::lock_guard<std::mutex> lock(tf_mutex_);
+        pending_map_to_base_ = map_to_base;
+      }
+      // The tf buffer may be invoking odomTransformableCallback() from the listener thread, so the request must be
+      // made without holding the tf mutex. Any older request is superseded by this one.
+      if (tf_request_handle_ != 0)
+      {
+        tf_buffer_->cancelTransformableRequest(tf_request_handle_);
+        tf_request_handle_ = 0;
       }
-      catch (const std::exception& e)
+      tf2::TransformableRequestHandle request_handle = 0;
+      std::string tf_error;
+      if (!tf_buffer_->canTransform(base_frame_, odom_frame_, latest_stamp_, &tf_error))
+      {
+        // Register a request for the transform. A request older than the tf cache is rejected immediately without a
+        // callback, so the pending pose is dropped here. Any other request that can never be satisfied is reported to
+        // odomTransformableCallback() as a TransformFailure, or is superseded by the next pose.
+        ROS_DEBUG_STREAM("Waiting for the transform " << base_frame_ << "->" << odom_frame_ << " at time " <<
+                         latest_stamp_ << ". Error: " << tf_error);
+        request_handle = tf_buffer_->addTransformableRequest(
+          tf_callback_handle_, base_frame_, odom_frame_, latest_stamp_);
+      }
+      if (request_handle == TF_REQUEST_TOO_OLD)
       {
         ROS_WARN_STREAM_THROTTLE(2.0, "Could not lookup the transform " << base_frame_ << "->" << odom_frame_ <<
-                                      ". Error: " << e.what());
+                                      " at time " << latest_stamp_ << ". The time is older than the tf cache.");
+        std::lock_guard<std::mutex> lock(tf_mutex_);
+        if (pending_map_to_base_.header.stamp == latest_stamp_)
+        {
+          pending_map_to_base_.header.stamp = TIME_ZERO;
+        }
+      }
+      else if (request_handle != 0)
+      {
+        // The map->odom transform is computed by odomTransformableCallback() once the transform arrives
+        tf_request_handle_ = request_handle;
+      }
+      else
+      {
+        // The transform is already available. Compute the map->odom transform now.
+        std::lock_guard<std::mutex> lock(tf_mutex_);
+        if ((pending_map_to_base_.header.stamp == latest_stamp_) && updateMapToOdom(pending_map_to_base_))
+        {
+          pending_map_to_base_.header.stamp = TIME_ZERO;
+        }
       }
     }
     else
     {
       // Simple. No intermediate frame. Just use the optimized map->base transform.
+      std::lock_guard<std::mutex> lock(tf_mutex_);
       tf_transform_ = map_to_base;
     }
   }
@@ -322,6 +367,7 @@ void Pose2DPublisher::notifyCallback(
 void Pose2DPublisher::tfPublishTimerCallback(const ros::TimerEvent& event)
 {
   // The tf_transform_ is updated in a separate thread, so we must guard the read/write operations.
+  std::lock_guard<std::mutex> lock(tf_mutex_);
   // Only publish if the tf transform is valid
   if (tf_transform_.header.stamp != TIME_ZERO)
   {
@@ -331,4 +377,56 @@ void Pose2DPublisher::tfPublishTimerCallback(const ros::TimerEvent& event)
   }
 }
 
+void Pose2DPublisher::odomTransformableCallback(
+  tf2::TransformableRequestHandle /* request_handle */,
+  const std::string& target_frame,
+  const std::string& source_frame,
+  ros::Time time,
+  tf2::TransformableResult result)
+{
+  if ((target_frame != base_frame_) || (source_frame != odom_frame_))
+  {
+    return;
+  }
+  // Only the most recent pose is of interest. Requests for older poses are ignored.
+  std::lock_guard<std::mutex> lock(tf_mutex_);
+  if (result != tf2::TransformAvailable)
+  {
+    // The transform will never become available at this time, e.g. because the time has fallen out of the tf cache.
+    // Drop the pending pose; the next optimized pose replaces it.
+    ROS_WARN_STREAM_THROTTLE(2.0, "Could not lookup the transform " << base_frame_ << "->" << odom_frame_ <<
+                                  " at time " << time << ".");
+    if (pending_map_to_base_.header.stamp == time)
+    {
+      pending_map_to_base_.header.stamp = TIME_ZERO;
+    }
+    return;
+  }
+  if ((pending_map_to_base_.header.stamp == time) && updateMapToOdom(pending_map_to_base_))
+  {
+    pending_map_to_base_.header.stamp = TIME_ZERO;
+  }
+}
+
+bool Pose2DPublisher::updateMapToOdom(const geometry_msgs::TransformStamped& map_to_base)
+{
+  // We need to lookup the base->odom frame first, so we can compute the map->odom transform from the
+  // map->base transform
+  try
+  {
+    auto base_to_odom = tf_buffer_->lookupTransform(base_frame_, odom_frame_, map_to_base.header.stamp);
+    geometry_msgs::TransformStamped map_to_odom;
+    tf2::doTransform(base_to_odom, map_to_odom, map_to_base);
+    map_to_odom.child_frame_id = odom_frame_;  // The child frame is not populated for some reason
+    tf_transform_ = map_to_odom;
+  }
+  catch (const std::exception& e)
+  {
+    ROS_WARN_STREAM_THROTTLE(2.0, "Could not lookup the transform " << base_frame_ << "->" << odom_frame_ <<
+                                  ". Error: " << e.what());
+    return false;
+  }
+  return true;
+}
+
 }  // namespace fuse_publishers
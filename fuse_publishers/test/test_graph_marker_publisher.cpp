@@ -0,0 +1,291 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/notification_needs.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_publishers/graph_marker_publisher.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
+#include <visualization_msgs/MarkerArray.h>
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Test fixture for the GraphMarkerPublisher
+ *
+ * This test fixture provides a graph containing three poses, a prior on the first pose, and relative constraints
+ * between consecutive poses. All received marker arrays are recorded.
+ */
+class GraphMarkerPublisherTestFixture : public ::testing::Test
+{
+public:
+  GraphMarkerPublisherTestFixture() :
+    private_node_handle_("~"),
+    graph_(fuse_graphs::HashGraph::make_shared()),
+    transaction_(fuse_core::Transaction::make_shared())
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      auto position = fuse_variables::Position2DStamped::make_shared(ros::Time(1234 + i, 0));
+      position->x() = 1.0 * i;
+      position->y() = 2.0 * i;
+      auto orientation = fuse_variables::Orientation2DStamped::make_shared(ros::Time(1234 + i, 0));
+      orientation->yaw() = 0.1 * i;
+      transaction_->addVariable(position);
+      transaction_->addVariable(orientation);
+      positions_.push_back(position);
+      orientations_.push_back(orientation);
+    }
+    // A prior constraint only involves a single pose, and is not drawn
+    fuse_core::Vector3d mean;
+    mean << 0.0, 0.0, 0.0;
+    fuse_core::Matrix3d cov;
+    cov << 1.0, 0.0, 0.0,  0.0, 1.0, 0.0,  0.0, 0.0, 1.0;
+    transaction_->addConstraint(fuse_constraints::AbsolutePose2DStampedConstraint::make_shared(
+      *positions_[0], *orientations_[0], mean, cov));
+    // Relative constraints are drawn between the poses
+    fuse_core::Vector3d delta;
+    delta << 1.0, 2.0, 0.1;
+    for (int i = 1; i < 3; ++i)
+    {
+      auto constraint = fuse_constraints::RelativePose2DStampedConstraint::make_shared(
+        *positions_[i - 1], *orientations_[i - 1], *positions_[i], *orientations_[i], delta, cov);
+      transaction_->addConstraint(constraint);
+      relative_constraints_.push_back(constraint);
+    }
+    graph_->update(*transaction_);
+  }
+
+  void markerCallback(const visualization_msgs::MarkerArray::ConstPtr& msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages_.push_back(*msg);
+  }
+
+  /**
+   * @brief Wait until the requested number of marker arrays have been received
+   */
+  bool waitForMessages(const size_t count)
+  {
+    ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+    while (ros::Time::now() < timeout)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (messages_.size() >= count)
+        {
+          return true;
+        }
+      }
+      ros::Duration(0.01).sleep();
+    }
+    return false;
+  }
+
+  /**
+   * @brief Wait for the subscriber to be connected to the publisher
+   */
+  void waitForConnection(const ros::Subscriber& subscriber)
+  {
+    ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+    while ((subscriber.getNumPublishers() == 0) && (ros::Time::now() < timeout))
+    {
+      ros::Duration(0.01).sleep();
+    }
+    // Give the publisher time to process its own connection callback
+    ros::Duration(0.5).sleep();
+  }
+
+  /**
+   * @brief Count the markers in a message with the provided namespace and action
+   */
+  static size_t countMarkers(const visualization_msgs::MarkerArray& msg, const std::string& ns, const int32_t action)
+  {
+    size_t count = 0;
+    for (const auto& marker : msg.markers)
+    {
+      if ((marker.ns == ns) && (marker.action == action))
+      {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+protected:
+  ros::NodeHandle private_node_handle_;
+  fuse_graphs::HashGraph::SharedPtr graph_;
+  fuse_core::Transaction::SharedPtr transaction_;
+  std::vector<fuse_variables::Position2DStamped::SharedPtr> positions_;
+  std::vector<fuse_variables::Orientation2DStamped::SharedPtr> orientations_;
+  std::vector<fuse_core::Constraint::SharedPtr> relative_constraints_;
+  std::mutex mutex_;
+  std::vector<visualization_msgs::MarkerArray> messages_;
+};
+
+TEST_F(GraphMarkerPublisherTestFixture, IncrementalUpdates)
+{
+  private_node_handle_.setParam("test_publisher/frame_id", "test_map");
+  fuse_publishers::GraphMarkerPublisher publisher;
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+
+  // Without subscribers, no variables are requested
+  EXPECT_EQ(fuse_core::NotificationNeeds::VARIABLES, publisher.notificationNeeds());
+  EXPECT_TRUE(publisher.notificationVariables(*transaction_).empty());
+  publisher.notify(transaction_, nullptr);
+
+  ros::Subscriber subscriber = private_node_handle_.subscribe(
+    "test_publisher/markers",
+    10,
+    &GraphMarkerPublisherTestFixture::markerCallback,
+    reinterpret_cast<GraphMarkerPublisherTestFixture*>(this));
+  waitForConnection(subscriber);
+
+  // With a subscriber, only the positions are requested. The constraints are tracked from the transactions.
+  auto variable_uuids = publisher.notificationVariables(fuse_core::Transaction());
+  EXPECT_EQ(3u, variable_uuids.size());
+
+  // The first message clears any old markers and adds everything
+  publisher.notify(fuse_core::Transaction::make_shared(), graph_->cloneVariables(variable_uuids));
+  ASSERT_TRUE(waitForMessages(1));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto& msg = messages_[0];
+    ASSERT_FALSE(msg.markers.empty());
+    EXPECT_EQ(visualization_msgs::Marker::DELETEALL, msg.markers[0].action);
+    EXPECT_EQ(3u, countMarkers(msg, "variables", visualization_msgs::Marker::ADD));
+    EXPECT_EQ(2u, countMarkers(msg, "constraints", visualization_msgs::Marker::ADD));
+    EXPECT_EQ(6u, msg.markers.size());
+    for (const auto& marker : msg.markers)
+    {
+      EXPECT_EQ("test_map", marker.header.frame_id);
+      if (marker.ns == "constraints")
+      {
+        EXPECT_EQ(visualization_msgs::Marker::LINE_LIST, marker.type);
+        EXPECT_EQ(2u, marker.points.size());
+      }
+    }
+  }
+
+  // Moving a single pose updates only that pose and the constraints connected to it
+  positions_[0]->x() = 5.0;
+  publisher.notify(fuse_core::Transaction::make_shared(), graph_);
+  ASSERT_TRUE(waitForMessages(2));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto& msg = messages_[1];
+    EXPECT_EQ(2u, msg.markers.size());
+    EXPECT_EQ(1u, countMarkers(msg, "variables", visualization_msgs::Marker::ADD));
+    EXPECT_EQ(1u, countMarkers(msg, "constraints", visualization_msgs::Marker::ADD));
+  }
+
+  // Nothing changed, so nothing is published
+  publisher.notify(fuse_core::Transaction::make_shared(), graph_);
+
+  // Removing a pose deletes its markers
+  auto removal = fuse_core::Transaction::make_shared();
+  removal->removeConstraint(relative_constraints_[1]->uuid());
+  removal->removeVariable(positions_[2]->uuid());
+  removal->removeVariable(orientations_[2]->uuid());
+  graph_->update(*removal);
+  publisher.notify(removal, graph_);
+  ASSERT_TRUE(waitForMessages(3));
+  ros::Duration(0.1).sleep();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ASSERT_EQ(3u, messages_.size());
+    const auto& msg = messages_[2];
+    EXPECT_EQ(2u, msg.markers.size());
+    EXPECT_EQ(1u, countMarkers(msg, "variables", visualization_msgs::Marker::DELETE));
+    EXPECT_EQ(1u, countMarkers(msg, "constraints", visualization_msgs::Marker::DELETE));
+  }
+}
+
+TEST_F(GraphMarkerPublisherTestFixture, LevelOfDetail)
+{
+  private_node_handle_.setParam("lod_publisher/max_variable_markers", 1);
+  private_node_handle_.setParam("lod_publisher/max_constraint_markers", 1);
+  fuse_publishers::GraphMarkerPublisher publisher;
+  publisher.initialize("lod_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+  ros::Subscriber subscriber = private_node_handle_.subscribe(
+    "lod_publisher/markers",
+    10,
+    &GraphMarkerPublisherTestFixture::markerCallback,
+    reinterpret_cast<GraphMarkerPublisherTestFixture*>(this));
+  waitForConnection(subscriber);
+
+  // Three positions and three constraints are reduced by the smallest power of two that satisfies the limit: 4.
+  // The selection is based on a hash of the UUID.
+  size_t expected_variables = 0;
+  for (const auto& position : positions_)
+  {
+    expected_variables += (fuse_core::uuid::hash()(position->uuid()) % 4 == 0) ? 1 : 0;
+  }
+  size_t expected_constraints = 0;
+  for (const auto& constraint : relative_constraints_)
+  {
+    expected_constraints += (fuse_core::uuid::hash()(constraint->uuid()) % 4 == 0) ? 1 : 0;
+  }
+
+  publisher.notify(transaction_, graph_);
+  ASSERT_TRUE(waitForMessages(1));
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto& msg = messages_[0];
+  EXPECT_EQ(expected_variables, countMarkers(msg, "variables", visualization_msgs::Marker::ADD));
+  EXPECT_EQ(expected_constraints, countMarkers(msg, "constraints", visualization_msgs::Marker::ADD));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_graph_marker_publisher");
+
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+  int ret = RUN_ALL_TESTS();
+  spinner.stop();
+  ros::shutdown();
+  return ret;
+}
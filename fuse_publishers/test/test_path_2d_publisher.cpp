@@ -33,12 +33,15 @@
  */
 #include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
 #include <fuse_core/eigen.h>
+#include <fuse_core/notification_needs.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
+#include <fuse_core/variable_archive.h>
 #include <fuse_graphs/hash_graph.h>
 #include <fuse_publishers/path_2d_publisher.h>
 #include <fuse_variables/orientation_2d_stamped.h>
 #include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/stamped.h>
 #include <geometry_msgs/PoseArray.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <nav_msgs/Path.h>
@@ -47,6 +50,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 
@@ -162,7 +167,7 @@ TEST_F(Path2DPublisherTestFixture, PublishPath)
   // Create a publisher and send it the graph
   private_node_handle_.setParam("test_publisher/frame_id", "test_map");
   fuse_publishers::Path2DPublisher publisher;
-  publisher.initialize("test_publisher");
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Subscribe to the "path" topic
   ros::Subscriber subscriber1 = private_node_handle_.subscribe(
@@ -236,6 +241,123 @@ TEST_F(Path2DPublisherTestFixture, PublishPath)
   EXPECT_NEAR(3.02, tf2::getYaw(pose_array_msg_.poses[2].orientation), 1.0e-9);
 }
 
+TEST_F(Path2DPublisherTestFixture, NotificationVariables)
+{
+  // Test that only the 2D poses of the configured device are requested, and that a graph containing only those
+  // variables is enough to publish the path
+  private_node_handle_.setParam("test_publisher/frame_id", "test_map");
+  fuse_publishers::Path2DPublisher publisher;
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+  EXPECT_EQ(fuse_core::NotificationNeeds::VARIABLES, publisher.notificationNeeds());
+
+  auto variable_uuids = publisher.notificationVariables(*transaction_);
+  std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> actual_uuids(variable_uuids.begin(), variable_uuids.end());
+  std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> expected_uuids;
+  for (const auto& variable : transaction_->addedVariables())
+  {
+    auto stamped_variable = dynamic_cast<const fuse_variables::Stamped*>(variable.get());
+    if (stamped_variable && stamped_variable->deviceId() == fuse_core::uuid::NIL)
+    {
+      expected_uuids.insert(variable->uuid());
+    }
+  }
+  EXPECT_EQ(6u, expected_uuids.size());
+  EXPECT_EQ(expected_uuids, actual_uuids);
+
+  // Removed variables are no longer requested
+  fuse_core::Transaction removal;
+  auto removed_uuid = fuse_variables::Position2DStamped(ros::Time(1234, 10)).uuid();
+  removal.removeVariable(removed_uuid);
+  variable_uuids = publisher.notificationVariables(removal);
+  EXPECT_EQ(5u, variable_uuids.size());
+  EXPECT_EQ(variable_uuids.end(), std::find(variable_uuids.begin(), variable_uuids.end(), removed_uuid));
+
+  // Publish from a graph holding only the requested variables
+  ros::Subscriber subscriber = private_node_handle_.subscribe(
+    "test_publisher/path",
+    1,
+    &Path2DPublisherTestFixture::pathCallback,
+    reinterpret_cast<Path2DPublisherTestFixture*>(this));
+  fuse_core::Graph::ConstSharedPtr variables_graph = graph_->cloneVariables(variable_uuids);
+  publisher.notify(transaction_, variables_graph);
+
+  ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+  while ((!received_path_msg_) && (ros::Time::now() < timeout))
+  {
+    ros::Duration(0.10).sleep();
+  }
+  ASSERT_TRUE(received_path_msg_);
+  ASSERT_EQ(2ul, path_msg_.poses.size());
+  EXPECT_EQ(ros::Time(1235, 9), path_msg_.poses[0].header.stamp);
+  EXPECT_EQ(ros::Time(1235, 10), path_msg_.poses[1].header.stamp);
+}
+
+TEST_F(Path2DPublisherTestFixture, PublishArchivedPath)
+{
+  // Test that retired poses are read from the archive, including the entries appended between notifications
+  private_node_handle_.setParam("test_publisher/frame_id", "test_map");
+  fuse_publishers::Path2DPublisher publisher;
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+  ros::Subscriber subscriber = private_node_handle_.subscribe(
+    "test_publisher/path",
+    1,
+    &Path2DPublisherTestFixture::pathCallback,
+    reinterpret_cast<Path2DPublisherTestFixture*>(this));
+
+  auto archive = fuse_core::VariableArchive::make_shared();
+  graph_->archive(archive);
+  fuse_variables::Position2DStamped position1(ros::Time(1233, 10));
+  position1.x() = 1.00;
+  position1.y() = 2.00;
+  fuse_variables::Orientation2DStamped orientation1(ros::Time(1233, 10));
+  orientation1.yaw() = 3.00;
+  archive->append(position1, position1.stamp(), position1.deviceId());
+  archive->append(orientation1, orientation1.stamp(), orientation1.deviceId());
+
+  auto wait_for_path = [this]()
+  {
+    ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+    while ((!received_path_msg_) && (ros::Time::now() < timeout))
+    {
+      ros::Duration(0.10).sleep();
+    }
+  };  // NOLINT(whitespace/braces)
+
+  publisher.notify(transaction_, graph_);
+  wait_for_path();
+  ASSERT_TRUE(received_path_msg_);
+  ASSERT_EQ(4ul, path_msg_.poses.size());
+  EXPECT_EQ(ros::Time(1233, 10), path_msg_.poses[0].header.stamp);
+  EXPECT_EQ("test_map", path_msg_.poses[0].header.frame_id);
+  EXPECT_NEAR(1.00, path_msg_.poses[0].pose.position.x, 1.0e-9);
+  EXPECT_NEAR(2.00, path_msg_.poses[0].pose.position.y, 1.0e-9);
+  EXPECT_NEAR(3.00, tf2::getYaw(path_msg_.poses[0].pose.orientation), 1.0e-9);
+
+  // An archived orientation is not published until its position has been archived as well
+  fuse_variables::Position2DStamped position2(ros::Time(1232, 10));
+  position2.x() = 0.99;
+  position2.y() = 1.99;
+  fuse_variables::Orientation2DStamped orientation2(ros::Time(1232, 10));
+  orientation2.yaw() = 2.99;
+  archive->append(orientation2, orientation2.stamp(), orientation2.deviceId());
+  received_path_msg_ = false;
+  publisher.notify(transaction_, graph_);
+  wait_for_path();
+  ASSERT_TRUE(received_path_msg_);
+  ASSERT_EQ(4ul, path_msg_.poses.size());
+
+  archive->append(position2, position2.stamp(), position2.deviceId());
+  received_path_msg_ = false;
+  publisher.notify(transaction_, graph_);
+  wait_for_path();
+  ASSERT_TRUE(received_path_msg_);
+  ASSERT_EQ(5ul, path_msg_.poses.size());
+  EXPECT_EQ(ros::Time(1232, 10), path_msg_.poses[0].header.stamp);
+  EXPECT_NEAR(0.99, path_msg_.poses[0].pose.position.x, 1.0e-9);
+  EXPECT_NEAR(2.99, tf2::getYaw(path_msg_.poses[0].pose.orientation), 1.0e-9);
+  EXPECT_EQ(ros::Time(1233, 10), path_msg_.poses[1].header.stamp);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,202 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_publishers/pose_2d_interpolator.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/velocity_angular_2d_stamped.h>
+#include <fuse_variables/velocity_linear_2d_stamped.h>
+#include <geometry_msgs/Pose.h>
+#include <geometry_msgs/PoseWithCovariance.h>
+#include <ros/time.h>
+#include <tf2/utils.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iterator>
+
+
+/**
+ * @brief Add a pose, and optionally a velocity, to the transaction
+ */
+void addState(
+  const ros::Time& stamp,
+  const double x,
+  const double y,
+  const double yaw,
+  fuse_core::Transaction& transaction,
+  const bool add_velocity = false,
+  const double vx = 0.0,
+  const double vyaw = 0.0)
+{
+  auto position = fuse_variables::Position2DStamped::make_shared(stamp);
+  position->x() = x;
+  position->y() = y;
+  auto orientation = fuse_variables::Orientation2DStamped::make_shared(stamp);
+  orientation->yaw() = yaw;
+  transaction.addVariable(position);
+  transaction.addVariable(orientation);
+  if (add_velocity)
+  {
+    auto linear_velocity = fuse_variables::VelocityLinear2DStamped::make_shared(stamp);
+    linear_velocity->x() = vx;
+    linear_velocity->y() = 0.0;
+    auto angular_velocity = fuse_variables::VelocityAngular2DStamped::make_shared(stamp);
+    angular_velocity->yaw() = vyaw;
+    transaction.addVariable(linear_velocity);
+    transaction.addVariable(angular_velocity);
+  }
+}
+
+TEST(Pose2DInterpolator, Empty)
+{
+  auto graph = fuse_graphs::HashGraph::make_shared();
+  fuse_publishers::Pose2DInterpolator interpolator(graph);
+  EXPECT_TRUE(interpolator.empty());
+  geometry_msgs::Pose pose;
+  EXPECT_FALSE(interpolator.getPose(ros::Time(10, 0), pose));
+}
+
+TEST(Pose2DInterpolator, Linear)
+{
+  auto graph = fuse_graphs::HashGraph::make_shared();
+  fuse_core::Transaction transaction;
+  addState(ros::Time(10, 0), 1.0, 2.0, 3.0, transaction);
+  addState(ros::Time(12, 0), 3.0, 6.0, -3.0, transaction);
+  graph->update(transaction);
+  const auto variable_count = std::distance(graph->getVariables().begin(), graph->getVariables().end());
+
+  fuse_publishers::Pose2DInterpolator interpolator(graph);
+  ASSERT_FALSE(interpolator.empty());
+  EXPECT_EQ(ros::Time(10, 0), interpolator.earliestStamp());
+  EXPECT_EQ(ros::Time(12, 0), interpolator.latestStamp());
+
+  // Queries outside of the optimized states fail
+  geometry_msgs::Pose pose;
+  EXPECT_FALSE(interpolator.getPose(ros::Time(9, 0), pose));
+  EXPECT_FALSE(interpolator.getPose(ros::Time(12, 1), pose));
+
+  // Queries at a state return the state
+  ASSERT_TRUE(interpolator.getPose(ros::Time(12, 0), pose));
+  EXPECT_NEAR(3.0, pose.position.x, 1.0e-9);
+  EXPECT_NEAR(6.0, pose.position.y, 1.0e-9);
+  EXPECT_NEAR(-3.0, tf2::getYaw(pose.orientation), 1.0e-9);
+
+  // Queries between states are interpolated, with the yaw following the shortest arc across +/-Pi
+  ASSERT_TRUE(interpolator.getPose(ros::Time(10, 500000000), pose));
+  EXPECT_NEAR(1.5, pose.position.x, 1.0e-9);
+  EXPECT_NEAR(3.0, pose.position.y, 1.0e-9);
+  EXPECT_NEAR(3.0 + 0.25 * (2.0 * M_PI - 6.0), tf2::getYaw(pose.orientation), 1.0e-9);
+
+  // Other devices have no poses
+  fuse_publishers::Pose2DInterpolator other_interpolator(graph, fuse_core::uuid::generate("kitt"));
+  EXPECT_TRUE(other_interpolator.empty());
+
+  // The graph is not modified by the queries
+  EXPECT_EQ(variable_count, std::distance(graph->getVariables().begin(), graph->getVariables().end()));
+}
+
+TEST(Pose2DInterpolator, Velocity)
+{
+  // Drive along a unit circle at 1m/s
+  const double duration = M_PI / 2.0;
+  auto graph = fuse_graphs::HashGraph::make_shared();
+  fuse_core::Transaction transaction;
+  addState(ros::Time(10, 0), 0.0, 0.0, 0.0, transaction, true, 1.0, 1.0);
+  addState(ros::Time(10, 0) + ros::Duration(duration), 1.0, 1.0, M_PI / 2.0, transaction, true, 1.0, 1.0);
+  graph->update(transaction);
+
+  fuse_publishers::Pose2DInterpolator interpolator(graph);
+  geometry_msgs::Pose pose;
+  ASSERT_TRUE(interpolator.getPose(ros::Time(10, 0) + ros::Duration(duration / 2.0), pose));
+  // A straight line would place the midpoint at (0.5, 0.5). The spline follows the circle closely.
+  EXPECT_NEAR(std::sin(M_PI / 4.0), pose.position.x, 0.02);
+  EXPECT_NEAR(1.0 - std::cos(M_PI / 4.0), pose.position.y, 0.02);
+  EXPECT_NEAR(M_PI / 4.0, tf2::getYaw(pose.orientation), 0.02);
+}
+
+TEST(Pose2DInterpolator, Covariance)
+{
+  auto graph = fuse_graphs::HashGraph::make_shared();
+  fuse_core::Transaction transaction;
+  auto position1 = fuse_variables::Position2DStamped::make_shared(ros::Time(10, 0));
+  auto orientation1 = fuse_variables::Orientation2DStamped::make_shared(ros::Time(10, 0));
+  auto position2 = fuse_variables::Position2DStamped::make_shared(ros::Time(11, 0));
+  auto orientation2 = fuse_variables::Orientation2DStamped::make_shared(ros::Time(11, 0));
+  transaction.addVariable(position1);
+  transaction.addVariable(orientation1);
+  transaction.addVariable(position2);
+  transaction.addVariable(orientation2);
+  fuse_core::Vector3d mean1;
+  mean1 << 1.0, 2.0, 0.5;
+  fuse_core::Matrix3d cov1;
+  cov1 << 1.0, 0.1, 0.0,  0.1, 2.0, 0.0,  0.0, 0.0, 3.0;
+  transaction.addConstraint(fuse_constraints::AbsolutePose2DStampedConstraint::make_shared(
+    *position1, *orientation1, mean1, cov1));
+  fuse_core::Vector3d mean2;
+  mean2 << 2.0, 3.0, 1.0;
+  fuse_core::Matrix3d cov2;
+  cov2 << 3.0, 0.0, 0.2,  0.0, 4.0, 0.0,  0.2, 0.0, 5.0;
+  transaction.addConstraint(fuse_constraints::AbsolutePose2DStampedConstraint::make_shared(
+    *position2, *orientation2, mean2, cov2));
+  graph->update(transaction);
+  graph->optimize();
+
+  fuse_publishers::Pose2DInterpolator interpolator(graph);
+  geometry_msgs::PoseWithCovariance pose;
+  ASSERT_TRUE(interpolator.getPoseWithCovariance(ros::Time(10, 250000000), pose));
+  EXPECT_NEAR(1.25, pose.pose.position.x, 1.0e-5);
+  EXPECT_NEAR(2.25, pose.pose.position.y, 1.0e-5);
+  EXPECT_NEAR(0.625, tf2::getYaw(pose.pose.orientation), 1.0e-5);
+  fuse_core::Matrix3d expected = 0.75 * cov1 + 0.25 * cov2;
+  EXPECT_NEAR(expected(0, 0), pose.covariance[0], 1.0e-5);
+  EXPECT_NEAR(expected(0, 1), pose.covariance[1], 1.0e-5);
+  EXPECT_NEAR(expected(0, 2), pose.covariance[5], 1.0e-5);
+  EXPECT_NEAR(expected(1, 1), pose.covariance[7], 1.0e-5);
+  EXPECT_NEAR(expected(2, 0), pose.covariance[30], 1.0e-5);
+  EXPECT_NEAR(expected(2, 2), pose.covariance[35], 1.0e-5);
+  EXPECT_EQ(0.0, pose.covariance[14]);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -45,6 +45,7 @@
 #include <tf2/utils.h>
 #include <tf2_msgs/TFMessage.h>
 #include <tf2_ros/static_transform_broadcaster.h>
+#include <tf2_ros/transform_broadcaster.h>
 
 #include <gtest/gtest.h>
 
@@ -191,7 +192,7 @@ TEST_F(Pose2DPublisherTestFixture, PublishPose)
   private_node_handle_.setParam("test_publisher/base_frame", "test_base");
   private_node_handle_.setParam("test_publisher/publish_to_tf", false);
   fuse_publishers::Pose2DPublisher publisher;
-  publisher.initialize("test_publisher");
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Subscribe to the "pose" topic
   ros::Subscriber subscriber = private_node_handle_.subscribe(
@@ -229,7 +230,7 @@ TEST_F(Pose2DPublisherTestFixture, PublishPoseWithCovariance)
   private_node_handle_.setParam("test_publisher/base_frame", "test_base");
   private_node_handle_.setParam("test_publisher/publish_to_tf", false);
   fuse_publishers::Pose2DPublisher publisher;
-  publisher.initialize("test_publisher");
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Subscribe to the "pose_with_covariance" topic
   ros::Subscriber subscriber = private_node_handle_.subscribe(
@@ -280,7 +281,7 @@ TEST_F(Pose2DPublisherTestFixture, PublishTfWithoutOdom)
   private_node_handle_.setParam("test_publisher/base_frame", "test_base");
   private_node_handle_.setParam("test_publisher/publish_to_tf", true);
   fuse_publishers::Pose2DPublisher publisher;
-  publisher.initialize("test_publisher");
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Subscribe to the "pose" topic
   ros::Subscriber subscriber = private_node_handle_.subscribe(
@@ -319,7 +320,7 @@ TEST_F(Pose2DPublisherTestFixture, PublishTfWithOdom)
   private_node_handle_.setParam("test_publisher/base_frame", "test_base");
   private_node_handle_.setParam("test_publisher/publish_to_tf", true);
   fuse_publishers::Pose2DPublisher publisher;
-  publisher.initialize("test_publisher");
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
 
   // Subscribe to the "pose" topic
   ros::Subscriber subscriber = private_node_handle_.subscribe(
@@ -348,6 +349,68 @@ TEST_F(Pose2DPublisherTestFixture, PublishTfWithOdom)
   EXPECT_NEAR(-2.8631853072, tf2::getYaw(tf_msg_.transforms[0].transform.rotation), 1.0e-9);
 }
 
+TEST_F(Pose2DPublisherTestFixture, PublishTfWithDelayedOdom)
+{
+  // Test that the map->odom transform is published once the odom->base transform arrives, even if the transform was
+  // not available when the graph was received
+
+  // Create a publisher and send it the graph. No transforms exist between these frames yet.
+  private_node_handle_.setParam("test_publisher/map_frame", "test_map");
+  private_node_handle_.setParam("test_publisher/odom_frame", "test_delayed_odom");
+  private_node_handle_.setParam("test_publisher/base_frame", "test_delayed_base");
+  private_node_handle_.setParam("test_publisher/publish_to_tf", true);
+  fuse_publishers::Pose2DPublisher publisher;
+  publisher.initialize("test_publisher", ros::NodeHandle(), ros::NodeHandle("~"));
+
+  // Subscribe to the "tf" topic
+  ros::Subscriber subscriber = private_node_handle_.subscribe(
+    "/tf",
+    1,
+    &Pose2DPublisherTestFixture::tfCallback,
+    reinterpret_cast<Pose2DPublisherTestFixture*>(this));
+
+  // Send the graph to the Publisher
+  publisher.notify(transaction_, graph_);
+  ros::Duration(0.5).sleep();
+
+  // Now publish the odom->base transform at the time of the latest pose
+  geometry_msgs::TransformStamped odom_to_base;
+  odom_to_base.header.stamp = ros::Time(1235, 10);
+  odom_to_base.header.frame_id = "test_delayed_odom";
+  odom_to_base.child_frame_id = "test_delayed_base";
+  odom_to_base.transform.translation.x = -0.10;
+  odom_to_base.transform.translation.y = -0.20;
+  odom_to_base.transform.translation.z = -0.30;
+  odom_to_base.transform.rotation.x = 0.0;
+  odom_to_base.transform.rotation.y = 0.0;
+  odom_to_base.transform.rotation.z = -0.1986693307950612164;
+  odom_to_base.transform.rotation.w = 0.98006657784124162625;  // -0.4rad in yaw
+  tf2_ros::TransformBroadcaster broadcaster;
+  broadcaster.sendTransform(odom_to_base);
+
+  // Verify the subscriber received the expected transform. Other transforms are also published on the tf topic,
+  // so wait for the map->odom transform specifically.
+  ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+  while (ros::Time::now() < timeout)
+  {
+    if (received_tf_msg_ && (tf_msg_.transforms.size() == 1ul) &&
+        (tf_msg_.transforms[0].child_frame_id == "test_delayed_odom"))
+    {
+      break;
+    }
+    ros::Duration(0.10).sleep();
+  }
+
+  ASSERT_TRUE(received_tf_msg_);
+  ASSERT_EQ(1ul, tf_msg_.transforms.size());
+  EXPECT_EQ("test_map", tf_msg_.transforms[0].header.frame_id);
+  EXPECT_EQ("test_delayed_odom", tf_msg_.transforms[0].child_frame_id);
+  EXPECT_NEAR(0.9788154983, tf_msg_.transforms[0].transform.translation.x, 1.0e-9);
+  EXPECT_NEAR(1.8002186614, tf_msg_.transforms[0].transform.translation.y, 1.0e-9);
+  EXPECT_NEAR(0.3000000000, tf_msg_.transforms[0].transform.translation.z, 1.0e-9);
+  EXPECT_NEAR(-2.8631853072, tf2::getYaw(tf_msg_.transforms[0].transform.rotation), 1.0e-9);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);